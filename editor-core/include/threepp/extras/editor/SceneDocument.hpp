@@ -138,6 +138,10 @@ namespace threepp::editor {
         std::vector<Object3D*> editorOnly_;
         std::vector<std::string> warnings_;
 
+        // Kept across saves: saving a .tpz again over the one it last wrote
+        // copies the members that did not change out of it.
+        ObjectExporter exporter_;
+
         struct Listener {
             int id;
             std::function<void(Scene&)> fn;
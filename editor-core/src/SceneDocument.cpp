@@ -143,7 +143,6 @@ bool SceneDocument::saveAs(const std::filesystem::path& path, std::string* error
     detachEditorOnly();
     ExportScope scope([this] { attachEditorOnly(); });
 
-    ObjectExporter exporter;
     ObjectExporterOptions options;
     options.images = imageStorage_;
     options.models = modelStorage_;
@@ -151,14 +150,14 @@ bool SceneDocument::saveAs(const std::filesystem::path& path, std::string* error
 
     try {
         // save() derives the base for relative references from `path`.
-        exporter.save(*scene_, path, options);
+        exporter_.save(*scene_, path, options);
     } catch (const std::exception& e) {
         if (error) *error = e.what();
-        warnings_ = exporter.warnings();
+        warnings_ = exporter_.warnings();
         return false;
     }
 
-    warnings_ = exporter.warnings();
+    warnings_ = exporter_.warnings();
     path_ = path;
     dirty_ = false;
     return true;
@@ -378,7 +378,11 @@ int main(int argc, char** argv) {
             std::cout << "  SOG asset, " << info.lodLevels << " level(s):";
             for (const auto& l : info.levels) std::cout << " [" << l.lod << "] " << l.count;
             std::cout << "\n  reading level " << lodLevel << std::endl;
-            data = SogLoader::load(plyPath, {lodLevel});
+            SogLoader::LoadStats stats;
+            data = SogLoader::load(plyPath, {lodLevel}, stats);
+            std::cout << "  " << stats.planes << " planes in " << stats.chunks << " chunk(s): decode "
+                      << stats.decodeSeconds * 1000 << " ms, dequantize " << stats.dequantizeSeconds * 1000
+                      << " ms" << std::endl;
         } else {
             data = SplatLoader::loadPly(plyPath);
         }
@@ -9,6 +9,7 @@
 namespace threepp {
 
     class AnimationMixer;
+    class CompiledClip;
     class PropertyMixer;
 
     class AnimationAction: public std::enable_shared_from_this<AnimationAction> {
@@ -97,6 +98,14 @@ namespace threepp {
 
         std::vector<std::shared_ptr<PropertyMixer>> _propertyBindings;
 
+        // AnimationMixer::compileClips: the clip's compiled form, each track's
+        // last key interval, and where each track's sample goes (the
+        // interpolants' result buffers, cleared whenever they are rebound).
+        std::shared_ptr<const CompiledClip> _compiled;
+        std::vector<std::uint32_t> _compiledKeys;
+        std::vector<std::vector<float>*> _compiledTargets;
+        bool _compiledUsable = false;
+
         std::optional<size_t> _cacheIndex;      // for the memory manager
         std::optional<size_t> _byClipCacheIndex;// for the memory manager
 
@@ -132,6 +141,8 @@ namespace threepp {
 
         void _update(float time, float deltaTime, int timeDirection, int accuIndex);
 
+        bool _prepareCompiled();
+
         AnimationAction& _scheduleFading(float duration, float weightNow, float weightThen);
 
         float _updateWeight(float time);
@@ -12,6 +12,7 @@ namespace threepp {
 
     class Object3D;
     class AnimationAction;
+    class CompiledClip;
 
     class AnimationClip {
 
@@ -51,8 +52,12 @@ namespace threepp {
         std::vector<std::shared_ptr<KeyframeTrack>> tracks;
         float duration;
 
+        // Built by the first AnimationMixer with compileClips set to play it.
+        std::shared_ptr<const CompiledClip> compiled_;
+
         friend class AnimationAction;
         friend class AnimationMixer;
+        friend class CompiledClip;
     };
 
 }// namespace threepp
@@ -14,6 +14,13 @@ namespace threepp {
         float time{0};
         float timeScale{1.f};
 
+        // Sample clips from a compiled, flat copy of their keyframes rather
+        // than one Interpolant per track: the same pose, bit for bit, for
+        // much less work on rigs with many bones. Each clip is compiled on
+        // first play and shared by every action and mixer using it, so edit
+        // its tracks before playing it, not after.
+        bool compileClips{false};
+
         explicit AnimationMixer(Object3D& root);
 
         AnimationAction* clipAction(const std::shared_ptr<AnimationClip>& clip,
@@ -16,6 +16,8 @@
 
 namespace threepp {
 
+    class BVH;
+
     class BufferGeometry: public EventDispatcher {
 
     public:
@@ -150,6 +152,22 @@ namespace threepp {
 
         void normalizeNormals();
 
+        // Opt-in triangle BVH that Mesh::raycast (and SkinnedMesh picking) walks
+        // instead of testing every triangle. Once computed, the tree follows the
+        // geometry: boundsTree() rebuilds it on first use after the attribute
+        // set, the positions or the index changed — tracked by version, so call
+        // needsUpdate() after editing them in place, as for rendering.
+        void computeBoundsTree();
+
+        void disposeBoundsTree();
+
+        [[nodiscard]] bool hasBoundsTree() const;
+
+        // The current tree, rebuilt first if stale; null unless
+        // computeBoundsTree() was called. Safe to call from several threads; a
+        // rebuild never touches a tree a caller still holds.
+        [[nodiscard]] std::shared_ptr<const BVH> boundsTree();
+
         [[nodiscard]] std::shared_ptr<BufferGeometry> toNonIndexed() const;
 
         void computeVertexNormals();
@@ -171,6 +189,9 @@ namespace threepp {
         std::unordered_map<std::string, std::vector<std::shared_ptr<BufferAttribute>>> morphAttributes_;
         unsigned int attributesVersion_ = 0;// see attributesVersion()
 
+        struct BoundsTree;
+        std::unique_ptr<BoundsTree> boundsTree_;// see computeBoundsTree()
+
         inline static std::atomic<unsigned int> _id{0};
     };
 
@@ -18,9 +18,12 @@
 #include <any>
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 namespace threepp {
 
@@ -298,6 +301,33 @@ namespace threepp {
          */
         virtual void updateWorldMatrix(bool updateParents = false, bool updateChildren = false);
 
+        /**
+         * @brief updateMatrixWorld across the ThreadPool, for wide graphs.
+         *
+         * The top levels are walked on the calling thread until there are enough
+         * independent subtrees to share out; each one of at least minSubtreeSize
+         * nodes goes to a worker, smaller ones stay on the calling thread. Every
+         * world matrix comes out the same, bit for bit, as updateMatrixWorld(force).
+         *
+         * The rule for overrides: only classes known to use Object3D's own
+         * updateMatrixWorld (Object3D, Group, Scene, Bone, Mesh, InstancedMesh,
+         * Points, Line, LineSegments, LineLoop, Sprite, LOD — exact types, not
+         * subclasses) are updated off the calling thread. Any other node — a
+         * camera, a SkinnedMesh, a helper, an AsyncGroup, a user subclass —
+         * is held back until every plain node is done; then its own
+         * updateMatrixWorld runs on the calling thread, for it and its
+         * subtree, in an order fixed by the graph alone. So an override sees
+         * the rest of the graph already updated, where the plain recursion
+         * would have run it midway. A class that wants to be shared out has to
+         * leave updateMatrixWorld alone. If this node is itself held back,
+         * this is just updateMatrixWorld(force).
+         *
+         * Scene is on the list although it overrides updateMatrixWorld: its
+         * override only routes the same matrices through a TransformStore
+         * (Scene::useTransformStore), so the walk may, and does, bypass it.
+         */
+        void updateMatrixWorldParallel(bool force = false, std::size_t minSubtreeSize = 2048);
+
         static std::shared_ptr<Object3D> create() {
 
             return std::make_shared<Object3D>();
@@ -371,8 +401,40 @@ namespace threepp {
         }
 
     private:
+        friend class TransformStore;
+
         inline static std::atomic<unsigned int> _object3Did{0};
 
+        // Bumped on this node and every ancestor whenever a link or unlink
+        // changes the tree below it (add, remove, clear, move, destruction of
+        // an attached node), so a TransformStore rooted here can tell whether
+        // the layout it flattened is still the tree. Per node rather than one
+        // counter for the process, so editing one scene does not make every
+        // other scene's store rebuild.
+        std::uint64_t hierarchyEpoch_ = 0;
+
+        // Bumps hierarchyEpoch_ from this node up to the top of its graph.
+        void markHierarchyChanged();
+
+        // The first half of updateMatrixWorld: bring `matrix` up to date (or
+        // notice an external write to it) and raise matrixWorldNeedsUpdate if
+        // it changed. Shared with TransformStore so both walks poll alike.
+        void pollLocalMatrix();
+
+        // The node's own step of updateMatrixWorld: poll, then recompute
+        // matrixWorld if it or the parent changed. Returns whether it did —
+        // the force its children get.
+        bool updateOwnMatrixWorld(bool force);
+
+        // Whether node's exact type is one of those updateMatrixWorldParallel
+        // lists as using the base updateMatrixWorld unchanged.
+        static bool usesBaseMatrixWorldUpdate(const Object3D& node);
+
+        // updateMatrixWorld for a subtree of such nodes, safe on a worker:
+        // any other node met is appended to `deferred`, with the force flag it
+        // would have been called with, instead of being updated.
+        void updateMatrixWorldDeferring(bool force, std::vector<std::pair<Object3D*, bool>>& deferred);
+
         // Unlink `object` from this node: drop it from `children`, clear its
         // parent, fire "remove", and hand back the owning reference if this node
         // held one. The caller decides whether that reference dies (destroying
@@ -8,7 +8,10 @@
 #include "threepp/math/Ray.hpp"
 #include "threepp/math/Vector2.hpp"
 
+#include <cstddef>
 #include <limits>
+#include <optional>
+#include <span>
 #include <vector>
 
 namespace threepp {
@@ -31,6 +34,14 @@ namespace threepp {
         std::optional<float> distanceToRay;
     };
 
+    // See Raycaster::intersectBatch.
+    struct RaycastBatchOptions {
+        bool recursive = true;
+        // Rays one task tests against each object in turn, so an object's
+        // data stays in cache across the packet.
+        std::size_t raysPerPacket = 64;
+    };
+
     class Raycaster {
 
     public:
@@ -47,6 +58,11 @@ namespace threepp {
         };
         Params params;
 
+        // Meshes report only their nearest hit instead of every triangle the
+        // ray crosses. With a bounds tree (BufferGeometry::computeBoundsTree)
+        // that lets the traversal stop early.
+        bool firstHitOnly = false;
+
         explicit Raycaster(const Vector3& origin = Vector3(), const Vector3& direction = Vector3(), float _near = 0, float _far = std::numeric_limits<float>::infinity());
 
         void set(const Vector3& origin, const Vector3& direction);
@@ -56,6 +72,26 @@ namespace threepp {
         std::vector<Intersection> intersectObject(Object3D& object, bool recursive = false);
 
         std::vector<Intersection> intersectObjects(const std::vector<Object3D*>& objects, bool recursive = false);
+
+        using BatchOptions = RaycastBatchOptions;
+
+        // Many rays against the same objects. `ray` is ignored; nearPlane,
+        // farPlane, layers and params apply to every ray. The object list is
+        // flattened once, each object is culled per ray on its world bounding
+        // sphere, and packets of rays run on the thread pool. hits[i] receives
+        // ray i's closest hit — what intersectObjects(...).front() would give
+        // — or nullopt. No allocation per ray.
+        //
+        // Plain Meshes are cast concurrently. Objects whose raycast keeps
+        // shared scratch state (SkinnedMesh, InstancedMesh, Line, Points,
+        // Sprite, ...) are cast on the calling thread afterwards.
+        void intersectBatch(std::span<const Ray> rays, const std::vector<Object3D*>& objects,
+                            std::span<std::optional<Intersection>> hits, const BatchOptions& options = {}) const;
+
+        // Occlusion variant: occluded[i] is whether ray i hits anything at all
+        // within [nearPlane, farPlane]; a ray stops at its first hit object.
+        void intersectBatchAny(std::span<const Ray> rays, const std::vector<Object3D*>& objects,
+                               std::span<bool> occluded, const BatchOptions& options = {}) const;
     };
 
 }// namespace threepp
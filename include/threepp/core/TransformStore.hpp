@@ -0,0 +1,58 @@
+
+#ifndef THREEPP_TRANSFORMSTORE_HPP
+#define THREEPP_TRANSFORMSTORE_HPP
+
+#include <cstddef>
+#include <memory>
+
+namespace threepp {
+
+    class Object3D;
+
+    // A flattened copy of a graph's layout for updateMatrixWorld: every node
+    // under root in one parent-before-child array, with each node's parent as
+    // an index. update() is then a single linear pass — poll the local matrix, and if
+    // it or the parent changed, multiply — instead of a virtual call and a
+    // walk of `children` per node.
+    //
+    // Produces exactly what root->updateMatrixWorld(force) does, bit for bit
+    // and in the same order. Types that override updateMatrixWorld (cameras,
+    // skinned meshes, helpers, audio, ...) are kept whole: the pass calls
+    // their override where the recursion would have, and it handles their
+    // subtree. The root's own override, if it has one, is skipped — the store
+    // is how it updates.
+    //
+    // The layout is rebuilt on the first update() after any node under root is
+    // added, removed or destroyed; changes to other graphs leave it alone. A
+    // graph that changes shape every frame gains nothing. Holds raw pointers; must not outlive root.
+    class TransformStore {
+
+    public:
+        explicit TransformStore(Object3D& root);
+
+        TransformStore(const TransformStore&) = delete;
+        TransformStore& operator=(const TransformStore&) = delete;
+
+        // Same contract as root.updateMatrixWorld(force).
+        void update(bool force = false);
+
+        [[nodiscard]] Object3D& root() const;
+
+        // Nodes in the flattened layout (as of the last update); the subtree
+        // below a node with its own updateMatrixWorld is not counted.
+        [[nodiscard]] std::size_t size() const;
+
+        // How many times the layout has been built, the first update()
+        // included.
+        [[nodiscard]] std::size_t rebuilds() const;
+
+        ~TransformStore();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+}// namespace threepp
+
+#endif//THREEPP_TRANSFORMSTORE_HPP
@@ -19,6 +19,7 @@
 #include "threepp/core/BufferGeometry.hpp"
 #include "threepp/objects/Mesh.hpp"
 #include "threepp/textures/DataTexture.hpp"
+#include "threepp/utils/Parallel.hpp"
 #include "threepp/math/Matrix3.hpp"
 
 #include <PxPhysicsAPI.h>
@@ -57,7 +58,6 @@
 #include <cmath>
 #include <memory>
 #include <stdexcept>
-#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -801,49 +801,60 @@ namespace threepp {
 
             const auto& vpos = vPosAttr->array();
             const float eps = 5e-3f;
-            unsigned threads = std::thread::hardware_concurrency();
-            if (threads == 0) threads = 1;
-            const size_t chunk = (vVerts + threads - 1) / threads;
-            std::vector<std::thread> ths;
-            ths.reserve(threads);
-            for (unsigned t = 0; t < threads; ++t) {
-                size_t start = t * chunk;
-                size_t end = std::min(start + chunk, vVerts);
-                if (start >= end) break;
-                ths.emplace_back([&, start, end]() {
-                    // Barycentric coordinates of v in T. Not clamped: outside a
-                    // tet they go negative and still sum to 1, which is what
-                    // makes an outside vertex reproduce EXACTLY at rest.
-                    const auto baryOf = [](const PxVec3& v, const TetData& T, TetBind& out) {
-                        const float V = tet_util::tetVolume6(T.p0, T.p1, T.p2, T.p3);
-                        if (std::fabs(V) < 1e-8f) return false;
-                        float w0 = tet_util::tetVolume6(v, T.p1, T.p2, T.p3) / V;
-                        float w1 = tet_util::tetVolume6(T.p0, v, T.p2, T.p3) / V;
-                        float w2 = tet_util::tetVolume6(T.p0, T.p1, v, T.p3) / V;
-                        float w3 = tet_util::tetVolume6(T.p0, T.p1, T.p2, v) / V;
-                        float sum = w0 + w1 + w2 + w3;
-                        if (std::fabs(sum) < 1e-6f) sum = 1.0f;
-                        out = {T.i0, T.i1, T.i2, T.i3, w0 / sum, w1 / sum, w2 / sum, w3 / sum};
-                        return true;
-                    };
-
-                    for (size_t vi = start; vi < end; ++vi) {
-                        PxVec3 v(vpos[vi * 3 + 0], vpos[vi * 3 + 1], vpos[vi * 3 + 2]);
-                        float bestDist = FLT_MAX;
-                        const TetData* bestTet = nullptr;
-                        bool found = false;
+            // Per-vertex cost varies a lot (stray vertices fall through to the
+            // full closest-tet scan), so small pieces and let the pool balance.
+            parallelFor(0, vVerts, 64, [&](size_t start, size_t end) {
+                // Barycentric coordinates of v in T. Not clamped: outside a
+                // tet they go negative and still sum to 1, which is what
+                // makes an outside vertex reproduce EXACTLY at rest.
+                const auto baryOf = [](const PxVec3& v, const TetData& T, TetBind& out) {
+                    const float V = tet_util::tetVolume6(T.p0, T.p1, T.p2, T.p3);
+                    if (std::fabs(V) < 1e-8f) return false;
+                    float w0 = tet_util::tetVolume6(v, T.p1, T.p2, T.p3) / V;
+                    float w1 = tet_util::tetVolume6(T.p0, v, T.p2, T.p3) / V;
+                    float w2 = tet_util::tetVolume6(T.p0, T.p1, v, T.p3) / V;
+                    float w3 = tet_util::tetVolume6(T.p0, T.p1, T.p2, v) / V;
+                    float sum = w0 + w1 + w2 + w3;
+                    if (std::fabs(sum) < 1e-6f) sum = 1.0f;
+                    out = {T.i0, T.i1, T.i2, T.i3, w0 / sum, w1 / sum, w2 / sum, w3 / sum};
+                    return true;
+                };
+
+                for (size_t vi = start; vi < end; ++vi) {
+                    PxVec3 v(vpos[vi * 3 + 0], vpos[vi * 3 + 1], vpos[vi * 3 + 2]);
+                    float bestDist = FLT_MAX;
+                    const TetData* bestTet = nullptr;
+                    bool found = false;
+                    for (const TetData& T : tetsData) {
+                        if (v.x < T.aabbMin.x || v.x > T.aabbMax.x ||
+                            v.y < T.aabbMin.y || v.y > T.aabbMax.y ||
+                            v.z < T.aabbMin.z || v.z > T.aabbMax.z) continue;
+                        TetBind bind{};
+                        if (!baryOf(v, T, bind)) continue;
+                        if (bind.w0 >= -eps && bind.w1 >= -eps &&
+                            bind.w2 >= -eps && bind.w3 >= -eps) {
+                            bindings_[vi] = bind;
+                            found = true;
+                            break;
+                        }
+                        auto r = tet_util::closestPointTetrahedron(v, T.p0, T.p1, T.p2, T.p3);
+                        const float d2 = (r.point - v).magnitudeSquared();
+                        if (d2 < bestDist) {
+                            bestDist = d2;
+                            bestTet = &T;
+                        }
+                    }
+                    if (found) continue;
+
+                    // The AABB pad is a speed filter, not a correctness
+                    // bound. A visual vertex can sit further outside the
+                    // collision hull than the pad — the remeshed hull cuts
+                    // the corners of a rotated box, for one — and leaving
+                    // such a vertex on an arbitrary tet teleports it, and
+                    // the whole face it belongs to, into the middle of the
+                    // body. Only the stray vertices pay for this pass.
+                    if (!bestTet) {
                         for (const TetData& T : tetsData) {
-                            if (v.x < T.aabbMin.x || v.x > T.aabbMax.x ||
-                                v.y < T.aabbMin.y || v.y > T.aabbMax.y ||
-                                v.z < T.aabbMin.z || v.z > T.aabbMax.z) continue;
-                            TetBind bind{};
-                            if (!baryOf(v, T, bind)) continue;
-                            if (bind.w0 >= -eps && bind.w1 >= -eps &&
-                                bind.w2 >= -eps && bind.w3 >= -eps) {
-                                bindings_[vi] = bind;
-                                found = true;
-                                break;
-                            }
                             auto r = tet_util::closestPointTetrahedron(v, T.p0, T.p1, T.p2, T.p3);
                             const float d2 = (r.point - v).magnitudeSquared();
                             if (d2 < bestDist) {
@@ -851,53 +862,31 @@ namespace threepp {
                                 bestTet = &T;
                             }
                         }
-                        if (found) continue;
-
-                        // The AABB pad is a speed filter, not a correctness
-                        // bound. A visual vertex can sit further outside the
-                        // collision hull than the pad — the remeshed hull cuts
-                        // the corners of a rotated box, for one — and leaving
-                        // such a vertex on an arbitrary tet teleports it, and
-                        // the whole face it belongs to, into the middle of the
-                        // body. Only the stray vertices pay for this pass.
-                        if (!bestTet) {
-                            for (const TetData& T : tetsData) {
-                                auto r = tet_util::closestPointTetrahedron(v, T.p0, T.p1, T.p2, T.p3);
-                                const float d2 = (r.point - v).magnitudeSquared();
-                                if (d2 < bestDist) {
-                                    bestDist = d2;
-                                    bestTet = &T;
-                                }
-                            }
-                        }
-                        if (!bestTet) bestTet = &tetsData[0];
-
-                        // Bind by extrapolation from the nearest tet, so a
-                        // vertex outside the hull sits exactly where it was
-                        // authored instead of snapped onto the hull surface
-                        // (which visibly rounds off sharp corners). Runaway
-                        // weights would amplify that tet's deformation, so a
-                        // far-outside vertex still falls back to the clamped
-                        // surface point.
-                        TetBind bind{};
-                        const bool usable =
-                                baryOf(v, *bestTet, bind) &&
-                                std::max({std::fabs(bind.w0), std::fabs(bind.w1),
-                                          std::fabs(bind.w2), std::fabs(bind.w3)}) <= 2.f;
-                        if (usable) {
-                            bindings_[vi] = bind;
-                        } else {
-                            auto r = tet_util::closestPointTetrahedron(
-                                    v, bestTet->p0, bestTet->p1, bestTet->p2, bestTet->p3);
-                            bindings_[vi] = {bestTet->i0, bestTet->i1, bestTet->i2, bestTet->i3,
-                                             r.w0, r.w1, r.w2, r.w3};
-                        }
                     }
-                });
-            }
-            for (auto& th : ths) {
-                if (th.joinable()) th.join();
-            }
+                    if (!bestTet) bestTet = &tetsData[0];
+
+                    // Bind by extrapolation from the nearest tet, so a
+                    // vertex outside the hull sits exactly where it was
+                    // authored instead of snapped onto the hull surface
+                    // (which visibly rounds off sharp corners). Runaway
+                    // weights would amplify that tet's deformation, so a
+                    // far-outside vertex still falls back to the clamped
+                    // surface point.
+                    TetBind bind{};
+                    const bool usable =
+                            baryOf(v, *bestTet, bind) &&
+                            std::max({std::fabs(bind.w0), std::fabs(bind.w1),
+                                      std::fabs(bind.w2), std::fabs(bind.w3)}) <= 2.f;
+                    if (usable) {
+                        bindings_[vi] = bind;
+                    } else {
+                        auto r = tet_util::closestPointTetrahedron(
+                                v, bestTet->p0, bestTet->p1, bestTet->p2, bestTet->p3);
+                        bindings_[vi] = {bestTet->i0, bestTet->i1, bestTet->i2, bestTet->i3,
+                                         r.w0, r.w1, r.w2, r.w3};
+                    }
+                }
+            });
         }
     };
 
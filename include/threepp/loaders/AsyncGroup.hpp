@@ -42,6 +42,8 @@ namespace threepp {
         std::unique_ptr<Impl> pimpl_;
     };
 
+    // Queued on LoaderService::global() at normal priority; see LoaderService
+    // for priorities and de-duplication.
     std::shared_ptr<AsyncGroup> loadAsync(std::function<std::shared_ptr<Group>()> loadFn);
 
     template<typename LoaderT, typename... Args>
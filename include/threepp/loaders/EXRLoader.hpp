@@ -27,9 +27,19 @@ namespace threepp {
     //
     // Channels are matched by name: R, G, B and A, or Y alone for a luminance
     // image (broadcast to RGB). Alpha defaults to 1 when the file has none.
+    //
+    // Chunks are decompressed in parallel on ThreadPool::global(), each
+    // straight into its rows of the final image.
     class EXRLoader {
 
     public:
+        // Return a HalfFloat texture holding the raw half bits instead of
+        // widening every sample to float: half the memory, and HALF channels —
+        // what nearly every EXR stores — come through untouched. FLOAT and UINT
+        // channels are rounded to half. The GL renderer uploads these as
+        // RGBA16F; the Vulkan environment path only takes Float textures.
+        bool halfFloat = false;
+
         std::shared_ptr<Texture> load(const std::filesystem::path& path, bool flipY = true);
 
         std::shared_ptr<Texture> loadFromMemory(const std::vector<unsigned char>& data,
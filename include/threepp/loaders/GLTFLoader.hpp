@@ -5,9 +5,13 @@
 #include "threepp/loaders/MaterialVariants.hpp"
 #include "threepp/threepp.hpp"
 
+#include <cstddef>
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <span>
+#include <string>
 
 namespace threepp {
 
@@ -30,7 +34,46 @@ namespace threepp {
         // widen-everything behaviour.
         bool preserveNarrowAttributes = true;
 
+        // The images the materials use are decoded before the scene is built,
+        // in parallel on the thread pool, with at most this many read and
+        // decoded at once (0 = one per pool thread). Each in flight holds its
+        // encoded bytes and the decoder's working memory; 1 decodes them one
+        // after another.
+        unsigned maxImagesInFlight = 0;
+
+        // Looks up a URI the document references — an external buffer or
+        // image — for a model loaded from memory. The bytes must stay valid
+        // until load() returns; nullopt when there is no such resource.
+        using Resolver = std::function<std::optional<std::span<const std::byte>>(const std::string& uri)>;
+
+        // What one load() decoded on the way to the scene. Decoded meshopt
+        // bufferViews and Draco accessors are dropped after their last read,
+        // so the two "held" counts are what was still cached when the scene
+        // was done: 0 unless a read was miscounted.
+        struct LoadStats {
+            std::size_t meshoptViewsDecoded{};
+            std::size_t dracoPrimitivesDecoded{};
+            std::size_t meshoptViewsHeld{};
+            std::size_t dracoAccessorsHeld{};
+        };
+
+        // The file is memory-mapped, as are the .bin buffers and images it
+        // references: accessors decode straight out of the mapping.
+        //
+        // KHR_draco_mesh_compression primitives are decoded only when threepp
+        // is built with THREEPP_WITH_DRACO, which is experimental: that path
+        // has not yet been run against a real Draco build. Without it, a
+        // Draco primitive is read from its uncompressed fallback accessors,
+        // and a file listing the extension in extensionsRequired fails.
         std::optional<GLTFResult> load(const std::filesystem::path& path);
+        std::optional<GLTFResult> load(const std::filesystem::path& path, LoadStats& stats);
+
+        // A .glb (told apart by its magic number) or .gltf already in memory,
+        // used in place: the bytes must stay valid until load() returns.
+        // Without a resolver, a document referencing external files fails to
+        // load.
+        std::optional<GLTFResult> load(std::span<const std::byte> data, const Resolver& resolver = {});
+        std::optional<GLTFResult> load(std::span<const std::byte> data, const Resolver& resolver, LoadStats& stats);
 
     private:
         struct Impl;
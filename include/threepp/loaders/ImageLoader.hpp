@@ -2,8 +2,10 @@
 #ifndef THREEPP_IMAGELOADER_HPP
 #define THREEPP_IMAGELOADER_HPP
 
+#include <cstddef>
 #include <filesystem>
 #include <optional>
+#include <span>
 
 #include <threepp/textures/Image.hpp>
 
@@ -14,6 +16,8 @@ namespace threepp {
     public:
         std::optional<Image> load(const std::filesystem::path& imagePath, int channels = 4, bool flipY = true);
         std::optional<Image> load(const std::vector<unsigned char>& data, int channels = 4, bool flipY = true);
+        // Decodes in place, e.g. from a ZipReader::view, without copying the encoded bytes first.
+        std::optional<Image> load(std::span<const std::byte> data, int channels = 4, bool flipY = true);
     };
 
 }// namespace threepp
@@ -0,0 +1,94 @@
+// The queue behind loadAsync.
+//
+// A fixed set of loader threads drains three priority classes — visible
+// first, then normal, then background, each in submission order — so opening
+// a scene with hundreds of linked models runs a handful of loads at once
+// instead of a thread per model competing for the disk. The loaders
+// themselves still fan out on ThreadPool::global() inside a load; these
+// threads are the ones waiting on files.
+//
+// A request made with a key (ModelLoader uses the canonical path) joins one
+// already queued or running under that key instead of loading it again: the
+// first AsyncGroup receives the result, the others a clone of it. A request
+// whose AsyncGroups have all been destroyed before it starts is dropped
+// without running; one that is already running finishes, and its result is
+// discarded.
+
+#ifndef THREEPP_LOADERSERVICE_HPP
+#define THREEPP_LOADERSERVICE_HPP
+
+#include "threepp/loaders/AsyncGroup.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace threepp {
+
+    class LoaderService {
+
+    public:
+        enum class Priority {
+            Visible,
+            Normal,
+            Background
+        };
+
+        struct Stats {
+            std::size_t submitted = 0;   // requests, not counting the ones that joined another
+            std::size_t deduplicated = 0;// requests that joined one in flight under their key
+            std::size_t pending = 0;     // queued, not started
+            std::size_t running = 0;
+            std::size_t completed = 0;   // returned a Group
+            std::size_t failed = 0;      // threw, or returned nullptr
+            std::size_t cancelled = 0;   // dropped: every AsyncGroup was gone
+            std::uint64_t bytes = 0;     // declared by the completed requests
+            double activeSeconds = 0;    // wall time with at least one load running
+
+            // Finished (completed, failed or cancelled) out of submitted; 1
+            // when nothing was ever submitted.
+            [[nodiscard]] double progress() const;
+
+            [[nodiscard]] double loadsPerSecond() const;
+
+            [[nodiscard]] double bytesPerSecond() const;
+        };
+
+        // numWorkers = 0 picks min(4, hardware_concurrency()).
+        explicit LoaderService(unsigned numWorkers = 0);
+
+        LoaderService(const LoaderService&) = delete;
+        LoaderService& operator=(const LoaderService&) = delete;
+
+        // Queue loadFn; the returned AsyncGroup receives its result. `bytes`
+        // is only counted, for bytesPerSecond().
+        std::shared_ptr<AsyncGroup> load(std::function<std::shared_ptr<Group>()> loadFn,
+                                         Priority priority = Priority::Normal,
+                                         const std::string& key = {},
+                                         std::uint64_t bytes = 0);
+
+        [[nodiscard]] unsigned numWorkers() const;
+
+        [[nodiscard]] Stats stats() const;
+
+        // Block until nothing is queued or running. Returns at once under
+        // Emscripten, where loads run from the event loop this would block.
+        void waitIdle() const;
+
+        // The service loadAsync uses, created on first use. It is guaranteed
+        // to be stopped, and its workers joined, before ThreadPool::global()
+        // is destroyed at exit.
+        static LoaderService& global();
+
+        // Drops whatever is still queued and waits for the running loads.
+        ~LoaderService();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+}// namespace threepp
+
+#endif//THREEPP_LOADERSERVICE_HPP
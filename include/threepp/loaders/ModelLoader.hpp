@@ -4,6 +4,7 @@
 
 #include "threepp/loaders/AsyncGroup.hpp"
 #include "threepp/loaders/Loader.hpp"
+#include "threepp/loaders/LoaderService.hpp"
 #include "threepp/objects/Group.hpp"
 
 #include <filesystem>
@@ -21,8 +22,12 @@ namespace threepp {
         [[nodiscard]] std::shared_ptr<Group> load(const std::filesystem::path& path) override;
 
         // Async variant — returns an empty AsyncGroup immediately.
-        // Children appear automatically once loading completes.
-        [[nodiscard]] std::shared_ptr<AsyncGroup> loadAsync(const std::filesystem::path& path);
+        // Children appear automatically once loading completes. Queued on
+        // LoaderService::global() under the file's canonical path, so asking
+        // for a file already on its way loads it once; the loader is copied,
+        // so it need not outlive the call.
+        [[nodiscard]] std::shared_ptr<AsyncGroup> loadAsync(const std::filesystem::path& path,
+                                                            LoaderService::Priority priority = LoaderService::Priority::Normal);
 
         // Propagates to inner loaders that have a file-level up-axis (Collada,
         // USD). Use when this ModelLoader is being driven by an outer system
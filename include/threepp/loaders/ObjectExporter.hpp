@@ -3,8 +3,11 @@
 #ifndef THREEPP_OBJECTEXPORTER_HPP
 #define THREEPP_OBJECTEXPORTER_HPP
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace threepp {
@@ -60,7 +63,7 @@ namespace threepp {
         // The JSON document alone. Whatever `images`/`models` ask for.
         Json,
 
-        // One .tpz file: an uncompressed zip holding scene.json next to the
+        // One .tpz file: a zip holding scene.json next to the
         // images and the geometry, so the document is self-contained AND cheap.
         // Images go in as their ORIGINAL encoded bytes (no base64, no PNG
         // re-encode) and geometry as raw little-endian binary, which is what
@@ -70,6 +73,23 @@ namespace threepp {
         Archive,
     };
 
+    // How geometry's numbers are written into a plain JSON document.
+    enum class GeometryEncoding {
+
+        // An `array` of JSON numbers per attribute, as three.js writes them.
+        // Readable by any three.js loader, and by far the slowest part of the
+        // document to parse.
+        Numbers,
+
+        // Each geometry's index and attributes back to back in one base64
+        // blob under the document's top-level `threeppBuffers`, with a
+        // url/byteOffset/byteLength window in each entry — the archive's binary
+        // sections, carried inside the document. Still one file, about 4/3 the
+        // size of the raw bytes, and decoded rather than parsed on load. A
+        // three.js loader does not know the key and gets no geometry.
+        Base64,
+    };
+
     struct ObjectExporterOptions {
 
         ImageStorage images = ImageStorage::Embed;
@@ -78,6 +98,16 @@ namespace threepp {
 
         DocumentFormat format = DocumentFormat::Auto;
 
+        // Only affects plain JSON; an archive always stores geometry as its
+        // own binary members.
+        GeometryEncoding geometry = GeometryEncoding::Numbers;
+
+        // Deflate the geometry buffers and scene.json inside an archive. Index
+        // and attribute data often halves; images are already compressed and
+        // stay stored. Costs time on save (entries compress in parallel) and a
+        // copy on load, so it is off by default. Only affects archives.
+        bool compressArchive = false;
+
         // Directory that Reference paths are written relative to. save() fills
         // this in from the output file when it is left empty; toJson() has no
         // file to infer it from, so set it there or get absolute paths.
@@ -102,6 +132,15 @@ namespace threepp {
         // options say so — the single-file archive. The archive is written
         // through a temp file and renamed over the target, so a crash mid-save
         // cannot destroy the archive that was already there.
+        //
+        // Saving an archive again to the path this exporter last saved one to
+        // is incremental: a geometry section, image or linked asset whose
+        // content hash matches what went into that archive is copied out of
+        // it as stored, rather than assembled, PNG-encoded, checksummed and
+        // deflated again; what did change is encoded in parallel. The file is
+        // byte-identical to a full save of the same scene. Only while the file
+        // is still the one that was written (same size and modification time)
+        // and can be memory-mapped; otherwise the save is a full one.
         void save(Object3D& object, const std::filesystem::path& path, const ObjectExporterOptions& options = {});
 
         // Everything the last toJson()/save() could not represent (a texture
@@ -111,11 +150,24 @@ namespace threepp {
         [[nodiscard]] const std::vector<std::string>& warnings() const;
 
     private:
+        // What one archive save() wrote: each member's content hash, and
+        // whether deflate was asked for it, as of the file's size and time.
+        struct ArchiveManifest {
+            std::filesystem::path path;
+            std::uintmax_t size{};
+            std::filesystem::file_time_type time{};
+            std::unordered_map<std::string, std::pair<std::uint64_t, bool>> members;
+        };
+
         // The one export routine. `archive` non-null routes images and geometry
-        // into it as their own members, leaving urls behind in the JSON.
-        std::string write(Object3D& object, const ObjectExporterOptions& options, ZipWriter* archive);
+        // into it as their own members, leaving urls behind in the JSON; then
+        // `manifest` (non-null) receives what they were.
+        std::string write(Object3D& object, const ObjectExporterOptions& options, ZipWriter* archive,
+                          ArchiveManifest* manifest = nullptr);
 
         std::vector<std::string> warnings_;
+
+        ArchiveManifest lastArchive_;
     };
 
 }// namespace threepp
@@ -11,6 +11,13 @@ namespace threepp {
     class STLLoader {
 
     public:
+        // Weld triangle corners that share a position into an indexed
+        // geometry, with smooth vertex normals computed from the welded mesh
+        // in place of STL's per-facet ones. A closed part keeps about a third
+        // of the vertex data; off, the geometry is STL's flat, unindexed
+        // triangles.
+        bool weld = false;
+
         [[nodiscard]] std::shared_ptr<BufferGeometry> load(const std::filesystem::path& path) const;
     };
 
@@ -133,6 +133,19 @@ namespace threepp {
             std::vector<ChunkInfo> chunks;
         };
 
+        // Where one load() spent its time, phase by phase, in wall-clock
+        // seconds. Each phase runs across ThreadPool::global() by itself:
+        // every plane of the level is decoded concurrently, then each chunk is
+        // dequantized in parallel over its splats.
+        struct LoadStats {
+
+            std::size_t chunks{};
+            std::size_t planes{};        // images decoded, five to seven per chunk
+            double parseSeconds{};       // resolving the asset, reading its json
+            double decodeSeconds{};      // reading and decoding the planes
+            double dequantizeSeconds{};  // planes to SplatData, normalize, validate
+        };
+
         // What an asset holds, without decoding a single plane. Reads only the
         // json — milliseconds against the ~1.2 GB resident that load() of
         // level 0 costs, which is exactly why it exists: a caller deserves to
@@ -182,6 +195,10 @@ namespace threepp {
         // still isn't, which GCC rejects.
         [[nodiscard]] static SplatData load(const std::filesystem::path& path, const Options& options);
 
+        // As above, and reports where the time went.
+        [[nodiscard]] static SplatData load(const std::filesystem::path& path, const Options& options,
+                                            LoadStats& stats);
+
         // Same resolution rules and the same exceptions as load(), but reads
         // only the json.
         [[nodiscard]] static Info describe(const std::filesystem::path& path);
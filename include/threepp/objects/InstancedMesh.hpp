@@ -44,6 +44,13 @@ namespace threepp {
 
         void dispose();
 
+        // Walks a tree over the instances' bounds, built on first use and
+        // refitted when instanceMatrix's version changes — call
+        // instanceMatrix()->needsUpdate() after setMatrixAt, as for rendering.
+        // Only instances whose box the ray enters are cast into, each through
+        // Mesh::raycast, so a geometry bounds tree (computeBoundsTree) serves
+        // every instance. With firstHitOnly, only the nearest hit of all
+        // instances is reported.
         void raycast(const Raycaster& raycaster, std::vector<Intersection>& intersects) override;
 
         static std::shared_ptr<InstancedMesh> create(
@@ -70,6 +77,11 @@ namespace threepp {
         Box3 _box3;
 
         std::vector<Intersection> _instanceIntersects;
+
+        struct InstanceTree;
+        std::unique_ptr<InstanceTree> instanceTree_;// see raycast()
+
+        const InstanceTree* updateInstanceTree();
     };
 
 }// namespace threepp
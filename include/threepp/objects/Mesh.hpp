@@ -27,6 +27,19 @@ namespace threepp {
 
         void raycast(const Raycaster& raycaster, std::vector<Intersection>& intersects) override;
 
+        // raycast() with the bounds tree already looked up through
+        // raycastBoundsTree(), for callers casting many rays at one mesh
+        // (Raycaster::intersectBatch): the lookup locks the geometry, which
+        // pool workers would otherwise contend on once per ray. Null tests
+        // every triangle.
+        void raycastWithTree(const Raycaster& raycaster, std::vector<Intersection>& intersects, const BVH* tree);
+
+        // The geometry's bounds tree when raycast() may use it in place of the
+        // full triangle loop, in this object's local space (see
+        // raycastBoundingSphere). Null falls back to the loop — e.g. while
+        // morph targets are active, since the tree holds the unmorphed positions.
+        virtual std::shared_ptr<const BVH> raycastBoundsTree();
+
         void copy(const Object3D& source, bool recursive = true) override;
 
         static std::shared_ptr<Mesh> create(
@@ -56,6 +69,11 @@ namespace threepp {
         virtual const Box3* raycastBoundingBox();
 
         std::shared_ptr<Object3D> createDefault() override;
+
+    private:
+        // resolveTree: look the tree up, after the bounding volumes have had
+        // their chance to reject the ray; otherwise use `tree` as given.
+        void raycastImpl(const Raycaster& raycaster, std::vector<Intersection>& intersects, const BVH* tree, bool resolveTree);
     };
 
 }// namespace threepp
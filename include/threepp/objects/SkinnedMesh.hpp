@@ -6,6 +6,8 @@
 
 #include "threepp/objects/Skeleton.hpp"
 
+#include <span>
+
 namespace threepp {
 
     class SkinnedMesh: public Mesh {
@@ -22,10 +24,25 @@ namespace threepp {
 
         std::shared_ptr<Skeleton> skeleton = nullptr;
 
+        // How posedBoundingBox is worked out. By default it is the union of
+        // one box per bone — each bone's share of the vertices, boxed in that
+        // bone's bind frame by bind() — carried to where the bone is now:
+        // O(bones) a frame, and never smaller than the drawn mesh, though
+        // looser where weights blend bones that have rotated apart. Set this
+        // to skin every vertex instead, for the tight box at O(vertices).
+        //
+        // Skin weights that do not sum to one, or negative ones, break the
+        // guarantee, and so do morph targets, which the bone boxes do not
+        // see: such a mesh — or one with a morph currently applied — gets the
+        // exact pass whatever this says.
+        bool exactPosedBounds{false};
+
         SkinnedMesh(const std::shared_ptr<BufferGeometry>& geometry, const std::shared_ptr<Material>& material);
 
         [[nodiscard]] std::string type() const override;
 
+        // Also boxes each bone's vertices for posedBoundingBox, so bind again
+        // after replacing the skin attributes or the bone inverses.
         void bind(const std::shared_ptr<Skeleton>& skeleton, std::optional<Matrix4> bindMatrix = {});
 
         void pose() const;
@@ -36,6 +53,22 @@ namespace threepp {
 
         void boneTransform(size_t index, Vector3& target);
 
+        // Vertices [first, first + positions.size()) as drawn, in the frame
+        // boneTransform answers in: morph targets applied (when the material
+        // enables them, as the renderer does), then skinned. normals, if not
+        // empty, must be the same size and receives the normals skinned the
+        // way the vertex shader does it, renormalised (zero where the
+        // geometry has none).
+        //
+        // Vectorised four vertices at a time (SSE2; scalar elsewhere, or with
+        // THREEPP_NO_SIMD), and split across ThreadPool::global() when the
+        // batch is large enough to pay for it. Every path gives the same bits.
+        void skinVertices(std::span<Vector3> positions, std::span<Vector3> normals = {}, std::size_t first = 0);
+
+        // Every vertex as skinVertices poses it, cached until the next
+        // updateMatrixWorld. What raycasting tests triangles against.
+        const std::vector<Vector3>& posedPositions();
+
         // This mesh's bounds AS POSED, in its own local space — the frame
         // boneTransform answers in, and the one a raycaster's local ray lives
         // in. Recomputed from the skeleton on demand and cached until the next
@@ -57,14 +90,44 @@ namespace threepp {
         const Sphere* raycastBoundingSphere() override;
         const Box3* raycastBoundingBox() override;
 
+        // The geometry's tree refitted to the current pose. Same topology, so a
+        // new pose costs one pass over the vertices — which the posed bounds
+        // already make — rather than a rebuild.
+        std::shared_ptr<const BVH> raycastBoundsTree() override;
+
     private:
         // Marked stale by updateMatrixWorld; filled by the two accessors above.
         bool posedBoundsDirty_ = true;
         Box3 posedBox_;
         Sphere posedSphere_;
 
+        // The posed vertices skinPositions produced, and the tree refitted to
+        // them while the geometry has one.
+        std::vector<Vector3> posedPositions_;
+        bool posedPositionsDirty_ = true;
+        std::shared_ptr<BVH> posedTree_;
+        std::shared_ptr<const BVH> posedTreeSource_;
+        bool posedTreeDirty_ = true;
+
+        // Per bone, the bind-frame box of the vertices it moves; empty for a
+        // bone that moves none. Keyed on what it was built from, so a mesh
+        // bound before its skin attributes were set catches up on first use.
+        std::vector<Box3> boneBoxes_;
+        const BufferGeometry* boneBoxesGeometry_ = nullptr;
+        const Skeleton* boneBoxesSkeleton_ = nullptr;
+        std::size_t boneBoxesVertexCount_ = 0;
+        bool boneBoxesUsable_ = false;
+
         void computePosedBounds();
 
+        void computeBoneBoxes();
+
+        // Whether skinVertices would move any vertex by a morph target now.
+        bool morphsApplied();
+
+        // Every vertex through skinVertices into posedPositions_, expanding box.
+        void skinPositions(Box3& box);
+
     public:
         static std::shared_ptr<SkinnedMesh> create(const std::shared_ptr<BufferGeometry>& geometry, const std::shared_ptr<Material>& material) {
 
@@ -4,6 +4,7 @@
 #define THREEPP_SCENE_HPP
 
 #include "threepp/core/Object3D.hpp"
+#include "threepp/core/TransformStore.hpp"
 
 #include "threepp/scenes/Fog.hpp"
 #include "threepp/scenes/FogExp2.hpp"
@@ -53,9 +54,22 @@ namespace threepp {
 
         bool autoUpdate = true;
 
+        // Update the graph's world matrices through a TransformStore: one
+        // linear pass over a flattened copy of the layout instead of the
+        // per-node recursion. Same matrices, bit for bit; worth it for large
+        // scenes whose shape is stable from frame to frame (see TransformStore).
+        // Nothing may depend on the store running: updateMatrixWorldParallel
+        // and an enclosing TransformStore update a Scene as a plain node.
+        bool useTransformStore = false;
+
         [[nodiscard]] std::string type() const override;
 
+        void updateMatrixWorld(bool force = false) override;
+
         static std::shared_ptr<Scene> create();
+
+    private:
+        std::unique_ptr<TransformStore> transformStore_;
     };
 
 }// namespace threepp
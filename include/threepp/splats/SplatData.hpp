@@ -373,9 +373,9 @@ namespace threepp {
         // there are none.
         //
         // One-time cost at load. std::stable_sort at five million splats is
-        // acceptable there; it is deliberately not parallelised, because
-        // Parallel.hpp's par policy is MSVC-only and silently serial elsewhere,
-        // which would make the cost a platform surprise rather than a constant.
+        // acceptable there; it is deliberately not parallelised — a parallel
+        // stable sort wants a second key/index buffer the size of the cloud,
+        // which is exactly the memory the in-place permutation avoids.
         std::vector<std::uint32_t> reorderMorton(float boundsPercentile = 0.999f);
 
         // True when every array length agrees and the degree is in range.
@@ -1,12 +1,27 @@
-// Simple BVH implementation for threepp Geometries
+// Bounding volume hierarchy over the triangles of a threepp Geometry.
+//
+// The tree is one contiguous array of nodes in depth-first order: a node's
+// first child is the next node, the second child is at `offset`. Leaf
+// triangles are reordered into contiguous blocks, so a leaf is a [first,
+// first + count) slice of the triangle array rather than its own vector.
+//
+// Splits are chosen by the surface area heuristic over 16 centroid bins per
+// axis. Subtrees above a size threshold build on the shared thread pool
+// (utils/Parallel.hpp); the partition never depends on the thread count, so
+// the tree is the same however many threads built it. Queries walk the array
+// with a small fixed stack — ray queries visit the nearer child first and skip
+// nodes entered beyond the current best hit.
 
 #ifndef THREEPP_BVH_HPP
 #define THREEPP_BVH_HPP
 
 
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
 #include "threepp/math/Box3.hpp"
@@ -47,7 +62,12 @@ namespace threepp {
             Vector3 normal;// geometric normal, flipped to face the ray origin
         };
 
-        explicit BVH(int maxTrianglesPerNode = 8, int maxSubdivisions = 10)
+        // Deepest tree the traversal stacks are sized for.
+        static constexpr int maxDepth = 64;
+
+        // maxSubdivisions is a depth cap, clamped to maxDepth. Leaves stop at
+        // maxTrianglesPerNode unless the cap is reached first.
+        explicit BVH(int maxTrianglesPerNode = 8, int maxSubdivisions = maxDepth)
             : maxTrianglesPerNode(maxTrianglesPerNode), maxSubdivisions(maxSubdivisions) {}
 
         void build(const BufferGeometry& geometry);
@@ -69,38 +89,72 @@ namespace threepp {
         // Early-out boolean occlusion query. The ray is in the BVH's local space.
         [[nodiscard]] bool raycastAny(const Ray& ray, float maxDistance) const;
 
+        // Candidate walk for callers that test triangles themselves (Mesh::raycast
+        // applies material sides, groups and draw ranges this tree knows nothing
+        // about). Every triangle of every leaf the ray enters within maxDistance
+        // is handed to visit(triangleIndex), nearer subtrees first. visit returns
+        // the distance beyond which nothing more is wanted: maxDistance to see
+        // every candidate, the distance of a hit to stop at the nearest one.
+        template<class Fn>
+        void raycastTriangles(const Ray& ray, float maxDistance, Fn&& visit) const {
+            using F = std::remove_reference_t<Fn>;
+            const TriangleFn erased{
+                    [](void* ctx, int triangleIndex) -> float { return (*static_cast<F*>(ctx))(triangleIndex); },
+                    const_cast<void*>(static_cast<const void*>(std::addressof(visit)))};
+            walkTriangles(ray, maxDistance, erased);
+        }
+
+        // Moves the tree's vertices without changing its topology: positions[i]
+        // replaces vertex i of the geometry it was built from. Queries stay
+        // exact; they only slow down as the deformation drifts from the shape
+        // the splits were chosen for. For posed skins (SkinnedMesh picking).
+        void refit(const std::vector<Vector3>& positions);
+
         void collectBoxes(std::vector<BVHBox3>& boxes) const;
 
         [[nodiscard]] const BufferGeometry* getGeometry() const;
 
+        [[nodiscard]] std::size_t nodeCount() const;
+
+        [[nodiscard]] std::size_t triangleCount() const;
+
+        // Number of levels, 0 for an empty tree.
+        [[nodiscard]] int depth() const;
+
     private:
-        class BVHNode {
-        public:
-            Box3 boundingBox;
-            std::unique_ptr<BVHNode> left;
-            std::unique_ptr<BVHNode> right;
-            std::vector<int> triangleIndices;
-
-            BVHNode() = default;
-
-            [[nodiscard]] bool isLeaf() const {
-                return left == nullptr && right == nullptr;
-            }
+        struct Node {
+            float min[3];
+            float max[3];
+            std::uint32_t offset;   // leaf: first triangle; interior: second child
+            std::uint32_t count: 30;// triangles in a leaf, 0 for an interior node
+            std::uint32_t axis: 2;  // split axis of an interior node
         };
 
-        std::unique_ptr<BVHNode> root;
         int maxTrianglesPerNode;
         int maxSubdivisions;
 
-        std::vector<Triangle> triangles;
+        std::vector<Node> nodes;
+        std::vector<Triangle> triangles;// leaf order
+        std::vector<int> triangleIds;   // leaf order -> triangle index in the geometry
+        int treeDepth = 0;
         const BufferGeometry* geometry = nullptr;
 
-        std::unique_ptr<BVHNode> buildNode(std::vector<int>& indices, int depth);
+        struct Builder;
 
-        // Tests intersection between two BVH nodes
-        static void intersectBVHNodes(const BVH& b1, const BVHNode* nodeA, const Matrix4& m1, const BVH& b2, const BVHNode* nodeB, const Matrix4& m2, std::vector<IntersectionResult>& results, bool accurate);
+        // Non-owning, type-erased `float(int triangleIndex)`: a function
+        // pointer + context like ThreadPool::RangeFn, called once per
+        // candidate triangle without std::function's indirection.
+        struct TriangleFn {
+            float (*invoke)(void* ctx, int triangleIndex);
+            void* ctx;
+
+            float operator()(int triangleIndex) const { return invoke(ctx, triangleIndex); }
+        };
+
+        void walkTriangles(const Ray& ray, float maxDistance, TriangleFn visit) const;
 
-        static void collectBoxes(const BVHNode* node, std::vector<BVHBox3>& boxes);
+        // Tests intersection between two BVH nodes
+        static void intersectBVHNodes(const BVH& b1, const Matrix4& m1, const BVH& b2, const Matrix4& m2, std::vector<IntersectionResult>& results, bool accurate);
     };
 
 
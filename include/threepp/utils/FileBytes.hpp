@@ -0,0 +1,32 @@
+// The bytes of one file or archive member, either owned or borrowed.
+//
+// A file read from a directory (or decoded from a data URI) has to land
+// somewhere, so it is owned. A stored ZipReader member is already in memory
+// and is borrowed in place, so the planes and buffers of a multi-gigabyte
+// bundle reach their decoder without a second copy. A borrowed view is valid
+// for as long as the ZipReader it came from, or any copy of it, is alive.
+
+#ifndef THREEPP_FILEBYTES_HPP
+#define THREEPP_FILEBYTES_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace threepp {
+
+    struct FileBytes {
+        std::vector<unsigned char> owned;
+        std::span<const std::byte> mapped;
+
+        // Whichever of the two is set. An empty owned buffer means "borrowed",
+        // so an owned empty file and a borrowed empty member read the same.
+        [[nodiscard]] std::span<const std::byte> view() const {
+
+            return owned.empty() ? mapped : std::as_bytes(std::span(owned));
+        }
+    };
+
+}// namespace threepp
+
+#endif//THREEPP_FILEBYTES_HPP
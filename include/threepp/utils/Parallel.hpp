@@ -1,35 +1,80 @@
-// Portable parallel std::for_each.
+// Portable data-parallel loops on threepp's own scheduler (utils/ThreadPool.hpp).
 //
-// Uses the C++17 Parallel STL (std::execution::par) on MSVC, which ships native
-// support with no extra dependency. Everywhere else the call runs serially:
-// Apple's libc++ does not implement the parallel execution policies at all, and
-// libstdc++'s policies require Intel TBB to be linked. Gating on _MSC_VER (rather
-// than the __cpp_lib_parallel_algorithm feature-test macro) is deliberate —
-// libstdc++ advertises that macro even when TBB is absent, which would select the
-// parallel path and then fail to link.
+//   parallelFor(begin, end, grain, fn)    fn(lo, hi) over disjoint sub-ranges
+//   parallelReduce(begin, end, grain, init, map, reduce)
+//   parallelForEach(first, last, fn)      fn(element), std::for_each shaped
 //
-// Contract: each invocation of fn must write disjoint state, so the serial
-// fallback is behaviourally identical to the parallel path — only the threading
-// differs, never the result.
+// The same work-stealing pool runs on every platform. This used to sit on the
+// C++17 Parallel STL, which only MSVC ships without strings attached (libc++
+// has no parallel policies, libstdc++'s need TBB linked), so every non-Windows
+// build was silently serial.
+//
+// Contract: each invocation of fn must write disjoint state, so a serial run
+// (one hardware thread, or inside a ThreadPool::SerialScope) is behaviourally
+// identical to the parallel one — only the threading differs, never the result.
+// parallelReduce keeps that promise for non-associative operations too (float
+// sums): its partition depends on the range and grain only, never on the
+// number of threads, and partials are combined left to right.
 
 #ifndef THREEPP_UTILS_PARALLEL_HPP
 #define THREEPP_UTILS_PARALLEL_HPP
 
+#include "threepp/utils/ThreadPool.hpp"
+
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
 #include <utility>
-#ifdef _MSC_VER
-#include <execution>
-#endif
+#include <vector>
 
 namespace threepp {
 
+    // grain = largest piece handed to one fn call; 0 lets the pool choose.
+    template<class Fn>
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, Fn&& fn) {
+        using F = std::remove_reference_t<Fn>;
+        const ThreadPool::RangeFn erased{
+                [](void* ctx, std::size_t lo, std::size_t hi) { (*static_cast<F*>(ctx))(lo, hi); },
+                const_cast<void*>(static_cast<const void*>(std::addressof(fn)))};
+        ThreadPool::global().parallelFor(begin, end, grain, erased);
+    }
+
+    // map(lo, hi) -> T folds one piece; reduce(T, T) -> T combines pieces in
+    // index order. grain = 0 splits the range into (at most) 64 pieces.
+    template<class T, class MapFn, class ReduceFn>
+    T parallelReduce(std::size_t begin, std::size_t end, std::size_t grain, T init, MapFn&& map, ReduceFn&& reduce) {
+        if (end <= begin) return init;
+
+        const std::size_t n = end - begin;
+        if (grain == 0) grain = std::max<std::size_t>(1, (n + 63) / 64);
+        const std::size_t pieces = (n + grain - 1) / grain;
+
+        std::vector<T> partial(pieces, init);
+        parallelFor(0, pieces, 1, [&](std::size_t p0, std::size_t p1) {
+            for (std::size_t p = p0; p < p1; ++p) {
+                const std::size_t lo = begin + p * grain;
+                partial[p] = map(lo, std::min(end, lo + grain));
+            }
+        });
+
+        T result = std::move(init);
+        for (auto& v : partial) result = reduce(std::move(result), std::move(v));
+        return result;
+    }
+
     template<class It, class Fn>
     void parallelForEach(It first, It last, Fn fn) {
-#ifdef _MSC_VER
-        std::for_each(std::execution::par, first, last, std::move(fn));
-#else
-        std::for_each(first, last, std::move(fn));
-#endif
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                        typename std::iterator_traits<It>::iterator_category>) {
+            const auto n = static_cast<std::size_t>(std::distance(first, last));
+            parallelFor(0, n, 0, [&](std::size_t lo, std::size_t hi) {
+                for (std::size_t i = lo; i < hi; ++i) fn(first[static_cast<std::ptrdiff_t>(i)]);
+            });
+        } else {
+            std::for_each(first, last, std::move(fn));
+        }
     }
 
 }// namespace threepp
@@ -0,0 +1,94 @@
+// threepp's own work-stealing scheduler.
+//
+// One process-wide pool (ThreadPool::global()) backs parallelFor,
+// parallelReduce and parallelForEach in utils/Parallel.hpp, and replaces the
+// ad-hoc std::thread pools the loaders and encoders used to spin up per call.
+// No TBB, no Parallel STL: the same scheduler runs on every platform, so a
+// parallel code path costs the same on Linux/GCC as it does on MSVC.
+//
+// Scheduling: every worker owns a deque. A range job is split recursively —
+// the running task pushes the upper half of its range onto its own deque and
+// keeps the lower half — until a piece is no larger than the grain. Owners pop
+// from the back (the most recently split, cache-warm piece); idle workers
+// steal from the front of someone else's deque (the oldest and therefore
+// largest piece), so a single steal moves a lot of work. The calling thread
+// never just blocks: it executes pieces of its own job (or anyone's) until the
+// job completes, which also makes nested parallel calls from inside a task
+// safe — the nested caller helps instead of waiting on a worker that is
+// waiting on it.
+//
+// The pool has hardware_concurrency() - 1 workers; the caller is the last
+// lane. A machine with one hardware thread gets zero workers and everything
+// runs inline.
+
+#ifndef THREEPP_THREADPOOL_HPP
+#define THREEPP_THREADPOOL_HPP
+
+#include <cstddef>
+#include <memory>
+
+namespace threepp {
+
+    class ThreadPool {
+
+    public:
+        // Non-owning, type-erased `void(std::size_t begin, std::size_t end)`.
+        // A plain function pointer + context rather than std::function, so
+        // handing a lambda to the pool never allocates.
+        struct RangeFn {
+            void (*invoke)(void* ctx, std::size_t begin, std::size_t end);
+            void* ctx;
+
+            void operator()(std::size_t begin, std::size_t end) const { invoke(ctx, begin, end); }
+        };
+
+        // numWorkers = 0 picks hardware_concurrency() - 1.
+        explicit ThreadPool(unsigned numWorkers = 0);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Workers plus the calling thread — the number of lanes a parallel
+        // call can actually use. Always at least 1.
+        [[nodiscard]] unsigned concurrency() const;
+
+        // Run fn over [begin, end) in pieces of at most `grain` indices
+        // (grain = 0 picks one from the range size and concurrency()) and
+        // return once every piece has run. The first exception thrown by a
+        // piece is rethrown here after the remaining pieces finish.
+        void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, RangeFn fn);
+
+        // True when the calling thread is one of this pool's workers.
+        [[nodiscard]] bool isWorkerThread() const;
+
+        // While alive, parallel calls made on the constructing thread run
+        // inline, in index order. For A/B timing against the serial path and
+        // for callers that must not fan out (e.g. code that is not safe to
+        // run off the calling thread). Nests.
+        class SerialScope {
+
+        public:
+            SerialScope();
+
+            SerialScope(const SerialScope&) = delete;
+            SerialScope& operator=(const SerialScope&) = delete;
+
+            ~SerialScope();
+        };
+
+        // True when a SerialScope is alive on the calling thread.
+        [[nodiscard]] static bool serialOnThisThread();
+
+        // The shared pool, created on first use.
+        static ThreadPool& global();
+
+        ~ThreadPool();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+}// namespace threepp
+
+#endif//THREEPP_THREADPOOL_HPP
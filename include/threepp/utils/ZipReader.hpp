@@ -1,15 +1,15 @@
-// A read-only reader for STORED (uncompressed) ZIP containers: the PlayCanvas
-// SOG / SuperSplat "SSOG" splat scans it was written for, and threepp's own
-// single-file scene archives (see ZipWriter, ObjectExporter).
+// A read-only ZIP reader: the PlayCanvas SOG / SuperSplat "SSOG" splat scans
+// it was written for, and threepp's own single-file scene archives (see
+// ZipWriter, ObjectExporter).
 //
 // Provenance: clean-room, written from the PKWARE .ZIP File Format Specification
 // (APPNOTE, public since 1989). No third-party zip code was consulted and none
-// is linked. That is affordable only because these archives use a tiny subset of
-// the format: every entry is STORED (compression method 0), because the payload
-// is already-compressed WebP/PNG, JSON, or raw vertex data that a general
-// compressor buys nothing on, so "reading an entry" is nothing but finding the
-// offset its bytes start at. Nothing here inflates anything; a method other than
-// stored is refused by name rather than guessed at.
+// is linked. That is affordable because these archives use a small subset of
+// the format: entries are STORED (method 0) or DEFLATED (method 8), and a
+// stored entry is nothing but the offset its bytes start at. A deflated one is
+// inflated with the raw-DEFLATE decoder stb_image already carries for PNG, and
+// checked against its CRC-32. Any other method is refused by name rather than
+// guessed at.
 //
 // THE TRAP, and the reason this file exists rather than a ten-line offset walk:
 // THE LOCAL FILE HEADER LIES. 153 of the 154 entries in the reference SOG
@@ -21,29 +21,46 @@
 // nothing, and the failure surfaces far away as a blank splat cloud. (ZipWriter
 // never emits that flag, precisely because of this.)
 //
-// THE CENTRAL DIRECTORY IS THE ONLY TRUTH. Compression method, uncompressed
-// size and the local header's offset are all taken from there. The local header
-// is consulted for exactly two fields — its own name length and extra length —
-// because those may legitimately differ from the central directory's copies
-// (writers routinely put different extra fields in the two places), and they
-// are what fixes where the data actually begins:
+// THE CENTRAL DIRECTORY IS THE ONLY TRUTH. Compression method, both sizes, the
+// CRC and the local header's offset are all taken from there (or from its
+// ZIP64 extra field, for the ones that parked a 0xFFFFFFFF sentinel). The local
+// header is consulted for exactly two fields — its own name length and extra
+// length — because those may legitimately differ from the central directory's
+// copies (writers routinely put different extra fields in the two places), and
+// they are what fixes where the data actually begins:
 //
 //     dataOffset = localHeaderOffset + 30 + localNameLen + localExtraLen
 //
+// ZIP64 is read wherever a writer used it: the ZIP64 end-of-central-directory
+// record and its locator, and the per-entry ZIP64 extra field.
+//
 // Everything this cannot honestly read is refused with std::runtime_error
-// naming the entry and the offending value — a non-stored method, an encrypted
-// entry, the ZIP64 sentinels (0xFFFFFFFF in a size or offset, 0xFFFF in the
-// entry count), a spanned archive, and any record or payload that runs past the
-// end of the file. It is pointed at arbitrary user files, so every offset is
-// bounds-checked in 64-bit arithmetic against the real file size before it is
-// used to index; a truncated or malformed archive throws, it never returns the
-// wrong bytes.
+// naming the entry and the offending value — an unsupported method, an
+// encrypted entry, a sentinel with no ZIP64 record behind it, a spanned
+// archive, and any record or payload that runs past the end of the file. It is
+// pointed at arbitrary user files, so every offset is bounds-checked in 64-bit
+// arithmetic against the real file size before it is used to index; a
+// truncated or malformed archive throws, it never returns the wrong bytes.
+//
+// The archive is memory-mapped where the platform allows (POSIX), and read into
+// one buffer otherwise. Mapped, opening a multi-gigabyte scene or splat bundle
+// costs address space rather than resident memory, and view() hands out a
+// stored entry's bytes in place: a loader decodes straight from the page cache
+// with no copy in between. A deflated entry is inflated straight out of the
+// mapping into a buffer its caller owns (read(), bytes()); the reader never
+// keeps one. The bounds checks above are made against the
+// mapping's length exactly as they were against the buffer's.
 
 #ifndef THREEPP_ZIPREADER_HPP
 #define THREEPP_ZIPREADER_HPP
 
+#include "threepp/utils/FileBytes.hpp"
+
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -65,13 +82,18 @@ namespace threepp {
         // neither of which anything in threepp writes.
         [[nodiscard]] static bool looksLikeZip(const std::filesystem::path& path);
 
-        // Reads the whole file into memory and parses the central directory.
+        // Maps the file (or, with memoryMap false, on a platform without mmap,
+        // or when mapping fails, reads the whole of it into memory) and parses
+        // the central directory.
         //
         // Throws std::runtime_error, with the offending entry and value in the
         // message, on anything it cannot represent. Validation is done here for
         // every entry rather than lazily at read() time, so has() never promises
         // bytes that a later read() would refuse to deliver.
-        explicit ZipReader(const std::filesystem::path& path);
+        explicit ZipReader(const std::filesystem::path& path, bool memoryMap = true);
+
+        // Whether the archive is served from a mapping rather than a buffer.
+        [[nodiscard]] bool mapped() const;
 
         // Lookup names are normalised: backslashes become forward slashes and a
         // leading "./" is stripped, so "0_0/meta.json" finds the entry however
@@ -80,9 +102,40 @@ namespace threepp {
 
         // The entry's uncompressed bytes, sized from the central directory.
         // Throws if there is no such entry — a caller that is unsure should ask
-        // has() first.
+        // has() first — and if a deflated entry does not inflate to exactly
+        // that size and CRC.
         [[nodiscard]] std::vector<unsigned char> read(const std::string& name) const;
 
+        // A STORED entry's bytes without the copy: a view into the mapping (or
+        // the buffer). Valid for as long as this reader, or any copy of it, is
+        // alive — copies share the one mapping. Throws like read(), and also
+        // for a deflated entry, which has no bytes in the file to point at.
+        //
+        // A mapped file that is truncated by another process while the view is
+        // in use faults on access (SIGBUS) rather than throwing; a reader that
+        // must survive that should pass memoryMap = false.
+        [[nodiscard]] std::span<const std::byte> view(const std::string& name) const;
+
+        // Any entry's bytes, copied only when they have to be: a stored entry
+        // is borrowed exactly as view() would hand it out, and a deflated one
+        // is inflated into a buffer the result owns. The reader keeps nothing,
+        // so an inflated entry lives as long as the caller holds the result and
+        // no longer. Throws like read().
+        [[nodiscard]] FileBytes bytes(const std::string& name) const;
+
+        // An entry as it sits in the file — deflated or not — with what a
+        // writer needs to copy it into another archive without inflating it
+        // or checksumming it again (see ZipWriter::copy). Throws if there is
+        // no such entry.
+        struct StoredEntry {
+            std::span<const std::byte> bytes;
+            std::uint64_t size{};// uncompressed
+            std::uint32_t crc{};
+            bool deflated{};
+        };
+
+        [[nodiscard]] StoredEntry stored(const std::string& name) const;
+
         // Every entry, normalised, in central directory order. Directory
         // entries (names ending in '/') are not listed; they carry no data.
         [[nodiscard]] std::vector<std::string> names() const;
@@ -91,17 +144,28 @@ namespace threepp {
         struct Entry {
             std::uint64_t offset{};
             std::uint64_t size{};
+            std::uint64_t compressedSize{};
+            std::uint32_t crc{};
+            std::uint16_t method{};
         };
 
-        // Walks the central directory of the already-loaded bytes_. Separate
+        // The mapping or the buffer; defined in the .cpp.
+        class Storage;
+
+        // Walks the central directory of the already-loaded data_. Separate
         // from the constructor only so the constructor can name the file in
         // whatever it throws.
         void parse();
 
-        // The whole file. A SOG archive is ~180 MB and a caller loads most of
-        // every one of them anyway, so a memory-mapped or streaming design would
-        // buy little and cost the portability of a per-platform mapping layer.
-        std::vector<unsigned char> bytes_;
+        [[nodiscard]] const Entry& entry(const std::string& name) const;
+
+        [[nodiscard]] std::vector<unsigned char> inflate(const std::string& name, const Entry& e) const;
+
+        // The whole file. Shared, so copying a reader neither re-maps nor
+        // re-reads, and a view outlives whichever copy it was taken from.
+        std::shared_ptr<const Storage> storage_;
+        const unsigned char* data_ = nullptr;
+        std::uint64_t size_ = 0;
 
         std::unordered_map<std::string, Entry> entries_;
         std::vector<std::string> names_;
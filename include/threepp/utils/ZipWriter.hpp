@@ -1,12 +1,14 @@
-// A STORED-only ZIP writer: the counterpart of ZipReader, and the container
-// behind threepp's single-file scene archive (.tpz, see ObjectExporter).
+// A ZIP writer: the counterpart of ZipReader, and the container behind
+// threepp's single-file scene archive (.tpz, see ObjectExporter).
 //
-// Clean-room from the PKWARE .ZIP File Format Specification, same as the reader
-// and for the same reason: nothing here compresses anything, so the whole
-// format reduces to a local header, the payload verbatim, a central directory
-// and an end-of-central-directory record. A scene archive holds already-
-// compressed PNG/JPEG bytes and raw vertex data — deflating the first buys
-// nothing and deflating the second would cost more time than the whole export.
+// Clean-room from the PKWARE .ZIP File Format Specification, same as the reader.
+// Entries are STORED unless the caller asks for DEFLATE per entry: a scene
+// archive's PNG/JPEG bytes are already compressed and deflating them buys
+// nothing, but its index and attribute buffers often shrink by half or more.
+// Deflated entries are compressed in parallel, one entry per task, when the
+// archive is built; one that does not come out smaller is stored instead. The
+// compressor is the zlib-format deflate stb_image_write already carries for
+// PNG encoding, so there is no compression library of our own to link.
 //
 // BYTE-IDENTICAL OUTPUT IS A GUARANTEE, not an accident: ObjectExporter
 // advertises deterministic documents so autosaves and version control diff on
@@ -24,21 +26,29 @@
 //   - Entries are emitted in a fixed order regardless of add() order: fewer
 //     path components first, then lexicographically. For the scene layout that
 //     is scene.json, then buffers/*, then images/*.
-//   - No extra fields, no comments, fixed version-made-by. The only variable
-//     flag bit is 0x800 (names are UTF-8), set exactly when a name carries a
-//     byte outside ASCII — a property of the name, so it is stable too.
+//   - No comments, fixed version-made-by, and no extra field but the ZIP64 one
+//     below. The only variable flag bit is 0x800 (names are UTF-8), set
+//     exactly when a name carries a byte outside ASCII — a property of the
+//     name, so it is stable too.
 //
-// ZIP64: NO. Refused with std::runtime_error naming the entry whenever a size,
-// an offset or the entry count would need a sentinel value — 4 GB of entry,
-// 4 GB of archive, or 65535 entries. The reader refuses to read those, so
-// writing them would only produce a file threepp itself could not open. A
-// contained ZIP64 addition can happen the day a real scene reaches that size.
+// An entry can also be copied from another archive as it is stored there
+// (copy()), which is how an incremental save reuses what did not change.
+//
+// ZIP64 is written only where a value does not fit: an entry of 4 GB or more
+// gets the ZIP64 extra field with its sizes, one starting past 4 GB gets it
+// with its offset, and an archive of 65535 or more entries or with a directory
+// past 4 GB gets the ZIP64 end records. An archive that needs none of it is
+// byte-identical to what a writer without the notion would emit.
 
 #ifndef THREEPP_ZIPWRITER_HPP
 #define THREEPP_ZIPWRITER_HPP
 
+#include "threepp/utils/ZipReader.hpp"
+
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,7 +58,12 @@ namespace threepp {
     class ZipWriter {
 
     public:
-        // Adds one stored entry. The name is normalised the way ZipReader
+        enum class Compression {
+            Stored,
+            Deflate
+        };
+
+        // Adds one entry. The name is normalised the way ZipReader
         // normalises lookups (backslashes to forward slashes, leading "./"
         // stripped), so the name that goes in is the name that comes back out.
         //
@@ -57,15 +72,28 @@ namespace threepp {
         // none), is longer than 65535 bytes, or repeats a name already added —
         // a duplicate is legal ZIP but the reader would only ever hand back the
         // last one, so silently keeping both would be a lie about the archive.
-        void add(std::string name, std::vector<unsigned char> data);
+        //
+        // Deflate is a request, not a promise: an entry that does not shrink,
+        // or one of 2 GB or more (past what the compressor takes), is stored.
+        void add(std::string name, std::vector<unsigned char> data, Compression compression = Compression::Stored);
+
+        void add(std::string name, const std::string& text, Compression compression = Compression::Stored);
 
-        void add(std::string name, const std::string& text);
+        // Adds `entry` of `from` under `name` exactly as it is stored there:
+        // the same compressed bytes, the same CRC, nothing inflated, deflated
+        // or checksummed. The output is the same as adding the entry's contents
+        // with the compression that produced them, because deflate here is
+        // deterministic. The reader (its mapping, really) is kept alive until
+        // the archive has been written. Throws like add() on the name, and like
+        // ZipReader::stored() when `from` has no such entry.
+        void copy(std::string name, std::shared_ptr<const ZipReader> from, const std::string& entry);
 
         // The whole archive, in memory. Deterministic: same entries in, same
         // bytes out, whatever order they were added in.
         [[nodiscard]] std::vector<unsigned char> build() const;
 
-        // build() plus a crash-safe write: the bytes go to a sibling temp file
+        // The same bytes as build(), streamed to the file rather than assembled
+        // in memory first, with a crash-safe write: they go to a sibling temp file
         // which is then renamed over the target, so an export that dies halfway
         // leaves the previous archive intact rather than a truncated one. The
         // temp file is <target>.tmp — two processes saving the same path at the
@@ -79,10 +107,20 @@ namespace threepp {
         struct Entry {
             std::string name;
             std::vector<unsigned char> data;
-            std::uint32_t crc{};
+            Compression compression{};
+            // Set for a copied entry, which has no `data` of its own.
+            std::shared_ptr<const ZipReader> source;
+            ZipReader::StoredEntry stored;
         };
 
         std::vector<Entry> entries_;
+
+        // Normalises the name and throws on the ones add() refuses.
+        [[nodiscard]] std::string checkName(std::string name) const;
+
+        // Compresses and checksums every entry, then hands the archive to
+        // `sink` piece by piece in file order.
+        void emit(const std::function<void(const unsigned char*, std::size_t)>& sink) const;
     };
 
 }// namespace threepp
@@ -143,6 +143,8 @@ namespace threepp_py {
                      py::arg("root"), py::keep_alive<1, 2>())
                 .def_readwrite("time", &AnimationMixer::time)
                 .def_readwrite("time_scale", &AnimationMixer::timeScale)
+                .def_readwrite("compile_clips", &AnimationMixer::compileClips,
+                               "Sample clips from a compiled copy of their keyframes; same pose, less work per bone.")
                 .def("clip_action", [](AnimationMixer& mx, const std::shared_ptr<AnimationClip>& clip, std::optional<AnimationBlendMode> blendMode) {
                     return mx.clipAction(clip, nullptr, blendMode);
                 }, py::arg("clip"), py::arg("blend_mode") = std::nullopt, py::return_value_policy::reference_internal,
@@ -160,6 +160,8 @@ namespace threepp_py {
                 }, py::arg("callback"))
                 .def("update_matrix", [](Object3D& o) { o.updateMatrix(); })
                 .def("update_matrix_world", [](Object3D& o, bool force) { o.updateMatrixWorld(force); }, py::arg("force") = false)
+                .def("update_matrix_world_parallel", [](Object3D& o, bool force, std::size_t minSubtreeSize) { o.updateMatrixWorldParallel(force, minSubtreeSize); },
+                     py::arg("force") = false, py::arg("min_subtree_size") = 2048)
                 // clone() dispatches through the virtual createDefault(), so it
                 // produces the concrete subclass (Mesh/Group/...) even though the
                 // lambda takes Object3D&; pybind downcasts the returned
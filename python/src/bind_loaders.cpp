@@ -58,6 +58,8 @@ namespace threepp_py {
         // None on a lossy codec (DWAA/B44/PXR24) rather than decoding garbage.
         py::class_<EXRLoader>(m, "EXRLoader")
                 .def(py::init<>())
+                .def_readwrite("half_float", &EXRLoader::halfFloat,
+                               "Return a HalfFloat texture (raw half bits) instead of widening to float.")
                 .def("load", [](EXRLoader& l, const std::string& path, bool flip_y) { return l.load(path, flip_y); },
                      py::arg("path"), py::arg("flip_y") = true,
                      "Load an OpenEXR .exr equirectangular environment as a float Texture.");
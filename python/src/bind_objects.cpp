@@ -107,6 +107,8 @@ namespace threepp_py {
                 }, py::arg("callback"))
                 .def("update_matrix", [](T& o) { o.updateMatrix(); })
                 .def("update_matrix_world", [](T& o, bool force) { o.updateMatrixWorld(force); }, py::arg("force") = false)
+                .def("update_matrix_world_parallel", [](T& o, bool force, std::size_t minSubtreeSize) { o.updateMatrixWorldParallel(force, minSubtreeSize); },
+                     py::arg("force") = false, py::arg("min_subtree_size") = 2048)
                 .def("__repr__", [](const T& o) { return "<threepp." + o.type() + " name='" + o.name + "'>"; });
     }
 
@@ -258,6 +260,7 @@ namespace threepp_py {
                 .def_readwrite("environment", &Scene::environment)
                 .def_readwrite("override_material", &Scene::overrideMaterial)
                 .def_readwrite("auto_update", &Scene::autoUpdate)
+                .def_readwrite("use_transform_store", &Scene::useTransformStore)
                 // Convenience: linear distance fog. (scene.fog is a std::variant
                 // under the hood; this avoids exposing the variant to Python.)
                 .def("set_fog", [](Scene& s, const Color& c, float near, float far) { s.fog = Fog(c, near, far); },
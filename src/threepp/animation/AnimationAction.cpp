@@ -2,8 +2,11 @@
 #include "threepp/animation/AnimationAction.hpp"
 
 #include "threepp/animation/AnimationMixer.hpp"
+#include "threepp/animation/CompiledClip.hpp"
 #include "threepp/animation/PropertyMixer.hpp"
 
+#include <unordered_set>
+
 using namespace threepp;
 
 AnimationAction::AnimationAction(AnimationMixer& mixer,
@@ -297,6 +300,28 @@ void AnimationAction::_update(float time, float deltaTime, int timeDirection, in
         const auto& interpolants = this->_interpolants;
         const auto& propertyMixers = this->_propertyBindings;
 
+        if (this->_mixer.compileClips && this->_prepareCompiled()) {
+
+            // Sample the whole clip in one pass, then blend: the same buffers
+            // and the same accumulate calls as below, minus the interpolants.
+            this->_compiled->evaluate(clipTime, this->_compiledKeys.data(), this->_compiledTargets.data());
+            for (const auto j : this->_compiled->interpolated()) {
+
+                interpolants[j]->evaluate(clipTime);
+            }
+
+            if (this->blendMode == AnimationBlendMode::Additive) {
+
+                for (const auto& propertyMixer : propertyMixers) propertyMixer->accumulateAdditive(weight);
+
+            } else {
+
+                for (const auto& propertyMixer : propertyMixers) propertyMixer->accumulate(accuIndex, weight);
+            }
+
+            return;
+        }
+
         switch (this->blendMode) {
 
             case AnimationBlendMode::Additive:
@@ -321,6 +346,33 @@ void AnimationAction::_update(float time, float deltaTime, int timeDirection, in
     }
 }
 
+bool AnimationAction::_prepareCompiled() {
+
+    if (!this->_compiledTargets.empty() || this->_interpolants.empty()) return this->_compiledUsable;
+
+    if (!this->_compiled) {
+
+        this->_compiled = CompiledClip::of(*this->_clip);
+        this->_compiledKeys.assign(this->_compiled->tracks().size(), 0);
+    }
+
+    // A clip edited after it was compiled no longer matches; so does one with
+    // two tracks on the same property, where sampling every track before
+    // accumulating any would let the second overwrite the first.
+    auto& targets = this->_compiledTargets;
+    for (const auto& interpolant : this->_interpolants) targets.push_back(interpolant->resultBuffer);
+
+    const auto& tracks = this->_compiled->tracks();
+    std::unordered_set<std::vector<float>*> unique(targets.begin(), targets.end());
+    this->_compiledUsable = tracks.size() == targets.size() && unique.size() == targets.size();
+    for (auto j = 0u; this->_compiledUsable && j != targets.size(); ++j) {
+
+        this->_compiledUsable = targets[j]->size() >= tracks[j].valueSize;
+    }
+
+    return this->_compiledUsable;
+}
+
 float AnimationAction::_updateWeight(float time) {
 
     float weight = 0;
@@ -98,6 +98,8 @@ struct AnimationMixer::Impl {
 
             interpolants[i]->resultBuffer = &binding->buffer;
         }
+
+        action->_compiledTargets.clear();
     }
 
     std::shared_ptr<Interpolant> _lendControlInterpolant() {
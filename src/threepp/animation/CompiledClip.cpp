@@ -0,0 +1,191 @@
+
+#include "threepp/animation/CompiledClip.hpp"
+
+#include "threepp/animation/AnimationClip.hpp"
+#include "threepp/math/Quaternion.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+using namespace threepp;
+
+namespace {
+
+    // Interval i1 in Interpolant::evaluate's sense: the number of keys at or
+    // before t, so times[i1 - 1] <= t < times[i1]. 0 means before the first
+    // key, keyCount at or after the last.
+    inline std::uint32_t seek(const float* times, std::uint32_t keyCount, float t, std::uint32_t hint) {
+
+        if (hint <= keyCount &&
+            (hint == 0 || times[hint - 1] <= t) &&
+            (hint == keyCount || t < times[hint])) {
+            return hint;
+        }
+        const auto next = hint + 1;
+        if (next <= keyCount && times[hint] <= t && (next == keyCount || t < times[next])) {
+            return next;
+        }
+        return static_cast<std::uint32_t>(std::upper_bound(times, times + keyCount, t) - times);
+    }
+
+    // Outside the keys the interpolants copy the nearest end sample; returns
+    // that sample's index, or -1 when t is between two keys.
+    inline int clampedKey(std::uint32_t i1, std::uint32_t keyCount) {
+
+        if (i1 == 0) return 0;
+        if (i1 == keyCount) return static_cast<int>(keyCount) - 1;
+        return -1;
+    }
+
+}// namespace
+
+CompiledClip::CompiledClip(const AnimationClip& clip) {
+
+    const auto& clipTracks = clip.getTracks();
+    tracks_.reserve(clipTracks.size());
+
+    std::size_t numTimes = 0, numValues = 0;
+    for (const auto& track : clipTracks) {
+        numTimes += track->getTimes().size();
+        numValues += track->getValues().size();
+    }
+    times_.reserve(numTimes);
+    values_.reserve(numValues);
+
+    for (const auto& track : clipTracks) {
+
+        const auto& times = track->getTimes();
+        const auto& values = track->getValues();
+
+        Track t{};
+        t.firstTime = static_cast<std::uint32_t>(times_.size());
+        t.keyCount = static_cast<std::uint32_t>(times.size());
+        t.firstValue = static_cast<std::uint32_t>(values_.size());
+        t.valueSize = times.empty() ? 0 : static_cast<std::uint32_t>(track->getValueSize());
+
+        if (times.empty() || t.valueSize == 0) {
+            t.kind = Kind::Interpolant;
+        } else if (track->getInterpolation() == Interpolation::Discrete) {
+            t.kind = Kind::Step;
+        } else if (track->getInterpolation() == Interpolation::Smooth) {
+            t.kind = Kind::Interpolant;
+        } else if (track->ValueTypeName() == "quaternion") {
+            t.kind = Kind::Slerp;
+        } else {
+            t.kind = Kind::Lerp;
+        }
+
+        times_.insert(times_.end(), times.begin(), times.end());
+        values_.insert(values_.end(), values.begin(), values.end());
+
+        const auto index = static_cast<std::uint32_t>(tracks_.size());
+        switch (t.kind) {
+            case Kind::Step:
+                step_.push_back(index);
+                break;
+            case Kind::Lerp:
+                (t.valueSize == 3 ? lerp3_ : lerp_).push_back(index);
+                break;
+            case Kind::Slerp:
+                slerp_.push_back(index);
+                break;
+            case Kind::Interpolant:
+                interpolated_.push_back(index);
+                break;
+        }
+        tracks_.push_back(t);
+    }
+}
+
+std::shared_ptr<const CompiledClip> CompiledClip::of(AnimationClip& clip) {
+
+    static std::mutex mutex;
+    std::lock_guard lock(mutex);
+
+    if (!clip.compiled_) clip.compiled_ = std::make_shared<const CompiledClip>(clip);
+    return clip.compiled_;
+}
+
+void CompiledClip::evaluate(float t, std::uint32_t* keys, std::vector<float>* const* dst) const {
+
+    const float* times = times_.data();
+    const float* values = values_.data();
+
+    for (const auto j : lerp3_) {
+
+        const auto& track = tracks_[j];
+        const float* tt = times + track.firstTime;
+        const auto i1 = keys[j] = seek(tt, track.keyCount, t, keys[j]);
+        float* out = dst[j]->data();
+
+        if (const auto k = clampedKey(i1, track.keyCount); k >= 0) {
+            const float* v = values + track.firstValue + k * 3;
+            out[0] = v[0];
+            out[1] = v[1];
+            out[2] = v[2];
+            continue;
+        }
+
+        const float t0 = tt[i1 - 1], t1 = tt[i1];
+        const auto weight1 = (t - t0) / (t1 - t0);
+        const auto weight0 = 1 - weight1;
+        const float* v0 = values + track.firstValue + (i1 - 1) * 3;
+        const float* v1 = v0 + 3;
+        out[0] = v0[0] * weight0 + v1[0] * weight1;
+        out[1] = v0[1] * weight0 + v1[1] * weight1;
+        out[2] = v0[2] * weight0 + v1[2] * weight1;
+    }
+
+    for (const auto j : slerp_) {
+
+        const auto& track = tracks_[j];
+        const float* tt = times + track.firstTime;
+        const auto i1 = keys[j] = seek(tt, track.keyCount, t, keys[j]);
+        const auto stride = track.valueSize;
+
+        if (const auto k = clampedKey(i1, track.keyCount); k >= 0) {
+            std::copy_n(values + track.firstValue + k * stride, stride, dst[j]->data());
+            continue;
+        }
+
+        const float t0 = tt[i1 - 1], t1 = tt[i1];
+        const auto alpha = (t - t0) / (t1 - t0);
+        // Every quaternion of a multi-quaternion sample lands at 0, as in
+        // QuaternionLinearInterpolant.
+        auto offset = track.firstValue + i1 * stride;
+        for (const auto end = offset + stride; offset != end; offset += 4) {
+            Quaternion::slerpFlat(*dst[j], 0, values_, offset - stride, values_, offset, alpha);
+        }
+    }
+
+    for (const auto j : lerp_) {
+
+        const auto& track = tracks_[j];
+        const float* tt = times + track.firstTime;
+        const auto i1 = keys[j] = seek(tt, track.keyCount, t, keys[j]);
+        const auto stride = track.valueSize;
+        float* out = dst[j]->data();
+
+        if (const auto k = clampedKey(i1, track.keyCount); k >= 0) {
+            std::copy_n(values + track.firstValue + k * stride, stride, out);
+            continue;
+        }
+
+        const float t0 = tt[i1 - 1], t1 = tt[i1];
+        const auto weight1 = (t - t0) / (t1 - t0);
+        const auto weight0 = 1 - weight1;
+        const float* v0 = values + track.firstValue + (i1 - 1) * stride;
+        const float* v1 = v0 + stride;
+        for (std::uint32_t i = 0; i != stride; ++i) {
+            out[i] = v0[i] * weight0 + v1[i] * weight1;
+        }
+    }
+
+    for (const auto j : step_) {
+
+        const auto& track = tracks_[j];
+        const auto i1 = keys[j] = seek(times + track.firstTime, track.keyCount, t, keys[j]);
+        const auto k = i1 == 0 ? 0 : i1 - 1;
+        std::copy_n(values + track.firstValue + k * track.valueSize, track.valueSize, dst[j]->data());
+    }
+}
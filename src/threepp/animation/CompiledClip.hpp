@@ -0,0 +1,87 @@
+// A clip's keyframes laid out for AnimationMixer::compileClips.
+//
+// Every track's key times sit in one contiguous array and every track's values
+// in another, with a small table saying where each track starts. Sampling the
+// whole clip is then one pass over that table — no Interpolant per track, no
+// virtual call, and no std::vector returned (and so allocated) per track per
+// frame, which is what the interpolant path costs.
+//
+// The math is the interpolants', operation for operation: the same interval
+// choice as Interpolant::evaluate, the same lerp weights as LinearInterpolant,
+// Quaternion::slerpFlat for rotations, a plain copy for Discrete. Smooth
+// (cubic) tracks depend on the action's ending settings and keep their
+// CubicInterpolant; evaluate() skips them.
+//
+// Built once per clip, on first use, and shared by every action playing it.
+// Like the interpolants, it is a snapshot: edit a clip's tracks before playing
+// it, not after.
+
+#ifndef THREEPP_COMPILEDCLIP_HPP
+#define THREEPP_COMPILEDCLIP_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace threepp {
+
+    class AnimationClip;
+
+    class CompiledClip {
+
+    public:
+        enum class Kind: std::uint8_t {
+            Step,       // Discrete: the key at or before t
+            Lerp,       // Linear, componentwise
+            Slerp,      // Linear quaternion
+            Interpolant // Smooth: left to the track's own interpolant
+        };
+
+        struct Track {
+            std::uint32_t firstTime;
+            std::uint32_t keyCount;
+            std::uint32_t firstValue;
+            std::uint32_t valueSize;
+            Kind kind;
+        };
+
+        explicit CompiledClip(const AnimationClip& clip);
+
+        // The clip's compiled form, built on the first call.
+        static std::shared_ptr<const CompiledClip> of(AnimationClip& clip);
+
+        [[nodiscard]] const std::vector<Track>& tracks() const {
+
+            return tracks_;
+        }
+
+        // The Smooth (and empty) tracks evaluate() leaves alone.
+        [[nodiscard]] const std::vector<std::uint32_t>& interpolated() const {
+
+            return interpolated_;
+        }
+
+        // Sample every track at t into dst[i] (from index 0, valueSize floats).
+        // keys[i] is track i's interval from the previous call — playback
+        // moves a frame at a time, so it is nearly always still right, or the
+        // next one — and is updated in place. Start it at 0.
+        void evaluate(float t, std::uint32_t* keys, std::vector<float>* const* dst) const;
+
+    private:
+        std::vector<float> times_;
+        std::vector<float> values_;
+        std::vector<Track> tracks_;
+
+        // Track indices by kind, so each loop in evaluate() runs one kind of
+        // arithmetic with no per-track switch. Linear vec3 (positions,
+        // scales) is the bulk of a skeletal clip and gets its own loop.
+        std::vector<std::uint32_t> lerp3_;
+        std::vector<std::uint32_t> lerp_;
+        std::vector<std::uint32_t> slerp_;
+        std::vector<std::uint32_t> step_;
+        std::vector<std::uint32_t> interpolated_;
+    };
+
+}// namespace threepp
+
+#endif//THREEPP_COMPILEDCLIP_HPP
@@ -352,6 +352,25 @@ void PropertyBinding::bind() {
     this->targetObject = targetObject;
     this->propertyName = propertyName;
 
+    this->morphIndex = parseMorphIndex(propertyName);
+    this->morphTargets.clear();
+    if (propertyName == "quaternion") {
+        this->directProperty = DirectProperty::Quaternion;
+    } else if (propertyName == "position") {
+        this->directProperty = DirectProperty::Position;
+    } else if (propertyName == "scale") {
+        this->directProperty = DirectProperty::Scale;
+    } else if (this->morphIndex >= 0) {
+        // Morph influences fan out to every primitive sharing the weights.
+        this->directProperty = DirectProperty::Morph;
+        if (auto* m = dynamic_cast<ObjectWithMorphTargetInfluences*>(targetObject)) this->morphTargets.push_back(m);
+        for (auto* t : this->extraTargets) {
+            if (auto* m = dynamic_cast<ObjectWithMorphTargetInfluences*>(t)) this->morphTargets.push_back(m);
+        }
+    } else {
+        this->directProperty = DirectProperty::Other;
+    }
+
     // select getter / setter
     if (dynamic_cast<MaterialAnimationProxy*>(targetObject)) {
         this->_getValue = _getValue_material;
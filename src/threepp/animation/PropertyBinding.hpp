@@ -62,17 +62,6 @@ namespace threepp {
         std::vector<Object3D*> extraTargets;
         std::string propertyName;
 
-        // Write a single morph influence onto obj (if it carries any),
-        // growing the array as needed. Shared by every direct setter so the
-        // multi-primitive fan-out lives in one place.
-        static void applyMorphInfluence(Object3D* obj, int idx, float value) {
-            if (auto* m = dynamic_cast<ObjectWithMorphTargetInfluences*>(obj)) {
-                auto& inf = m->morphTargetInfluences();
-                if (idx >= static_cast<int>(inf.size())) inf.resize(idx + 1, 0.f);
-                inf[idx] = value;
-            }
-        }
-
         PropertyBinding(Object3D* rootNode, const std::string& path, const std::optional<TrackResults>& parsedPath)
             : rootNode(rootNode), path(path), parsedPath(parsedPath.value_or(parseTrackName(path))) {
 
@@ -103,52 +92,83 @@ namespace threepp {
             return -1;
         }
 
+        // What propertyName names, worked out once in bind() so the direct
+        // setters, which run for every animated property every frame, switch
+        // on this instead of comparing strings.
+        enum class DirectProperty {
+            Position,
+            Quaternion,
+            Scale,
+            Morph,
+            Other
+        };
+        DirectProperty directProperty = DirectProperty::Other;
+        int morphIndex = -1;
+        // targetObject and extraTargets that carry morph influences, already cast.
+        std::vector<ObjectWithMorphTargetInfluences*> morphTargets;
+
+        static void applyMorphInfluence(ObjectWithMorphTargetInfluences* m, int idx, float value) {
+            auto& inf = m->morphTargetInfluences();
+            if (idx >= static_cast<int>(inf.size())) inf.resize(idx + 1, 0.f);
+            inf[idx] = value;
+        }
+
         static void _getValue_direct(PropertyBinding* that, std::vector<float>& buffer, size_t offset) {
 
-            if (that->propertyName == "quaternion") {
-                that->targetObject->quaternion.toArray(buffer, offset);
-            } else if (that->propertyName == "position") {
-                that->targetObject->position.toArray(buffer, offset);
-            } else if (that->propertyName == "scale") {
-                that->targetObject->scale.toArray(buffer, offset);
-            } else if (int idx = parseMorphIndex(that->propertyName); idx >= 0) {
-                if (auto* m = dynamic_cast<ObjectWithMorphTargetInfluences*>(that->targetObject)) {
-                    auto& inf = m->morphTargetInfluences();
-                    buffer[offset] = idx < static_cast<int>(inf.size()) ? inf[idx] : 0.f;
-                }
-            } else {
-                std::cerr << that->propertyName << " is not readable." << std::endl;
+            switch (that->directProperty) {
+                case DirectProperty::Quaternion:
+                    that->targetObject->quaternion.toArray(buffer, offset);
+                    break;
+                case DirectProperty::Position:
+                    that->targetObject->position.toArray(buffer, offset);
+                    break;
+                case DirectProperty::Scale:
+                    that->targetObject->scale.toArray(buffer, offset);
+                    break;
+                case DirectProperty::Morph:
+                    if (auto* m = dynamic_cast<ObjectWithMorphTargetInfluences*>(that->targetObject)) {
+                        auto& inf = m->morphTargetInfluences();
+                        buffer[offset] = that->morphIndex < static_cast<int>(inf.size()) ? inf[that->morphIndex] : 0.f;
+                    }
+                    break;
+                case DirectProperty::Other:
+                    std::cerr << that->propertyName << " is not readable." << std::endl;
+                    break;
+            }
+        }
+
+        // Returns false when propertyName is not a property it knows.
+        static bool setDirect(PropertyBinding* that, const std::vector<float>& buffer, size_t offset) {
+
+            switch (that->directProperty) {
+                case DirectProperty::Quaternion:
+                    that->targetObject->quaternion.fromArray(buffer, offset);
+                    return true;
+                case DirectProperty::Position:
+                    that->targetObject->position.fromArray(buffer, offset);
+                    return true;
+                case DirectProperty::Scale:
+                    that->targetObject->scale.fromArray(buffer, offset);
+                    return true;
+                case DirectProperty::Morph:
+                    for (auto* m : that->morphTargets) applyMorphInfluence(m, that->morphIndex, buffer[offset]);
+                    return true;
+                case DirectProperty::Other:
+                    break;
             }
+            return false;
         }
 
         static void _setValue_direct(PropertyBinding* that, const std::vector<float>& buffer, size_t offset) {
 
-            if (that->propertyName == "quaternion") {
-                that->targetObject->quaternion.fromArray(buffer, offset);
-            } else if (that->propertyName == "position") {
-                that->targetObject->position.fromArray(buffer, offset);
-            } else if (that->propertyName == "scale") {
-                that->targetObject->scale.fromArray(buffer, offset);
-            } else if (int idx = parseMorphIndex(that->propertyName); idx >= 0) {
-                applyMorphInfluence(that->targetObject, idx, buffer[offset]);
-                for (auto* t : that->extraTargets) applyMorphInfluence(t, idx, buffer[offset]);
-            } else {
+            if (!setDirect(that, buffer, offset)) {
                 std::cerr << that->propertyName << " is not writable." << std::endl;
             }
         }
 
         static void _setValue_direct_setMatrixWorldNeedsUpdate(PropertyBinding* that, const std::vector<float>& buffer, size_t offset) {
 
-            if (that->propertyName == "quaternion") {
-                that->targetObject->quaternion.fromArray(buffer, offset);
-            } else if (that->propertyName == "position") {
-                that->targetObject->position.fromArray(buffer, offset);
-            } else if (that->propertyName == "scale") {
-                that->targetObject->scale.fromArray(buffer, offset);
-            } else if (int idx = parseMorphIndex(that->propertyName); idx >= 0) {
-                applyMorphInfluence(that->targetObject, idx, buffer[offset]);
-                for (auto* t : that->extraTargets) applyMorphInfluence(t, idx, buffer[offset]);
-            } else {
+            if (!setDirect(that, buffer, offset)) {
                 std::cerr << "_setValue_direct_setMatrixWorldNeedsUpdate: " << that->propertyName << " is not writable." << std::endl;
             }
             that->targetObject->matrixWorldNeedsUpdate = true;
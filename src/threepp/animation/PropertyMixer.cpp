@@ -1,15 +1,15 @@
 
 #include "threepp/animation/PropertyMixer.hpp"
 
-#include <functional>
-
 using namespace threepp;
 
 namespace {
 
-    using MixFunction = std::function<void(PropertyMixer*, std::vector<float>&, int, int, float, int)>;
+    // Plain pointers: these run once per track per action per frame, too
+    // often to go through std::function.
+    using MixFunction = void (*)(PropertyMixer*, std::vector<float>&, int, int, float, int);
     using MixFunctionAdditive = MixFunction;
-    using SetIdentity = std::function<void(PropertyMixer*)>;
+    using SetIdentity = void (*)(PropertyMixer*);
 
 
 }// namespace
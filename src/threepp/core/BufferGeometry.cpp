@@ -4,9 +4,11 @@
 #include "threepp/math/MathUtils.hpp"
 #include "threepp/math/Matrix3.hpp"
 #include "threepp/math/Matrix4.hpp"
+#include "threepp/utils/BVH.hpp"
 
 #include <cmath>
 #include <iostream>
+#include <mutex>
 #include <utility>
 
 using namespace threepp;
@@ -680,8 +682,66 @@ std::shared_ptr<BufferGeometry> BufferGeometry::clone() const {
     return g;
 }
 
+struct BufferGeometry::BoundsTree {
+    std::mutex mutex;
+    std::shared_ptr<const BVH> tree;
+
+    // What the tree was built from.
+    unsigned int attributesVersion = 0;
+    unsigned int positionVersion = 0;
+    unsigned int indexVersion = 0;
+};
+
+void BufferGeometry::computeBoundsTree() {
+
+    if (!boundsTree_) boundsTree_ = std::make_unique<BoundsTree>();
+    (void) boundsTree();
+}
+
+void BufferGeometry::disposeBoundsTree() {
+
+    boundsTree_ = nullptr;
+}
+
+bool BufferGeometry::hasBoundsTree() const {
+
+    return boundsTree_ != nullptr;
+}
+
+std::shared_ptr<const BVH> BufferGeometry::boundsTree() {
+
+    if (!boundsTree_) return nullptr;
+
+    std::lock_guard lock(boundsTree_->mutex);
+
+    const auto position = getAttribute("position");
+    const auto positionVersion = position ? position->version : 0;
+    const auto indexVersion = index_ ? index_->version : 0;
+
+    auto& cache = *boundsTree_;
+    if (!cache.tree || cache.attributesVersion != attributesVersion_ ||
+        cache.positionVersion != positionVersion || cache.indexVersion != indexVersion) {
+
+        auto tree = std::make_shared<BVH>();
+        tree->build(*this);
+
+        cache.tree = std::move(tree);
+        cache.attributesVersion = attributesVersion_;
+        cache.positionVersion = positionVersion;
+        cache.indexVersion = indexVersion;
+    }
+
+    return cache.tree;
+}
+
 void BufferGeometry::dispose() {
 
+    // Stays opted in; the tree is rebuilt if the geometry is used again.
+    if (boundsTree_) {
+        std::lock_guard lock(boundsTree_->mutex);
+        boundsTree_->tree = nullptr;
+    }
+
     if (!disposed_) {
         disposed_ = true;
         this->dispatchEvent("dispose", this);
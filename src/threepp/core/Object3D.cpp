@@ -12,10 +12,23 @@
 
 #include "threepp/lights/Light.hpp"
 
+#include "threepp/objects/Bone.hpp"
+#include "threepp/objects/Group.hpp"
+#include "threepp/objects/InstancedMesh.hpp"
+#include "threepp/objects/LOD.hpp"
+#include "threepp/objects/LineLoop.hpp"
+#include "threepp/objects/LineSegments.hpp"
+#include "threepp/objects/Points.hpp"
+#include "threepp/objects/Sprite.hpp"
+#include "threepp/scenes/Scene.hpp"
+
+#include "threepp/utils/Parallel.hpp"
+
 #include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <limits>
+#include <typeindex>
 
 using namespace threepp;
 
@@ -41,6 +54,26 @@ namespace {
         return true;
     }
 
+    // Nodes in the subtree at root, counting no further than limit.
+    std::size_t countUpTo(const Object3D& root, std::size_t limit) {
+
+        std::size_t count = 0;
+        std::vector<const Object3D*> stack{&root};
+        while (!stack.empty() && count < limit) {
+
+            const auto* node = stack.back();
+            stack.pop_back();
+            ++count;
+            stack.insert(stack.end(), node->children.begin(), node->children.end());
+        }
+
+        return count;
+    }
+
+    // How many levels updateMatrixWorldParallel walks on the calling thread
+    // at most while looking for enough subtrees to share out.
+    constexpr int maxSerialDepth = 8;
+
 }// namespace
 
 Object3D::Object3D()
@@ -267,6 +300,7 @@ void Object3D::addRef(Object3D& object) {
 
     object.parent = this;
     this->children.emplace_back(&object);
+    markHierarchyChanged();
 
     // The new parent's world transform must flow into this subtree even when
     // the child's local transform is unchanged (updateMatrix()'s early-out no
@@ -311,6 +345,7 @@ std::shared_ptr<Object3D> Object3D::detachChild(Object3D& object) {
         children.erase(it);
 
         child->parent = nullptr;
+        markHierarchyChanged();
         child->dispatchEvent("remove", child);
     }
 
@@ -348,6 +383,7 @@ void Object3D::clear() {
 
     this->children.clear();
     this->children_.clear();
+    markHierarchyChanged();
 }
 
 void Object3D::getWorldPosition(Vector3& target) {
@@ -450,6 +486,141 @@ void Object3D::updateMatrix() {
 
 void Object3D::updateMatrixWorld(bool force) {
 
+    force = updateOwnMatrixWorld(force);
+
+    // update children
+
+    for (auto& child : this->children) {
+
+        child->updateMatrixWorld(force);
+    }
+}
+
+bool Object3D::updateOwnMatrixWorld(bool force) {
+
+    pollLocalMatrix();
+
+    if (this->matrixWorldNeedsUpdate || force) {
+
+        if (!this->parent) {
+
+            this->matrixWorld->copy(*this->matrix);
+
+        } else {
+
+            this->matrixWorld->multiplyMatrices(*this->parent->matrixWorld, *this->matrix);
+        }
+
+        this->matrixWorldNeedsUpdate = false;
+
+        return true;
+    }
+
+    return false;
+}
+
+void Object3D::updateMatrixWorldDeferring(bool force, std::vector<std::pair<Object3D*, bool>>& deferred) {
+
+    force = updateOwnMatrixWorld(force);
+
+    for (auto& child : this->children) {
+
+        if (usesBaseMatrixWorldUpdate(*child)) {
+
+            child->updateMatrixWorldDeferring(force, deferred);
+
+        } else {
+
+            deferred.emplace_back(child, force);
+        }
+    }
+}
+
+void Object3D::updateMatrixWorldParallel(bool force, std::size_t minSubtreeSize) {
+
+    if (!usesBaseMatrixWorldUpdate(*this)) {
+
+        updateMatrixWorld(force);
+        return;
+    }
+
+    using Subtree = std::pair<Object3D*, bool>;
+    std::vector<Subtree> deferred;
+
+    // Walk down a level at a time until the frontier has a few subtrees per
+    // lane. A node depends on nothing but its parent, so breadth first gives
+    // the same matrices as the recursion's depth first.
+    const std::size_t wanted = 4 * std::size_t{ThreadPool::global().concurrency()};
+    std::vector<Subtree> frontier{{this, force}}, next;
+    int depth = 0;
+    do {
+
+        next.clear();
+        for (const auto& [node, inherited] : frontier) {
+
+            const bool changed = node->updateOwnMatrixWorld(inherited);
+            for (auto* child : node->children) {
+
+                (usesBaseMatrixWorldUpdate(*child) ? next : deferred).emplace_back(child, changed);
+            }
+        }
+        frontier.swap(next);
+
+    } while (!frontier.empty() && frontier.size() < wanted && ++depth < maxSerialDepth);
+
+    std::vector<Subtree> large;
+    for (const auto& subtree : frontier) {
+
+        if (countUpTo(*subtree.first, minSubtreeSize) >= minSubtreeSize) {
+
+            large.push_back(subtree);
+
+        } else {
+
+            subtree.first->updateMatrixWorldDeferring(subtree.second, deferred);
+        }
+    }
+
+    // Disjoint subtrees, each reading only its own nodes and the already
+    // final matrices above it; what each holds back is kept apart and
+    // appended in subtree order, so the threading never shows.
+    std::vector<std::vector<Subtree>> held(large.size());
+    parallelFor(0, large.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            large[i].first->updateMatrixWorldDeferring(large[i].second, held[i]);
+        }
+    });
+    for (const auto& h : held) deferred.insert(deferred.end(), h.begin(), h.end());
+
+    for (const auto& [node, inherited] : deferred) {
+
+        node->updateMatrixWorld(inherited);
+    }
+}
+
+bool Object3D::usesBaseMatrixWorldUpdate(const Object3D& node) {
+
+    // Exact types: a subclass of any of these may override updateMatrixWorld.
+    // Listing the plain types rather than the overriding ones keeps a class
+    // nobody told us about on the safe side. Scene's override is only a
+    // faster route to the same matrices (a TransformStore), so passing it by
+    // changes nothing.
+    static const std::array<std::type_index, 12> plain{
+            typeid(Object3D), typeid(Group), typeid(Scene), typeid(Bone), typeid(Mesh), typeid(InstancedMesh),
+            typeid(Points), typeid(Line), typeid(LineSegments), typeid(LineLoop), typeid(Sprite), typeid(LOD)};
+
+    return std::ranges::find(plain, std::type_index(typeid(node))) != plain.end();
+}
+
+void Object3D::markHierarchyChanged() {
+
+    for (Object3D* node = this; node; node = node->parent) {
+        ++node->hierarchyEpoch_;
+    }
+}
+
+void Object3D::pollLocalMatrix() {
+
     if (this->matrixAutoUpdate) {
 
         this->updateMatrix();
@@ -475,29 +646,6 @@ void Object3D::updateMatrixWorld(bool force) {
 
         this->matrixWorldNeedsUpdate = true;
     }
-
-    if (this->matrixWorldNeedsUpdate || force) {
-
-        if (!this->parent) {
-
-            this->matrixWorld->copy(*this->matrix);
-
-        } else {
-
-            this->matrixWorld->multiplyMatrices(*this->parent->matrixWorld, *this->matrix);
-        }
-
-        this->matrixWorldNeedsUpdate = false;
-
-        force = true;
-    }
-
-    // update children
-
-    for (auto& child : this->children) {
-
-        child->updateMatrixWorld(force);
-    }
 }
 
 void Object3D::updateWorldMatrix(bool updateParents, bool updateChildren) {
@@ -651,6 +799,9 @@ Object3D::Object3D(Object3D&& source) noexcept: Object3D() {
     for (auto& c : children) {
         c->parent = this;
     }
+
+    // The source may still sit in a graph, which just lost this subtree.
+    source.markHierarchyChanged();
 }
 
 Object3D::~Object3D() {
@@ -670,6 +821,7 @@ Object3D::~Object3D() {
     if (parent) {
         auto& siblings = parent->children;
         siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+        parent->markHierarchyChanged();
         parent = nullptr;
     }
 
@@ -3,9 +3,19 @@
 
 #include "threepp/cameras/OrthographicCamera.hpp"
 #include "threepp/cameras/PerspectiveCamera.hpp"
+#include "threepp/math/Sphere.hpp"
+#include "threepp/math/infinity.hpp"
+#include "threepp/objects/Mesh.hpp"
+#include "threepp/objects/SkinnedMesh.hpp"
+#include "threepp/utils/Parallel.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <typeinfo>
 
 using namespace threepp;
 
@@ -34,6 +44,96 @@ namespace {
         }
     }
 
+    struct BatchTarget {
+        Object3D* object;
+        std::optional<Sphere> bounds;// world space; none = no early-out
+        std::uint32_t order;         // position in the flattened list
+        // Concurrent targets only: the mesh and its bounds tree, looked up
+        // once here rather than under the geometry's lock for every ray.
+        Mesh* mesh = nullptr;
+        std::shared_ptr<const BVH> tree;
+    };
+
+    struct BatchTargets {
+        std::vector<BatchTarget> concurrent;
+        std::vector<BatchTarget> serial;
+        std::uint32_t count = 0;
+    };
+
+    // Also does, up front and on one thread, the lazy work a raycast would
+    // otherwise do on whichever worker got there first.
+    void flattenBatchTargets(Object3D& object, const Layers& layers, bool recursive, BatchTargets& targets) {
+
+        if (object.layers.test(layers)) {
+
+            BatchTarget target{&object, std::nullopt, targets.count++};
+
+            // Exactly Mesh: its raycast keeps scratch in thread_locals and only
+            // reads the object. Subclasses may override raycast or its hooks.
+            if (typeid(object) == typeid(Mesh)) {
+
+                target.mesh = object.as<Mesh>();
+                if (const auto geometry = object.geometry()) {
+                    if (!geometry->boundingSphere) geometry->computeBoundingSphere();
+                    target.tree = target.mesh->raycastBoundsTree();
+                    if (geometry->boundingSphere) {
+                        target.bounds = Sphere(*geometry->boundingSphere).applyMatrix4(*object.matrixWorld);
+                    }
+                }
+                targets.concurrent.emplace_back(target);
+
+            } else {
+
+                if (auto skinned = object.as<SkinnedMesh>()) {
+                    const auto& posed = skinned->posedBoundingSphere();
+                    if (posed.radius >= 0) target.bounds = Sphere(posed).applyMatrix4(*object.matrixWorld);
+                }
+                targets.serial.emplace_back(target);
+            }
+        }
+
+        if (recursive) {
+
+            for (const auto& child : object.children) {
+
+                flattenBatchTargets(*child, layers, true, targets);
+            }
+        }
+    }
+
+    void castAt(const BatchTarget& target, const Raycaster& caster, std::vector<Intersection>& intersects) {
+
+        if (target.mesh) {
+            target.mesh->raycastWithTree(caster, intersects, target.tree.get());
+        } else {
+            target.object->raycast(caster, intersects);
+        }
+    }
+
+    // Distance along a (normalized) ray to where it enters the sphere, 0 from
+    // inside, +inf on a miss.
+    float sphereEntry(const Ray& ray, const Sphere& sphere) {
+
+        const Vector3 oc = sphere.center - ray.origin;
+        const float tca = oc.dot(ray.direction);
+        const float d2 = oc.lengthSq() - tca * tca;
+        const float r2 = sphere.radius * sphere.radius;
+        if (d2 > r2) return Infinity<float>;
+
+        const float thc = std::sqrt(r2 - d2);
+        if (tca + thc < 0) return Infinity<float>;
+        return std::max(0.f, tca - thc);
+    }
+
+    void checkBatchSize(std::size_t rays, std::size_t out) {
+
+        if (out < rays) {
+
+            throw std::invalid_argument("Raycaster: batch output holds " + std::to_string(out) +
+                                        " results for " + std::to_string(rays) + " rays");
+        }
+    }
+
 }// namespace
 
 
@@ -74,6 +174,110 @@ std::vector<Intersection> Raycaster::intersectObjects(const std::vector<Object3D
     return intersects;
 }
 
+void Raycaster::intersectBatch(std::span<const Ray> rays, const std::vector<Object3D*>& objects,
+                               std::span<std::optional<Intersection>> hits, const BatchOptions& options) const {
+
+    checkBatchSize(rays.size(), hits.size());
+
+    BatchTargets targets;
+    for (auto& object : objects) {
+
+        flattenBatchTargets(*object, layers, options.recursive, targets);
+    }
+
+    // Order of the object that produced hits[i]: equal distances go to the
+    // earlier object, as intersectObjects' stable sort would have it.
+    std::vector<std::uint32_t> hitOrder(rays.size());
+    for (std::size_t i = 0; i < rays.size(); ++i) hits[i].reset();
+
+    const std::size_t packetSize = std::max<std::size_t>(1, options.raysPerPacket);
+    const std::size_t packets = (rays.size() + packetSize - 1) / packetSize;
+
+    // Every ray against every target, object-major within a packet. Each
+    // ray's far limit shrinks to its best hit so far, which both culls whole
+    // objects and lets firstHitOnly stop early inside the next one.
+    const auto castPackets = [&](const std::vector<BatchTarget>& list, std::size_t p0, std::size_t p1) {
+        Raycaster caster(*this);
+        caster.firstHitOnly = true;
+        std::vector<Intersection> scratch;
+
+        for (std::size_t p = p0; p < p1; ++p) {
+            const std::size_t r0 = p * packetSize;
+            const std::size_t r1 = std::min(rays.size(), r0 + packetSize);
+
+            for (const auto& target : list) {
+                for (std::size_t r = r0; r < r1; ++r) {
+                    const float limit = hits[r] ? hits[r]->distance : farPlane;
+                    if (target.bounds && sphereEntry(rays[r], *target.bounds) > limit) continue;
+
+                    caster.ray = rays[r];
+                    caster.farPlane = limit;
+                    scratch.clear();
+                    castAt(target, caster, scratch);
+
+                    for (const auto& hit : scratch) {
+                        if (!hits[r] || hit.distance < hits[r]->distance ||
+                            (hit.distance == hits[r]->distance && target.order < hitOrder[r])) {
+                            hits[r] = hit;
+                            hitOrder[r] = target.order;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    parallelFor(0, packets, 1, [&](std::size_t p0, std::size_t p1) {
+        castPackets(targets.concurrent, p0, p1);
+    });
+    if (!targets.serial.empty()) castPackets(targets.serial, 0, packets);
+}
+
+void Raycaster::intersectBatchAny(std::span<const Ray> rays, const std::vector<Object3D*>& objects,
+                                  std::span<bool> occluded, const BatchOptions& options) const {
+
+    checkBatchSize(rays.size(), occluded.size());
+
+    BatchTargets targets;
+    for (auto& object : objects) {
+
+        flattenBatchTargets(*object, layers, options.recursive, targets);
+    }
+
+    for (std::size_t i = 0; i < rays.size(); ++i) occluded[i] = false;
+
+    const std::size_t packetSize = std::max<std::size_t>(1, options.raysPerPacket);
+    const std::size_t packets = (rays.size() + packetSize - 1) / packetSize;
+
+    const auto castPackets = [&](const std::vector<BatchTarget>& list, std::size_t p0, std::size_t p1) {
+        Raycaster caster(*this);
+        caster.firstHitOnly = true;
+        std::vector<Intersection> scratch;
+
+        for (std::size_t p = p0; p < p1; ++p) {
+            const std::size_t r0 = p * packetSize;
+            const std::size_t r1 = std::min(rays.size(), r0 + packetSize);
+
+            for (const auto& target : list) {
+                for (std::size_t r = r0; r < r1; ++r) {
+                    if (occluded[r]) continue;
+                    if (target.bounds && sphereEntry(rays[r], *target.bounds) > farPlane) continue;
+
+                    caster.ray = rays[r];
+                    scratch.clear();
+                    castAt(target, caster, scratch);
+                    occluded[r] = !scratch.empty();
+                }
+            }
+        }
+    };
+
+    parallelFor(0, packets, 1, [&](std::size_t p0, std::size_t p1) {
+        castPackets(targets.concurrent, p0, p1);
+    });
+    if (!targets.serial.empty()) castPackets(targets.serial, 0, packets);
+}
+
 void Raycaster::setFromCamera(const Vector2& coords, Camera& camera) {
 
     if (camera.is<PerspectiveCamera>()) {
@@ -0,0 +1,143 @@
+
+#include "threepp/core/TransformStore.hpp"
+
+#include "threepp/core/Object3D.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    constexpr std::size_t prefetchDistance = 8;
+
+}// namespace
+
+struct TransformStore::Impl {
+
+    Object3D* root;
+    std::uint64_t version = std::numeric_limits<std::uint64_t>::max();
+    std::size_t rebuilds = 0;
+
+    // Parent-before-child (the recursion's preorder), one entry per node.
+    // Nodes whose class may override updateMatrixWorld are updated through
+    // it, and their subtree is not laid out.
+    std::vector<Object3D*> nodes;
+    std::vector<std::int32_t> parent;// index into nodes; -1 for the root
+    std::vector<std::uint8_t> opaque;// updated through its own override
+    std::vector<std::uint8_t> changed;// world matrix rewritten this pass
+
+    explicit Impl(Object3D& root): root(&root) {}
+
+    // The walk knows which nodes come next, which the recursion through
+    // `children` cannot tell the hardware: pull in the fields the poll reads
+    // a few nodes ahead.
+    static void prefetch([[maybe_unused]] const Object3D& node) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&node.position);
+        __builtin_prefetch(&node.scale);
+        __builtin_prefetch(&node.matrixWorldNeedsUpdate);
+        __builtin_prefetch(node.composedPqs_.data());
+        __builtin_prefetch(node.composedMatrix_.data());
+        __builtin_prefetch(node.matrix.get());
+#endif
+    }
+
+    void rebuild() {
+
+        nodes.clear();
+        parent.clear();
+        opaque.clear();
+
+        std::vector<std::pair<Object3D*, std::int32_t>> stack{{root, -1}};
+        while (!stack.empty()) {
+
+            const auto [node, p] = stack.back();
+            stack.pop_back();
+
+            const auto index = static_cast<std::int32_t>(nodes.size());
+            const bool custom = p >= 0 && !Object3D::usesBaseMatrixWorldUpdate(*node);
+            nodes.push_back(node);
+            parent.push_back(p);
+            opaque.push_back(custom);
+
+            if (custom) continue;
+            for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+                stack.emplace_back(*it, index);
+            }
+        }
+
+        changed.assign(nodes.size(), 0);
+        ++rebuilds;
+    }
+
+    void update(bool force) {
+
+        const auto current = root->hierarchyEpoch_;
+        if (current != version) {
+            rebuild();
+            version = current;
+        }
+
+        const auto count = nodes.size();
+        for (std::size_t i = 0; i < count; ++i) {
+
+            if (i + prefetchDistance < count) prefetch(*nodes[i + prefetchDistance]);
+
+            Object3D& node = *nodes[i];
+            const auto p = parent[i];
+            const bool inherited = p < 0 ? force : changed[p] != 0;
+
+            if (opaque[i]) {
+                node.updateMatrixWorld(inherited);
+                changed[i] = 0;
+                continue;
+            }
+
+            node.pollLocalMatrix();
+
+            if (!node.matrixWorldNeedsUpdate && !inherited) {
+                changed[i] = 0;
+                continue;
+            }
+
+            // Parents come first, so a parent rewritten this pass has already
+            // written its own matrixWorld.
+            if (node.parent) {
+                node.matrixWorld->multiplyMatrices(*node.parent->matrixWorld, *node.matrix);
+            } else {
+                node.matrixWorld->copy(*node.matrix);
+            }
+            node.matrixWorldNeedsUpdate = false;
+            changed[i] = 1;
+        }
+    }
+};
+
+TransformStore::TransformStore(Object3D& root)
+    : pimpl_(std::make_unique<Impl>(root)) {}
+
+void TransformStore::update(bool force) {
+
+    pimpl_->update(force);
+}
+
+Object3D& TransformStore::root() const {
+
+    return *pimpl_->root;
+}
+
+std::size_t TransformStore::size() const {
+
+    return pimpl_->nodes.size();
+}
+
+std::size_t TransformStore::rebuilds() const {
+
+    return pimpl_->rebuilds;
+}
+
+TransformStore::~TransformStore() = default;
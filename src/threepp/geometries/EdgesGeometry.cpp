@@ -3,80 +3,115 @@
 
 #include "threepp/math/MathUtils.hpp"
 #include "threepp/math/Triangle.hpp"
+#include "threepp/utils/HashIndex.hpp"
+#include "threepp/utils/Parallel.hpp"
 
+#include <array>
+#include <climits>
 #include <cmath>
-#include <sstream>
 
 using namespace threepp;
 
 namespace {
 
-    Vector3 _v0;
-    Vector3 _v1;
-    Vector3 _normal;
-    Triangle _triangle;
+    // Vertices are matched on their position rounded to 1e-4 (three.js'
+    // precisionPoints = 4), as integers.
+    constexpr double precision = 1e4;
+
+    int64_t quantize(float value) {
+
+        const double rounded = std::round(value * precision);
+        // Far outside any grid that means anything; saturate rather than
+        // overflow. NaN gets a bucket of its own.
+        if (!(std::abs(rounded) < 0x1p62)) {
+            if (std::isnan(rounded)) return LLONG_MIN;
+            return rounded < 0 ? -(1ll << 62) : (1ll << 62);
+        }
+        return static_cast<int64_t>(rounded);
+    }
+
+    struct Face {
+        std::array<unsigned int, 3> index;
+        Vector3 normal;
+    };
 
     struct EdgeData {
+        uint64_t key;
         unsigned int index0;
         unsigned int index1;
         Vector3 normal;
+        bool open;
     };
 
+    uint64_t edgeKey(uint32_t from, uint32_t to) {
+
+        return static_cast<uint64_t>(from) << 32 | to;
+    }
+
 }// namespace
 
 
 EdgesGeometry::EdgesGeometry(const BufferGeometry& geometry, float thresholdAngle) {
 
-    const auto precisionPoints = 4;
-    const auto precision = std::pow(10, precisionPoints);
     const auto thresholdDot = std::cos(math::DEG2RAD * thresholdAngle);
 
     const auto indexAttr = geometry.getIndex();
     const auto positionAttr = geometry.getAttribute<float>("position");
     const auto indexCount = indexAttr ? indexAttr->count() : positionAttr->count();
+    const auto vertexCount = static_cast<size_t>(positionAttr->count());
+    const auto faceCount = static_cast<size_t>(indexCount / 3);
+
+    // Quantize every vertex once, in parallel, then weld: each vertex maps to
+    // the first vertex sharing its rounded position. Two corners are "the same
+    // point" exactly when they weld to the same id.
+    std::vector<std::array<int64_t, 3>> grid(vertexCount);
+    std::vector<uint64_t> gridHash(vertexCount);
+    parallelFor(0, vertexCount, 4096, [&](size_t lo, size_t hi) {
+        for (auto i = lo; i < hi; ++i) {
+            const auto v = static_cast<unsigned int>(i);
+            grid[i] = {quantize(positionAttr->getX(v)), quantize(positionAttr->getY(v)), quantize(positionAttr->getZ(v))};
+            gridHash[i] = utils::hashCombine(utils::hashCombine(utils::hashMix(grid[i][0]), grid[i][1]), grid[i][2]);
+        }
+    });
+
+    std::vector<uint32_t> weld(vertexCount);
+    utils::HashIndex vertexIndex(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        weld[i] = vertexIndex.findOrInsert(gridHash[i], static_cast<uint32_t>(i), [&](uint32_t other) {
+            return grid[other] == grid[i];
+        });
+    }
 
-    std::vector<unsigned int> indexArr{0, 0, 0};
-    std::vector vertKeys{'a', 'b', 'c'};
-    std::vector<std::string> hashes(3);
+    // Face normals don't depend on each other either.
+    std::vector<Face> faces(faceCount);
+    parallelFor(0, faceCount, 4096, [&](size_t lo, size_t hi) {
+        Vector3 a, b, c;
+        for (auto f = lo; f < hi; ++f) {
+            auto& face = faces[f];
+            for (unsigned j = 0; j < 3; j++) {
+                const auto i = static_cast<int>(f * 3 + j);
+                face.index[j] = indexAttr ? indexAttr->getX(i) : i;
+            }
+            positionAttr->setFromBufferAttribute(a, face.index[0]);
+            positionAttr->setFromBufferAttribute(b, face.index[1]);
+            positionAttr->setFromBufferAttribute(c, face.index[2]);
+            Triangle::getNormal(a, b, c, face.normal);
+        }
+    });
 
-    std::unordered_map<std::string, std::optional<EdgeData>> edgeData;
+    // The pairing itself is order dependent — which face claims an edge
+    // first decides the normal it is compared with — so it stays serial.
+    std::vector<EdgeData> edgeData;
+    utils::HashIndex edgeIndex(faceCount * 3 / 2);
     std::vector<float> vertices;
-    for (int i = 0; i < indexCount; i += 3) {
+    Vector3 v0, v1;
 
-        if (indexAttr) {
+    for (const auto& face : faces) {
 
-            indexArr[0] = indexAttr->getX(i);
-            indexArr[1] = indexAttr->getX(i + 1);
-            indexArr[2] = indexAttr->getX(i + 2);
-
-        } else {
-
-            indexArr[0] = i;
-            indexArr[1] = i + 1;
-            indexArr[2] = i + 2;
-        }
-
-        Vector3 a, b, c;
-        positionAttr->setFromBufferAttribute(a, indexArr[0]);
-        positionAttr->setFromBufferAttribute(b, indexArr[1]);
-        positionAttr->setFromBufferAttribute(c, indexArr[2]);
-        _triangle.set(a, b, c);
-        _triangle.getNormal(_normal);
-
-        // create hashes for the edge from the vertices
-        std::stringstream ss;
-        ss << std::round(a.x * precision) << "," << std::round(a.y * precision) << "," << std::round(a.z * precision);
-        hashes[0] = ss.str();
-        ss.str(std::string());
-        ss << std::round(b.x * precision) << "," << std::round(b.y * precision) << "," << std::round(b.z * precision);
-        hashes[1] = ss.str();
-        ss.str(std::string());
-        ss << std::round(c.x * precision) << "," << std::round(c.y * precision) << "," << std::round(c.z * precision);
-        hashes[2] = ss.str();
-        ss.str(std::string());
+        const std::array<uint32_t, 3> ids{weld[face.index[0]], weld[face.index[1]], weld[face.index[2]]};
 
         // skip degenerate triangles
-        if (hashes[0] == hashes[1] || hashes[1] == hashes[2] || hashes[2] == hashes[0]) {
+        if (ids[0] == ids[1] || ids[1] == ids[2] || ids[2] == ids[0]) {
 
             continue;
         }
@@ -86,54 +121,59 @@ EdgesGeometry::EdgesGeometry(const BufferGeometry& geometry, float thresholdAngl
 
             // get the first and next vertex making up the edge
             const auto jNext = (j + 1) % 3;
-            const auto vecHash0 = hashes[j];
-            const auto vecHash1 = hashes[jNext];
-            const auto v0 = _triangle[vertKeys[j]];
-            const auto v1 = _triangle[vertKeys[jNext]];
+            const auto hash = edgeKey(ids[j], ids[jNext]);
+            const auto reverseHash = edgeKey(ids[jNext], ids[j]);
 
-            ss << vecHash0 << '_' << vecHash1;
-            const auto hash = ss.str();
-            ss.str(std::string());
-            ss << vecHash1 << '_' << vecHash0;
-            const auto reverseHash = ss.str();
-            ss.str(std::string());
+            const auto reverse = edgeIndex.find(utils::hashMix(reverseHash), [&](uint32_t e) {
+                return edgeData[e].key == reverseHash;
+            });
 
-            if (edgeData.contains(reverseHash) && edgeData.at(reverseHash)) {
+            if (reverse != utils::HashIndex::npos && edgeData[reverse].open) {
 
                 // if we found a sibling edge add it into the vertex array if
                 // it meets the angle threshold and delete the edge from the map.
-                if (_normal.dot(edgeData[reverseHash]->normal) <= thresholdDot) {
+                if (face.normal.dot(edgeData[reverse].normal) <= thresholdDot) {
 
+                    positionAttr->setFromBufferAttribute(v0, face.index[j]);
+                    positionAttr->setFromBufferAttribute(v1, face.index[jNext]);
                     vertices.insert(vertices.end(), {v0.x, v0.y, v0.z});
                     vertices.insert(vertices.end(), {v1.x, v1.y, v1.z});
                 }
 
-                edgeData[reverseHash] = std::nullopt;
+                edgeData[reverse].open = false;
+
+            } else {
 
-            } else if (!(edgeData[hash])) {
+                const auto next = static_cast<uint32_t>(edgeData.size());
+                const auto e = edgeIndex.findOrInsert(utils::hashMix(hash), next, [&](uint32_t e) {
+                    return edgeData[e].key == hash;
+                });
 
-                // if we've already got an edge here then skip adding a new one
-                edgeData[hash] = {
+                // if we've already got an edge here then skip adding a new one;
+                // a closed one is reopened in place
+                if (e == next) {
 
-                        indexArr[j],
-                        indexArr[jNext],
-                        _normal,
+                    edgeData.push_back({hash, face.index[j], face.index[jNext], face.normal, true});
 
-                };
+                } else if (!edgeData[e].open) {
+
+                    edgeData[e] = {hash, face.index[j], face.index[jNext], face.normal, true};
+                }
             }
         }
     }
 
-    // iterate over all remaining, unmatched edges and add them to the vertex array
-    for (const auto& [key, data] : edgeData) {
+    // iterate over all remaining, unmatched edges and add them to the vertex
+    // array, in the order they were first seen
+    for (const auto& data : edgeData) {
 
-        if (data) {
+        if (data.open) {
 
-            positionAttr->setFromBufferAttribute(_v0, data->index0);
-            positionAttr->setFromBufferAttribute(_v1, data->index1);
+            positionAttr->setFromBufferAttribute(v0, data.index0);
+            positionAttr->setFromBufferAttribute(v1, data.index1);
 
-            vertices.insert(vertices.end(), {_v0.x, _v0.y, _v0.z});
-            vertices.insert(vertices.end(), {_v1.x, _v1.y, _v1.z});
+            vertices.insert(vertices.end(), {v0.x, v0.y, v0.z});
+            vertices.insert(vertices.end(), {v1.x, v1.y, v1.z});
         }
     }
 
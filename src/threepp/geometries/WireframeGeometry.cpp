@@ -1,8 +1,10 @@
 
 #include "threepp/geometries/WireframeGeometry.hpp"
 
-#include <unordered_map>
-#include <utility>
+#include "threepp/utils/HashIndex.hpp"
+#include "threepp/utils/Parallel.hpp"
+
+#include <algorithm>
 #include <vector>
 
 using namespace threepp;
@@ -13,13 +15,6 @@ WireframeGeometry::WireframeGeometry(const BufferGeometry& geometry) {
 
     std::vector<float> vertices;
 
-    // helper variables
-
-    std::pair<unsigned int, unsigned int> edge;
-    std::unordered_map<std::string, std::pair<int, int>> edges;
-
-    Vector3 vertex;
-
     if (geometry.hasIndex()) {
 
         // indexed BufferGeometry
@@ -32,7 +27,11 @@ WireframeGeometry::WireframeGeometry(const BufferGeometry& geometry) {
             groups = {GeometryGroup{0, indices->count(), 0}};
         }
 
-        // create a data structure that contains all eges without duplicates
+        // create a data structure that contains all eges without duplicates,
+        // an edge being its two indices packed smaller first
+
+        std::vector<uint64_t> edges;
+        utils::HashIndex edgeIndex(indices->count());
 
         for (const auto& group : groups) {
 
@@ -43,54 +42,57 @@ WireframeGeometry::WireframeGeometry(const BufferGeometry& geometry) {
 
                 for (int j = 0; j < 3; j++) {
 
-                    const auto edge1 = indices->getX(i + j);
-                    const auto edge2 = indices->getX(i + (j + 1) % 3);
-                    edge.first = std::min(edge1, edge2);// sorting prevents duplicates
-                    edge.second = std::max(edge1, edge2);
-
-                    std::string key = std::to_string(edge.first) + ',' + std::to_string(edge.second);
+                    const auto edge1 = static_cast<uint32_t>(indices->getX(i + j));
+                    const auto edge2 = static_cast<uint32_t>(indices->getX(i + (j + 1) % 3));
+                    // sorting prevents duplicates
+                    const auto key = static_cast<uint64_t>(std::min(edge1, edge2)) << 32 | std::max(edge1, edge2);
 
-                    if (!edges.contains(key)) {
-
-                        edges[key] = edge;
-                    }
+                    const auto next = static_cast<uint32_t>(edges.size());
+                    const auto e = edgeIndex.findOrInsert(utils::hashMix(key), next, [&](uint32_t e) {
+                        return edges[e] == key;
+                    });
+                    if (e == next) edges.emplace_back(key);
                 }
             }
         }
 
-        // generate vertices
-
-        for (const auto& [key, e] : edges) {
+        // generate vertices, in the order the edges were first seen
 
-            position->setFromBufferAttribute(vertex, e.first);
-            vertices.insert(vertices.begin(), {vertex.x, vertex.y, vertex.z});
-
-            position->setFromBufferAttribute(vertex, e.second);
-            vertices.insert(vertices.begin(), {vertex.x, vertex.y, vertex.z});
-        }
+        vertices.resize(edges.size() * 6);
+        parallelFor(0, edges.size(), 4096, [&](size_t lo, size_t hi) {
+            for (auto e = lo; e < hi; ++e) {
+                auto* out = vertices.data() + e * 6;
+                for (const auto index : {static_cast<unsigned int>(edges[e] >> 32), static_cast<unsigned int>(edges[e])}) {
+                    *out++ = position->getX(index);
+                    *out++ = position->getY(index);
+                    *out++ = position->getZ(index);
+                }
+            }
+        });
 
     } else {
 
         // non-indexed BufferGeometry
 
         auto position = geometry.getAttribute<float>("position");
-
-        for (int i = 0, l = (position->count() / 3); i < l; i++) {
-
-            for (int j = 0; j < 3; j++) {
-
-                // three edges per triangle, an edge is represented as (index1, index2)
-                // e.g. the first triangle has the following edges: (0,1),(1,2),(2,0)
-
-                const auto index1 = 3 * i + j;
-                position->setFromBufferAttribute(vertex, index1);
-                vertices.insert(vertices.begin(), {vertex.x, vertex.y, vertex.z});
-
-                const auto index2 = 3 * i + ((j + 1) % 3);
-                position->setFromBufferAttribute(vertex, index2);
-                vertices.insert(vertices.begin(), {vertex.x, vertex.y, vertex.z});
+        const auto triangles = static_cast<size_t>(position->count() / 3);
+
+        // three edges per triangle, an edge is represented as (index1, index2)
+        // e.g. the first triangle has the following edges: (0,1),(1,2),(2,0)
+
+        vertices.resize(triangles * 18);
+        parallelFor(0, triangles, 4096, [&](size_t lo, size_t hi) {
+            for (auto i = lo; i < hi; ++i) {
+                auto* out = vertices.data() + i * 18;
+                for (unsigned j = 0; j < 3; j++) {
+                    for (const auto index : {3 * i + j, 3 * i + (j + 1) % 3}) {
+                        *out++ = position->getX(static_cast<unsigned int>(index));
+                        *out++ = position->getY(static_cast<unsigned int>(index));
+                        *out++ = position->getZ(static_cast<unsigned int>(index));
+                    }
+                }
             }
-        }
+        });
     }
 
     // build geometry
@@ -1,37 +1,14 @@
 
 #include "threepp/loaders/AsyncGroup.hpp"
 
+#include "threepp/loaders/LoaderService.hpp"
+
 #include <atomic>
 #include <mutex>
-#include <thread>
 #include <vector>
 
-#ifdef __EMSCRIPTEN__
-#include <emscripten.h>
-#endif
-
 using namespace threepp;
 
-namespace {
-
-    struct LoadContext {
-        std::weak_ptr<AsyncGroup> weak;
-        std::function<std::shared_ptr<Group>()> fn;
-    };
-
-    void executeLoad(LoadContext* ctx) {
-        std::shared_ptr<Group> result;
-        try {
-            result = ctx->fn();
-        } catch (...) {}
-
-        if (auto ag = ctx->weak.lock()) {
-            ag->deliverResult(std::move(result));
-        }
-    }
-
-}// namespace
-
 struct AsyncGroup::Impl {
     std::mutex mutex;
     std::vector<std::shared_ptr<Object3D>> pendingChildren;
@@ -108,24 +85,5 @@ std::shared_ptr<Object3D> AsyncGroup::createDefault() {
 }
 
 std::shared_ptr<AsyncGroup> threepp::loadAsync(std::function<std::shared_ptr<Group>()> loadFn) {
-    auto group = AsyncGroup::create();
-    group->setLoading(true);
-    auto* ctx = new LoadContext{group, std::move(loadFn)};
-
-#ifdef __EMSCRIPTEN__
-    emscripten_async_call(
-            [](void* arg) {
-                auto* c = static_cast<LoadContext*>(arg);
-                executeLoad(c);
-                delete c;
-            },
-            ctx, 0);
-#else
-    std::thread([ctx]() {
-        executeLoad(ctx);
-        delete ctx;
-    }).detach();
-#endif
-
-    return group;
+    return LoaderService::global().load(std::move(loadFn));
 }
@@ -4,6 +4,9 @@
 #include "threepp/loaders/HdrTexture.hpp"
 #include "threepp/loaders/exr/PizDecode.hpp"
 
+#include "threepp/extras/DataUtils.hpp"
+#include "threepp/utils/Parallel.hpp"
+
 // stb_image.h is already compiled via ImageLoader.cpp — declared here only for
 // stbi_zlib_decode_buffer. EXR's ZIP/ZIPS chunks are ordinary zlib streams, so
 // the inflate that PNG decoding already brings into the build is the whole of
@@ -11,12 +14,14 @@
 #include "stb_image.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 using namespace threepp;
@@ -336,13 +341,167 @@ namespace {
         return written == out.size();
     }
 
+    // A chunk located by the serial pass over the offset table, and the
+    // scanline its block starts on.
+    struct Chunk {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        int64_t firstRow = -1;// -1: no chunk in the file claimed this block
+    };
+
+    // Everything a worker needs to turn one chunk into output rows.
+    struct BlockLayout {
+        Compression compression{};
+        int64_t width{};
+        int64_t height{};
+        int linesPerBlock{};
+        size_t bytesPerLine{};
+        bool flipY{};
+        std::vector<PixelType> types;
+        std::vector<int> component;
+        std::vector<size_t> channelOffset;
+        std::vector<int> shortsPerSample;
+    };
+
+    // Decompress one chunk into `block`, sized for the lines it covers.
+    bool inflateChunk(const BlockLayout& l, const Chunk& c, size_t linesInBlock,
+                      std::vector<unsigned char>& block, std::vector<unsigned char>& scratch,
+                      std::string& error) {
+
+        const size_t uncompressedSize = linesInBlock * l.bytesPerLine;
+        block.assign(uncompressedSize, 0);
+
+        // A codec that failed to shrink a chunk stores it raw; the reader
+        // tells the two apart by size alone, exactly as OpenEXR does. Getting
+        // this wrong turns every noisy or tiny image into garbage.
+        if (l.compression == Compression::None || c.size >= uncompressedSize) {
+            if (c.size < uncompressedSize) {
+                error = "uncompressed chunk is short";
+                return false;
+            }
+            std::memcpy(block.data(), c.data, uncompressedSize);
+        } else if (l.compression == Compression::Rle) {
+            if (!rleUncompress(c.data, c.size, block)) {
+                error = "corrupt RLE chunk";
+                return false;
+            }
+            reconstruct(block, scratch);
+        } else if (l.compression == Compression::Piz) {
+            // PIZ carries its own transform end to end — no predictor, no
+            // byte de-interleave; those belong to ZIP/RLE only.
+            if (!detail::pizDecode(c.data, c.size, l.shortsPerSample,
+                                   static_cast<int>(l.width), static_cast<int>(linesInBlock),
+                                   block.data(), uncompressedSize)) {
+                error = "corrupt PIZ chunk";
+                return false;
+            }
+        } else {
+            const int written = stbi_zlib_decode_buffer(
+                    reinterpret_cast<char*>(block.data()), static_cast<int>(uncompressedSize),
+                    reinterpret_cast<const char*>(c.data), static_cast<int>(c.size));
+            if (written != static_cast<int>(uncompressedSize)) {
+                error = "corrupt ZIP chunk (inflate produced " + std::to_string(written) +
+                        " of " + std::to_string(uncompressedSize) + " bytes)";
+                return false;
+            }
+            reconstruct(block, scratch);
+        }
+        return true;
+    }
+
+    template<class T>
+    T convertSample(const unsigned char* p, PixelType t) {
+
+        if constexpr (std::is_same_v<T, float>) {
+            return sampleToFloat(p, t);
+        } else {
+            // HALF channels — nearly every file — are copied bit for bit.
+            if (t == PixelType::Half) {
+                uint16_t h;
+                std::memcpy(&h, p, sizeof h);
+                return h;
+            }
+            return DataUtils::toHalfFloat(sampleToFloat(p, t));
+        }
+    }
+
+    // Decode every chunk into `out` (RGBA, prefilled). Blocks cover disjoint
+    // rows, so the workers write the final image directly, each with its own
+    // decompression buffers. The first failure is reported; the pieces
+    // that have not started by then skip their work.
+    template<class T>
+    bool decodeChunks(const BlockLayout& l, const std::vector<Chunk>& chunks, std::vector<T>& out) {
+
+        std::atomic<bool> failed{false};
+        std::string failure;
+
+        // ZIPS/RLE blocks are a single scanline; hand them out a few dozen
+        // lines at a time so the scheduling does not outweigh the inflate.
+        const size_t grain = std::max<size_t>(1, 64 / static_cast<size_t>(l.linesPerBlock));
+
+        parallelFor(0, chunks.size(), grain, [&](size_t lo, size_t hi) {
+            std::vector<unsigned char> block;
+            std::vector<unsigned char> scratch;
+            std::string error;
+
+            for (size_t b = lo; b < hi; ++b) {
+
+                if (failed.load(std::memory_order_relaxed)) return;
+
+                const Chunk& c = chunks[b];
+                if (c.firstRow < 0) continue;
+
+                const int64_t linesInBlock = std::min<int64_t>(l.linesPerBlock, l.height - c.firstRow);
+                if (!inflateChunk(l, c, static_cast<size_t>(linesInBlock), block, scratch, error)) {
+                    if (!failed.exchange(true)) failure = std::move(error);
+                    return;
+                }
+
+                for (int64_t line = 0; line < linesInBlock; ++line) {
+
+                    const int64_t fileRow = c.firstRow + line;
+                    const int64_t outRow = l.flipY ? (l.height - 1 - fileRow) : fileRow;
+                    T* dst = out.data() + static_cast<size_t>(outRow * l.width) * 4;
+                    const unsigned char* linePtr = block.data() + static_cast<size_t>(line) * l.bytesPerLine;
+
+                    for (size_t ci = 0; ci < l.types.size(); ++ci) {
+
+                        const int comp = l.component[ci];
+                        if (comp < 0) continue;
+
+                        const PixelType type = l.types[ci];
+                        const size_t stride = bytesPerSample(type);
+                        const unsigned char* src = linePtr + l.channelOffset[ci];
+
+                        for (int64_t x = 0; x < l.width; ++x) {
+                            const T v = convertSample<T>(src + static_cast<size_t>(x) * stride, type);
+                            if (comp == 4) {
+                                dst[x * 4 + 0] = v;
+                                dst[x * 4 + 1] = v;
+                                dst[x * 4 + 2] = v;
+                            } else {
+                                dst[x * 4 + comp] = v;
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        if (failed) {
+            std::cerr << "[EXRLoader] " << failure << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     struct DecodedExr {
-        std::vector<float> rgba;
+        ImageData rgba;// float, or half bits with EXRLoader::halfFloat
         unsigned int width{};
         unsigned int height{};
     };
 
-    std::optional<DecodedExr> decode(const unsigned char* bytes, size_t size, bool flipY) {
+    std::optional<DecodedExr> decode(const unsigned char* bytes, size_t size, bool flipY, bool halfFloat) {
 
         ByteReader r{bytes, size};
 
@@ -446,20 +605,13 @@ namespace {
             return std::nullopt;
         }
 
-        DecodedExr result;
-        result.width = static_cast<unsigned int>(width);
-        result.height = static_cast<unsigned int>(height);
-        result.rgba.assign(static_cast<size_t>(width * height) * 4, 0.f);
-        // Prefilled so a file without an A channel — the usual case for a sky —
-        // comes out opaque rather than fully transparent.
-        for (size_t i = 3; i < result.rgba.size(); i += 4) result.rgba[i] = 1.f;
-
-        std::vector<unsigned char> block;
-        std::vector<unsigned char> scratch;
+        // Walk the offset table serially — it is a few bytes per chunk — and
+        // file each chunk under the block its scanline names. A file that
+        // lists a block twice keeps the later one, as decoding them in order
+        // did; one that leaves a block out leaves its rows at the fill value.
+        std::vector<Chunk> chunks(static_cast<size_t>(numBlocks));
+        for (const uint64_t offset : offsets) {
 
-        for (int64_t b = 0; b < numBlocks; ++b) {
-
-            const uint64_t offset = offsets[static_cast<size_t>(b)];
             if (offset >= size) {
                 std::cerr << "[EXRLoader] chunk offset past end of file" << std::endl;
                 return std::nullopt;
@@ -482,77 +634,37 @@ namespace {
             }
 
             const int64_t firstRow = y - h.yMin;
-            const int64_t linesInBlock = std::min<int64_t>(linesPerBlock, height - firstRow);
-            const size_t uncompressedSize = static_cast<size_t>(linesInBlock) * bytesPerLine;
-
-            const unsigned char* chunk = bytes + cr.pos;
-            block.assign(uncompressedSize, 0);
-
-            // A codec that failed to shrink a chunk stores it raw; the reader
-            // tells the two apart by size alone, exactly as OpenEXR does. Getting
-            // this wrong turns every noisy or tiny image into garbage.
-            if (h.compression == Compression::None || static_cast<size_t>(dataSize) >= uncompressedSize) {
-                if (static_cast<size_t>(dataSize) < uncompressedSize) {
-                    std::cerr << "[EXRLoader] uncompressed chunk is short" << std::endl;
-                    return std::nullopt;
-                }
-                std::memcpy(block.data(), chunk, uncompressedSize);
-            } else if (h.compression == Compression::Rle) {
-                if (!rleUncompress(chunk, static_cast<size_t>(dataSize), block)) {
-                    std::cerr << "[EXRLoader] corrupt RLE chunk" << std::endl;
-                    return std::nullopt;
-                }
-                reconstruct(block, scratch);
-            } else if (h.compression == Compression::Piz) {
-                // PIZ carries its own transform end to end — no predictor, no
-                // byte de-interleave; those belong to ZIP/RLE only.
-                if (!detail::pizDecode(chunk, static_cast<size_t>(dataSize), shortsPerSample,
-                                       static_cast<int>(width), static_cast<int>(linesInBlock),
-                                       block.data(), uncompressedSize)) {
-                    std::cerr << "[EXRLoader] corrupt PIZ chunk" << std::endl;
-                    return std::nullopt;
-                }
-            } else {
-                const int written = stbi_zlib_decode_buffer(
-                        reinterpret_cast<char*>(block.data()), static_cast<int>(uncompressedSize),
-                        reinterpret_cast<const char*>(chunk), dataSize);
-                if (written != static_cast<int>(uncompressedSize)) {
-                    std::cerr << "[EXRLoader] corrupt ZIP chunk (inflate produced " << written
-                              << " of " << uncompressedSize << " bytes)" << std::endl;
-                    return std::nullopt;
-                }
-                reconstruct(block, scratch);
-            }
-
-            for (int64_t line = 0; line < linesInBlock; ++line) {
-
-                const int64_t fileRow = firstRow + line;
-                const int64_t outRow = flipY ? (height - 1 - fileRow) : fileRow;
-                float* dst = result.rgba.data() + static_cast<size_t>(outRow * width) * 4;
-                const unsigned char* linePtr = block.data() + static_cast<size_t>(line) * bytesPerLine;
-
-                for (size_t ci = 0; ci < h.channels.size(); ++ci) {
+            chunks[static_cast<size_t>(firstRow / linesPerBlock)] = {bytes + cr.pos, static_cast<size_t>(dataSize), firstRow};
+        }
 
-                    const int comp = component[ci];
-                    if (comp < 0) continue;
+        BlockLayout layout;
+        layout.compression = h.compression;
+        layout.width = width;
+        layout.height = height;
+        layout.linesPerBlock = linesPerBlock;
+        layout.bytesPerLine = bytesPerLine;
+        layout.flipY = flipY;
+        layout.component = std::move(component);
+        layout.channelOffset = std::move(channelOffset);
+        layout.shortsPerSample = std::move(shortsPerSample);
+        for (const auto& c : h.channels) layout.types.push_back(c.type);
 
-                    const PixelType type = h.channels[ci].type;
-                    const size_t stride = bytesPerSample(type);
-                    const unsigned char* src = linePtr + channelOffset[ci];
+        DecodedExr result;
+        result.width = static_cast<unsigned int>(width);
+        result.height = static_cast<unsigned int>(height);
 
-                    for (int64_t x = 0; x < width; ++x) {
-                        const float v = sampleToFloat(src + static_cast<size_t>(x) * stride, type);
-                        if (comp == 4) {
-                            dst[x * 4 + 0] = v;
-                            dst[x * 4 + 1] = v;
-                            dst[x * 4 + 2] = v;
-                        } else {
-                            dst[x * 4 + comp] = v;
-                        }
-                    }
-                }
-            }
-        }
+        // Prefilled so a file without an A channel — the usual case for a sky —
+        // comes out opaque rather than fully transparent.
+        const auto decodeAs = [&](auto one) {
+            using T = decltype(one);
+            std::vector<T> rgba(static_cast<size_t>(width * height) * 4, T{});
+            for (size_t i = 3; i < rgba.size(); i += 4) rgba[i] = one;
+            if (!decodeChunks(layout, chunks, rgba)) return false;
+            result.rgba = std::move(rgba);
+            return true;
+        };
+        const bool ok = halfFloat ? decodeAs(DataUtils::toHalfFloat(1.f)) : decodeAs(1.f);
+        if (!ok) return std::nullopt;
 
         return result;
     }
@@ -574,7 +686,7 @@ std::shared_ptr<Texture> EXRLoader::load(const std::filesystem::path& path, bool
     std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)),
                                      std::istreambuf_iterator<char>());
 
-    auto decoded = decode(bytes.data(), bytes.size(), flipY);
+    auto decoded = decode(bytes.data(), bytes.size(), flipY, halfFloat);
     if (!decoded) {
         std::cerr << "[EXRLoader] Failed to load '" << path.string() << "'" << std::endl;
         return nullptr;
@@ -587,7 +699,7 @@ std::shared_ptr<Texture> EXRLoader::load(const std::filesystem::path& path, bool
 std::shared_ptr<Texture> EXRLoader::loadFromMemory(const std::vector<unsigned char>& data,
                                                    const std::string& name, bool flipY) {
 
-    auto decoded = decode(data.data(), data.size(), flipY);
+    auto decoded = decode(data.data(), data.size(), flipY, halfFloat);
     if (!decoded) return nullptr;
 
     return detail::makeHdrTexture(std::move(decoded->rgba), decoded->width, decoded->height, name);
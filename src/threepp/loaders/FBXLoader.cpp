@@ -14,6 +14,7 @@
 #include "threepp/math/Matrix4.hpp"
 #include "threepp/objects/Group.hpp"
 #include "threepp/objects/Mesh.hpp"
+#include "threepp/utils/Parallel.hpp"
 
 #include "ofbx.h"
 
@@ -25,7 +26,6 @@
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -249,22 +249,18 @@ namespace threepp {
 
             if (jobs.empty()) return;
 
-            // Bounded pool: cap concurrent decodes so peak transient memory (a 4K
-            // RGBA decode is ~64 MB) stays sane even when two FBX files load at
-            // once (each runs its own pool). 8 is plenty — decode saturates memory
-            // bandwidth well before then. Atomic index = simple load balancing.
-            const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
-            const unsigned nThreads = std::min({hw, 8u, static_cast<unsigned>(jobs.size())});
+            // Bounded fan-out: cap concurrent decodes so peak transient memory (a
+            // 4K RGBA decode is ~64 MB) stays sane even when two FBX files load
+            // at once. 8 is plenty — decode saturates memory bandwidth well
+            // before then. At most 8 lanes run on the shared pool; within them
+            // an atomic index = simple load balancing.
+            const size_t lanes = std::min<size_t>(8, jobs.size());
             std::atomic<size_t> next{0};
-            auto worker = [&]() {
+            parallelFor(0, lanes, 1, [&](size_t, size_t) {
                 for (size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
                     texLoader.load(jobs[i].path, jobs[i].cs);
                 }
-            };
-            std::vector<std::thread> pool;
-            pool.reserve(nThreads);
-            for (unsigned t = 0; t < nThreads; ++t) pool.emplace_back(worker);
-            for (auto& th : pool) th.join();
+            });
         }
 
         // Returns true when the material name or diffuse texture name suggests glass.
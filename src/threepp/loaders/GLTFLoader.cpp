@@ -4,6 +4,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstring>
@@ -12,6 +13,7 @@
 #include <limits>
 #include <map>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <tuple>
 #include <unordered_map>
@@ -36,11 +38,17 @@
 #include <threepp/objects/SkinnedMesh.hpp>
 
 #include "threepp/utils/Base64.hpp"
+#include "threepp/utils/MappedFile.hpp"
+#include "threepp/utils/Parallel.hpp"
 
 #include <unordered_set>
 
 #include "meshoptimizer.h"
 
+#ifdef THREEPP_WITH_DRACO
+#include "draco/compression/decode.h"
+#endif
+
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
@@ -78,24 +86,6 @@ namespace threepp {
             return out;
         }
 
-        // Read an already-open binary stream into a byte vector in one shot,
-        // sizing the buffer from the file length instead of growing it a
-        // character at a time (as std::istreambuf_iterator does). Falls back to
-        // the iterator form if the size can't be determined (e.g. a pipe).
-        std::vector<uint8_t> readAllBytes(std::ifstream& f, const fs::path& p) {
-            std::error_code ec;
-            auto sz = fs::file_size(p, ec);
-            std::vector<uint8_t> out;
-            if (!ec) {
-                out.resize(static_cast<size_t>(sz));
-                f.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(sz));
-                out.resize(static_cast<size_t>(f.gcount()));
-            } else {
-                out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
-            }
-            return out;
-        }
-
         // ===========================================================================
         //  glTF constants
         // ===========================================================================
@@ -210,13 +200,117 @@ namespace threepp {
             return 0;
         }
 
+        // One KHR_draco_mesh_compression primitive, as a job for decodeDraco:
+        // its compressed bytes, and every accessor it stands in for with the
+        // Draco attribute behind it (-1 for the indices). Decoding fills in
+        // the bytes, tightly packed in `componentType`, which is the
+        // accessor's own for attributes and UNSIGNED_INT for the indices.
+        struct DracoPrimitive {
+            struct Target {
+                int accessor;
+                int uniqueId;
+                int componentType;
+                int numComponents;
+                std::vector<uint8_t> bytes;
+                size_t count = 0;
+            };
+            std::span<const uint8_t> compressed;
+            std::vector<Target> targets;
+        };
+
+#ifdef THREEPP_WITH_DRACO
+        constexpr bool dracoAvailable = true;
+#else
+        constexpr bool dracoAvailable = false;
+#endif
+
+#ifdef THREEPP_WITH_DRACO
+        template<class T>
+        void convertDracoAttribute(const draco::PointAttribute& attr, uint32_t numPoints, DracoPrimitive::Target& target) {
+            const auto nc = static_cast<size_t>(target.numComponents);
+            if (nc == 0 || nc > 16)
+                throw std::runtime_error("KHR_draco_mesh_compression: bad accessor type (accessor " + std::to_string(target.accessor) + ")");
+
+            target.count = numPoints;
+            target.bytes.resize(numPoints * nc * sizeof(T));
+            std::array<T, 16> value{};
+            for (uint32_t i = 0; i < numPoints; ++i) {
+                if (!attr.ConvertValue<T>(attr.mapped_index(draco::PointIndex(i)), static_cast<int8_t>(nc), value.data()))
+                    throw std::runtime_error("KHR_draco_mesh_compression: attribute " + std::to_string(target.uniqueId) +
+                                             " does not convert to accessor " + std::to_string(target.accessor));
+                std::memcpy(target.bytes.data() + i * nc * sizeof(T), value.data(), nc * sizeof(T));
+            }
+        }
+#endif
+
+        // Decompress one Draco primitive. Touches nothing but `primitive`, so
+        // any number run at once.
+        void decodeDraco(DracoPrimitive& primitive) {
+#ifdef THREEPP_WITH_DRACO
+            draco::DecoderBuffer buffer;
+            buffer.Init(reinterpret_cast<const char*>(primitive.compressed.data()), primitive.compressed.size());
+            draco::Decoder decoder;
+            auto decoded = decoder.DecodeMeshFromBuffer(&buffer);
+            if (!decoded.ok())
+                throw std::runtime_error(std::string("KHR_draco_mesh_compression: ") + decoded.status().error_msg());
+            const std::unique_ptr<draco::Mesh> mesh = std::move(decoded).value();
+
+            for (auto& target : primitive.targets) {
+                if (target.uniqueId < 0) {
+                    // Draco may renumber the points, so the accessor's
+                    // componentType need not be wide enough for the result.
+                    target.count = static_cast<size_t>(mesh->num_faces()) * 3;
+                    target.bytes.resize(target.count * sizeof(uint32_t));
+                    for (uint32_t f = 0; f < mesh->num_faces(); ++f) {
+                        const auto& face = mesh->face(draco::FaceIndex(f));
+                        for (int k = 0; k < 3; ++k) {
+                            const uint32_t v = face[k].value();
+                            std::memcpy(target.bytes.data() + (f * 3 + k) * sizeof(uint32_t), &v, sizeof(uint32_t));
+                        }
+                    }
+                    continue;
+                }
+
+                const auto* attr = mesh->GetAttributeByUniqueId(static_cast<uint32_t>(target.uniqueId));
+                if (!attr)
+                    throw std::runtime_error("KHR_draco_mesh_compression: no attribute " + std::to_string(target.uniqueId));
+
+                const auto numPoints = mesh->num_points();
+                switch (target.componentType) {
+                    case COMP_FLOAT: convertDracoAttribute<float>(*attr, numPoints, target); break;
+                    case COMP_BYTE: convertDracoAttribute<int8_t>(*attr, numPoints, target); break;
+                    case COMP_UNSIGNED_BYTE: convertDracoAttribute<uint8_t>(*attr, numPoints, target); break;
+                    case COMP_SHORT: convertDracoAttribute<int16_t>(*attr, numPoints, target); break;
+                    case COMP_UNSIGNED_SHORT: convertDracoAttribute<uint16_t>(*attr, numPoints, target); break;
+                    case COMP_UNSIGNED_INT: convertDracoAttribute<uint32_t>(*attr, numPoints, target); break;
+                    default:
+                        throw std::runtime_error("KHR_draco_mesh_compression: bad componentType (accessor " +
+                                                 std::to_string(target.accessor) + ")");
+                }
+            }
+#else
+            (void) primitive;
+            throw std::runtime_error("KHR_draco_mesh_compression: threepp was built without Draco (THREEPP_WITH_DRACO)");
+#endif
+        }
+
         // ===========================================================================
         //  Parser state
         // ===========================================================================
         struct GLTFParser {
             json gltf;
-            std::vector<std::vector<uint8_t>> buffers;
+            // Buffer bytes by index, resolved on first use: a view of the BIN
+            // chunk of the .glb, of a mapped .bin, of bytes the resolver
+            // handed over, or of a decoded data: URI in ownedBuffers. Nothing
+            // is copied until an accessor is decoded out of it.
+            std::vector<std::span<const uint8_t>> buffers;
+            std::vector<std::vector<uint8_t>> ownedBuffers;
+            std::vector<std::unique_ptr<utils::MappedFile>> mappedFiles;
             fs::path basePath;
+            // Set when loading from memory: external URIs go through it, and
+            // there is no directory to look in.
+            GLTFLoader::Resolver resolver;
+            bool fromMemory = false;
             bool preserveNarrowAttributes = true;// mirrors GLTFLoader's flag
 
             // Cache to avoid duplicate GPU uploads.
@@ -276,15 +370,80 @@ namespace threepp {
             // meshIdx -> primIdx -> list of variant mappings
             std::unordered_map<int, std::unordered_map<int, std::vector<PrimVariantMapping>>> primVariantData;
 
-            // Cache of decoded EXT_meshopt_compression bufferViews (keyed by bufferView index)
-            std::unordered_map<int, std::vector<uint8_t>> meshoptCache;
+            // Images decoded ahead of scene construction (see decodeImages),
+            // keyed by image index. `uses` counts the textures that have yet
+            // to take one: the last takes the pixels, the others a copy.
+            struct DecodedImage {
+                std::optional<Image> image;
+                std::vector<uint8_t> encoded;// embedded bytes, for Texture::encodedSource
+                bool embedded = false;
+                int uses = 0;
+            };
+            std::unordered_map<int, DecodedImage> decodedImages;
+            unsigned maxImagesInFlight = 0;// mirrors GLTFLoader's setting
+
+            // How many times each accessor is read while the result is built
+            // (see countAccessorUses). Decoded data below is dropped after
+            // its last read instead of living until the load ends.
+            std::unordered_map<int, int> accessorUses;
+            std::unordered_map<int, int> bufferViewUses;// the same, summed per bufferView
+
+            // Decoded EXT_meshopt_compression bufferViews (keyed by bufferView
+            // index), with the reads of their accessors still to come.
+            struct MeshoptView {
+                std::vector<uint8_t> bytes;
+                int uses = 0;
+            };
+            std::unordered_map<int, MeshoptView> meshoptCache;
+
+            // The accessors of KHR_draco_mesh_compression primitives, decoded
+            // (keyed by accessor index); getAccessor reads them in place of a
+            // bufferView.
+            struct DracoAccessor {
+                std::vector<uint8_t> bytes;
+                size_t count = 0;
+                int componentType = 0;
+                int uses = 0;
+            };
+            std::unordered_map<int, DracoAccessor> dracoAccessors;
+            // Draco primitives in document order, decoded a batch at a time
+            // (see ensureDraco); dracoNext is how far the batches have got.
+            std::vector<const json*> dracoQueue;
+            std::unordered_set<const json*> dracoStarted;
+            size_t dracoNext = 0;
+
+            // What was decoded along the way, for GLTFLoader::LoadStats.
+            size_t meshoptViewsDecoded = 0;
+            size_t dracoPrimitivesDecoded = 0;
 
             // -----------------------------------------------------------------------
             //  Buffer/accessor helpers
             // -----------------------------------------------------------------------
 
-            const std::vector<uint8_t>& resolveBuffer(int idx) {
-                if (idx < static_cast<int>(buffers.size()) && !buffers[idx].empty())
+            // The bytes behind a URI that is not a data: URI — the resolver's
+            // when loading from memory, otherwise the file next to the model,
+            // mapped. Valid for the parser's lifetime.
+            std::span<const uint8_t> external(const std::string& uri, const std::string& what) {
+                const auto name = percentDecode(uri);
+                if (fromMemory) {
+                    const auto bytes = resolver ? resolver(name) : std::nullopt;
+                    if (!bytes) throw std::runtime_error("Cannot resolve " + what + ": " + name);
+                    return {reinterpret_cast<const uint8_t*>(bytes->data()), bytes->size()};
+                }
+
+                const fs::path p = basePath / name;
+                try {
+                    const auto& file = mappedFiles.emplace_back(std::make_unique<utils::MappedFile>(p));
+                    return {file->data(), static_cast<size_t>(file->size())};
+                } catch (const std::exception&) {
+                    throw std::runtime_error("Cannot open " + what + ": " + p.string());
+                }
+            }
+
+            std::span<const uint8_t> resolveBuffer(int idx) {
+                if (idx < 0 || idx >= static_cast<int>(buffers.size()))
+                    throw std::runtime_error("Buffer " + std::to_string(idx) + " out of range");
+                if (!buffers[idx].empty())
                     return buffers[idx];
 
                 const auto& bufDef = gltf["buffers"][idx];
@@ -294,12 +453,9 @@ namespace threepp {
                 if (uri.rfind("data:", 0) == 0) {
                     // data URI — find the comma
                     auto comma = uri.find(',');
-                    buffers[idx] = base64Decode(uri.substr(comma + 1));
+                    buffers[idx] = ownedBuffers.emplace_back(base64Decode(uri.substr(comma + 1)));
                 } else {
-                    fs::path p = basePath / percentDecode(uri);
-                    std::ifstream f(p, std::ios::binary);
-                    if (!f) throw std::runtime_error("Cannot open buffer file: " + p.string());
-                    buffers[idx] = readAllBytes(f, p);
+                    buffers[idx] = external(uri, "buffer file");
                 }
                 return buffers[idx];
             }
@@ -332,7 +488,7 @@ namespace threepp {
             // Decode a meshopt-compressed bufferView on first access and cache it.
             const std::vector<uint8_t>& decodeMeshoptBV(int bvIdx) {
                 auto it = meshoptCache.find(bvIdx);
-                if (it != meshoptCache.end()) return it->second;
+                if (it != meshoptCache.end()) return it->second.bytes;
 
                 const auto& ext = *meshoptExtension(gltf["bufferViews"][bvIdx]);
                 int bufIdx        = ext["buffer"].get<int>();
@@ -349,7 +505,11 @@ namespace threepp {
                                              std::to_string(bvIdx) + ")");
                 const uint8_t* src = compressed.data() + byteOffset;
 
-                auto& decoded = meshoptCache[bvIdx];
+                auto& view = meshoptCache[bvIdx];
+                ++meshoptViewsDecoded;
+                const auto uses = bufferViewUses.find(bvIdx);
+                view.uses = uses != bufferViewUses.end() ? uses->second : 1;
+                auto& decoded = view.bytes;
                 decoded.resize(count * byteStride);
 
                 int rc = 0;
@@ -377,6 +537,187 @@ namespace threepp {
                 return decoded;
             }
 
+            // A read of this accessor is complete: the decoded data behind it
+            // goes once nothing else will read it.
+            void consumed(int accessorIdx) {
+                if (auto it = dracoAccessors.find(accessorIdx); it != dracoAccessors.end() && --it->second.uses <= 0)
+                    dracoAccessors.erase(it);
+
+                const auto& acc = gltf["accessors"][accessorIdx];
+                if (auto it = meshoptCache.find(acc.value("bufferView", -1)); it != meshoptCache.end() && --it->second.uses <= 0)
+                    meshoptCache.erase(it);
+            }
+
+            static const json* dracoExtension(const json& prim) {
+                auto ext = prim.find("extensions");
+                if (ext == prim.end()) return nullptr;
+                if (auto e = ext->find("KHR_draco_mesh_compression"); e != ext->end()) return &*e;
+                return nullptr;
+            }
+
+            bool extensionRequired(const std::string& name) const {
+                const auto required = gltf.find("extensionsRequired");
+                if (required == gltf.end() || !required->is_array()) return false;
+                return std::find(required->begin(), required->end(), name) != required->end();
+            }
+
+            // Count the reads ahead: one per primitive for the accessors it
+            // references (geometry is built once per primitive), one per node
+            // for its instancing attributes, one per skin, and one per
+            // distinct animation accessor (loadAnimations reads each once).
+            // A wrong count costs memory or a second decode, never a wrong
+            // result.
+            void countAccessorUses() {
+                auto use = [&](const json& ref) {
+                    if (ref.is_number_integer()) ++accessorUses[ref.get<int>()];
+                };
+                auto useAll = [&](const json& refs) {
+                    for (const auto& ref : refs.items()) use(ref.value());
+                };
+
+                if (gltf.contains("meshes")) {
+                    for (const auto& mesh : gltf["meshes"]) {
+                        if (!mesh.contains("primitives")) continue;
+                        for (const auto& prim : mesh["primitives"]) {
+                            if (prim.contains("attributes")) useAll(prim["attributes"]);
+                            if (prim.contains("indices")) use(prim["indices"]);
+                            if (prim.contains("targets")) {
+                                for (const auto& target : prim["targets"]) useAll(target);
+                            }
+                            if (dracoAvailable && dracoExtension(prim) && prim.value("mode", 4) == 4) dracoQueue.push_back(&prim);
+                        }
+                    }
+                }
+                if (gltf.contains("skins")) {
+                    for (const auto& skin : gltf["skins"]) {
+                        if (skin.contains("inverseBindMatrices")) use(skin["inverseBindMatrices"]);
+                    }
+                }
+                if (gltf.contains("nodes")) {
+                    for (const auto& node : gltf["nodes"]) {
+                        const auto ext = node.find("extensions");
+                        if (ext == node.end()) continue;
+                        const auto inst = ext->find("EXT_mesh_gpu_instancing");
+                        if (inst != ext->end() && inst->contains("attributes")) useAll((*inst)["attributes"]);
+                    }
+                }
+                if (gltf.contains("animations")) {
+                    std::set<int> distinct;
+                    for (const auto& anim : gltf["animations"]) {
+                        if (!anim.contains("samplers")) continue;
+                        for (const auto& sampler : anim["samplers"]) {
+                            for (const char* key : {"input", "output"}) {
+                                if (sampler.contains(key) && sampler[key].is_number_integer()) distinct.insert(sampler[key].get<int>());
+                            }
+                        }
+                    }
+                    for (int accIdx : distinct) ++accessorUses[accIdx];
+                }
+
+                if (!gltf.contains("accessors")) return;
+                const auto& accessors = gltf["accessors"];
+                for (const auto& [accIdx, n] : accessorUses) {
+                    if (accIdx < 0 || accIdx >= static_cast<int>(accessors.size())) continue;
+                    const int bvIdx = accessors[accIdx].value("bufferView", -1);
+                    if (bvIdx >= 0) bufferViewUses[bvIdx] += n;
+                }
+            }
+
+            DracoPrimitive dracoJob(const json& prim) {
+                const auto& ext = *dracoExtension(prim);
+                const int bvIdx = ext.at("bufferView").get<int>();
+                const auto& bv = gltf.at("bufferViews").at(bvIdx);
+                const size_t off = bv.value("byteOffset", 0);
+                const size_t len = bv.at("byteLength").get<size_t>();
+                const auto buf = resolveBuffer(bv.at("buffer").get<int>());
+                if (off > buf.size() || len > buf.size() - off)
+                    throw std::runtime_error("KHR_draco_mesh_compression: bufferView " + std::to_string(bvIdx) + " out of bounds");
+
+                DracoPrimitive job;
+                job.compressed = buf.subspan(off, len);
+                const auto& attrs = prim["attributes"];
+                for (const auto& attr : ext.at("attributes").items()) {
+                    if (!attrs.contains(attr.key())) continue;
+                    const int accIdx = attrs[attr.key()].get<int>();
+                    const auto& acc = gltf["accessors"][accIdx];
+                    job.targets.push_back({accIdx, attr.value().get<int>(), acc["componentType"].get<int>(),
+                                           typeCount(acc["type"].get<std::string>()), {}, 0});
+                }
+                if (prim.contains("indices")) {
+                    job.targets.push_back({prim["indices"].get<int>(), -1, COMP_UNSIGNED_INT, 1, {}, 0});
+                }
+                return job;
+            }
+
+            bool dracoPending(const json& prim) {
+                const auto& ext = *dracoExtension(prim);
+                const auto& attrs = prim["attributes"];
+                for (const auto& attr : ext.at("attributes").items()) {
+                    if (attrs.contains(attr.key()) && !dracoAccessors.contains(attrs[attr.key()].get<int>())) return true;
+                }
+                return prim.contains("indices") && !dracoAccessors.contains(prim["indices"].get<int>());
+            }
+
+            // Make sure a Draco primitive's accessors are decoded, before its
+            // geometry reads them. A miss decodes it together with the next
+            // Draco primitives not yet started, in parallel, one per pool
+            // thread: at most that many primitives are held decoded ahead of
+            // the geometry that consumes (and so releases) them.
+            //
+            // Without Draco, the primitive's accessors are read as they stand:
+            // a file that does not list the extension in extensionsRequired
+            // keeps uncompressed fallback data behind them.
+            void ensureDraco(const json& prim) {
+                if (!dracoExtension(prim)) return;
+                if (!dracoAvailable) {
+                    requireDracoFallback(prim);
+                    return;
+                }
+                if (!dracoPending(prim)) return;
+
+                std::vector<DracoPrimitive> jobs;
+                jobs.push_back(dracoJob(prim));
+                dracoStarted.insert(&prim);
+                const auto inFlight = ThreadPool::global().concurrency();
+                for (; dracoNext < dracoQueue.size() && jobs.size() < inFlight; ++dracoNext) {
+                    const json* next = dracoQueue[dracoNext];
+                    if (dracoStarted.insert(next).second) jobs.push_back(dracoJob(*next));
+                }
+
+                parallelFor(0, jobs.size(), 1, [&](size_t lo, size_t hi) {
+                    for (auto i = lo; i < hi; ++i) decodeDraco(jobs[i]);
+                });
+                dracoPrimitivesDecoded += jobs.size();
+
+                for (auto& job : jobs) {
+                    for (auto& target : job.targets) {
+                        const auto uses = accessorUses.find(target.accessor);
+                        dracoAccessors.try_emplace(target.accessor, DracoAccessor{std::move(target.bytes), target.count, target.componentType,
+                                                                                  uses != accessorUses.end() ? uses->second : 1});
+                    }
+                }
+            }
+
+            // A Draco primitive read without Draco: every accessor the
+            // extension stands in for needs a bufferView of its own.
+            void requireDracoFallback(const json& prim) {
+                const auto& ext = *dracoExtension(prim);
+                const auto& attrs = prim["attributes"];
+                std::vector<int> accessors;
+                if (ext.contains("attributes")) {
+                    for (const auto& attr : ext["attributes"].items()) {
+                        if (attrs.contains(attr.key())) accessors.push_back(attrs[attr.key()].get<int>());
+                    }
+                }
+                if (prim.contains("indices")) accessors.push_back(prim["indices"].get<int>());
+
+                for (const int accIdx : accessors) {
+                    if (!gltf["accessors"][accIdx].contains("bufferView"))
+                        throw std::runtime_error("KHR_draco_mesh_compression: accessor " + std::to_string(accIdx) +
+                                                 " has no uncompressed fallback, and threepp was built without Draco (THREEPP_WITH_DRACO)");
+                }
+            }
+
             AccessorData getAccessor(int accessorIdx) {
                 const auto& acc = gltf["accessors"][accessorIdx];
                 size_t accOff = acc.value("byteOffset", 0);
@@ -387,6 +728,12 @@ namespace threepp {
                 bool normalized = acc.value("normalized", false);
                 const size_t elemSize = static_cast<size_t>(componentSize(ct) * nc);
 
+                if (auto it = dracoAccessors.find(accessorIdx); it != dracoAccessors.end()) {
+                    const auto& decoded = it->second;
+                    const auto stride = static_cast<size_t>(componentSize(decoded.componentType) * nc);
+                    return {decoded.bytes.data(), stride, decoded.count, decoded.componentType, nc, normalized};
+                }
+
                 // A sparse accessor may omit bufferView entirely (its base is all
                 // zeros, fully replaced by the sparse overlay). Callers handle a
                 // null pointer by zero-filling the base.
@@ -511,6 +858,7 @@ namespace threepp {
                                                 decodeComponentFloat(valPtr + j * lcomp, lct, lnorm);
                                 });
                 }
+                consumed(accessorIdx);
                 return out;
             }
 
@@ -544,6 +892,7 @@ namespace threepp {
                                     std::memcpy(&out[target * lnc], valPtr, lnc * sizeof(T));
                                 });
                 }
+                consumed(accessorIdx);
                 return out;
             }
 
@@ -570,6 +919,7 @@ namespace threepp {
                                     out[target] = decodeIndex(valPtr, lct);
                                 });
                 }
+                consumed(accessorIdx);
                 return out;
             }
 
@@ -609,6 +959,7 @@ namespace threepp {
                                         out[target * lnc + j] = decodeRaw(valPtr + j * lcomp, lct);
                                 });
                 }
+                consumed(accessorIdx);
                 return out;
             }
 
@@ -760,8 +1111,23 @@ namespace threepp {
             // image referenced by path keeps having a file, so it gets nothing
             // and the caller stays on the path it always had.
             std::optional<Image> loadImageData(int imageIdx, std::vector<uint8_t>* embedded = nullptr) {
+                if (auto it = decodedImages.find(imageIdx); it != decodedImages.end()) {
+                    auto& decoded = it->second;
+                    std::optional<Image> image;
+                    if (--decoded.uses > 0) {
+                        image = decoded.image;
+                        if (image && embedded && decoded.embedded) *embedded = decoded.encoded;
+                    } else {
+                        image = std::move(decoded.image);
+                        if (image && embedded && decoded.embedded) *embedded = std::move(decoded.encoded);
+                        decodedImages.erase(it);
+                    }
+                    return image;
+                }
+
                 const auto& imgDef = gltf["images"][imageIdx];
-                std::vector<uint8_t> raw;
+                std::vector<uint8_t> decodedUri;
+                std::span<const uint8_t> raw;
                 bool isEmbedded = true;
 
                 if (imgDef.contains("bufferView")) {
@@ -770,19 +1136,20 @@ namespace threepp {
                     int bufIdx = bv["buffer"].get<int>();
                     size_t off = bv.value("byteOffset", 0);
                     size_t len = bv["byteLength"].get<size_t>();
-                    const auto& buf = resolveBuffer(bufIdx);
-                    raw.assign(buf.data() + off, buf.data() + off + len);
+                    const auto buf = resolveBuffer(bufIdx);
+                    if (off > buf.size() || len > buf.size() - off)
+                        throw std::runtime_error("Image " + std::to_string(imageIdx) + " out of bounds of buffer " + std::to_string(bufIdx));
+                    raw = buf.subspan(off, len);
                 } else if (imgDef.contains("uri")) {
                     std::string uri = imgDef["uri"].get<std::string>();
                     if (uri.rfind("data:", 0) == 0) {
                         auto comma = uri.find(',');
-                        raw = base64Decode(uri.substr(comma + 1));
+                        decodedUri = base64Decode(uri.substr(comma + 1));
+                        raw = decodedUri;
                     } else {
-                        fs::path p = basePath / percentDecode(uri);
-                        std::ifstream f(p, std::ios::binary);
-                        if (!f) throw std::runtime_error("Cannot open image: " + p.string());
-                        raw = readAllBytes(f, p);
-                        isEmbedded = false;
+                        raw = external(uri, "image");
+                        // Bytes from the resolver have no file either.
+                        isEmbedded = fromMemory;
                     }
                 } else {
                     throw std::runtime_error("Image " + std::to_string(imageIdx) + " has no source");
@@ -792,12 +1159,125 @@ namespace threepp {
                 // flipY false: glTF's UV origin is the top-left corner, so the
                 // rows are used in the order the file stores them. Whatever
                 // reads the retained bytes back has to agree.
-                auto image = loader.load(raw, 4, false);
-                if (image && embedded && isEmbedded) *embedded = std::move(raw);
+                auto image = loader.load(std::as_bytes(raw), 4, false);
+                if (image && embedded && isEmbedded) embedded->assign(raw.begin(), raw.end());
 
                 return image;
             }
 
+            // Texture references are textureInfo objects, under keys like
+            // "baseColorTexture" — in the core material and its extensions.
+            static void collectTextureRefs(const json& node, std::set<int>& textures) {
+                if (!node.is_object()) return;
+                for (const auto& [key, value] : node.items()) {
+                    if (!value.is_object()) continue;
+                    if (key.ends_with("Texture") && value.contains("index") && value["index"].is_number_integer()) {
+                        textures.insert(value["index"].get<int>());
+                    }
+                    collectTextureRefs(value, textures);
+                }
+            }
+
+            // Decode every image the materials refer to before the scene is
+            // built, on the thread pool, so a texture-heavy file is not
+            // decoded one image at a time as loadTexture meets them. At most
+            // maxImagesInFlight are read and decoded at once; their pixels
+            // then wait in decodedImages for loadTexture, which binds them as
+            // before. An image that cannot be read is left for loadTexture to
+            // fail on, at the point (and with the error) it always did.
+            void decodeImages() {
+                if (!gltf.contains("materials") || !gltf.contains("textures") || !gltf.contains("images")) return;
+
+                std::set<int> textures;
+                for (const auto& material : gltf.at("materials")) collectTextureRefs(material, textures);
+
+                const auto& textureDefs = gltf.at("textures");
+                const auto& imageDefs = gltf.at("images");
+                std::map<int, int> uses;
+                for (int texIdx : textures) {
+                    if (texIdx < 0 || texIdx >= static_cast<int>(textureDefs.size())) continue;
+                    const int imageIdx = textureDefs[texIdx].value("source", -1);
+                    if (imageIdx >= 0 && imageIdx < static_cast<int>(imageDefs.size())) ++uses[imageIdx];
+                }
+
+                // The bytes are found here, where the buffers, the document
+                // and the resolver can be touched; files are mapped, and
+                // everything decoded, on the workers.
+                struct Job {
+                    int imageIdx;
+                    std::span<const uint8_t> bytes;
+                    std::vector<uint8_t> decodedUri;
+                    fs::path file;
+                    DecodedImage decoded;
+                    bool ok = false;
+                };
+
+                const unsigned inFlight = maxImagesInFlight > 0 ? maxImagesInFlight : ThreadPool::global().concurrency();
+                auto next = uses.begin();
+                std::vector<Job> jobs;
+                while (next != uses.end()) {
+
+                    jobs.clear();
+                    for (; next != uses.end() && jobs.size() < inFlight; ++next) {
+                        auto& job = jobs.emplace_back();
+                        job.imageIdx = next->first;
+                        job.decoded.uses = next->second;
+                        try {
+                            const auto& imgDef = imageDefs[job.imageIdx];
+                            if (imgDef.contains("bufferView")) {
+                                const auto& bv = gltf.at("bufferViews").at(imgDef["bufferView"].get<int>());
+                                const size_t off = bv.value("byteOffset", 0);
+                                const size_t len = bv.at("byteLength").get<size_t>();
+                                const auto buf = resolveBuffer(bv.at("buffer").get<int>());
+                                if (off > buf.size() || len > buf.size() - off) continue;
+                                job.bytes = buf.subspan(off, len);
+                                job.decoded.embedded = true;
+                            } else if (imgDef.contains("uri")) {
+                                const auto uri = imgDef["uri"].get<std::string>();
+                                if (uri.rfind("data:", 0) == 0) {
+                                    job.decodedUri = base64Decode(uri.substr(uri.find(',') + 1));
+                                    job.bytes = job.decodedUri;
+                                    job.decoded.embedded = true;
+                                } else if (fromMemory) {
+                                    job.bytes = external(uri, "image");
+                                    job.decoded.embedded = true;
+                                } else {
+                                    job.file = basePath / percentDecode(uri);
+                                }
+                            }
+                        } catch (const std::exception&) {
+                            // Left for loadTexture to report.
+                        }
+                    }
+
+                    parallelFor(0, jobs.size(), 1, [&](size_t lo, size_t hi) {
+                        for (auto i = lo; i < hi; ++i) {
+                            auto& job = jobs[i];
+                            std::unique_ptr<utils::MappedFile> file;
+                            if (!job.file.empty()) {
+                                try {
+                                    file = std::make_unique<utils::MappedFile>(job.file);
+                                } catch (const std::exception&) {
+                                    continue;
+                                }
+                                job.bytes = {file->data(), static_cast<size_t>(file->size())};
+                            } else if (job.bytes.empty()) {
+                                continue;
+                            }
+                            // flipY false, as in loadImageData.
+                            job.decoded.image = ImageLoader().load(std::as_bytes(job.bytes), 4, false);
+                            if (job.decoded.embedded) job.decoded.encoded.assign(job.bytes.begin(), job.bytes.end());
+                            job.decodedUri = {};
+                            job.ok = true;
+                        }
+                    });
+
+                    for (auto& job : jobs) {
+                        if (job.ok) decodedImages.emplace(job.imageIdx, std::move(job.decoded));
+                    }
+                }
+            }
+
             std::shared_ptr<Texture> loadTexture(int texIdx, ColorSpace cs = ColorSpace::sRGB) {
                 const std::pair<int, int> key{texIdx, static_cast<int>(cs)};
                 if (auto it = textureCache.find(key); it != textureCache.end())
@@ -1180,6 +1660,8 @@ namespace threepp {
                 if (auto it = geometryCache.find(key); it != geometryCache.end())
                     return it->second;
 
+                ensureDraco(prim);
+
                 auto geometry = BufferGeometry::create();
                 const auto& attrs = prim["attributes"];
 
@@ -1679,8 +2161,17 @@ namespace threepp {
                     }
                 }
 
+                // Draco is optional unless the file says otherwise: a
+                // primitive may keep uncompressed accessors next to the
+                // extension, which a build without Draco reads instead.
+                if (!dracoAvailable && extensionRequired("KHR_draco_mesh_compression"))
+                    throw std::runtime_error("KHR_draco_mesh_compression is required by this file, "
+                                             "but threepp was built without Draco (THREEPP_WITH_DRACO)");
+
                 gatherJoints();
+                countAccessorUses();
                 preCreateNodes();
+                decodeImages();
 
                 GLTFResult result;
                 int defaultScene = gltf.value("scene", 0);
@@ -1711,6 +2202,13 @@ namespace threepp {
                 return result;
             }
 
+            void reportStats(GLTFLoader::LoadStats& stats) const {
+                stats.meshoptViewsDecoded = meshoptViewsDecoded;
+                stats.dracoPrimitivesDecoded = dracoPrimitivesDecoded;
+                stats.meshoptViewsHeld = meshoptCache.size();
+                stats.dracoAccessorsHeld = dracoAccessors.size();
+            }
+
             GLTFResult parseGLTF(const std::string& jsonText) {
                 gltf = json::parse(jsonText);
                 int numBuffers = gltf.contains("buffers") ? static_cast<int>(gltf["buffers"].size()) : 0;
@@ -1718,7 +2216,7 @@ namespace threepp {
                 return buildResult();
             }
 
-            GLTFResult parseGLB(const std::vector<uint8_t>& data) {
+            GLTFResult parseGLB(std::span<const uint8_t> data) {
                 if (data.size() < 12) throw std::runtime_error("GLB too small");
 
                 uint32_t magic, version, totalLength;
@@ -1757,9 +2255,9 @@ namespace threepp {
                         jsonText = std::string(reinterpret_cast<const char*>(data.data() + offset), chunkLen);
                         gotJSON = true;
                     } else if (chunkType == GLB_CHUNK_BIN && !gotBIN) {
-                        // Buffer 0 is the embedded BIN chunk
+                        // Buffer 0 is the embedded BIN chunk, used where it lies.
                         buffers.resize(1);
-                        buffers[0].assign(data.data() + offset, data.data() + offset + chunkLen);
+                        buffers[0] = data.subspan(offset, chunkLen);
                         gotBIN = true;
                     }
 
@@ -2068,32 +2566,76 @@ namespace threepp {
     //  GLTFLoader public API
     // ===========================================================================
 
+    namespace {
+
+        bool isGlb(std::span<const uint8_t> data) {
+            uint32_t magic = 0;
+            if (data.size() >= 4) std::memcpy(&magic, data.data(), 4);
+            return magic == GLB_MAGIC;
+        }
+
+    }// namespace
+
     std::optional<GLTFResult> GLTFLoader::load(const fs::path& path) {
-        try {
-            std::ifstream f(path, std::ios::binary);
-            if (!f) throw std::runtime_error("Cannot open file: " + path.string());
-            std::vector<uint8_t> data = readAllBytes(f, path);
+        LoadStats stats;
+        return load(path, stats);
+    }
 
+    std::optional<GLTFResult> GLTFLoader::load(const fs::path& path, LoadStats& stats) {
+        try {
             GLTFParser parser;
             parser.basePath = path.parent_path();
-            parser.buffers = {};
             parser.preserveNarrowAttributes = preserveNarrowAttributes;
+            parser.maxImagesInFlight = maxImagesInFlight;
+
+            // Mapped, so a large .glb's BIN chunk is read straight out of the
+            // page cache by the accessors that need it.
+            std::unique_ptr<utils::MappedFile> file;
+            try {
+                file = std::make_unique<utils::MappedFile>(path);
+            } catch (const std::exception&) {
+                throw std::runtime_error("Cannot open file: " + path.string());
+            }
+            const std::span<const uint8_t> data(file->data(), static_cast<size_t>(file->size()));
+            parser.mappedFiles.emplace_back(std::move(file));
 
             std::string ext = path.extension().string();
             // lowercase extension
             for (auto& c : ext) c = static_cast<char>(std::tolower(c));
 
-            if (ext == ".glb") {
-                return parser.parseGLB(data);
-            }
-
-            // .gltf — plain JSON
-            std::string jsonText(data.begin(), data.end());
-            return parser.parseGLTF(jsonText);
+            // Anything but .glb is plain JSON.
+            auto result = ext == ".glb" ? parser.parseGLB(data)
+                                        : parser.parseGLTF(std::string(data.begin(), data.end()));
+            parser.reportStats(stats);
+            return result;
         } catch (const std::exception& e) {
             std::cerr << "[GLTFLoader] Error loading " << path << ": " << e.what() << "\n";
             return std::nullopt;
         }
     }
 
+    std::optional<GLTFResult> GLTFLoader::load(std::span<const std::byte> bytes, const Resolver& resolver) {
+        LoadStats stats;
+        return load(bytes, resolver, stats);
+    }
+
+    std::optional<GLTFResult> GLTFLoader::load(std::span<const std::byte> bytes, const Resolver& resolver, LoadStats& stats) {
+        try {
+            GLTFParser parser;
+            parser.fromMemory = true;
+            parser.resolver = resolver;
+            parser.preserveNarrowAttributes = preserveNarrowAttributes;
+            parser.maxImagesInFlight = maxImagesInFlight;
+
+            const std::span<const uint8_t> data(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+            auto result = isGlb(data) ? parser.parseGLB(data)
+                                      : parser.parseGLTF(std::string(data.begin(), data.end()));
+            parser.reportStats(stats);
+            return result;
+        } catch (const std::exception& e) {
+            std::cerr << "[GLTFLoader] Error loading from memory: " << e.what() << "\n";
+            return std::nullopt;
+        }
+    }
+
 }// namespace threepp
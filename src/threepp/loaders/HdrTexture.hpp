@@ -7,11 +7,12 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace threepp::detail {
 
-    // Shared tail of the HDR image loaders: linear float RGBA pixels in, an
+    // Shared tail of the HDR image loaders: linear RGBA pixels in, an
     // environment-ready Texture out. RGBELoader (.hdr) and EXRLoader (.exr)
     // differ only in how they get to the floats — if they disagreed on any
     // property below, the same sky would light a scene differently depending on
@@ -21,7 +22,10 @@ namespace threepp::detail {
     // rgba32f more reliably than a 3-channel float format, and not every API
     // exposes an rgb32float at all. The Vulkan environment path additionally
     // requires exactly this (float RGBA) and ignores anything else.
-    inline std::shared_ptr<Texture> makeHdrTexture(std::vector<float> rgba,
+    //
+    // Half-float pixels (EXRLoader::halfFloat) make a HalfFloat texture; float
+    // is the default for both loaders.
+    inline std::shared_ptr<Texture> makeHdrTexture(ImageData rgba,
                                                    unsigned int width,
                                                    unsigned int height,
                                                    std::string name) {
@@ -29,13 +33,14 @@ namespace threepp::detail {
         // Moved through the vector<Image> overload rather than create(const
         // Image&): an 8k equirect is ~1 GB of floats, and the by-reference
         // overload would copy every one of them.
+        const bool half = std::holds_alternative<std::vector<std::uint16_t>>(rgba);
         std::vector<Image> images;
         images.emplace_back(std::move(rgba), width, height, 0u);
 
         auto texture = Texture::create(std::move(images));
         texture->name = std::move(name);
         texture->format = Format::RGBA;
-        texture->type = Type::Float;
+        texture->type = half ? Type::HalfFloat : Type::Float;
         texture->colorSpace = ColorSpace::Linear;// both decoders emit linear scene-referred floats
         texture->mapping = Mapping::EquirectangularReflection;
         // Equirect maps wrap 360° in azimuth — Repeat on S keeps the atan2 seam (at
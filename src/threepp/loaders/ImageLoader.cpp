@@ -21,6 +21,7 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 using namespace threepp;
 
@@ -37,11 +38,6 @@ namespace {
                std::memcmp(data + 8, "WEBP", 4) == 0;
     }
 
-    bool isWebp(const std::vector<unsigned char>& data) {
-
-        return isWebp(data.data(), data.size());
-    }
-
     std::optional<Image> loadWebp(const unsigned char* data, size_t size, int channels, bool flipY) {
 
         WebPBitstreamFeatures features{};
@@ -109,8 +105,10 @@ namespace {
         int channels;
         unsigned char* pixels = nullptr;
 
-        ImageStruct(const std::vector<unsigned char>& data, int channels): channels(channels) {
-            pixels = stbi_load_from_memory(data.data(), static_cast<int>(data.size()),
+        ImageStruct(const unsigned char* data, size_t size, int channels): channels(channels) {
+            // stb takes an int length; anything past that is not an image it could decode anyway.
+            if (size > static_cast<size_t>(std::numeric_limits<int>::max())) return;
+            pixels = stbi_load_from_memory(data, static_cast<int>(size),
                                            &width, &height, nullptr, channels);
         }
 
@@ -182,11 +180,17 @@ std::optional<Image> ImageLoader::load(const std::filesystem::path& imagePath, i
 
 std::optional<Image> ImageLoader::load(const std::vector<unsigned char>& data, int channels, bool flipY) {
 
-    if (isWebp(data)) {
-        return loadWebp(data.data(), data.size(), channels, flipY);
+    return load(std::as_bytes(std::span(data)), channels, flipY);
+}
+
+std::optional<Image> ImageLoader::load(std::span<const std::byte> data, int channels, bool flipY) {
+
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    if (isWebp(bytes, data.size())) {
+        return loadWebp(bytes, data.size(), channels, flipY);
     }
 
-    ImageStruct image{data, channels};
+    ImageStruct image{bytes, data.size(), channels};
     if (!image.ok()) return std::nullopt;
 
     return Image{
@@ -0,0 +1,314 @@
+
+#include "threepp/loaders/LoaderService.hpp"
+
+#include "threepp/utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+using namespace threepp;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        std::function<std::shared_ptr<Group>()> fn;
+        std::string key;
+        std::uint64_t bytes = 0;
+        LoaderService::Priority priority;
+        std::vector<std::weak_ptr<AsyncGroup>> groups;
+        bool started = false;
+    };
+
+    // The first live group gets the result itself, the rest a copy each — an
+    // object has one parent. Animations are not part of copy(), so the
+    // clones share the clips.
+    void deliver(const std::vector<std::weak_ptr<AsyncGroup>>& groups, std::shared_ptr<Group> result) {
+        bool first = true;
+        for (const auto& weak : groups) {
+            auto group = weak.lock();
+            if (!group) continue;
+            if (!result || first) {
+                group->deliverResult(result);
+                first = false;
+                continue;
+            }
+            auto copy = result->clone<Group>();
+            copy->animations = result->animations;
+            group->deliverResult(std::move(copy));
+        }
+    }
+
+}// namespace
+
+struct LoaderService::Impl {
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    mutable std::condition_variable idle;
+
+    // One queue per priority class. A request promoted by a more urgent
+    // duplicate is queued again in the higher class; the entry left behind
+    // is skipped when it comes up.
+    std::array<std::deque<std::shared_ptr<Request>>, 3> queues;
+    std::unordered_map<std::string, std::shared_ptr<Request>> inFlight;
+
+    Stats stats;
+    Clock::time_point activeSince;
+
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+#ifdef __EMSCRIPTEN__
+    // What a queued emscripten_async_call holds weakly, to find out whether
+    // the service it was queued on still exists.
+    std::shared_ptr<Impl*> self = std::make_shared<Impl*>(this);
+#endif
+
+    std::shared_ptr<Request> pop() {
+        for (auto i = 0u; i < queues.size(); ++i) {
+            auto& queue = queues[i];
+            while (!queue.empty()) {
+                auto request = std::move(queue.front());
+                queue.pop_front();
+                if (!request->started && static_cast<unsigned>(request->priority) == i) return request;
+            }
+        }
+        return nullptr;
+    }
+
+    void forget(const Request& request) {
+        if (request.key.empty()) return;
+        if (auto it = inFlight.find(request.key); it != inFlight.end() && it->second.get() == &request) inFlight.erase(it);
+    }
+
+    void run() {
+        std::unique_lock lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&] { return stopping || stats.pending > 0; });
+            if (stopping) return;
+
+            auto request = pop();
+            if (!request) continue;
+            --stats.pending;
+
+            std::erase_if(request->groups, [](const auto& weak) { return weak.expired(); });
+            if (request->groups.empty()) {
+                ++stats.cancelled;
+                forget(*request);
+                idle.notify_all();
+                continue;
+            }
+
+            request->started = true;
+            if (stats.running++ == 0) activeSince = Clock::now();
+            lock.unlock();
+
+            std::shared_ptr<Group> result;
+            try {
+                result = request->fn();
+            } catch (...) {}
+
+            lock.lock();
+            // Off the map before delivering: a request for the key made from
+            // here on is a new load, not one that missed this result.
+            forget(*request);
+            const auto groups = std::move(request->groups);
+            if (result) {
+                ++stats.completed;
+                stats.bytes += request->bytes;
+            } else {
+                ++stats.failed;
+            }
+            lock.unlock();
+
+            deliver(groups, std::move(result));
+            request.reset();
+
+            lock.lock();
+            if (--stats.running == 0) {
+                stats.activeSeconds += std::chrono::duration<double>(Clock::now() - activeSince).count();
+            }
+            idle.notify_all();
+        }
+    }
+
+    [[nodiscard]] bool isIdle() const {
+        return stats.pending == 0 && stats.running == 0;
+    }
+};
+
+double LoaderService::Stats::progress() const {
+    if (submitted == 0) return 1;
+    return static_cast<double>(completed + failed + cancelled) / static_cast<double>(submitted);
+}
+
+double LoaderService::Stats::loadsPerSecond() const {
+    return activeSeconds > 0 ? static_cast<double>(completed) / activeSeconds : 0;
+}
+
+double LoaderService::Stats::bytesPerSecond() const {
+    return activeSeconds > 0 ? static_cast<double>(bytes) / activeSeconds : 0;
+}
+
+LoaderService::LoaderService(unsigned numWorkers): pimpl_(std::make_unique<Impl>()) {
+
+#ifndef __EMSCRIPTEN__
+    if (numWorkers == 0) numWorkers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    pimpl_->workers.reserve(numWorkers);
+    for (auto i = 0u; i < numWorkers; ++i) {
+        pimpl_->workers.emplace_back([this] { pimpl_->run(); });
+    }
+#else
+    (void) numWorkers;
+#endif
+}
+
+LoaderService::~LoaderService() {
+    {
+        std::lock_guard lock(pimpl_->mutex);
+        pimpl_->stopping = true;
+    }
+    pimpl_->wake.notify_all();
+    for (auto& worker : pimpl_->workers) worker.join();
+}
+
+std::shared_ptr<AsyncGroup> LoaderService::load(std::function<std::shared_ptr<Group>()> loadFn,
+                                                Priority priority,
+                                                const std::string& key,
+                                                std::uint64_t bytes) {
+
+    auto group = AsyncGroup::create();
+    group->setLoading(true);
+
+    auto request = std::make_shared<Request>();
+    request->fn = std::move(loadFn);
+    request->key = key;
+    request->bytes = bytes;
+    request->priority = priority;
+    request->groups.emplace_back(group);
+
+#ifdef __EMSCRIPTEN__
+    // No threads to queue for: run it from the browser's event loop, as
+    // loadAsync always did. There is one thread, so no lock is taken, and
+    // the counts are kept exactly as a worker keeps them. A service
+    // destroyed before the call comes up still has its load run; only the
+    // counting is skipped.
+    ++pimpl_->stats.submitted;
+    ++pimpl_->stats.pending;
+
+    struct Call {
+        std::weak_ptr<Impl*> service;
+        std::shared_ptr<Request> request;
+    };
+    emscripten_async_call(
+            [](void* arg) {
+                std::unique_ptr<Call> call(static_cast<Call*>(arg));
+                const auto service = [&]() -> Impl* {
+                    const auto alive = call->service.lock();
+                    return alive ? *alive : nullptr;
+                };
+                auto& request = *call->request;
+                Impl* impl = service();
+                if (impl) --impl->stats.pending;
+
+                std::erase_if(request.groups, [](const auto& weak) { return weak.expired(); });
+                if (request.groups.empty()) {
+                    if (impl) ++impl->stats.cancelled;
+                    return;
+                }
+
+                if (impl && impl->stats.running++ == 0) impl->activeSince = Clock::now();
+                std::shared_ptr<Group> result;
+                try {
+                    result = request.fn();
+                } catch (...) {}
+
+                // The load itself may have destroyed the service.
+                impl = service();
+                if (impl) {
+                    if (result) {
+                        ++impl->stats.completed;
+                        impl->stats.bytes += request.bytes;
+                    } else {
+                        ++impl->stats.failed;
+                    }
+                    if (--impl->stats.running == 0) {
+                        const auto active = Clock::now() - impl->activeSince;
+                        impl->stats.activeSeconds += std::chrono::duration<double>(active).count();
+                    }
+                }
+                deliver(request.groups, std::move(result));
+            },
+            new Call{pimpl_->self, std::move(request)}, 0);
+#else
+    {
+        std::lock_guard lock(pimpl_->mutex);
+        if (!key.empty()) {
+            if (auto it = pimpl_->inFlight.find(key); it != pimpl_->inFlight.end()) {
+                auto& existing = it->second;
+                existing->groups.emplace_back(group);
+                ++pimpl_->stats.deduplicated;
+                if (!existing->started && priority < existing->priority) {
+                    existing->priority = priority;
+                    pimpl_->queues[static_cast<unsigned>(priority)].push_back(existing);
+                }
+                return group;
+            }
+            pimpl_->inFlight.emplace(key, request);
+        }
+        pimpl_->queues[static_cast<unsigned>(priority)].push_back(std::move(request));
+        ++pimpl_->stats.submitted;
+        ++pimpl_->stats.pending;
+    }
+    pimpl_->wake.notify_one();
+#endif
+
+    return group;
+}
+
+unsigned LoaderService::numWorkers() const {
+    return static_cast<unsigned>(pimpl_->workers.size());
+}
+
+LoaderService::Stats LoaderService::stats() const {
+    std::lock_guard lock(pimpl_->mutex);
+    auto stats = pimpl_->stats;
+    if (stats.running > 0) {
+        stats.activeSeconds += std::chrono::duration<double>(Clock::now() - pimpl_->activeSince).count();
+    }
+    return stats;
+}
+
+void LoaderService::waitIdle() const {
+    // Under Emscripten the loads run from the event loop, which cannot turn
+    // while this blocks; waiting there would never return.
+#ifndef __EMSCRIPTEN__
+    std::unique_lock lock(pimpl_->mutex);
+    pimpl_->idle.wait(lock, [&] { return pimpl_->isIdle(); });
+#endif
+}
+
+LoaderService& LoaderService::global() {
+    // The loads these workers run fan out on ThreadPool::global(), so the
+    // pool must outlive the service: its destructor joins the workers, and a
+    // load still running then uses the pool until it returns. Statics are
+    // destroyed in the reverse order their construction completed, so
+    // finishing the pool's first is what puts the service's destructor ahead
+    // of the pool's at exit, whichever of the two was asked for first.
+    ThreadPool::global();
+    static LoaderService service;
+    return service;
+}
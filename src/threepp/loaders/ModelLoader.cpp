@@ -108,8 +108,20 @@ std::shared_ptr<Group> ModelLoader::load(const std::filesystem::path& path) {
     return nullptr;
 }
 
-std::shared_ptr<AsyncGroup> ModelLoader::loadAsync(const std::filesystem::path& path) {
-    return threepp::loadAsync(*this, path);
+std::shared_ptr<AsyncGroup> ModelLoader::loadAsync(const std::filesystem::path& path, LoaderService::Priority priority) {
+
+    std::error_code ec;
+    auto canonical = std::filesystem::weakly_canonical(path, ec);
+    if (ec) canonical = path;
+    const auto bytes = std::filesystem::file_size(canonical, ec);
+
+    // The settings are part of the key: the same file loaded up-axis aware
+    // and not is two different results.
+    const auto key = std::string(ignoreUpDirection_ ? "model:ignore-up:" : "model:") + canonical.string();
+
+    return LoaderService::global().load(
+            [loader = *this, path]() mutable { return loader.load(path); },
+            priority, key, ec ? 0 : bytes);
 }
 
 ModelLoader& ModelLoader::setIgnoreUpDirection(bool ignore) {
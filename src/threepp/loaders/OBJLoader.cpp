@@ -7,13 +7,19 @@
 #include "threepp/objects/LineSegments.hpp"
 #include "threepp/objects/Mesh.hpp"
 #include "threepp/objects/Points.hpp"
-#include "threepp/utils/StringUtils.hpp"
-
-#include <fstream>
+#include "threepp/utils/CharConv.hpp"
+#include "threepp/utils/MappedFile.hpp"
+#include "threepp/utils/Parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <climits>
+#include <cstdint>
 #include <iostream>
 #include <optional>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -21,35 +27,270 @@ using namespace threepp;
 
 namespace {
 
-    // Resolve an OBJ face index into a flat offset into a tightly-packed array
-    // of `stride` floats per element.
+    // OBJ text is parsed straight out of the mapped file in newline-aligned
+    // chunks of about this size, a batch of them at a time: the text of a
+    // batch in parallel, each chunk into arrays of its own, then those merged
+    // into the parser state in file order. A batch is a few chunks per lane,
+    // so a lane that draws a slow chunk does not hold up the rest.
+    constexpr size_t chunkSize = 1 << 20;
+    constexpr size_t chunksPerLane = 4;
+
+    // A face corner's missing component — the uv of "1//3", the normal of "1/2".
+    constexpr int32_t absent = INT32_MIN;
+
+    // Resolve an OBJ index into an element index, given how many elements had
+    // been declared at that line.
     //
     // OBJ indices are 1-based, and negative values are relative to the end
     // (-1 = last element declared so far). Both forms come straight out of the
     // file, so both must be range-checked: a truncated or hand-edited .obj can
     // easily name element 999999 of a 3-element array, and the callers index
     // with operator[]. Returns nullopt for anything that does not address a
-    // real element (including 0, which is never a valid OBJ index) so the
-    // caller can drop the face instead of reading out of bounds.
-    std::optional<size_t> resolveIndex(const std::string& value, size_t arraySize, size_t stride) {
+    // real element (including 0, which is never a valid OBJ index, and an
+    // absent component) so the caller can drop the face instead of reading
+    // out of bounds.
+    std::optional<size_t> resolveIndex(int32_t index, size_t count) {
+
+        if (index == 0 || index == absent) return std::nullopt;
+
+        const long long i = index > 0 ? index - 1ll : static_cast<long long>(count) + index;
+
+        if (i < 0 || i >= static_cast<long long>(count)) return std::nullopt;
+
+        return static_cast<size_t>(i);
+    }
 
-        const int index = utils::parseInt(value);
-        if (index == 0) return std::nullopt;
+    std::string_view trim(std::string_view s) {
 
-        const auto count = static_cast<long long>(arraySize / stride);
-        const long long i = index > 0 ? index - 1 : count + index;
+        while (!s.empty() && utils::isSpace(s.front())) s.remove_prefix(1);
+        while (!s.empty() && utils::isSpace(s.back())) s.remove_suffix(1);
+        return s;
+    }
 
-        if (i < 0 || i >= count) return std::nullopt;
+    // Calls fn for each run of non-space characters, in order.
+    template<class Fn>
+    void forEachToken(std::string_view s, Fn&& fn) {
+
+        size_t i = 0;
+        while (true) {
+            while (i < s.size() && utils::isSpace(s[i])) ++i;
+            if (i == s.size()) return;
+            const auto start = i;
+            while (i < s.size() && !utils::isSpace(s[i])) ++i;
+            fn(s.substr(start, i - start));
+        }
+    }
 
-        return static_cast<size_t>(i) * stride;
+    // The first N tokens into `out` (the rest left empty); returns how many
+    // tokens the line has in all.
+    template<size_t N>
+    size_t tokenize(std::string_view s, std::array<std::string_view, N>& out) {
+
+        size_t n = 0;
+        forEachToken(s, [&](std::string_view token) {
+            if (n < N) out[n] = token;
+            ++n;
+        });
+        return n;
     }
 
-    std::optional<size_t> parseVertexOrNormalIndex(const std::string& value, size_t len) {
-        return resolveIndex(value, len, 3);
+    // A face corner, "v", "v/vt", "v//vn" or "v/vt/vn": an empty or missing
+    // component is `absent`, one that does not parse is 0 (so it never
+    // resolves).
+    std::array<int32_t, 3> toCorner(std::string_view token) {
+
+        std::array<int32_t, 3> corner{absent, absent, absent};
+        for (auto& component : corner) {
+            const auto slash = token.find('/');
+            const auto part = token.substr(0, slash);
+            if (!part.empty()) component = utils::toInt(part);
+            if (slash == std::string_view::npos) break;
+            token.remove_prefix(slash + 1);
+        }
+        return corner;
     }
 
-    std::optional<size_t> parseUvIndex(const std::string& value, size_t len) {
-        return resolveIndex(value, len, 2);
+    bool isOff(std::string_view value) {
+
+        return value == "0" || (value.size() == 3 && std::tolower(static_cast<unsigned char>(value[0])) == 'o' &&
+                                std::tolower(static_cast<unsigned char>(value[1])) == 'f' &&
+                                std::tolower(static_cast<unsigned char>(value[2])) == 'f');
+    }
+
+    // How many elements of each kind were declared up to some line.
+    struct Counts {
+        size_t vertices = 0;
+        size_t uvs = 0;
+        size_t normals = 0;
+        size_t colors = 0;
+    };
+
+    // A line that does something other than declare an element. Recorded as
+    // it is parsed and replayed in order by the merge, which is where object,
+    // material and index state lives.
+    struct Command {
+
+        enum class Op : uint8_t {
+            Face,
+            Points,
+            Object,
+            UseMtl,
+            MtlLib,
+            Smooth,
+            Unexpected
+        };
+
+        Op op;
+        bool smooth = false;
+        // Face: a range of corners. Points: a range of indices.
+        uint32_t first = 0;
+        uint32_t count = 0;
+        // The chunk's own element counts at this line.
+        Counts declared;
+        // A name, a library, or the unexpected line; a view into the file.
+        std::string_view text;
+    };
+
+    // One newline-aligned piece of the file and what it parses to. Kept
+    // between batches, so the arrays stop allocating once they have grown to
+    // the size a chunk needs.
+    struct Chunk {
+
+        std::string_view text;
+
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> colors;
+        std::vector<float> uvs;
+
+        std::vector<std::array<int32_t, 3>> corners;
+        std::vector<int32_t> points;
+        std::vector<Command> commands;
+
+        void parse() {
+
+            vertices.clear();
+            normals.clear();
+            colors.clear();
+            uvs.clear();
+            corners.clear();
+            points.clear();
+            commands.clear();
+
+            size_t pos = 0;
+            while (pos < text.size()) {
+                auto end = text.find('\n', pos);
+                if (end == std::string_view::npos) end = text.size();
+                parseLine(trim(text.substr(pos, end - pos)));
+                pos = end + 1;
+            }
+        }
+
+    private:
+        Command& command(Command::Op op) {
+
+            auto& c = commands.emplace_back();
+            c.op = op;
+            c.declared = {vertices.size() / 3, uvs.size() / 2, normals.size() / 3, colors.size() / 3};
+            return c;
+        }
+
+        void parseLine(std::string_view line) {
+
+            if (line.empty() || line.front() == '#') return;
+
+            switch (line.front()) {
+
+                case 'v': {
+
+                    std::array<std::string_view, 8> data;
+                    const auto n = tokenize(line, data);
+
+                    if (data[0] == "v") {
+                        vertices.insert(vertices.end(), {utils::toFloat(data[1]), utils::toFloat(data[2]), utils::toFloat(data[3])});
+
+                        if (n == 8) {
+                            colors.insert(colors.end(), {utils::toFloat(data[4]), utils::toFloat(data[5]), utils::toFloat(data[6])});
+                        }
+                    } else if (data[0] == "vn") {
+                        normals.insert(normals.end(), {utils::toFloat(data[1]), utils::toFloat(data[2]), utils::toFloat(data[3])});
+                    } else if (data[0] == "vt") {
+                        uvs.insert(uvs.end(), {utils::toFloat(data[1]), utils::toFloat(data[2])});
+                    }
+                    return;
+                }
+
+                case 'f': {
+
+                    const auto first = corners.size();
+                    forEachToken(line.substr(1), [&](std::string_view token) {
+                        corners.emplace_back(toCorner(token));
+                    });
+
+                    // A face needs at least 3 vertices; skip malformed faces.
+                    if (corners.size() - first < 3) {
+                        corners.resize(first);
+                        return;
+                    }
+
+                    auto& c = command(Command::Op::Face);
+                    c.first = static_cast<uint32_t>(first);
+                    c.count = static_cast<uint32_t>(corners.size() - first);
+                    return;
+                }
+
+                case 'l':
+
+                    // TODO
+                    return;
+
+                case 'p': {
+
+                    const auto first = points.size();
+                    forEachToken(line.substr(1), [&](std::string_view token) {
+                        points.emplace_back(utils::toInt(token));
+                    });
+
+                    auto& c = command(Command::Op::Points);
+                    c.first = static_cast<uint32_t>(first);
+                    c.count = static_cast<uint32_t>(points.size() - first);
+                    return;
+                }
+
+                case 's': {
+
+                    std::array<std::string_view, 2> result;
+                    const auto n = tokenize(line, result);
+                    command(Command::Op::Smooth).smooth = n < 2 || !isOff(result[1]);
+                    return;
+                }
+
+                default:
+                    break;
+            }
+
+            if ((line.front() == 'o' || line.front() == 'g') && line.size() > 1 && utils::isSpace(line[1])) {
+                command(Command::Op::Object).text = trim(line.substr(1));
+            } else if (line.find("usemtl ") != std::string_view::npos) {
+                command(Command::Op::UseMtl).text = trim(line.substr(7));
+            } else if (line.find("mtllib ") != std::string_view::npos) {
+                command(Command::Op::MtlLib).text = trim(line.substr(7));
+            } else if (line != "\\0") {
+                command(Command::Op::Unexpected).text = line;
+            }
+        }
+    };
+
+    // Appends elements a, b and c of a tightly-packed array of Stride floats.
+    template<size_t Stride>
+    void appendTriangle(std::vector<float>& dst, const std::vector<float>& src, size_t a, size_t b, size_t c) {
+
+        const auto at = dst.size();
+        dst.resize(at + 3 * Stride);
+        auto* out = dst.data() + at;
+        std::copy_n(src.data() + a * Stride, Stride, out);
+        std::copy_n(src.data() + b * Stride, Stride, out + Stride);
+        std::copy_n(src.data() + c * Stride, Stride, out + 2 * Stride);
     }
 
     struct OBJGeometry {
@@ -198,86 +439,94 @@ namespace {
             object->finalize(true);
         }
 
-        void addVertex(size_t a, size_t b, size_t c) {
-
-            auto& src = vertices;
-            auto& dst = object->geometry.vertices;
-
-            dst.insert(dst.end(), {src[a + 0], src[a + 1], src[a + 2],
-                                   src[b + 0], src[b + 1], src[b + 2],
-                                   src[c + 0], src[c + 1], src[c + 2]});
-        }
+        // Appends a parsed chunk: its elements after those of the chunks
+        // before it, then its commands, against counts offset by those same
+        // chunks — so every index resolves exactly as it would have had the
+        // file been read line by line.
+        void merge(const Chunk& chunk) {
 
-        void addVertexPointOrLine(size_t a) {
+            const Counts before{vertices.size() / 3, uvs.size() / 2, normals.size() / 3, colors.size() / 3};
 
-            auto& src = vertices;
-            auto& dst = object->geometry.vertices;
+            vertices.insert(vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+            colors.insert(colors.end(), chunk.colors.begin(), chunk.colors.end());
+            uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
 
-            dst.insert(dst.end(), {src[a + 0], src[a + 1], src[a + 2]});
-        }
+            for (const auto& command : chunk.commands) {
 
-        void addNormal(size_t a, size_t b, size_t c) {
+                const Counts declared{before.vertices + command.declared.vertices,
+                                      before.uvs + command.declared.uvs,
+                                      before.normals + command.declared.normals,
+                                      before.colors + command.declared.colors};
 
-            auto& src = normals;
-            auto& dst = object->geometry.normals;
+                switch (command.op) {
 
-            dst.insert(dst.end(), {src[a + 0], src[a + 1], src[a + 2],
-                                   src[b + 0], src[b + 1], src[b + 2],
-                                   src[c + 0], src[c + 1], src[c + 2]});
-        }
+                    case Command::Op::Face: {
 
-        void addColor(size_t a, size_t b, size_t c) {
+                        const auto* corners = chunk.corners.data() + command.first;
+                        for (unsigned j = 1; j + 1 < command.count; ++j) {
+                            addFace(corners[0], corners[j], corners[j + 1], declared);
+                        }
+                        break;
+                    }
 
-            auto& src = colors;
-            auto& dst = object->geometry.colors;
+                    case Command::Op::Points:
+                        addPointGeometry(chunk.points.data() + command.first, command.count, declared);
+                        break;
 
-            dst.insert(dst.end(), {src[a + 0], src[a + 1], src[a + 2],
-                                   src[b + 0], src[b + 1], src[b + 2],
-                                   src[c + 0], src[c + 1], src[c + 2]});
-        }
+                    case Command::Op::Object:
+                        startObject(std::string(command.text));
+                        break;
 
-        void addUv(size_t a, size_t b, size_t c) {
+                    case Command::Op::UseMtl:
+                        object->startMaterial(std::string(command.text), materialLibraries);
+                        break;
 
-            auto& src = uvs;
-            auto& dst = object->geometry.uvs;
+                    case Command::Op::MtlLib:
+                        materialLibraries.emplace_back(command.text);
+                        break;
 
-            dst.insert(dst.end(), {src[a + 0], src[a + 1],
-                                   src[b + 0], src[b + 1],
-                                   src[c + 0], src[c + 1]});
-        }
+                    case Command::Op::Smooth: {
 
-        void addUvLine(size_t a) {
+                        object->smooth = command.smooth;
 
-            auto& src = uvs;
-            auto& dst = object->geometry.uvs;
+                        auto material = object->currentMaterial();
+                        if (material) {
+                            material->smooth = object->smooth;
+                        }
+                        break;
+                    }
 
-            dst.insert(dst.end(), {src[a + 0], src[a + 1]});
+                    case Command::Op::Unexpected:
+                        std::cerr << "[OBJLoader] Unexpected line: " << command.text << ":" << command.text.size() << std::endl;
+                        break;
+                }
+            }
         }
 
-        void addFace(const std::string& a, const std::string& b, const std::string& c,
-                     const std::string& ua, const std::string& ub, const std::string& uc,
-                     const std::string& na, const std::string& nb, const std::string& nc) {
+    private:
+        void addFace(const std::array<int32_t, 3>& a, const std::array<int32_t, 3>& b, const std::array<int32_t, 3>& c,
+                     const Counts& declared) {
 
             // Resolve EVERY index before appending anything. The per-vertex
             // arrays (vertices/uvs/normals/colors) are written in parallel, so
             // emitting a vertex and then bailing on a bad uv would leave them
             // permanently out of step. A face with any unresolvable index is
             // dropped whole instead.
-            const auto vLen = vertices.size();
-            const auto ia = parseVertexOrNormalIndex(a, vLen);
-            const auto ib = parseVertexOrNormalIndex(b, vLen);
-            const auto ic = parseVertexOrNormalIndex(c, vLen);
+            const auto ia = resolveIndex(a[0], declared.vertices);
+            const auto ib = resolveIndex(b[0], declared.vertices);
+            const auto ic = resolveIndex(c[0], declared.vertices);
             if (!ia || !ib || !ic) {
                 ++badIndexCount;
                 return;
             }
 
+            // Whether the face has uvs/normals is the first corner's call.
             std::optional<size_t> ta, tb, tc;
-            if (!ua.empty()) {
-                const auto uvLen = uvs.size();
-                ta = parseUvIndex(ua, uvLen);
-                tb = parseUvIndex(ub, uvLen);
-                tc = parseUvIndex(uc, uvLen);
+            if (a[1] != absent) {
+                ta = resolveIndex(a[1], declared.uvs);
+                tb = resolveIndex(b[1], declared.uvs);
+                tc = resolveIndex(c[1], declared.uvs);
                 if (!ta || !tb || !tc) {
                     ++badIndexCount;
                     return;
@@ -285,50 +534,48 @@ namespace {
             }
 
             std::optional<size_t> nia, nib, nic;
-            if (!na.empty()) {
-                const auto nLen = normals.size();
-                nia = parseVertexOrNormalIndex(na, nLen);
-                nib = (na == nb) ? nia : parseVertexOrNormalIndex(nb, nLen);
-                nic = (na == nc) ? nia : parseVertexOrNormalIndex(nc, nLen);
+            if (a[2] != absent) {
+                nia = resolveIndex(a[2], declared.normals);
+                nib = resolveIndex(b[2], declared.normals);
+                nic = resolveIndex(c[2], declared.normals);
                 if (!nia || !nib || !nic) {
                     ++badIndexCount;
                     return;
                 }
             }
 
-            // Vertex colors come from a 6-float `v` line, so they are addressed
-            // by the VERTEX index at stride 3 — not by whatever ia/ib/ic held
-            // after the uv block above reassigned them at stride 2.
+            // Vertex colors come from a 6-float `v` line, so they are
+            // addressed by the VERTEX index, resolved against the colors
+            // declared so far.
             std::optional<size_t> ca, cb, cc;
-            if (!colors.empty()) {
-                const auto cLen = colors.size();
-                ca = resolveIndex(a, cLen, 3);
-                cb = resolveIndex(b, cLen, 3);
-                cc = resolveIndex(c, cLen, 3);
+            if (declared.colors > 0) {
+                ca = resolveIndex(a[0], declared.colors);
+                cb = resolveIndex(b[0], declared.colors);
+                cc = resolveIndex(c[0], declared.colors);
                 if (!ca || !cb || !cc) {
                     ++badIndexCount;
                     return;
                 }
             }
 
-            addVertex(*ia, *ib, *ic);
-            if (ta) addUv(*ta, *tb, *tc);
-            if (nia) addNormal(*nia, *nib, *nic);
-            if (ca) addColor(*ca, *cb, *cc);
+            auto& geometry = object->geometry;
+            appendTriangle<3>(geometry.vertices, vertices, *ia, *ib, *ic);
+            if (ta) appendTriangle<2>(geometry.uvs, uvs, *ta, *tb, *tc);
+            if (nia) appendTriangle<3>(geometry.normals, normals, *nia, *nib, *nic);
+            if (ca) appendTriangle<3>(geometry.colors, colors, *ca, *cb, *cc);
         }
 
-        void addPointGeometry(const std::vector<std::string>& verts) {
+        void addPointGeometry(const int32_t* indices, size_t count, const Counts& declared) {
 
             object->geometry.type = "Points";
 
-            // Indices address the accumulated vertex array, not this line's
-            // token list — `verts.size()` here silently mis-resolved every
-            // negative (relative) index.
-            const auto vLen = vertices.size();
-
-            for (const auto& v : verts) {
-                if (const auto i = parseVertexOrNormalIndex(v, vLen)) {
-                    addVertexPointOrLine(*i);
+            // Indices address the vertices declared so far, not this line's
+            // token list.
+            auto& dst = object->geometry.vertices;
+            for (size_t k = 0; k < count; ++k) {
+                if (const auto i = resolveIndex(indices[k], declared.vertices)) {
+                    dst.insert(dst.end(), vertices.begin() + static_cast<std::ptrdiff_t>(*i * 3),
+                               vertices.begin() + static_cast<std::ptrdiff_t>(*i * 3 + 3));
                 } else {
                     ++badIndexCount;
                 }
@@ -363,7 +610,6 @@ struct OBJLoader::Impl {
             return nullptr;
         }
 
-        std::ifstream in(path);
 
         if (tryLoadMtl) {
             std::filesystem::path mtlFile{path.parent_path() / (path.stem().string() + ".mtl")};
@@ -373,134 +619,43 @@ struct OBJLoader::Impl {
             }
         }
 
-        ParserState state;
-
-        std::string line;
-        while (std::getline(in, line)) {
-            utils::trimInplace(line);
-
-            auto lineLength = line.size();
+        std::optional<utils::MappedFile> file;
+        try {
 
-            if (lineLength == 0) continue;
-
-            auto lineFirstChar = line.front();
-
-            if (lineFirstChar == '#') continue;
-
-            if (lineFirstChar == 'v') {
-
-                auto data = utils::split(line, ' ');
-
-                if (data[0] == "v") {
-                    state.vertices.insert(state.vertices.end(), {utils::parseFloat(data[1]),
-                                                                 utils::parseFloat(data[2]),
-                                                                 utils::parseFloat(data[3])});
-
-                    if (data.size() == 8) {
-                        state.colors.insert(state.colors.end(), {utils::parseFloat(data[4]),
-                                                                 utils::parseFloat(data[5]),
-                                                                 utils::parseFloat(data[6])});
-                    }
-                } else if (data[0] == "vn") {
-                    state.normals.insert(state.normals.end(), {utils::parseFloat(data[1]),
-                                                               utils::parseFloat(data[2]),
-                                                               utils::parseFloat(data[3])});
-                } else if (data[0] == "vt") {
-                    state.uvs.insert(state.uvs.end(), {utils::parseFloat(data[1]),
-                                                       utils::parseFloat(data[2])});
-                }
-            } else if (lineFirstChar == 'f') {
+            file.emplace(path);
 
-                std::string lineData{line.begin() + 1, line.end()};
-                utils::trimInplace(lineData);
-                auto vertexData = utils::split(lineData, ' ');
-                std::vector<std::vector<std::string>> faceVertices;
+        } catch (const std::exception& e) {
 
-                for (const auto& vertex : vertexData) {
-
-                    if (!vertex.empty()) {
-                        auto vertexParts = utils::split(vertex, '/');
-                        faceVertices.insert(faceVertices.end(), vertexParts);
-                    }
-                }
-
-                // A face needs at least 3 vertices; skip malformed faces.
-                if (faceVertices.size() < 3) continue;
-
-                // A face-vertex token can be "v", "v/vt", "v//vn" or "v/vt/vn", so
-                // the uv (index 1) and normal (index 2) components may be absent.
-                // Substitute an empty string when missing — addFace() guards on
-                // emptiness — instead of indexing out of bounds.
-                auto part = [](const std::vector<std::string>& parts, size_t i) -> std::string {
-                    return i < parts.size() ? parts[i] : std::string{};
-                };
-
-                auto& v1 = faceVertices[0];
-
-                for (unsigned j = 1; j < faceVertices.size() - 1; ++j) {
-
-                    auto& v2 = faceVertices[j];
-                    auto& v3 = faceVertices[j + 1];
-
-                    state.addFace(v1[0], v2[0], v3[0],
-                                  part(v1, 1), part(v2, 1), part(v3, 1),
-                                  part(v1, 2), part(v2, 2), part(v3, 2));
-                }
-
-
-            } else if (lineFirstChar == 'l') {
-
-                // TODO
-
-            } else if (lineFirstChar == 'p') {
-
-                auto lineData = utils::trim(line.substr(1));
-                auto pointData = utils::split(lineData, ' ');
-
-                state.addPointGeometry(pointData);
-
-            } else if (lineFirstChar == 's') {
+            std::cerr << "[OBJLoader] " << e.what() << std::endl;
+            return nullptr;
+        }
 
-                auto result = utils::split(line, ' ');
+        ParserState state;
 
-                if (!result.empty()) {
+        const std::string_view text(reinterpret_cast<const char*>(file->data()), static_cast<size_t>(file->size()));
+        std::vector<Chunk> batch(std::max(1u, ThreadPool::global().concurrency()) * chunksPerLane);
 
-                    auto value = utils::trim(result[1]);
-                    utils::toLowerInplace(value);
-                    state.object->smooth = (value != "0" && value != "off");
+        size_t pos = 0;
+        while (pos < text.size()) {
 
+            size_t n = 0;
+            for (; n < batch.size() && pos < text.size(); ++n) {
+                auto end = pos + chunkSize;
+                if (end >= text.size()) {
+                    end = text.size();
                 } else {
-
-                    state.object->smooth = true;
-                }
-
-                auto material = state.object->currentMaterial();
-                if (material) {
-                    material->smooth = state.object->smooth;
+                    const auto newline = text.find('\n', end - 1);
+                    end = newline == std::string_view::npos ? text.size() : newline + 1;
                 }
+                batch[n].text = text.substr(pos, end - pos);
+                pos = end;
+            }
 
-            } else {
-                static std::regex r("^[og]\\s+(.*)");
-                std::smatch match;
-                if (std::regex_match(line, match, r)) {
-                    std::string name = utils::trim(match[1]);
-                    state.startObject(name);
-                    continue;
-                }
-                if (line.find("usemtl ") != std::string::npos) {
-                    state.object->startMaterial(utils::trim(line.substr(7)), state.materialLibraries);
-                    continue;
-                }
-                if (line.find("mtllib ") != std::string::npos) {
-                    state.materialLibraries.emplace_back(utils::trim(line.substr(7)));
-                    continue;
-                }
-
-
-                if (line == "\\0") continue;
+            parallelFor(0, n, 1, [&](size_t lo, size_t hi) {
+                for (auto i = lo; i < hi; ++i) batch[i].parse();
+            });
 
-                std::cerr << "[OBJLoader] Unexpected line: " << line << ":" << line.size() << std::endl;
-            }
+            for (size_t i = 0; i < n; ++i) state.merge(batch[i]);
         }
 
         state.finalize();
@@ -37,6 +37,8 @@
 #include "ObjectJsonConstants.hpp"
 #include "threepp/loaders/AssetSource.hpp"
 #include "threepp/utils/Base64.hpp"
+#include "threepp/utils/ContentHash.hpp"
+#include "threepp/utils/Parallel.hpp"
 #include "threepp/utils/ZipReader.hpp"
 #include "threepp/utils/ZipWriter.hpp"
 
@@ -55,6 +57,7 @@
 #include <map>
 #include <optional>
 #include <set>
+#include <span>
 #include <unordered_set>
 
 // ordered_json keeps object keys in insertion order, so the same scene always
@@ -65,6 +68,35 @@ using namespace threepp::objectjson;
 
 namespace {
 
+    // One archive member as the walk describes it: the bytes it is made of,
+    // and how they become the entry. Nothing is assembled or encoded until the
+    // walk is over (see addMembers), so a member the last save already wrote
+    // costs one pass of hashing, and the ones that changed encode side by side.
+    struct Member {
+        std::string name;
+        ZipWriter::Compression compression{ZipWriter::Compression::Stored};
+        // Hashed to recognise the member: views into the scene (attribute
+        // arrays, pixels) or into `owned`.
+        std::vector<std::span<const unsigned char>> content;
+        std::shared_ptr<const std::vector<unsigned char>> owned;
+        // Whatever else the entry depends on — an image's dimensions.
+        std::uint64_t salt{0};
+        // Makes the entry's bytes, or nothing when it cannot. Unset: the
+        // content, back to back.
+        std::function<std::optional<std::vector<unsigned char>>()> encode;
+    };
+
+    std::vector<unsigned char> concatenate(const std::vector<std::span<const unsigned char>>& pieces) {
+
+        std::size_t size = 0;
+        for (const auto& piece : pieces) size += piece.size();
+
+        std::vector<unsigned char> out;
+        out.reserve(size);
+        for (const auto& piece : pieces) out.insert(out.end(), piece.begin(), piece.end());
+        return out;
+    }
+
     // Collector for the shared, uuid-keyed top-level arrays. Insertion order is
     // scene-traversal order, which makes exports reproducible run to run.
     struct Meta {
@@ -74,8 +106,17 @@ namespace {
         std::filesystem::path resourcePath;
 
         // Non-null while writing a .tpz. Images and geometry become members of
-        // it and the JSON keeps a url where the bytes would have been.
+        // it and the JSON keeps a url where the bytes would have been; they are
+        // collected in `members` and only added once the walk is done.
         ZipWriter* archive{nullptr};
+        std::vector<Member> members;
+        ZipWriter::Compression bufferCompression{ZipWriter::Compression::Stored};
+
+        // GeometryEncoding::Base64 without an archive: the sections go into
+        // `buffers` (url -> data URI) instead, and from there into the
+        // document's top-level threeppBuffers.
+        bool embedBuffers{false};
+        json buffers = json::object();
 
         std::vector<json> geometries;
         std::vector<json> materials;
@@ -246,11 +287,28 @@ namespace {
         out->insert(out->end(), bytes, bytes + size);
     }
 
+    bool canEncodePng(const Image& image) {
+
+        const int channels = image.channels();
+        return channels >= 1 && channels <= 4 && image.width() > 0 && image.height() > 0;
+    }
+
+    // The pixels as they are stored, whatever their type.
+    std::span<const unsigned char> pixelBytes(const Image& image) {
+
+        const auto bytes = [](const auto& v) {
+            return std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(v.data()),
+                                                  v.size() * sizeof(v[0]));
+        };
+        if (image.isFloat()) return bytes(image.data<float>());
+        if (image.isHalfFloat()) return bytes(image.data<std::uint16_t>());
+        return bytes(image.data<unsigned char>());
+    }
+
     std::optional<std::vector<unsigned char>> encodePng(const Image& image) {
 
+        if (!canEncodePng(image)) return std::nullopt;
         const int channels = image.channels();
-        if (channels < 1 || channels > 4) return std::nullopt;
-        if (image.width() == 0 || image.height() == 0) return std::nullopt;
 
         std::vector<unsigned char> pixels;
         if (image.isFloat()) {
@@ -290,6 +348,15 @@ namespace {
         return "data:image/png;base64," + utils::base64Encode(*png);
     }
 
+    // A member whose bytes were read for it: they are the entry as they are.
+    Member ownedMember(std::string name, std::vector<unsigned char> bytes) {
+
+        auto owned = std::make_shared<const std::vector<unsigned char>>(std::move(bytes));
+        Member member{std::move(name), ZipWriter::Compression::Stored, {{owned->data(), owned->size()}}};
+        member.owned = std::move(owned);
+        return member;
+    }
+
     // The texture's source file, verbatim. An archive stores these bytes rather
     // than re-encoding the pixels: they are already compressed, in a format
     // chosen for the image, and a PNG round-trip through stb would be both
@@ -352,7 +419,7 @@ namespace {
             if (auto bytes = readFile(texture.sourceFile)) {
 
                 const auto name = base + texture.sourceFile.extension().generic_string();
-                meta.archive->add(name, std::move(*bytes));
+                meta.members.push_back(ownedMember(name, std::move(*bytes)));
                 entry["url"] = name;
                 return true;
             }
@@ -366,24 +433,34 @@ namespace {
         if (const auto& encoded = texture.encodedSource; !encoded.empty() && images.size() != 6) {
 
             const auto name = base + encoded.extension;
-            meta.archive->add(name, std::vector<unsigned char>{encoded.bytes->begin(), encoded.bytes->end()});
+            Member member{name, ZipWriter::Compression::Stored, {{encoded.bytes->data(), encoded.bytes->size()}}};
+            member.owned = encoded.bytes;
+            meta.members.push_back(std::move(member));
             entry["url"] = name;
             entry["flipY"] = encoded.flipY;
             return true;
         }
 
+        if (!std::all_of(images.begin(), images.end(), canEncodePng)) return false;
+
         json urls = json::array();
         for (std::size_t i = 0; i < images.size(); ++i) {
 
-            auto png = encodePng(images[i]);
-            if (!png) return false;
-
             // A cube map is six faces behind one texture, so the face index is
             // part of the name; a plain texture keeps the bare uuid.
             const auto name = images.size() == 6
                                       ? base + "-" + std::to_string(i) + ".png"
                                       : base + ".png";
-            meta.archive->add(name, std::move(*png));
+
+            // Encoded after the walk, and only if these pixels are not the
+            // ones the last save already encoded.
+            const auto& image = images[i];
+            Member member{name, ZipWriter::Compression::Stored, {pixelBytes(image)}};
+            member.salt = utils::hashCombine(utils::hashCombine(image.width(), image.height()),
+                                             static_cast<std::uint64_t>(image.channels()) << 2 |
+                                                     (image.isFloat() ? 1 : 0) | (image.isHalfFloat() ? 2 : 0));
+            member.encode = [&image] { return encodePng(image); };
+            meta.members.push_back(std::move(member));
             urls.push_back(name);
         }
 
@@ -793,8 +870,19 @@ namespace {
     // JSON numbers costs orders of magnitude more than a memcpy.
     struct BinarySink {
 
-        std::vector<unsigned char>& blob;
         const std::string& url;
+        // The section as the views it is made of — the attribute arrays
+        // themselves and the padding between them. Nothing is copied until the
+        // section is written out.
+        std::vector<std::span<const unsigned char>> pieces;
+        std::size_t size{0};
+
+        void append(std::span<const unsigned char> bytes) {
+
+            if (bytes.empty()) return;
+            pieces.push_back(bytes);
+            size += bytes.size();
+        }
     };
 
     // The bytes are the host's, unswapped. Every platform threepp builds for is
@@ -823,17 +911,17 @@ namespace {
         // trailing section cannot leave the blob longer than its own contents.
         // Every type here is 1, 2 or 4 bytes wide, so this is alignment enough
         // for a reader that memcpys.
-        while (sink->blob.size() % 4 != 0) sink->blob.push_back(0);
+        static constexpr unsigned char padding[4]{};
+        if (sink->size % 4 != 0) sink->append({padding, 4 - sink->size % 4});
 
         const auto& array = typed->array();
         const auto bytes = array.size() * sizeof(T);
 
         data["url"] = sink->url;
-        data["byteOffset"] = sink->blob.size();
+        data["byteOffset"] = sink->size;
         data["byteLength"] = bytes;
 
-        const auto* first = reinterpret_cast<const unsigned char*>(array.data());
-        sink->blob.insert(sink->blob.end(), first, first + bytes);
+        sink->append({reinterpret_cast<const unsigned char*>(array.data()), bytes});
 
         return true;
     }
@@ -1014,10 +1102,9 @@ namespace {
         // One section per geometry, named by uuid — which the exporter and the
         // loader both keep verbatim, so the name is stable across a round trip
         // and two saves of the same scene name the same member.
-        std::vector<unsigned char> blob;
         const std::string url = std::string(archiveBufferDir) + geometry.uuid + ".bin";
-        BinarySink sink{blob, url};
-        BinarySink* const into = meta.archive ? &sink : nullptr;
+        BinarySink sink{url};
+        BinarySink* const into = meta.archive || meta.embedBuffers ? &sink : nullptr;
 
         // The host-side index is always uint32 (BufferGeometry::index_ is an
         // IntBufferAttribute); the uint16 index buffers added in dce8acbb are a
@@ -1075,7 +1162,14 @@ namespace {
         // Empty when every attribute was skipped, and then there is nothing to
         // point a url at either — the entry would only be a name in the
         // directory promising bytes no attribute asks for.
-        if (into && !blob.empty()) meta.archive->add(url, std::move(blob));
+        if (into && sink.size > 0) {
+            if (meta.archive) {
+                meta.members.push_back({url, meta.bufferCompression, std::move(sink.pieces)});
+            } else {
+                meta.buffers[url] = "data:application/octet-stream;base64," +
+                                    utils::base64Encode(concatenate(sink.pieces));
+            }
+        }
 
         meta.geometries.push_back(data);
 
@@ -1277,6 +1371,61 @@ namespace {
         return out;
     }
 
+    // ------------------------------------------------ incremental archive saves
+
+    // Member name -> content hash, and whether deflate was asked for it.
+    using MemberHashes = std::unordered_map<std::string, std::pair<std::uint64_t, bool>>;
+
+    // Hands the walk's members to the archive. Each is hashed; one whose hash
+    // and compression match what `previous` was written with is copied out of
+    // it as stored, and the rest are assembled or encoded — one member per
+    // task. The writer then checksums and deflates only what it got fresh.
+    void addMembers(Meta& meta, ZipWriter& archive, const std::shared_ptr<const ZipReader>& previous,
+                    const MemberHashes& before, MemberHashes& after) {
+
+        auto& members = meta.members;
+        std::vector<std::uint64_t> hashes(members.size());
+        std::vector<char> reuse(members.size(), 0);
+        std::vector<std::optional<std::vector<unsigned char>>> encoded(members.size());
+
+        parallelFor(0, members.size(), 1, [&](std::size_t lo, std::size_t hi) {
+            for (auto i = lo; i < hi; ++i) {
+
+                const auto& member = members[i];
+                auto hash = member.salt;
+                for (const auto& piece : member.content) hash = utils::contentHash(piece.data(), piece.size(), hash);
+                hashes[i] = hash;
+
+                const bool deflate = member.compression == ZipWriter::Compression::Deflate;
+                if (previous) {
+                    const auto it = before.find(member.name);
+                    if (it != before.end() && it->second == std::pair{hash, deflate} && previous->has(member.name)) {
+                        reuse[i] = 1;
+                        continue;
+                    }
+                }
+
+                encoded[i] = member.encode ? member.encode() : concatenate(member.content);
+            }
+        });
+
+        for (std::size_t i = 0; i < members.size(); ++i) {
+
+            const auto& member = members[i];
+            if (reuse[i]) {
+                archive.copy(member.name, previous, member.name);
+            } else if (encoded[i]) {
+                archive.add(member.name, std::move(*encoded[i]), member.compression);
+            } else {
+                meta.warn("cannot encode '" + member.name + "' - it is missing from the archive");
+                continue;
+            }
+            after[member.name] = {hashes[i], member.compression == ZipWriter::Compression::Deflate};
+        }
+
+        members.clear();
+    }
+
     // ------------------------------------------------ linked assets in an archive
 
     // Copies every linked asset the archive is allowed to carry into it, and
@@ -1337,7 +1486,7 @@ namespace {
             if (fromArchive && !taken.contains(entryName)) name = entryName;
 
             taken.insert(name);
-            meta.archive->add(name, std::move(*bytes));
+            meta.members.push_back(ownedMember(name, std::move(*bytes)));
             meta.assetEntries[source] = name;
         }
     }
@@ -1623,7 +1772,8 @@ std::string ObjectExporter::toJson(Object3D& object, const ObjectExporterOptions
     return write(object, options, nullptr);
 }
 
-std::string ObjectExporter::write(Object3D& object, const ObjectExporterOptions& options, ZipWriter* archive) {
+std::string ObjectExporter::write(Object3D& object, const ObjectExporterOptions& options, ZipWriter* archive,
+                                  ArchiveManifest* manifest) {
 
     warnings_.clear();
 
@@ -1632,6 +1782,8 @@ std::string ObjectExporter::write(Object3D& object, const ObjectExporterOptions&
     meta.modelStorage = options.models;
     meta.resourcePath = options.resourcePath;
     meta.archive = archive;
+    if (options.compressArchive) meta.bufferCompression = ZipWriter::Compression::Deflate;
+    meta.embedBuffers = !archive && options.geometry == GeometryEncoding::Base64;
 
     // Before the walk: the asset entry names are numbered over the whole
     // scene's sources, and writeObject only ever sees one subtree at a time.
@@ -1673,9 +1825,40 @@ std::string ObjectExporter::write(Object3D& object, const ObjectExporterOptions&
     if (!meta.images.empty()) output["images"] = meta.images;
     if (!meta.skeletons.empty()) output["skeletons"] = meta.skeletons;
     if (!meta.animations.empty()) output["animations"] = meta.animations;
+    if (!meta.buffers.empty()) output[embeddedBuffers] = meta.buffers;
 
     output["object"] = objectJson;
 
+    if (archive) {
+
+        // The archive the last save() wrote to this same path — as long as the
+        // file is still exactly what was written there, and mapped, so copying
+        // out of it does not mean reading all of it first.
+        std::shared_ptr<const ZipReader> previous;
+        if (manifest && manifest->path == lastArchive_.path && !lastArchive_.members.empty()) {
+
+            std::error_code sizeError, timeError;
+            const auto size = std::filesystem::file_size(manifest->path, sizeError);
+            const auto time = std::filesystem::last_write_time(manifest->path, timeError);
+            if (!sizeError && !timeError && size == lastArchive_.size && time == lastArchive_.time) {
+
+                try {
+
+                    auto reader = std::make_shared<const ZipReader>(manifest->path);
+                    if (reader->mapped()) previous = std::move(reader);
+
+                } catch (const std::exception&) {
+                    // Not an archive any more: a full save, which is what it would
+                    // have been without the manifest.
+                }
+            }
+        }
+
+        MemberHashes written;
+        addMembers(meta, *archive, previous, lastArchive_.members, written);
+        if (manifest) manifest->members = std::move(written);
+    }
+
     warnings_ = std::move(meta.warnings);
 
     return options.prettyPrint ? output.dump(2) : output.dump();
@@ -1699,14 +1882,25 @@ void ObjectExporter::save(Object3D& object, const std::filesystem::path& path, c
 
         ZipWriter zip;
 
+        ArchiveManifest manifest;
+        manifest.path = std::filesystem::absolute(path);
+
         // The document is added last though the writer's fixed order puts it
         // first in the file: producing it is what fills the archive with
         // everything the urls in it point at.
-        const auto document = write(object, resolved, &zip);
-        zip.add(archiveDocument, document);
+        const auto document = write(object, resolved, &zip, &manifest);
+        zip.add(archiveDocument, document,
+                resolved.compressArchive ? ZipWriter::Compression::Deflate : ZipWriter::Compression::Stored);
 
         zip.writeTo(path);
 
+        // Stamped after the rename: what the next save checks is that nothing
+        // has touched the file since.
+        std::error_code ec;
+        manifest.size = std::filesystem::file_size(path, ec);
+        if (!ec) manifest.time = std::filesystem::last_write_time(path, ec);
+        lastArchive_ = ec ? ArchiveManifest{} : std::move(manifest);
+
         return;
     }
 
@@ -161,6 +161,11 @@ namespace threepp::objectjson {
     // stored once.
     inline constexpr const char* archiveAssetDir = "assets/";
 
+    // The same sections, carried in a plain JSON document instead
+    // (GeometryEncoding::Base64): a top-level object mapping each buffers/ url
+    // to a base64 data URI. Looked up before the archive or the directory.
+    inline constexpr const char* embeddedBuffers = "threeppBuffers";
+
     // What ObjectLoader stamps on a subtree it re-imported OUT of an archive:
     // "<absolute archive path>|<entry name>". The '|' is the whole trick — it
     // cannot occur in a Windows path — so an exporter can always tell a mark
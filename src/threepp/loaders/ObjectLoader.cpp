@@ -45,6 +45,7 @@
 #include "threepp/objects/Sprite.hpp"
 #include "threepp/scenes/Scene.hpp"
 #include "threepp/textures/CubeTexture.hpp"
+#include "threepp/utils/FileBytes.hpp"
 
 #include "ObjectJsonConstants.hpp"
 #include "threepp/utils/Base64.hpp"
@@ -59,7 +60,9 @@
 #include <iostream>
 #include <limits>
 #include <optional>
+#include <span>
 #include <unordered_map>
+#include <variant>
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
@@ -95,6 +98,314 @@ namespace {
         return j.at(key).get<T>();
     }
 
+    // ------------------------------------------------------------- the parse
+    //
+    // A document's bulk is its geometry: every vertex a JSON number, and every
+    // number a DOM node of its own — 16 bytes plus an allocation's worth of
+    // bookkeeping for a 4-byte float, built only to be copied out of again by
+    // get<std::vector<float>>(). The parse is therefore SAX, driving a DOM
+    // builder for everything except the arrays of numbers under
+    // geometries[*].data, which go straight into a vector of the type their
+    // entry declares. The DOM keeps the entry with its array
+    // replaced by capturedArrayKey: an index into the side table.
+    //
+    // An entry's "type" normally comes before its "array" (three.js and
+    // ObjectExporter both write it that way); when it does not, the numbers are
+    // held as doubles — exact for every type an attribute can have — and
+    // converted when the type is known. An array that turns out to hold
+    // anything other than numbers is handed back to the DOM as it was.
+    using NumberArray = std::variant<std::vector<float>, std::vector<unsigned int>,
+                                     std::vector<std::uint16_t>, std::vector<std::int16_t>,
+                                     std::vector<std::uint8_t>, std::vector<std::int8_t>,
+                                     std::vector<double>>;
+
+    constexpr const char* capturedArrayKey = "threeppArrayId";
+
+    NumberArray numberArrayFor(const std::string& type) {
+
+        if (type == "Float32Array") return std::vector<float>{};
+        if (type == "Uint32Array") return std::vector<unsigned int>{};
+        if (type == "Uint16Array") return std::vector<std::uint16_t>{};
+        if (type == "Int16Array") return std::vector<std::int16_t>{};
+        if (type == "Uint8Array" || type == "Uint8ClampedArray") return std::vector<std::uint8_t>{};
+        if (type == "Int8Array") return std::vector<std::int8_t>{};
+        return std::vector<double>{};
+    }
+
+    // The plain DOM half of DocumentSax. nlohmann's own builder is in its
+    // detail namespace and may change under us, so this one is written
+    // against the public json_sax interface instead: values go into the
+    // innermost open container, and a repeated key keeps its last value, as
+    // json::parse does.
+    class DomBuilder final: public nlohmann::json_sax<json> {
+
+    public:
+        explicit DomBuilder(json& root): root_(root) {}
+
+        bool null() override {
+            place(nullptr);
+            return true;
+        }
+
+        bool boolean(bool v) override {
+            place(v);
+            return true;
+        }
+
+        bool number_integer(number_integer_t v) override {
+            place(v);
+            return true;
+        }
+
+        bool number_unsigned(number_unsigned_t v) override {
+            place(v);
+            return true;
+        }
+
+        bool number_float(number_float_t v, const string_t&) override {
+            place(v);
+            return true;
+        }
+
+        bool string(string_t& s) override {
+            place(std::move(s));
+            return true;
+        }
+
+        bool binary(binary_t& b) override {
+            place(std::move(b));
+            return true;
+        }
+
+        bool start_object(std::size_t) override {
+            open_.push_back(place(json::object()));
+            return true;
+        }
+
+        bool key(string_t& k) override {
+            member_ = &(*open_.back())[k];
+            return true;
+        }
+
+        bool end_object() override {
+            open_.pop_back();
+            return true;
+        }
+
+        bool start_array(std::size_t) override {
+            open_.push_back(place(json::array()));
+            return true;
+        }
+
+        bool end_array() override {
+            open_.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::json::exception&) override {
+            errored_ = true;
+            return false;
+        }
+
+        [[nodiscard]] bool is_errored() const {
+            return errored_;
+        }
+
+    private:
+        json& root_;
+        std::vector<json*> open_;
+        json* member_ = nullptr;
+        bool errored_ = false;
+
+        json* place(json&& v) {
+            if (open_.empty()) {
+                root_ = std::move(v);
+                return &root_;
+            }
+            auto& parent = *open_.back();
+            if (parent.is_array()) {
+                parent.push_back(std::move(v));
+                return &parent.back();
+            }
+            *member_ = std::move(v);
+            return member_;
+        }
+    };
+
+    class DocumentSax {
+
+    public:
+        DocumentSax(json& root, std::vector<NumberArray>& arrays): dom_(root), arrays_(arrays) {}
+
+        bool null() {
+            return flush() && dom_.null();
+        }
+
+        bool boolean(bool v) {
+            return flush() && dom_.boolean(v);
+        }
+
+        bool number_integer(json::number_integer_t v) {
+            if (capturing_) return push(v);
+            return flush() && dom_.number_integer(v);
+        }
+
+        bool number_unsigned(json::number_unsigned_t v) {
+            if (capturing_) return push(v);
+            return flush() && dom_.number_unsigned(v);
+        }
+
+        bool number_float(json::number_float_t v, const json::string_t& s) {
+            if (capturing_) return push(v);
+            return flush() && dom_.number_float(v, s);
+        }
+
+        bool string(json::string_t& s) {
+            if (!flush()) return false;
+            // Only the innermost object's own "type" is wanted; a string
+            // inside an array has no key of its own.
+            if (!frames_.empty() && frames_.back().object && frames_.back().key == "type") frames_.back().type = s;
+            return dom_.string(s);
+        }
+
+        bool binary(json::binary_t& b) {
+            return flush() && dom_.binary(b);
+        }
+
+        bool start_object(std::size_t n) {
+            if (!flush()) return false;
+            open(true);
+            return dom_.start_object(n);
+        }
+
+        bool key(json::string_t& k) {
+            if (!flush()) return false;
+            frames_.back().key = k;
+            if (k == "array" && capturable()) {
+                pendingArray_ = true;
+                return true;
+            }
+            return dom_.key(k);
+        }
+
+        bool end_object() {
+            if (!flush()) return false;
+            frames_.pop_back();
+            return dom_.end_object();
+        }
+
+        bool start_array(std::size_t n) {
+            if (pendingArray_) {
+                pendingArray_ = false;
+                capturing_ = true;
+                current_ = numberArrayFor(frames_.back().type);
+                open(false);
+                return true;
+            }
+            if (!flush()) return false;
+            open(false);
+            return dom_.start_array(n);
+        }
+
+        bool end_array() {
+            if (capturing_) {
+                capturing_ = false;
+                frames_.pop_back();
+                json::string_t k = capturedArrayKey;
+                const auto id = arrays_.size();
+                arrays_.push_back(std::move(current_));
+                return dom_.key(k) && dom_.number_unsigned(id);
+            }
+            if (!flush()) return false;
+            frames_.pop_back();
+            return dom_.end_array();
+        }
+
+        template<class Exception>
+        bool parse_error(std::size_t position, const std::string& token, const Exception& e) {
+            return dom_.parse_error(position, token, e);
+        }
+
+        [[nodiscard]] bool is_errored() const {
+            return dom_.is_errored();
+        }
+
+    private:
+        struct Frame {
+            std::string opened;// the key this container is the value of; empty in an array
+            std::string key;   // the member being read, in an object
+            std::string type;  // the object's "type", once seen
+            bool object;
+        };
+
+        DomBuilder dom_;
+        std::vector<NumberArray>& arrays_;
+
+        std::vector<Frame> frames_;
+        bool pendingArray_ = false;
+        bool capturing_ = false;
+        NumberArray current_;
+
+        void open(bool object) {
+            const bool inObject = !frames_.empty() && frames_.back().object;
+            frames_.push_back({inObject ? frames_.back().key : std::string(), {}, {}, object});
+        }
+
+        // geometries[*].data.index.array, .attributes.<name>.array and
+        // .morphAttributes.<name>[*].array, counting the root object as the
+        // first frame. Nothing else: an "array" in userData means whatever its
+        // owner meant by it.
+        [[nodiscard]] bool capturable() const {
+            const auto n = frames_.size();
+            if (n < 5 || frames_[1].opened != "geometries" || frames_[3].opened != "data") return false;
+            if (n == 5) return frames_[4].opened == "index";
+            if (n == 6) return frames_[4].opened == "attributes";
+            if (n == 7) return frames_[4].opened == "morphAttributes" && frames_[6].opened.empty();
+            return false;
+        }
+
+        template<class V>
+        bool push(V v) {
+            std::visit([v](auto& out) {
+                using T = typename std::decay_t<decltype(out)>::value_type;
+                out.push_back(static_cast<T>(v));
+            },
+                       current_);
+            return true;
+        }
+
+        // Resolves a deferred "array" key now that the next event is known not
+        // to open an array of numbers — or, mid-capture, hands everything
+        // captured so far to the DOM and lets the rest of the array follow.
+        bool flush() {
+            json::string_t k = "array";
+            if (pendingArray_) {
+                pendingArray_ = false;
+                return dom_.key(k);
+            }
+            if (!capturing_) return true;
+
+            capturing_ = false;
+            bool ok = dom_.key(k);
+            std::visit([&](const auto& values) {
+                ok = ok && dom_.start_array(values.size());
+                for (const auto v : values) {
+                    using T = std::decay_t<decltype(v)>;
+                    if constexpr (std::is_floating_point_v<T>) {
+                        ok = ok && dom_.number_float(v, {});
+                    } else if constexpr (std::is_signed_v<T>) {
+                        ok = ok && dom_.number_integer(v);
+                    } else {
+                        ok = ok && dom_.number_unsigned(v);
+                    }
+                }
+            },
+                       current_);
+            current_ = {};
+            return ok;
+        }
+    };
+
     // ------------------------------------------------------------ resolution
     //
     // Where a `url` in the document resolves from. A document is either a file
@@ -106,10 +417,24 @@ namespace {
     // ImageLoader's path-taking overload, which sniffs its own file (see
     // decodeImage): handing it bytes instead would change behaviour for every
     // document that ever referenced an image by path.
+    //
+    // A stored member of an archive is a view into the archive's mapping; a
+    // deflated member and a file next to the document have to land somewhere,
+    // and are owned (see FileBytes).
+
     struct DocumentSource {
 
         std::filesystem::path resourcePath;
         const ZipReader* archive{nullptr};
+        // The document's threeppBuffers object, if it has one.
+        const json* embedded{nullptr};
+
+        [[nodiscard]] const std::string* embeddedUri(const std::string& url) const {
+
+            if (!embedded || !embedded->is_object()) return nullptr;
+            const auto it = embedded->find(url);
+            return it != embedded->end() && it->is_string() ? it->get_ptr<const std::string*>() : nullptr;
+        }
 
         [[nodiscard]] bool has(const std::string& url) const {
 
@@ -119,12 +444,19 @@ namespace {
             return !resourcePath.empty() && std::filesystem::is_regular_file(resourcePath / url, ec);
         }
 
-        [[nodiscard]] std::optional<std::vector<unsigned char>> read(const std::string& url) const {
+        [[nodiscard]] std::optional<FileBytes> read(const std::string& url) const {
+
+            if (const auto* uri = embeddedUri(url)) {
+
+                const auto comma = uri->find(',');
+                if (comma == std::string::npos) return std::nullopt;
+                return FileBytes{utils::base64Decode(std::string_view(*uri).substr(comma + 1)), {}};
+            }
 
             if (archive) {
 
                 if (!archive->has(url)) return std::nullopt;
-                return archive->read(url);
+                return archive->bytes(url);
             }
 
             const auto path = resourcePath.empty() ? fs::path(url) : resourcePath / url;
@@ -143,23 +475,55 @@ namespace {
                 if (in.gcount() != end) return std::nullopt;
             }
 
-            return bytes;
+            return FileBytes{std::move(bytes), {}};
         }
     };
 
     // The binary sections geometry attributes point into, read once each. A
     // geometry's attributes and its index all name the same section, so without
-    // this a mesh with five attributes would read (and, in an archive, copy out
-    // of the loaded archive) the same megabytes five times over.
+    // this a mesh with five attributes would read the same megabytes five times
+    // over. (An archive's stored sections are views into its mapping and cost
+    // nothing to hold; a deflated one is inflated once and held here until the
+    // load ends, and a directory's are read in whole.)
     //
     // A section that cannot be read is remembered as absent, so the warning is
     // one per section rather than one per attribute.
     class BufferCache {
 
     public:
-        explicit BufferCache(const DocumentSource& source): source_(source) {}
+        BufferCache(const DocumentSource& source, std::vector<NumberArray>& arrays)
+            : source_(source), arrays_(arrays) {}
+
+        // The numbers of an entry's array as T: moved out of the side table
+        // when the parse captured them, read out of the DOM when it did not.
+        // Each captured array is taken once — every entry is parsed once.
+        template<class T>
+        std::vector<T> numbers(const json& j) {
+
+            if (const auto it = j.find(capturedArrayKey); it != j.end()) {
+
+                const auto id = it->get<std::size_t>();
+                if (id >= arrays_.size()) return {};
+
+                return std::visit([](auto& captured) {
+                    using V = typename std::decay_t<decltype(captured)>::value_type;
+                    if constexpr (std::is_same_v<V, T>) {
+                        return std::move(captured);
+                    } else {
+                        std::vector<T> out(captured.size());
+                        std::transform(captured.begin(), captured.end(), out.begin(),
+                                       [](V v) { return static_cast<T>(v); });
+                        return out;
+                    }
+                },
+                                  arrays_[id]);
+            }
+
+            const auto it = j.find("array");
+            return it != j.end() ? it->template get<std::vector<T>>() : std::vector<T>{};
+        }
 
-        const std::vector<unsigned char>* get(const std::string& url, Warnings& warnings) {
+        const FileBytes* get(const std::string& url, Warnings& warnings) {
 
             const auto it = sections_.find(url);
             if (it != sections_.end()) return it->second ? &*it->second : nullptr;
@@ -173,7 +537,8 @@ namespace {
 
     private:
         const DocumentSource& source_;
-        std::unordered_map<std::string, std::optional<std::vector<unsigned char>>> sections_;
+        std::vector<NumberArray>& arrays_;
+        std::unordered_map<std::string, std::optional<FileBytes>> sections_;
     };
 
     // The bytes of one `url`/`byteOffset`/`byteLength` window, or nothing.
@@ -195,11 +560,13 @@ namespace {
 
         // Subtraction rather than offset + length, so a length near the 64-bit
         // ceiling cannot wrap the comparison.
-        if (offset > section->size() || length > section->size() - offset) {
+        const auto bytes = section->view();
+        const std::uint64_t size = bytes.size();
+        if (offset > size || length > size - offset) {
 
             warnings.add("attribute claims " + std::to_string(length) + " bytes at offset " +
                          std::to_string(offset) + " of '" + url + "', which is " +
-                         std::to_string(section->size()) + " bytes - skipped");
+                         std::to_string(size) + " bytes - skipped");
             return nullptr;
         }
 
@@ -214,7 +581,7 @@ namespace {
 
         count = static_cast<std::size_t>(length / elementSize);
 
-        return section->data() + offset;
+        return reinterpret_cast<const unsigned char*>(bytes.data()) + offset;
     }
 
     template<class T>
@@ -333,9 +700,7 @@ namespace {
             // name: a document inside an archive may still reference a file
             // outside it, and that url means what it always meant.
             if (source.archive && source.archive->has(u)) {
-                auto bytes = source.read(u);
-                if (!bytes) return std::nullopt;
-                return loader.load(*bytes, channels, hasOverride ? override : true);
+                return loader.load(source.archive->bytes(u).view(), channels, hasOverride ? override : true);
             }
             return loader.load(source.resourcePath.empty() ? fs::path(u) : source.resourcePath / u, channels,
                                hasOverride ? override : true);
@@ -757,10 +1122,15 @@ namespace {
 
     // ---------------------------------------------------------- geometries
 
+    bool hasNumbers(const json& j) {
+
+        return j.contains("array") || j.contains(capturedArrayKey);
+    }
+
     template<class T>
-    std::shared_ptr<BufferAttribute> makeAttribute(const json& array, int itemSize, bool normalized) {
+    std::shared_ptr<BufferAttribute> makeAttribute(const json& j, int itemSize, bool normalized, BufferCache& buffers) {
 
-        return TypedBufferAttribute<T>::create(array.get<std::vector<T>>(), itemSize, normalized);
+        return TypedBufferAttribute<T>::create(buffers.numbers<T>(j), itemSize, normalized);
     }
 
     // The `url` form: the numbers are in a binary section instead of the JSON.
@@ -792,7 +1162,7 @@ namespace {
         // Only the six types with an exact threepp counterpart can be read
         // straight out of a section; the two that are widened (Float64Array,
         // Int32Array) have no binary form because nothing writes one.
-        if (!j.contains("array") && j.contains("url")) {
+        if (!hasNumbers(j) && j.contains("url")) {
 
             std::shared_ptr<BufferAttribute> binary;
 
@@ -820,38 +1190,37 @@ namespace {
             return binary;
         }
 
-        if (!j.contains("array")) return nullptr;
-        const auto& array = j["array"];
+        if (!hasNumbers(j)) return nullptr;
 
         std::shared_ptr<BufferAttribute> attribute;
 
         if (type == "Float32Array") {
-            attribute = makeAttribute<float>(array, itemSize, normalized);
+            attribute = makeAttribute<float>(j, itemSize, normalized, buffers);
         } else if (type == "Uint32Array") {
-            attribute = makeAttribute<unsigned int>(array, itemSize, normalized);
+            attribute = makeAttribute<unsigned int>(j, itemSize, normalized, buffers);
         } else if (type == "Uint16Array") {
-            attribute = makeAttribute<std::uint16_t>(array, itemSize, normalized);
+            attribute = makeAttribute<std::uint16_t>(j, itemSize, normalized, buffers);
         } else if (type == "Int16Array") {
-            attribute = makeAttribute<std::int16_t>(array, itemSize, normalized);
+            attribute = makeAttribute<std::int16_t>(j, itemSize, normalized, buffers);
         } else if (type == "Uint8Array" || type == "Uint8ClampedArray") {
             // Uint8ClampedArray differs from Uint8Array only in how JS coerces
             // out-of-range writes; the stored bytes are identical, so this is exact.
-            attribute = makeAttribute<std::uint8_t>(array, itemSize, normalized);
+            attribute = makeAttribute<std::uint8_t>(j, itemSize, normalized, buffers);
         } else if (type == "Int8Array") {
-            attribute = makeAttribute<std::int8_t>(array, itemSize, normalized);
+            attribute = makeAttribute<std::int8_t>(j, itemSize, normalized, buffers);
 
         } else if (type == "Float64Array") {
             // No 64-bit attribute type in threepp. Float32 is the least-lossy
             // target: it keeps sign and magnitude, losing only mantissa bits.
             warnings.add("attribute type 'Float64Array' has no threepp counterpart - "
                          "narrowed to Float32Array (double-precision mantissa bits are lost)");
-            attribute = makeAttribute<float>(array, itemSize, normalized);
+            attribute = makeAttribute<float>(j, itemSize, normalized, buffers);
 
         } else if (type == "Int32Array") {
             // No signed 32-bit attribute type. Two candidate widenings, neither
             // lossless in general, so pick per data: UInt32 keeps all 32 bits but
             // misreads negatives, Float32 keeps the sign but is only exact to 2^24.
-            const auto values = array.get<std::vector<std::int64_t>>();
+            const auto values = buffers.numbers<std::int64_t>(j);
             const bool anyNegative = std::any_of(values.begin(), values.end(),
                                                  [](std::int64_t v) { return v < 0; });
 
@@ -874,7 +1243,7 @@ namespace {
 
         } else {
             warnings.add("unknown attribute array type '" + type + "' - read as Float32Array");
-            attribute = makeAttribute<float>(array, itemSize, normalized);
+            attribute = makeAttribute<float>(j, itemSize, normalized, buffers);
         }
 
         if (j.contains("usage")) attribute->setUsage(static_cast<DrawUsage>(j["usage"].get<int>()));
@@ -914,8 +1283,8 @@ namespace {
         if (data.contains("index")) {
 
             const auto& index = data["index"];
-            if (index.contains("array")) {
-                geometry->setIndex(index["array"].get<std::vector<unsigned int>>());
+            if (hasNumbers(index)) {
+                geometry->setIndex(buffers.numbers<unsigned int>(index));
             } else if (index.contains("url")) {
                 if (auto indices = parseBinaryIndex(index, buffers, warnings)) {
                     geometry->setIndex(std::move(*indices));
@@ -1648,7 +2017,7 @@ namespace {
     class TempAsset {
 
     public:
-        explicit TempAsset(const std::string& entry, const std::vector<unsigned char>& bytes) {
+        explicit TempAsset(const std::string& entry, std::span<const std::byte> bytes) {
 
             const std::filesystem::path name{entry};
             path_ = std::filesystem::temp_directory_path() /
@@ -1727,7 +2096,8 @@ namespace {
                 return nullptr;
             }
 
-            extracted.emplace(markEntry, holder->read(markEntry));
+            const auto member = holder->bytes(markEntry);
+            extracted.emplace(markEntry, member.view());
             if (!extracted->ok()) {
                 ctx.warnings.add("could not extract '" + markEntry + "' from '" + markArchive + "'");
                 return nullptr;
@@ -1974,9 +2344,13 @@ std::shared_ptr<Object3D> ObjectLoader::parse(const std::string& jsonText) {
 
     Warnings warnings;
 
-    const auto j = json::parse(jsonText, nullptr, false);
+    json root;
+    std::vector<NumberArray> arrays;
+    DocumentSax sax(root, arrays);
+    const bool parsed = json::sax_parse(jsonText, &sax) && !sax.is_errored();
+    const json& j = root;
 
-    if (j.is_discarded() || !j.is_object()) {
+    if (!parsed || !j.is_object()) {
         warnings.add("malformed JSON");
         warnings_ = std::move(warnings.messages);
         return nullptr;
@@ -1988,8 +2362,9 @@ std::shared_ptr<Object3D> ObjectLoader::parse(const std::string& jsonText) {
         return nullptr;
     }
 
-    const DocumentSource source{resourcePath_, archive_.get()};
-    BufferCache buffers{source};
+    const auto embedded = j.find(embeddedBuffers);
+    const DocumentSource source{resourcePath_, archive_.get(), embedded != j.end() ? &*embedded : nullptr};
+    BufferCache buffers{source, arrays};
 
     const auto animations = parseAnimations(j.contains("animations") ? j["animations"] : json(), warnings);
     const auto geometries = parseGeometries(j.contains("geometries") ? j["geometries"] : json(), buffers, warnings);
@@ -2038,8 +2413,9 @@ std::shared_ptr<Object3D> ObjectLoader::load(const std::filesystem::path& path)
             return nullptr;
         }
 
-        const auto bytes = archive_->read(objectjson::archiveDocument);
-        text.assign(bytes.begin(), bytes.end());
+        const auto member = archive_->bytes(objectjson::archiveDocument);
+        const auto bytes = member.view();
+        text.assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
 
         // Absolute, because it goes into the assetSource mark of anything
         // re-imported out of it and that mark outlives this call.
@@ -1,123 +1,173 @@
-
 #include "threepp/loaders/STLLoader.hpp"
 
+#include "threepp/utils/CharConv.hpp"
+#include "threepp/utils/HashIndex.hpp"
+#include "threepp/utils/MappedFile.hpp"
+#include "threepp/utils/Parallel.hpp"
+
+#include <bit>
 #include <cstring>
-#include <fstream>
 #include <iostream>
-#include <sstream>
-#include <string>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 using namespace threepp;
 
 namespace {
 
+    constexpr size_t headerLength = 80;
+    constexpr size_t dataOffset = headerLength + sizeof(uint32_t);
+    constexpr size_t faceLength = 12 * 4 + 2;// 50
+
     // A binary STL has a fixed layout: 80-byte header + uint32 face count + 50 bytes/face
     // (12-byte normal + 3*12-byte vertices + 2-byte attribute). An ASCII STL is text
     // starting with "solid " followed by "facet"/"vertex" keywords. Some binary writers
     // also start the header with "solid", so the size check is the primary discriminator
     // (matching three.js' STLLoader heuristic).
-    bool isBinary(const std::vector<char>& data) {
+    bool isBinary(const unsigned char* data, uint64_t size) {
 
-        constexpr size_t headerLength = 80;
-        constexpr size_t faceLength = 12 * 4 + 2;// 50
-
-        if (data.size() < headerLength + sizeof(uint32_t)) {
+        if (size < dataOffset) {
             // Too small to hold a binary header — must be (truncated) ASCII.
             return false;
         }
 
         uint32_t faces;
-        std::memcpy(&faces, data.data() + headerLength, sizeof(uint32_t));
+        std::memcpy(&faces, data + headerLength, sizeof(uint32_t));
 
-        const size_t expect = headerLength + sizeof(uint32_t) + static_cast<size_t>(faces) * faceLength;
-        if (expect == data.size()) {
+        const uint64_t expect = dataOffset + static_cast<uint64_t>(faces) * faceLength;
+        if (expect == size) {
             return true;
         }
 
         // Size didn't match: if the file does not begin with "solid", assume binary.
-        static const char solid[] = {'s', 'o', 'l', 'i', 'd'};
-        for (size_t i = 0; i < sizeof(solid); ++i) {
-            if (data[i] != solid[i]) {
-                return true;
-            }
-        }
-        return false;
+        return std::memcmp(data, "solid", 5) != 0;
     }
 
-    std::shared_ptr<BufferGeometry> parseBinary(const std::vector<char>& data) {
+    // Positions and per-corner normals, three corners per triangle. Welding
+    // computes its own normals, so then the file's are not kept.
+    struct Triangles {
+        bool withNormals = true;
+        std::vector<float> vertices;
+        std::vector<float> normals;
+    };
 
-        uint32_t faces;
-        std::memcpy(&faces, data.data() + 80, sizeof(uint32_t));
+    bool parseBinary(const unsigned char* data, uint64_t size, Triangles& out) {
 
-        constexpr size_t dataOffset = 84;
-        constexpr size_t faceLength = 12 * 4 + 2;
+        uint32_t faces;
+        std::memcpy(&faces, data + headerLength, sizeof(uint32_t));
 
-        const size_t expect = dataOffset + static_cast<size_t>(faces) * faceLength;
-        if (data.size() < expect) {
+        const uint64_t expect = dataOffset + static_cast<uint64_t>(faces) * faceLength;
+        if (size < expect) {
             std::cerr << "[STLLoader] Truncated binary STL: header claims " << faces
                       << " faces but file is too small!" << std::endl;
-            return nullptr;
+            return false;
         }
 
-        std::vector<float> vertices(static_cast<size_t>(faces) * 3 * 3);
-        std::vector<float> normals(static_cast<size_t>(faces) * 3 * 3);
+        out.vertices.resize(static_cast<size_t>(faces) * 9);
+        if (out.withNormals) out.normals.resize(static_cast<size_t>(faces) * 9);
+
+        // A record's three vertices are nine contiguous little-endian floats,
+        // copied as they are; only the normal is spread over the corners.
+        parallelFor(0, faces, 16384, [&](size_t lo, size_t hi) {
+            for (auto face = lo; face < hi; ++face) {
+                const auto* record = data + dataOffset + face * faceLength;
+                std::memcpy(out.vertices.data() + face * 9, record + 12, 36);
+                if (!out.withNormals) continue;
+                auto* normal = out.normals.data() + face * 9;
+                std::memcpy(normal, record, 12);
+                std::memcpy(normal + 3, normal, 12);
+                std::memcpy(normal + 6, normal, 12);
+            }
+        });
 
-        for (uint32_t face = 0; face < faces; ++face) {
-            const size_t start = dataOffset + static_cast<size_t>(face) * faceLength;
+        return true;
+    }
 
-            float normalX, normalY, normalZ;
-            std::memcpy(&normalX, data.data() + start + 0, 4);
-            std::memcpy(&normalY, data.data() + start + 4, 4);
-            std::memcpy(&normalZ, data.data() + start + 8, 4);
+    // Whitespace-separated tokens straight out of the mapped text.
+    class Tokens {
 
-            for (int i = 1; i <= 3; ++i) {
-                const size_t vertexStart = start + static_cast<size_t>(i) * 12;
-                const size_t componentIdx = static_cast<size_t>(face) * 3 * 3 + static_cast<size_t>(i - 1) * 3;
+    public:
+        explicit Tokens(std::string_view text): text_(text) {}
 
-                std::memcpy(&vertices[componentIdx + 0], data.data() + vertexStart + 0, 4);
-                std::memcpy(&vertices[componentIdx + 1], data.data() + vertexStart + 4, 4);
-                std::memcpy(&vertices[componentIdx + 2], data.data() + vertexStart + 8, 4);
+        // Empty at the end of the text.
+        std::string_view next() {
 
-                normals[componentIdx + 0] = normalX;
-                normals[componentIdx + 1] = normalY;
-                normals[componentIdx + 2] = normalZ;
-            }
+            while (pos_ < text_.size() && utils::isSpace(text_[pos_])) ++pos_;
+            const auto start = pos_;
+            while (pos_ < text_.size() && !utils::isSpace(text_[pos_])) ++pos_;
+            return text_.substr(start, pos_ - start);
         }
 
-        auto geometry = std::make_shared<BufferGeometry>();
-        geometry->setAttribute("position", FloatBufferAttribute::create(vertices, 3));
-        geometry->setAttribute("normal", FloatBufferAttribute::create(normals, 3));
-
-        return geometry;
-    }
-
-    std::shared_ptr<BufferGeometry> parseASCII(const std::vector<char>& data) {
-
-        std::vector<float> vertices;
-        std::vector<float> normals;
+    private:
+        std::string_view text_;
+        size_t pos_ = 0;
+    };
 
-        std::istringstream stream(std::string(data.begin(), data.end()));
-        std::string token;
+    void parseASCII(std::string_view text, Triangles& out) {
 
+        Tokens tokens(text);
         float nx = 0.f, ny = 0.f, nz = 0.f;
 
-        while (stream >> token) {
+        for (auto token = tokens.next(); !token.empty(); token = tokens.next()) {
             if (token == "facet") {
-                std::string keyword;
-                stream >> keyword;// "normal"
-                stream >> nx >> ny >> nz;
+                tokens.next();// "normal"
+                nx = utils::toFloat(tokens.next());
+                ny = utils::toFloat(tokens.next());
+                nz = utils::toFloat(tokens.next());
             } else if (token == "vertex") {
-                float x, y, z;
-                stream >> x >> y >> z;
-                vertices.insert(vertices.end(), {x, y, z});
-                normals.insert(normals.end(), {nx, ny, nz});
+                const auto x = utils::toFloat(tokens.next());
+                const auto y = utils::toFloat(tokens.next());
+                const auto z = utils::toFloat(tokens.next());
+                out.vertices.insert(out.vertices.end(), {x, y, z});
+                if (out.withNormals) out.normals.insert(out.normals.end(), {nx, ny, nz});
+            }
+        }
+    }
+
+    // Corners are the same vertex when their positions compare equal, as
+    // floats: STL writers repeat a shared vertex bit for bit, and -0 and 0
+    // are one point.
+    std::shared_ptr<BufferGeometry> weld(std::vector<float>&& soup) {
+
+        const auto count = soup.size() / 3;
+        const auto bits = [](float v) {
+            return static_cast<uint64_t>(std::bit_cast<uint32_t>(v == 0.f ? 0.f : v));
+        };
+
+        std::vector<uint64_t> hashes(count);
+        parallelFor(0, count, 16384, [&](size_t lo, size_t hi) {
+            for (auto i = lo; i < hi; ++i) {
+                const auto* p = soup.data() + i * 3;
+                hashes[i] = utils::hashCombine(utils::hashCombine(utils::hashMix(bits(p[0])), bits(p[1])), bits(p[2]));
             }
+        });
+
+        // A closed triangle mesh has about half as many vertices as
+        // triangles, so a sixth of its corners.
+        std::vector<float> positions;
+        positions.reserve(count / 2);
+        std::vector<unsigned int> index(count);
+        utils::HashIndex table(count / 6);
+
+        for (size_t i = 0; i < count; ++i) {
+            const auto* p = soup.data() + i * 3;
+            const auto next = static_cast<uint32_t>(positions.size() / 3);
+            const auto id = table.findOrInsert(hashes[i], next, [&](uint32_t other) {
+                const auto* q = positions.data() + other * 3;
+                return q[0] == p[0] && q[1] == p[1] && q[2] == p[2];
+            });
+            if (id == next) positions.insert(positions.end(), p, p + 3);
+            index[i] = id;
         }
 
+        soup = {};
+        hashes = {};
+
         auto geometry = std::make_shared<BufferGeometry>();
-        geometry->setAttribute("position", FloatBufferAttribute::create(vertices, 3));
-        geometry->setAttribute("normal", FloatBufferAttribute::create(normals, 3));
+        geometry->setIndex(std::move(index));
+        geometry->setAttribute("position", FloatBufferAttribute::create(std::move(positions), 3));
+        geometry->computeVertexNormals();
 
         return geometry;
     }
@@ -132,21 +182,37 @@ std::shared_ptr<BufferGeometry> STLLoader::load(const std::filesystem::path& pat
         return nullptr;
     }
 
-    std::ifstream reader(path, std::ios::binary | std::ios::ate);
-    if (!reader) {
+    std::optional<utils::MappedFile> file;
+    try {
+
+        file.emplace(path);
+
+    } catch (const std::exception&) {
+
         std::cerr << "[STLLoader] Failed to open file: '" << absolute(path).string() << "'!" << std::endl;
         return nullptr;
     }
 
-    const auto fileSize = static_cast<std::streamoff>(reader.tellg());
-    if (fileSize <= 0) {
+    if (file->size() == 0) {
         std::cerr << "[STLLoader] Empty file: '" << absolute(path).string() << "'!" << std::endl;
         return nullptr;
     }
-    reader.seekg(0, std::ios::beg);
 
-    std::vector<char> data(static_cast<size_t>(fileSize));
-    reader.read(data.data(), fileSize);
+    Triangles triangles;
+    triangles.withNormals = !weld;
+    if (isBinary(file->data(), file->size())) {
+        if (!parseBinary(file->data(), file->size(), triangles)) return nullptr;
+    } else {
+        parseASCII({reinterpret_cast<const char*>(file->data()), static_cast<size_t>(file->size())}, triangles);
+    }
+
+    file.reset();
+
+    if (weld) return ::weld(std::move(triangles.vertices));
+
+    auto geometry = std::make_shared<BufferGeometry>();
+    geometry->setAttribute("position", FloatBufferAttribute::create(std::move(triangles.vertices), 3));
+    geometry->setAttribute("normal", FloatBufferAttribute::create(std::move(triangles.normals), 3));
 
-    return isBinary(data) ? parseBinary(data) : parseASCII(data);
+    return geometry;
 }
@@ -3,14 +3,19 @@
 
 #include "nlohmann/json.hpp"
 #include "threepp/loaders/ImageLoader.hpp"
+#include "threepp/utils/FileBytes.hpp"
+#include "threepp/utils/Parallel.hpp"
 #include "threepp/utils/ZipReader.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -34,12 +39,17 @@ namespace {
     // names relative to the asset root ("meta.json", "0_0/means_l.webp"), so the
     // two containers differ in exactly one method each and nothing else in the
     // file has to know which one it got.
+    //
+    // A file read from a directory has to land somewhere; a stored archive
+    // member is already in memory (mapped, see ZipReader) and is handed out in
+    // place, so the planes of a multi-gigabyte bundle are decoded without a
+    // second copy (see FileBytes).
     class Source {
 
     public:
         virtual ~Source() = default;
         [[nodiscard]] virtual bool has(const std::string& rel) const = 0;
-        [[nodiscard]] virtual std::vector<unsigned char> read(const std::string& rel) const = 0;
+        [[nodiscard]] virtual FileBytes read(const std::string& rel) const = 0;
         [[nodiscard]] virtual std::string describe() const = 0;
     };
 
@@ -54,7 +64,7 @@ namespace {
             return std::filesystem::is_regular_file(root_ / rel, ec);
         }
 
-        [[nodiscard]] std::vector<unsigned char> read(const std::string& rel) const override {
+        [[nodiscard]] FileBytes read(const std::string& rel) const override {
 
             const auto p = root_ / rel;
             // Constructed from the path object, never from path.string(): on
@@ -70,7 +80,8 @@ namespace {
             std::vector<unsigned char> bytes(static_cast<std::size_t>(size));
             in.read(reinterpret_cast<char*>(bytes.data()), size);
             if (in.gcount() != size) fail("truncated read of '" + p.string() + "'");
-            return bytes;
+
+            return {std::move(bytes), {}};
         }
 
         [[nodiscard]] std::string describe() const override { return root_.string(); }
@@ -87,9 +98,9 @@ namespace {
 
         [[nodiscard]] bool has(const std::string& rel) const override { return zip_.has(rel); }
 
-        [[nodiscard]] std::vector<unsigned char> read(const std::string& rel) const override {
+        [[nodiscard]] FileBytes read(const std::string& rel) const override {
 
-            return zip_.read(rel);
+            return zip_.bytes(rel);
         }
 
         [[nodiscard]] std::string describe() const override { return name_; }
@@ -167,9 +178,11 @@ namespace {
     nlohmann::json parseJson(const Source& src, const std::string& rel) {
 
         const auto bytes = src.read(rel);
+        const auto view = bytes.view();
+        const auto* text = reinterpret_cast<const char*>(view.data());
         try {
 
-            return nlohmann::json::parse(bytes.begin(), bytes.end());
+            return nlohmann::json::parse(text, text + view.size());
 
         } catch (const std::exception& e) {
 
@@ -318,7 +331,7 @@ namespace {
     Image loadPlane(const Source& src, const std::string& rel) {
 
         const auto bytes = src.read(rel);
-        auto img = ImageLoader().load(bytes, 4, false);
+        auto img = ImageLoader().load(bytes.view(), 4, false);
         if (!img) fail("'" + rel + "' could not be decoded as an image");
 
         if (img->isFloat() || img->isHalfFloat()) fail("'" + rel + "' did not decode to 8-bit data");
@@ -346,17 +359,51 @@ namespace {
         }
     }
 
-    // Decodes [0, meta.count) of one chunk directly into out[dstFirst...].
+    // One chunk's decoded planes. Optional only because Image has no empty
+    // state: after decodePlanes() every plane the chunk declares is present.
+    struct ChunkPlanes {
+
+        std::optional<Image> lo, hi, sc, qt, s0, ce, lb;
+    };
+
+    // Reads and decodes every plane of every chunk at once. The planes are
+    // independent images — a chunk has five to seven, a level up to a few
+    // dozen — and WebP decoding is most of what opening an asset costs, so
+    // they go to the pool as one flat list rather than chunk by chunk.
+    std::vector<ChunkPlanes> decodePlanes(const Source& src, const std::vector<ChunkMeta>& chunks) {
+
+        std::vector<ChunkPlanes> planes(chunks.size());
+        std::vector<std::pair<const std::string*, std::optional<Image>*>> jobs;
+
+        for (std::size_t k = 0; k < chunks.size(); ++k) {
+
+            const auto& m = chunks[k];
+            auto& p = planes[k];
+            jobs.insert(jobs.end(), {{&m.meansLo, &p.lo}, {&m.meansHi, &p.hi}, {&m.scales, &p.sc},
+                                     {&m.quats, &p.qt}, {&m.sh0, &p.s0}});
+            if (m.shDegree > 0) jobs.insert(jobs.end(), {{&m.shNCentroids, &p.ce}, {&m.shNLabels, &p.lb}});
+        }
+
+        parallelFor(0, jobs.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t j = first; j < last; ++j) {
+                *jobs[j].second = loadPlane(src, *jobs[j].first);
+            }
+        });
+
+        return planes;
+    }
+
+    // Dequantizes [0, meta.count) of one chunk directly into out[dstFirst...].
     // `out` is already sized and carries the level's degree; this neither
     // normalizes nor validates, because the caller does both once when the whole
     // level is assembled.
-    void decodeChunkInto(const Source& src, const ChunkMeta& m, SplatData& out, std::size_t dstFirst) {
+    void dequantizeChunk(const ChunkMeta& m, const ChunkPlanes& decoded, SplatData& out, std::size_t dstFirst) {
 
-        const auto lo = loadPlane(src, m.meansLo);
-        const auto hi = loadPlane(src, m.meansHi);
-        const auto sc = loadPlane(src, m.scales);
-        const auto qt = loadPlane(src, m.quats);
-        const auto s0 = loadPlane(src, m.sh0);
+        const auto& lo = *decoded.lo;
+        const auto& hi = *decoded.hi;
+        const auto& sc = *decoded.sc;
+        const auto& qt = *decoded.qt;
+        const auto& s0 = *decoded.s0;
 
         requireArea(lo, m.count, m.meansLo);
 
@@ -391,7 +438,7 @@ namespace {
         const int coeffCount = out.coeffCount();
 
         // The higher-order palette, decoded once per chunk.
-        std::vector<unsigned char> labels;
+        const unsigned char* labels = nullptr;
         std::vector<float> centroids;// [palette][shCoeffs][3]
         int shCoeffs = 0;
 
@@ -399,8 +446,8 @@ namespace {
 
             shCoeffs = splats::shCoeffCount(m.shDegree) - 1;
 
-            const auto ce = loadPlane(src, m.shNCentroids);
-            const auto lb = loadPlane(src, m.shNLabels);
+            const auto& ce = *decoded.ce;
+            const auto& lb = *decoded.lb;
             if (lb.width() != width || lb.height() != height) {
 
                 fail("'" + m.shNLabels + "' is " + std::to_string(lb.width()) + "x" +
@@ -435,95 +482,97 @@ namespace {
                 }
             }
 
-            const unsigned char* pLb = pixels(lb);
-            labels.assign(pLb, pLb + static_cast<std::size_t>(lb.width()) * lb.height() * 4);
+            labels = pixels(lb);
         }
 
-        for (std::size_t i = 0; i < m.count; ++i) {
+        // Splats are independent, and each writes only its own slot of `out`.
+        parallelFor(0, m.count, 4096, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
 
-            const std::size_t px = i * 4;// planes share one width, so one index serves all
-            const std::size_t o = dstFirst + i;
+                const std::size_t px = i * 4;// planes share one width, so one index serves all
+                const std::size_t o = dstFirst + i;
 
-            // Gotcha 3: the quantised value is in LOG space over [mins, maxs],
-            // and attains both endpoints — so 65535, not 65536.
-            for (int a = 0; a < 3; ++a) {
+                // Gotcha 3: the quantised value is in LOG space over [mins, maxs],
+                // and attains both endpoints — so 65535, not 65536.
+                for (int a = 0; a < 3; ++a) {
 
-                const unsigned int q = (static_cast<unsigned int>(pHi[px + a]) << 8) | pLo[px + a];
-                const float t = static_cast<float>(q) / 65535.f;
-                const float n = m.meansMin[a] + (m.meansMax[a] - m.meansMin[a]) * t;
-                const float p = std::copysign(std::expm1(std::fabs(n)), n);
-                if (a == 0) out.means[o].x = p;
-                else if (a == 1) out.means[o].y = p;
-                else out.means[o].z = p;
-            }
+                    const unsigned int q = (static_cast<unsigned int>(pHi[px + a]) << 8) | pLo[px + a];
+                    const float t = static_cast<float>(q) / 65535.f;
+                    const float n = m.meansMin[a] + (m.meansMax[a] - m.meansMin[a]) * t;
+                    const float p = std::copysign(std::expm1(std::fabs(n)), n);
+                    if (a == 0) out.means[o].x = p;
+                    else if (a == 1) out.means[o].y = p;
+                    else out.means[o].z = p;
+                }
 
-            out.scales[o].set(std::exp(m.scalesCodebook[pSc[px + 0]]),
-                              std::exp(m.scalesCodebook[pSc[px + 1]]),
-                              std::exp(m.scalesCodebook[pSc[px + 2]]));
-
-            // Gotcha 2 + gotcha 4, and the one tripwire in this file. Valid mode
-            // bytes are exactly {252, 253, 254, 255} across a real chunk, while
-            // the padding past `count` carries alpha 0 — so this single check
-            // turns BOTH of the two worst silent bugs (flipY left true, and
-            // iterating width*height) into a named exception on the first splat,
-            // before the -252 index into a four-element tuple can happen. It is
-            // load-bearing; do not relax it into a clamp.
-            const unsigned int mode = pQt[px + 3];
-            if (mode < 252u || mode > 255u) {
-
-                fail("'" + m.quats + "': splat " + std::to_string(i) + " has mode byte " +
-                     std::to_string(mode) + ", expected 252..255 (a flipped or mis-sized image "
-                                            "reads padding as data)");
-            }
+                out.scales[o].set(std::exp(m.scalesCodebook[pSc[px + 0]]),
+                                  std::exp(m.scalesCodebook[pSc[px + 1]]),
+                                  std::exp(m.scalesCodebook[pSc[px + 2]]));
+
+                // Gotcha 2 + gotcha 4, and the one tripwire in this file. Valid mode
+                // bytes are exactly {252, 253, 254, 255} across a real chunk, while
+                // the padding past `count` carries alpha 0 — so this single check
+                // turns BOTH of the two worst silent bugs (flipY left true, and
+                // iterating width*height) into a named exception on the first splat,
+                // before the -252 index into a four-element tuple can happen. It is
+                // load-bearing; do not relax it into a clamp.
+                const unsigned int mode = pQt[px + 3];
+                if (mode < 252u || mode > 255u) {
+
+                    fail("'" + m.quats + "': splat " + std::to_string(i) + " has mode byte " +
+                         std::to_string(mode) + ", expected 252..255 (a flipped or mis-sized image "
+                                                "reads padding as data)");
+                }
 
-            constexpr float SCALE = 1.4142135623730951f;// sqrt(2)
-            float wxyz[4];
-            const int omitted = static_cast<int>(mode - 252u);
-            float sum = 0.f;
-            for (int k = 0, s = 0; k < 4; ++k) {
-
-                if (k == omitted) continue;
-                const float c = (static_cast<float>(pQt[px + s]) / 255.f - 0.5f) * 2.f / SCALE;
-                wxyz[k] = c;
-                sum += c * c;
-                ++s;
-            }
-            wxyz[omitted] = std::sqrt(std::max(0.f, 1.f - sum));
+                constexpr float SCALE = 1.4142135623730951f;// sqrt(2)
+                float wxyz[4];
+                const int omitted = static_cast<int>(mode - 252u);
+                float sum = 0.f;
+                for (int k = 0, s = 0; k < 4; ++k) {
+
+                    if (k == omitted) continue;
+                    const float c = (static_cast<float>(pQt[px + s]) / 255.f - 0.5f) * 2.f / SCALE;
+                    wxyz[k] = c;
+                    sum += c * c;
+                    ++s;
+                }
+                wxyz[omitted] = std::sqrt(std::max(0.f, 1.f - sum));
 
-            // The tuple is (w, x, y, z); threepp's Quaternion is (x, y, z, w).
-            out.rotations[o].set(wxyz[1], wxyz[2], wxyz[3], wxyz[0]);
+                // The tuple is (w, x, y, z); threepp's Quaternion is (x, y, z, w).
+                out.rotations[o].set(wxyz[1], wxyz[2], wxyz[3], wxyz[0]);
 
-            // Gotcha 5: alpha is already-activated opacity, not a logit.
-            out.opacities[o] = static_cast<float>(pS0[px + 3]) / 255.f;
+                // Gotcha 5: alpha is already-activated opacity, not a logit.
+                out.opacities[o] = static_cast<float>(pS0[px + 3]) / 255.f;
 
-            float* c = out.shAt(o);
-            // Gotcha 5 again: raw DC coefficients, not colours. No 0.5 + c*SH_C0
-            // and no clamp — the large values are the sky smears removeOutliers
-            // exists to find.
-            for (int ch = 0; ch < 3; ++ch) c[ch] = m.sh0Codebook[pS0[px + ch]];
+                float* c = out.shAt(o);
+                // Gotcha 5 again: raw DC coefficients, not colours. No 0.5 + c*SH_C0
+                // and no clamp — the large values are the sky smears removeOutliers
+                // exists to find.
+                for (int ch = 0; ch < 3; ++ch) c[ch] = m.sh0Codebook[pS0[px + ch]];
 
-            if (m.shDegree > 0) {
+                if (m.shDegree > 0) {
 
-                const std::size_t lpx = i * 4;
-                const std::size_t label = static_cast<std::size_t>(labels[lpx + 0]) |
-                                          (static_cast<std::size_t>(labels[lpx + 1]) << 8);
-                if (label >= m.palette) {
+                    const std::size_t lpx = i * 4;
+                    const std::size_t label = static_cast<std::size_t>(labels[lpx + 0]) |
+                                              (static_cast<std::size_t>(labels[lpx + 1]) << 8);
+                    if (label >= m.palette) {
 
-                    fail("'" + m.shNLabels + "': splat " + std::to_string(i) + " references palette entry " +
-                         std::to_string(label) + " of " + std::to_string(m.palette));
-                }
+                        fail("'" + m.shNLabels + "': splat " + std::to_string(i) + " references palette entry " +
+                             std::to_string(label) + " of " + std::to_string(m.palette));
+                    }
 
-                // Gotcha 6: already coefficient-major with rgb in the pixel,
-                // which is SplatData's own layout. NO channel-major reorder —
-                // this is the one line of SplatLoader's PLY path that must not
-                // be copied.
-                const float* srcCoeff = centroids.data() + label * static_cast<std::size_t>(shCoeffs) * 3;
-                for (int k = 0; k < shCoeffs && (1 + k) < coeffCount; ++k) {
+                    // Gotcha 6: already coefficient-major with rgb in the pixel,
+                    // which is SplatData's own layout. NO channel-major reorder —
+                    // this is the one line of SplatLoader's PLY path that must not
+                    // be copied.
+                    const float* srcCoeff = centroids.data() + label * static_cast<std::size_t>(shCoeffs) * 3;
+                    for (int k = 0; k < shCoeffs && (1 + k) < coeffCount; ++k) {
 
-                    for (int ch = 0; ch < 3; ++ch) c[(1 + k) * 3 + ch] = srcCoeff[k * 3 + ch];
+                        for (int ch = 0; ch < 3; ++ch) c[(1 + k) * 3 + ch] = srcCoeff[k * 3 + ch];
+                    }
                 }
             }
-        }
+        });
     }
 
     // ── lod-meta.json ───────────────────────────────────────────────────────
@@ -689,6 +738,20 @@ SplatData SogLoader::load(const std::filesystem::path& path) {
 
 SplatData SogLoader::load(const std::filesystem::path& path, const Options& options) {
 
+    LoadStats stats;
+    return load(path, options, stats);
+}
+
+SplatData SogLoader::load(const std::filesystem::path& path, const Options& options, LoadStats& stats) {
+
+    using Clock = std::chrono::steady_clock;
+    const auto seconds = [](Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    };
+
+    stats = {};
+    auto phase = Clock::now();
+
     const auto resolved = resolve(path);
     const Source& src = *resolved.source;
 
@@ -748,17 +811,31 @@ SplatData SogLoader::load(const std::filesystem::path& path, const Options& opti
         total += c.count;
     }
 
+    stats.chunks = chunks.size();
+    stats.parseSeconds = seconds(phase);
+    phase = Clock::now();
+
+    // Every plane of the level decoded up front. They are 8-bit RGBA, four
+    // bytes per splat each — about 140 MB for a 5.0M-splat level, small next
+    // to the ~1.2 GB of floats they turn into.
+    auto planes = decodePlanes(src, chunks);
+    for (const auto& p : planes) stats.planes += p.ce ? 7 : 5;
+
+    stats.decodeSeconds = seconds(phase);
+    phase = Clock::now();
+
     // Build, do not concatenate: appending nine SplatData peaks near twice a
-    // 1.2 GB result. One resize, then each chunk decodes straight into its own
-    // slice, and its seven decoded planes are released before the next opens.
+    // 1.2 GB result. One resize, then each chunk dequantizes straight into its
+    // own slice, and its planes are released as soon as it is done.
     SplatData data;
     data.resize(total, degree);
 
     std::size_t first = 0;
-    for (const auto& c : chunks) {
+    for (std::size_t k = 0; k < chunks.size(); ++k) {
 
-        decodeChunkInto(src, c, data, first);
-        first += c.count;
+        dequantizeChunk(chunks[k], planes[k], data, first);
+        planes[k] = {};
+        first += chunks[k].count;
     }
 
     data.normalizeRotations();
@@ -766,6 +843,8 @@ SplatData SogLoader::load(const std::filesystem::path& path, const Options& opti
     std::string why;
     if (!data.validate(&why)) fail("internal consistency check failed: " + why);
 
+    stats.dequantizeSeconds = seconds(phase);
+
     return data;
 }
 
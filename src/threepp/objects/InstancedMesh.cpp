@@ -2,7 +2,11 @@
 #include "threepp/objects/InstancedMesh.hpp"
 
 #include "threepp/core/Raycaster.hpp"
+#include "threepp/math/infinity.hpp"
+#include "threepp/utils/Parallel.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <stdexcept>
 
 using namespace threepp;
@@ -21,8 +25,157 @@ namespace {
         }
     }
 
+    constexpr std::uint32_t instancesPerLeaf = 4;
+
+    // Parametric entry distance of the ray into the box, or +inf on a miss
+    // or when the entry lies beyond tMax. 0 when the origin is inside.
+    float rayBoxEntry(const Ray& ray, const Box3& box, float tMax) {
+        float t0 = 0.f, t1 = tMax;
+        for (int a = 0; a < 3; ++a) {
+            const float invD = 1.f / ray.direction[a];
+            float tNear = (box.min()[a] - ray.origin[a]) * invD;
+            float tFar = (box.max()[a] - ray.origin[a]) * invD;
+            if (tNear > tFar) std::swap(tNear, tFar);
+            t0 = tNear > t0 ? tNear : t0;
+            t1 = tFar < t1 ? tFar : t1;
+            if (t0 > t1) return Infinity<float>;
+        }
+        return t0;
+    }
+
 }// namespace
 
+// A tree over the instances' boxes in this mesh's local space — the geometry
+// box pushed through each instance matrix. Median splits on the largest
+// centroid extent: instances are few and alike next to a triangle soup, and a
+// balanced tree keeps the fixed traversal stack safe for any count.
+struct InstancedMesh::InstanceTree {
+
+    struct Node {
+        Box3 box;
+        std::uint32_t offset;// leaf: first slot in ids; interior: second child
+        std::uint32_t count; // instances in a leaf, 0 for an interior node
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> ids;// leaf order -> instanceId
+    std::vector<Box3> boxes;       // by instanceId
+
+    // What the tree describes.
+    size_t count = 0;
+    unsigned int matrixVersion = 0;
+    Box3 geometryBox;
+
+    void computeBoxes(const FloatBufferAttribute& matrices) {
+        boxes.resize(count);
+        parallelFor(0, count, 1024, [&](size_t lo, size_t hi) {
+            Matrix4 m;
+            for (size_t i = lo; i < hi; ++i) {
+                m.fromArray(matrices.array(), i * 16);
+                boxes[i].copy(geometryBox).applyMatrix4(m);
+            }
+        });
+    }
+
+    void build() {
+        ids.resize(count);
+        for (size_t i = 0; i < count; ++i) ids[i] = static_cast<std::uint32_t>(i);
+        nodes.clear();
+        nodes.reserve(2 * count / instancesPerLeaf + 1);
+        buildNode(0, static_cast<std::uint32_t>(count));
+    }
+
+    // Same topology, new boxes. Pre-order puts children after their parent,
+    // so a reverse sweep sees both children first.
+    void refit() {
+        for (size_t n = nodes.size(); n-- > 0;) {
+            Node& node = nodes[n];
+            node.box.makeEmpty();
+            if (node.count > 0) {
+                for (auto k = node.offset; k < node.offset + node.count; ++k) node.box.union_(boxes[ids[k]]);
+            } else {
+                node.box.union_(nodes[n + 1].box).union_(nodes[node.offset].box);
+            }
+        }
+    }
+
+    // visit(instanceId) for every instance whose box the ray enters within
+    // the limit visit returns, nearer subtrees first.
+    template<class Visit>
+    void raycast(const Ray& ray, Visit&& visit) const {
+        float limit = Infinity<float>;
+
+        struct Entry {
+            std::uint32_t node;
+            float t;
+        };
+        Entry stack[64];
+        int sp = 0;
+
+        const float tRoot = rayBoxEntry(ray, nodes[0].box, limit);
+        if (tRoot == Infinity<float>) return;
+        stack[sp++] = {0, tRoot};
+
+        while (sp > 0) {
+            const Entry e = stack[--sp];
+            if (e.t > limit) continue;
+
+            const Node& node = nodes[e.node];
+            if (node.count > 0) {
+                for (auto k = node.offset; k < node.offset + node.count; ++k) {
+                    if (rayBoxEntry(ray, boxes[ids[k]], limit) == Infinity<float>) continue;
+                    limit = std::min(limit, visit(ids[k]));
+                }
+                continue;
+            }
+
+            const std::uint32_t left = e.node + 1, right = node.offset;
+            const float tl = rayBoxEntry(ray, nodes[left].box, limit);
+            const float tr = rayBoxEntry(ray, nodes[right].box, limit);
+            if (tl <= tr) {
+                if (tr != Infinity<float>) stack[sp++] = {right, tr};
+                if (tl != Infinity<float>) stack[sp++] = {left, tl};
+            } else {
+                if (tl != Infinity<float>) stack[sp++] = {left, tl};
+                stack[sp++] = {right, tr};
+            }
+        }
+    }
+
+private:
+    std::uint32_t buildNode(std::uint32_t first, std::uint32_t last) {
+        const auto index = static_cast<std::uint32_t>(nodes.size());
+        nodes.emplace_back();
+
+        Box3 bounds, centroids;
+        Vector3 center;
+        for (auto k = first; k < last; ++k) {
+            bounds.union_(boxes[ids[k]]);
+            boxes[ids[k]].getCenter(center);
+            centroids.expandByPoint(center);
+        }
+
+        if (last - first <= instancesPerLeaf) {
+            nodes[index] = {bounds, first, last - first};
+            return index;
+        }
+
+        Vector3 extent;
+        centroids.getSize(extent);
+        const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+        const auto mid = first + (last - first) / 2;
+        std::nth_element(ids.begin() + first, ids.begin() + mid, ids.begin() + last, [&](auto a, auto b) {
+            return boxes[a].min()[axis] + boxes[a].max()[axis] < boxes[b].min()[axis] + boxes[b].max()[axis];
+        });
+
+        buildNode(first, mid);
+        const auto second = buildNode(mid, last);
+        nodes[index] = {bounds, second, 0};
+        return index;
+    }
+};
+
 
 InstancedMesh::InstancedMesh(
         std::shared_ptr<BufferGeometry> geometry,
@@ -109,41 +262,103 @@ void InstancedMesh::dispose() {
     }
 }
 
-void InstancedMesh::raycast(const Raycaster& raycaster, std::vector<Intersection>& intersects) {
+const InstancedMesh::InstanceTree* InstancedMesh::updateInstanceTree() {
+
+    if (!geometry_ || count_ == 0) return nullptr;
+    if (!geometry_->boundingBox) geometry_->computeBoundingBox();
+    if (!geometry_->boundingBox || geometry_->boundingBox->isEmpty()) return nullptr;
+
+    if (!instanceTree_) instanceTree_ = std::make_unique<InstanceTree>();
+    auto& tree = *instanceTree_;
 
-    const auto& matrixWorld = this->matrixWorld;
-    const auto raycastTimes = this->count_;
+    const bool rebuild = tree.nodes.empty() || tree.count != count_ || tree.geometryBox != *geometry_->boundingBox;
+    if (rebuild || tree.matrixVersion != instanceMatrix_->version) {
+
+        tree.count = count_;
+        tree.matrixVersion = instanceMatrix_->version;
+        tree.geometryBox = *geometry_->boundingBox;
+        tree.computeBoxes(*instanceMatrix_);
+
+        if (rebuild) {
+            tree.build();
+        } else {
+            tree.refit();
+        }
+    }
+
+    return &tree;
+}
+
+void InstancedMesh::raycast(const Raycaster& raycaster, std::vector<Intersection>& intersects) {
 
     _mesh.setGeometry(geometry_);
     _mesh.setMaterials(materials_);
 
     if (!_mesh.material()) return;
 
-    for (unsigned instanceId = 0; instanceId < raycastTimes; instanceId++) {
+    const auto* tree = updateInstanceTree();
+    if (!tree) return;
 
-        // calculate the world matrix for each instance
+    Matrix4 inverseMatrix(*matrixWorld);
+    inverseMatrix.invert();
+    Ray ray(raycaster.ray);
+    ray.applyMatrix4(inverseMatrix);
 
+    // The mesh represents one instance at a time.
+    const auto castInstance = [&](std::uint32_t instanceId) {
         this->getMatrixAt(instanceId, _instanceLocalMatrix);
-
         _instanceWorldMatrix.multiplyMatrices(*matrixWorld, _instanceLocalMatrix);
-
-        // the mesh represents this single instance
-
         _mesh.matrixWorld->copy(_instanceWorldMatrix);
 
+        _instanceIntersects.clear();
         _mesh.raycast(raycaster, _instanceIntersects);
 
-        // process the result of raycast
-
         for (auto& intersect : _instanceIntersects) {
-
             intersect.instanceId = instanceId;
             intersect.object = this;
-            intersects.emplace_back(intersect);
         }
-
-        _instanceIntersects.clear();
+    };
+
+    if (raycaster.firstHitOnly) {
+
+        std::optional<Intersection> nearest;
+        Vector3 local;
+
+        tree->raycast(ray, [&](std::uint32_t instanceId) {
+            castInstance(instanceId);
+            // At most one hit each; ties go to the lower instanceId, as the
+            // plain loop over instances would have reported first.
+            for (auto& hit : _instanceIntersects) {
+                if (!nearest || hit.distance < nearest->distance ||
+                    (hit.distance == nearest->distance && hit.instanceId < nearest->instanceId)) {
+                    nearest = hit;
+                }
+            }
+            // The tree measures along the local ray.
+            return nearest ? local.copy(nearest->point).applyMatrix4(inverseMatrix).distanceTo(ray.origin)
+                           : Infinity<float>;
+        });
+
+        if (nearest) intersects.emplace_back(*nearest);
+
+    } else {
+
+        // In instance order, so hits at equal distances keep the order the
+        // plain loop produced.
+        std::vector<std::uint32_t> candidates;
+        tree->raycast(ray, [&](std::uint32_t instanceId) {
+            candidates.push_back(instanceId);
+            return Infinity<float>;
+        });
+        std::sort(candidates.begin(), candidates.end());
+
+        for (const auto instanceId : candidates) {
+            castInstance(instanceId);
+            intersects.insert(intersects.end(), _instanceIntersects.begin(), _instanceIntersects.end());
+        }
     }
+
+    _instanceIntersects.clear();
 }
 
 InstancedMesh::~InstancedMesh() {
@@ -10,6 +10,9 @@
 #include "threepp/materials/MeshBasicMaterial.hpp"
 
 #include "threepp/math/Triangle.hpp"
+#include "threepp/math/infinity.hpp"
+
+#include "threepp/utils/BVH.hpp"
 
 #include <algorithm>
 #include <memory>
@@ -125,9 +128,12 @@ namespace {
         }
 
         if (auto skinned = object.as<SkinnedMesh>()) {
-            skinned->boneTransform(a, _vA);
-            skinned->boneTransform(b, _vB);
-            skinned->boneTransform(c, _vC);
+            // Posed once per pose for the whole mesh (morphs included), not
+            // three boneTransforms per triangle tested.
+            const auto& posed = skinned->posedPositions();
+            _vA.copy(posed[a]);
+            _vB.copy(posed[b]);
+            _vC.copy(posed[c]);
         }
 
         auto intersection = checkIntersection(object, material, raycaster, ray, _vA, _vB, _vC, _intersectionPoint);
@@ -191,6 +197,16 @@ Mesh::Mesh(std::shared_ptr<BufferGeometry> geometry, std::vector<std::shared_ptr
 
 void Mesh::raycast(const Raycaster& raycaster, std::vector<Intersection>& intersects) {
 
+    raycastImpl(raycaster, intersects, nullptr, true);
+}
+
+void Mesh::raycastWithTree(const Raycaster& raycaster, std::vector<Intersection>& intersects, const BVH* tree) {
+
+    raycastImpl(raycaster, intersects, tree, false);
+}
+
+void Mesh::raycastImpl(const Raycaster& raycaster, std::vector<Intersection>& intersects, const BVH* givenTree, bool resolveTree) {
+
     if (material() == nullptr) return;
 
     static thread_local Sphere _sphere{};
@@ -236,9 +252,112 @@ void Mesh::raycast(const Raycaster& raycaster, std::vector<Intersection>& inters
     const FloatAttributeView uv2View(geometry_->getAttribute("uv2"));
     const auto* uv = uvView ? &uvView : nullptr;
     const auto* uv2 = uv2View ? &uv2View : nullptr;
-    const auto groups = geometry_->groups;
+    const auto& groups = geometry_->groups;
     const auto drawRange = geometry_->drawRange;
 
+    const auto firstNew = intersects.size();
+
+    // With a bounds tree, only the triangles in leaves the ray enters are
+    // tested — by the same checkBufferGeometryIntersection the loops below use,
+    // so every field comes out as it would without the tree. A tree triangle
+    // covers three index entries, so a range that does not start on a
+    // multiple of 3 walks different triplets than the tree holds; those keep
+    // the plain loops.
+    std::shared_ptr<const BVH> resolved;
+    if (resolveTree && position) resolved = raycastBoundsTree();
+    const BVH* tree = position ? (resolveTree ? resolved.get() : givenTree) : nullptr;
+    const bool aligned = drawRange.start % 3 == 0 &&
+                         (numMaterials() <= 1 ||
+                          std::all_of(groups.begin(), groups.end(), [](auto& g) { return g.start % 3 == 0; }));
+
+    if (tree && aligned) {
+
+        struct Range {
+            int start;
+            int end;
+            const GeometryGroup* group;
+        };
+
+        // In the order the loops below visit them.
+        static thread_local std::vector<Range> _ranges;
+        _ranges.clear();
+        if (numMaterials() > 1) {
+            for (auto& group : groups) {
+                _ranges.push_back({std::max(group.start, drawRange.start),
+                                   std::min((group.start + group.count), (drawRange.start + drawRange.count)),
+                                   &group});
+            }
+        } else {
+            const int count = index ? index->count() : position->count();
+            _ranges.push_back({std::max(0, drawRange.start), std::min(count, (drawRange.start + drawRange.count)), nullptr});
+        }
+
+        const auto test = [&](const Range& range, int t) -> std::optional<Intersection> {
+            const int j = t * 3;
+            if (j < range.start || j >= range.end) return std::nullopt;
+
+            const unsigned int a = index ? index->getX(j) : j;
+            const unsigned int b = index ? index->getX(j + 1) : j + 1;
+            const unsigned int c = index ? index->getX(j + 2) : j + 2;
+
+            auto& rangeMaterial = range.group ? *materials_[range.group->materialIndex] : *material();
+            auto hit = checkBufferGeometryIntersection(
+                    *this, rangeMaterial, raycaster, _ray, *position,
+                    morphPosition, morphTargetsRelative, uv, uv2, a, b, c);
+
+            if (hit) {
+                hit->faceIndex = t;
+                if (range.group) hit->face->materialIndex = range.group->materialIndex;
+            }
+            return hit;
+        };
+
+        if (raycaster.firstHitOnly) {
+
+            std::optional<Intersection> nearest;
+            std::pair<size_t, int> nearestOrder;
+            Vector3 local;
+
+            tree->raycastTriangles(_ray, Infinity<float>, [&](int t) {
+                for (size_t r = 0; r < _ranges.size(); ++r) {
+                    auto hit = test(_ranges[r], t);
+                    if (!hit) continue;
+                    // Ties go to the triangle the loops would have reported first.
+                    const auto order = std::make_pair(r, t);
+                    if (!nearest || hit->distance < nearest->distance ||
+                        (hit->distance == nearest->distance && order < nearestOrder)) {
+                        nearest = hit;
+                        nearestOrder = order;
+                    }
+                }
+                // The tree measures along the local ray.
+                return nearest ? local.copy(nearest->point).applyMatrix4(_inverseMatrix).distanceTo(_ray.origin)
+                               : Infinity<float>;
+            });
+
+            if (nearest) intersects.emplace_back(*nearest);
+
+        } else {
+
+            static thread_local std::vector<int> _candidates;
+            _candidates.clear();
+
+            tree->raycastTriangles(_ray, Infinity<float>, [](int t) {
+                _candidates.push_back(t);
+                return Infinity<float>;
+            });
+            std::sort(_candidates.begin(), _candidates.end());
+
+            for (const auto& range : _ranges) {
+                for (const int t : _candidates) {
+                    if (auto hit = test(range, t)) intersects.emplace_back(*hit);
+                }
+            }
+        }
+
+        return;
+    }
+
     if (index != nullptr) {
 
         // indexed buffer geometry
@@ -349,6 +468,15 @@ void Mesh::raycast(const Raycaster& raycaster, std::vector<Intersection>& inters
             }
         }
     }
+
+    if (raycaster.firstHitOnly && intersects.size() > firstNew + 1) {
+
+        const auto nearest = *std::min_element(intersects.begin() + firstNew, intersects.end(), [](auto& a, auto& b) {
+            return a.distance < b.distance;
+        });
+        intersects.resize(firstNew);
+        intersects.emplace_back(nearest);
+    }
 }
 
 std::string Mesh::type() const {
@@ -404,6 +532,20 @@ const Box3* Mesh::raycastBoundingBox() {
     return &*geometry_->boundingBox;
 }
 
+std::shared_ptr<const BVH> Mesh::raycastBoundsTree() {
+
+    if (!geometry_ || !geometry_->hasBoundsTree()) return nullptr;
+
+    // The tree holds the unmorphed positions; morphed triangles may lie
+    // outside its boxes.
+    if (geometry_->getMorphAttribute("position")) {
+        const auto& influences = morphTargetInfluences();
+        if (std::any_of(influences.begin(), influences.end(), [](float w) { return w != 0; })) return nullptr;
+    }
+
+    return geometry_->boundsTree();
+}
+
 std::shared_ptr<Object3D> Mesh::createDefault() {
     return create();
 }
@@ -1,6 +1,25 @@
 
 #include "threepp/objects/SkinnedMesh.hpp"
 
+#include "threepp/core/AttributeView.hpp"
+#include "threepp/materials/interfaces.hpp"
+#include "threepp/utils/BVH.hpp"
+#include "threepp/utils/Parallel.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// skinVertices runs four vertices per step. With SSE2 (every x86-64 build) the
+// blend of each vertex's bone matrices is one row per register, and the four
+// blended matrices are transposed so the transform itself runs across the
+// four vertices. THREEPP_NO_SIMD forces the scalar path, which performs the
+// same operations in the same order and so gives the same bits.
+#if !defined(THREEPP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define THREEPP_SKINNING_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace threepp;
 
 namespace {
@@ -13,6 +32,125 @@ namespace {
     Vector3 _vector;
     Matrix4 _matrix;
 
+    // A bone's whole chain — bind matrix, inverse bind, the bone as posed,
+    // and the linear part of bindMatrixInverse — as the top three rows of a
+    // row-major 3x4. bindMatrixInverse's translation is added once after the
+    // blend, which keeps the result right when the weights do not sum to one.
+    struct alignas(16) BoneRows {
+        float r[3][4];
+    };
+
+    // Four vertices, staged for the kernel. Lanes past the end of the range
+    // carry zero weights and are never written back.
+    struct alignas(16) Lanes {
+        float px[4], py[4], pz[4];
+        float nx[4], ny[4], nz[4];
+        float w[4][4];// [influence][lane]
+        int bone[4][4];
+    };
+
+    struct SkinInputs {
+        const BoneRows* bones = nullptr;
+        std::size_t numBones = 0;
+        float t[3]{};
+        bool normals = false;
+    };
+
+#ifdef THREEPP_SKINNING_SSE2
+
+    void skinLanes(const SkinInputs& in, Lanes& l) {
+
+        __m128 rows[4][3];
+        for (int v = 0; v < 4; ++v) {
+            __m128 r0 = _mm_setzero_ps(), r1 = _mm_setzero_ps(), r2 = _mm_setzero_ps();
+            for (int j = 0; j < 4; ++j) {
+                const float w = l.w[j][v];
+                if (w == 0) continue;
+                const auto& b = in.bones[l.bone[j][v]];
+                const __m128 wv = _mm_set1_ps(w);
+                r0 = _mm_add_ps(r0, _mm_mul_ps(wv, _mm_load_ps(b.r[0])));
+                r1 = _mm_add_ps(r1, _mm_mul_ps(wv, _mm_load_ps(b.r[1])));
+                r2 = _mm_add_ps(r2, _mm_mul_ps(wv, _mm_load_ps(b.r[2])));
+            }
+            rows[v][0] = r0;
+            rows[v][1] = r1;
+            rows[v][2] = r2;
+        }
+
+        const __m128 px = _mm_load_ps(l.px), py = _mm_load_ps(l.py), pz = _mm_load_ps(l.pz);
+        const __m128 nx = _mm_load_ps(l.nx), ny = _mm_load_ps(l.ny), nz = _mm_load_ps(l.nz);
+        __m128 outP[3], outN[3];
+        for (int r = 0; r < 3; ++r) {
+            // Row r of the four vertices' matrices, as columns across vertices.
+            __m128 c0 = rows[0][r], c1 = rows[1][r], c2 = rows[2][r], c3 = rows[3][r];
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, px), _mm_mul_ps(c1, py)), _mm_mul_ps(c2, pz));
+            outP[r] = _mm_add_ps(_mm_add_ps(p, c3), _mm_set1_ps(in.t[r]));
+            outN[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, nx), _mm_mul_ps(c1, ny)), _mm_mul_ps(c2, nz));
+        }
+        _mm_store_ps(l.px, outP[0]);
+        _mm_store_ps(l.py, outP[1]);
+        _mm_store_ps(l.pz, outP[2]);
+
+        if (in.normals) {
+            const __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(outN[0], outN[0]), _mm_mul_ps(outN[1], outN[1])),
+                                           _mm_mul_ps(outN[2], outN[2]));
+            const __m128 len = _mm_sqrt_ps(len2);
+            // Zero-length normals stay zero rather than turning into NaN.
+            const __m128 keep = _mm_cmpgt_ps(len, _mm_setzero_ps());
+            const __m128 one = _mm_set1_ps(1.f);
+            const __m128 div = _mm_or_ps(_mm_and_ps(keep, len), _mm_andnot_ps(keep, one));
+            _mm_store_ps(l.nx, _mm_div_ps(outN[0], div));
+            _mm_store_ps(l.ny, _mm_div_ps(outN[1], div));
+            _mm_store_ps(l.nz, _mm_div_ps(outN[2], div));
+        }
+    }
+
+#else
+
+    void skinLanes(const SkinInputs& in, Lanes& l) {
+
+        for (int v = 0; v < 4; ++v) {
+            float m[3][4]{};
+            for (int j = 0; j < 4; ++j) {
+                const float w = l.w[j][v];
+                if (w == 0) continue;
+                const auto& b = in.bones[l.bone[j][v]];
+                for (int r = 0; r < 3; ++r) {
+                    for (int c = 0; c < 4; ++c) m[r][c] = m[r][c] + w * b.r[r][c];
+                }
+            }
+
+            const float px = l.px[v], py = l.py[v], pz = l.pz[v];
+            const float nx = l.nx[v], ny = l.ny[v], nz = l.nz[v];
+            float p[3], n[3];
+            for (int r = 0; r < 3; ++r) {
+                p[r] = ((m[r][0] * px + m[r][1] * py) + m[r][2] * pz + m[r][3]) + in.t[r];
+                n[r] = (m[r][0] * nx + m[r][1] * ny) + m[r][2] * nz;
+            }
+            l.px[v] = p[0];
+            l.py[v] = p[1];
+            l.pz[v] = p[2];
+
+            if (in.normals) {
+                const float len = std::sqrt((n[0] * n[0] + n[1] * n[1]) + n[2] * n[2]);
+                const float div = len > 0 ? len : 1.f;
+                l.nx[v] = n[0] / div;
+                l.ny[v] = n[1] / div;
+                l.nz[v] = n[2] / div;
+            }
+        }
+    }
+
+#endif
+
+    // One morph target and how strongly it applies.
+    struct Morph {
+        float influence;
+        FloatAttributeView position;
+        FloatAttributeView normal;
+    };
+
 }// namespace
 
 
@@ -40,6 +178,9 @@ void SkinnedMesh::bind(const std::shared_ptr<Skeleton>& skeleton, std::optional<
 
     this->bindMatrix.copy(*bindMatrix);
     this->bindMatrixInverse.copy(*bindMatrix).invert();
+
+    computeBoneBoxes();
+    posedBoundsDirty_ = true;
 }
 
 void SkinnedMesh::pose() const {
@@ -73,6 +214,10 @@ void SkinnedMesh::normalizeSkinWeights() {
 
         skinWeight->setXYZW(i, vector.x, vector.y, vector.z, vector.w);
     }
+
+    // Weights that did not sum to one may now; box the bones again.
+    boneBoxesGeometry_ = nullptr;
+    posedBoundsDirty_ = true;
 }
 
 void SkinnedMesh::updateMatrixWorld(bool force) {
@@ -85,9 +230,265 @@ void SkinnedMesh::updateMatrixWorld(bool force) {
     }
 
     // The pose may have moved; the cached bounds describe the previous one.
-    // Only a flag here — recomputing walks every vertex, and most frames
-    // nobody asks (see posedBoundingBox).
+    // Only a flag here — most frames nobody asks (see posedBoundingBox).
     posedBoundsDirty_ = true;
+    posedPositionsDirty_ = true;
+}
+
+void SkinnedMesh::computeBoneBoxes() {
+
+    boneBoxes_.clear();
+    boneBoxesUsable_ = false;
+    boneBoxesGeometry_ = nullptr;
+    boneBoxesSkeleton_ = nullptr;
+
+    const auto position = geometry_ ? geometry_->getAttribute<float>("position") : nullptr;
+    const auto skinIndex = geometry_ ? geometry_->getAttribute<float>("skinIndex") : nullptr;
+    const auto skinWeight = geometry_ ? geometry_->getAttribute<float>("skinWeight") : nullptr;
+    if (!position || !skinIndex || !skinWeight || !skeleton || skeleton->bones.empty()) return;
+
+    boneBoxesGeometry_ = geometry_.get();
+    boneBoxesSkeleton_ = skeleton.get();
+    boneBoxesVertexCount_ = static_cast<std::size_t>(position->count());
+
+    const auto numBones = skeleton->bones.size();
+    if (skeleton->boneInverses.size() < numBones) return;
+    boneBoxes_.resize(numBones);
+
+    // A skinned vertex is a weighted sum of its bind position carried by each
+    // of its bones. With weights that are non-negative and sum to one, that
+    // sum lies between the carried points, so it is inside the union of each
+    // bone's box carried the same way — whatever the pose.
+    Vector3 bindPosition, inBone;
+    Vector4 index, weight;
+    for (unsigned i = 0, l = position->count(); i < l; ++i) {
+
+        position->setFromBufferAttribute(bindPosition, i);
+        bindPosition.applyMatrix4(this->bindMatrix);
+        skinIndex->setFromBufferAttribute(index, i);
+        skinWeight->setFromBufferAttribute(weight, i);
+
+        float sum = 0;
+        for (unsigned j = 0; j < 4; ++j) {
+
+            const auto w = weight[j];
+            if (w == 0) continue;
+
+            const auto bone = static_cast<int>(index[j]);
+            if (w < 0 || bone < 0 || bone >= static_cast<int>(numBones)) return;
+
+            sum += w;
+            boneBoxes_[bone].expandByPoint(inBone.copy(bindPosition).applyMatrix4(skeleton->boneInverses[bone]));
+        }
+        if (std::abs(sum - 1) > 1e-4f) return;
+    }
+
+    boneBoxesUsable_ = true;
+}
+
+bool SkinnedMesh::morphsApplied() {
+
+    // The same test skinVertices makes before folding a target in.
+    const auto* morphMaterial = material() ? material()->as<MaterialWithMorphTargets>() : nullptr;
+    const auto position = geometry_ ? geometry_->getAttribute<float>("position") : nullptr;
+    if (!morphMaterial || !morphMaterial->morphTargets || !position) return false;
+
+    const auto* morphPosition = geometry_->getMorphAttribute("position");
+    const auto& weights = morphTargetInfluences();
+    for (std::size_t k = 0; morphPosition && k < morphPosition->size() && k < weights.size(); ++k) {
+        const auto* p = (*morphPosition)[k].get();
+        if (weights[k] != 0 && p && p->count() >= position->count()) return true;
+    }
+    return false;
+}
+
+void SkinnedMesh::skinVertices(std::span<Vector3> positions, std::span<Vector3> normals, std::size_t first) {
+
+    const FloatAttributeView position(geometry_ ? geometry_->getAttribute("position") : nullptr);
+    const auto count = static_cast<std::size_t>(position ? position.count() : 0);
+    if (first > count || positions.size() > count - first) {
+        throw std::out_of_range("SkinnedMesh::skinVertices: vertices [" + std::to_string(first) + ", " +
+                                std::to_string(first + positions.size()) + ") of " + std::to_string(count));
+    }
+    if (!normals.empty() && normals.size() != positions.size()) {
+        throw std::invalid_argument("SkinnedMesh::skinVertices: " + std::to_string(normals.size()) +
+                                    " normals for " + std::to_string(positions.size()) + " positions");
+    }
+    if (positions.empty()) return;
+
+    const FloatAttributeView normal(normals.empty() ? nullptr : geometry_->getAttribute("normal"));
+    const FloatAttributeView skinIndex(geometry_->getAttribute("skinIndex"));
+    const FloatAttributeView skinWeight(geometry_->getAttribute("skinWeight"));
+
+    SkinInputs in;
+    in.normals = !normals.empty();
+    const auto covers = [&](const FloatAttributeView& view, int itemSize) {
+        return view && view.itemSize() >= itemSize && static_cast<std::size_t>(view.count()) >= count;
+    };
+    const bool hasNormal = covers(normal, 3);
+    const bool skinned = skeleton && !skeleton->bones.empty() &&
+                         skeleton->boneInverses.size() >= skeleton->bones.size() &&
+                         covers(skinIndex, 4) && covers(skinWeight, 4);
+
+    // Not skinned (yet): every vertex fully on one identity "bone", which
+    // leaves it where the geometry has it and still renormalises normals.
+    std::vector<BoneRows> bones(1, BoneRows{{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}}});
+    if (skinned) {
+        Matrix4 linear(this->bindMatrixInverse);
+        linear.elements[12] = linear.elements[13] = linear.elements[14] = 0;
+        in.t[0] = this->bindMatrixInverse.elements[12];
+        in.t[1] = this->bindMatrixInverse.elements[13];
+        in.t[2] = this->bindMatrixInverse.elements[14];
+
+        bones.resize(skeleton->bones.size());
+        Matrix4 m;
+        for (std::size_t b = 0; b < bones.size(); ++b) {
+            m.multiplyMatrices(linear, *skeleton->bones[b]->matrixWorld)
+                    .multiply(skeleton->boneInverses[b])
+                    .multiply(this->bindMatrix);
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 4; ++c) bones[b].r[r][c] = m.elements[c * 4 + r];
+            }
+        }
+    }
+    in.bones = bones.data();
+    in.numBones = bones.size();
+
+    // Morph targets, as the renderer applies them: only when the material
+    // asks for them, normals only with morphNormals.
+    std::vector<Morph> morphs;
+    const auto* morphMaterial = material() ? material()->as<MaterialWithMorphTargets>() : nullptr;
+    if (morphMaterial && morphMaterial->morphTargets) {
+        const auto* morphPosition = geometry_->getMorphAttribute("position");
+        const auto* morphNormal = in.normals && morphMaterial->morphNormals ? geometry_->getMorphAttribute("normal") : nullptr;
+        const auto& weights = morphTargetInfluences();
+        for (std::size_t k = 0; morphPosition && k < morphPosition->size() && k < weights.size(); ++k) {
+            const auto* p = (*morphPosition)[k].get();
+            if (weights[k] == 0 || !p || static_cast<std::size_t>(p->count()) < count) continue;
+            auto* n = morphNormal && k < morphNormal->size() ? (*morphNormal)[k].get() : nullptr;
+            if (n && static_cast<std::size_t>(n->count()) < count) n = nullptr;
+            morphs.push_back({weights[k], FloatAttributeView(p), FloatAttributeView(n)});
+        }
+    }
+    const bool relative = geometry_->morphTargetsRelative;
+
+    const auto run = [&](std::size_t lo, std::size_t hi) {
+        Lanes l{};
+        for (std::size_t base = lo; base < hi; base += 4) {
+
+            const auto n = std::min<std::size_t>(4, hi - base);
+            for (std::size_t v = 0; v < 4; ++v) {
+
+                if (v >= n) {
+                    l.px[v] = l.py[v] = l.pz[v] = l.nx[v] = l.ny[v] = l.nz[v] = 0;
+                    for (int j = 0; j < 4; ++j) {
+                        l.w[j][v] = 0;
+                        l.bone[j][v] = 0;
+                    }
+                    continue;
+                }
+
+                const auto i = first + base + v;
+                const float* p = position.data() + i * position.itemSize();
+                float x = p[0], y = p[1], z = p[2];
+                for (const auto& morph : morphs) {
+                    const float* q = morph.position.data() + i * morph.position.itemSize();
+                    if (relative) {
+                        x += q[0] * morph.influence;
+                        y += q[1] * morph.influence;
+                        z += q[2] * morph.influence;
+                    } else {
+                        x += (q[0] - p[0]) * morph.influence;
+                        y += (q[1] - p[1]) * morph.influence;
+                        z += (q[2] - p[2]) * morph.influence;
+                    }
+                }
+                l.px[v] = x;
+                l.py[v] = y;
+                l.pz[v] = z;
+
+                if (hasNormal) {
+                    const float* nn = normal.data() + i * normal.itemSize();
+                    x = nn[0], y = nn[1], z = nn[2];
+                    for (const auto& morph : morphs) {
+                        if (!morph.normal) continue;
+                        const float* q = morph.normal.data() + i * morph.normal.itemSize();
+                        if (relative) {
+                            x += q[0] * morph.influence;
+                            y += q[1] * morph.influence;
+                            z += q[2] * morph.influence;
+                        } else {
+                            x += (q[0] - nn[0]) * morph.influence;
+                            y += (q[1] - nn[1]) * morph.influence;
+                            z += (q[2] - nn[2]) * morph.influence;
+                        }
+                    }
+                } else {
+                    x = y = z = 0;
+                }
+                l.nx[v] = x;
+                l.ny[v] = y;
+                l.nz[v] = z;
+
+                if (skinned) {
+                    const float* si = skinIndex.data() + i * skinIndex.itemSize();
+                    const float* sw = skinWeight.data() + i * skinWeight.itemSize();
+                    for (int j = 0; j < 4; ++j) {
+                        const auto bone = static_cast<std::size_t>(si[j]);
+                        // A weight on a bone the skeleton does not have is
+                        // dropped; boneTransform would read past the end.
+                        const bool valid = si[j] >= 0 && bone < in.numBones;
+                        l.w[j][v] = valid ? sw[j] : 0;
+                        l.bone[j][v] = valid ? static_cast<int>(bone) : 0;
+                    }
+                } else {
+                    for (int j = 0; j < 4; ++j) {
+                        l.w[j][v] = j == 0 ? 1.f : 0.f;
+                        l.bone[j][v] = 0;
+                    }
+                }
+            }
+
+            skinLanes(in, l);
+
+            for (std::size_t v = 0; v < n; ++v) {
+                positions[base + v].set(l.px[v], l.py[v], l.pz[v]);
+                if (in.normals) normals[base + v].set(l.nx[v], l.ny[v], l.nz[v]);
+            }
+        }
+    };
+
+    // Below this a pool hand-off costs more than it saves. Lanes are
+    // independent, so how the range is cut does not change a single bit.
+    constexpr std::size_t parallelThreshold = 16384;
+    constexpr std::size_t grain = 8192;
+    if (positions.size() < parallelThreshold) {
+        run(0, positions.size());
+    } else {
+        parallelFor(0, positions.size(), grain, run);
+    }
+}
+
+const std::vector<Vector3>& SkinnedMesh::posedPositions() {
+
+    const auto position = geometry_ ? geometry_->getAttribute("position") : nullptr;
+    if (posedPositionsDirty_ || !position || posedPositions_.size() != static_cast<std::size_t>(position->count())) {
+        Box3 box;
+        skinPositions(box);
+    }
+    return posedPositions_;
+}
+
+void SkinnedMesh::skinPositions(Box3& box) {
+
+    const auto position = geometry_ ? geometry_->getAttribute("position") : nullptr;
+
+    posedPositions_.resize(position ? position->count() : 0);
+    skinVertices(posedPositions_);
+    posedPositionsDirty_ = false;
+    posedTreeDirty_ = true;
+
+    for (const auto& vertex : posedPositions_) box.expandByPoint(vertex);
 }
 
 void SkinnedMesh::computePosedBounds() {
@@ -107,10 +508,27 @@ void SkinnedMesh::computePosedBounds() {
         return;
     }
 
-    Vector3 vertex;
-    for (unsigned i = 0, l = position->count(); i < l; ++i) {
-        boneTransform(i, vertex);
-        posedBox_.expandByPoint(vertex);
+    if (!exactPosedBounds &&
+        (boneBoxesGeometry_ != geometry_.get() || boneBoxesSkeleton_ != skeleton.get() ||
+         boneBoxesVertexCount_ != static_cast<std::size_t>(position->count()))) {
+        computeBoneBoxes();
+    }
+
+    // The bone boxes hold the rest positions; a morph can carry a vertex out
+    // of them, so a morphed pose is boxed from the vertices themselves.
+    if (exactPosedBounds || !boneBoxesUsable_ || morphsApplied()) {
+        skinPositions(posedBox_);
+    } else {
+        Box3 box;
+        const auto& bones = skeleton->bones;
+        for (std::size_t b = 0; b < boneBoxes_.size(); ++b) {
+            if (boneBoxes_[b].isEmpty()) continue;
+            // The box is already in the bone's frame (boneInverse applied), so
+            // the rest of boneTransform's chain: the bone as posed now, then
+            // into this mesh's local frame.
+            _matrix.multiplyMatrices(this->bindMatrixInverse, *bones[b]->matrixWorld);
+            posedBox_.union_(box.copy(boneBoxes_[b]).applyMatrix4(_matrix));
+        }
     }
     posedBox_.getBoundingSphere(posedSphere_);
 }
@@ -142,6 +560,28 @@ const Box3* SkinnedMesh::raycastBoundingBox() {
     return box.isEmpty() ? nullptr : &box;
 }
 
+std::shared_ptr<const BVH> SkinnedMesh::raycastBoundsTree() {
+
+    auto rest = Mesh::raycastBoundsTree();
+    const auto position = geometry_ ? geometry_->getAttribute<float>("position") : nullptr;
+    // Unbound: drawn at rest, which is what the geometry's tree holds.
+    if (!rest || !position || !skeleton || skeleton->bones.empty()) return rest;
+
+    if (posedPositionsDirty_ || posedPositions_.size() != static_cast<size_t>(position->count())) {
+        Box3 exact;
+        skinPositions(exact);
+    }
+
+    if (posedTreeDirty_ || posedTreeSource_ != rest) {
+        if (posedTreeSource_ != rest) posedTree_ = std::make_shared<BVH>(*rest);
+        posedTree_->refit(posedPositions_);
+        posedTreeSource_ = std::move(rest);
+        posedTreeDirty_ = false;
+    }
+
+    return posedTree_;
+}
+
 void SkinnedMesh::boneTransform(size_t index, Vector3& target) {
 
     // skinIndex is a float attribute everywhere it is produced (GLTFLoader's
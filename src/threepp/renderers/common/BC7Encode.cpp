@@ -1,10 +1,11 @@
 #include "threepp/renderers/common/BC7Encode.hpp"
 
+#include "threepp/utils/Parallel.hpp"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstring>
-#include <thread>
 
 namespace threepp::bcn {
 
@@ -279,22 +280,13 @@ std::vector<std::uint8_t> bc7EncodeMode6(const std::uint8_t* rgba, int w, int h)
 
     // Parallel over block rows. Load-time transcoding is the hot path for
     // texture-heavy scenes (Bistro: hundreds of multi-megapixel textures), so
-    // saturate the machine; small images stay single-threaded to skip the
-    // thread spawn cost.
-    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
-    const int rowsPerThread = 8;
-    if (hw > 1 && bh > rowsPerThread * 2) {
-        const int nThreads = static_cast<int>(std::min<unsigned>(hw, (bh + rowsPerThread - 1) / rowsPerThread));
-        std::vector<std::thread> pool;
-        pool.reserve(nThreads);
-        const int chunk = (bh + nThreads - 1) / nThreads;
-        for (int t = 0; t < nThreads; ++t) {
-            const int y0 = t * chunk;
-            const int y1 = std::min(bh, y0 + chunk);
-            if (y0 >= y1) break;
-            pool.emplace_back(encodeRows, y0, y1);
-        }
-        for (auto& th : pool) th.join();
+    // saturate the machine; images of 16 block rows or fewer fit in a single
+    // piece and stay on the calling thread.
+    const int rowsPerPiece = 8;
+    if (bh > rowsPerPiece * 2) {
+        parallelFor(0, static_cast<size_t>(bh), rowsPerPiece, [&](size_t y0, size_t y1) {
+            encodeRows(static_cast<int>(y0), static_cast<int>(y1));
+        });
     } else {
         encodeRows(0, bh);
     }
@@ -4,12 +4,68 @@
 #include "threepp/materials/interfaces.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
 #include <memory>
 
 using namespace threepp;
 
 namespace {
 
+    // Below this the comparator sort wins: the radix passes pay for their
+    // histograms whatever the list length.
+    constexpr size_t radixSortMinItems = 128;
+
+    uint64_t packOrder(int groupOrder, int renderOrder) {
+
+        return static_cast<uint64_t>(static_cast<uint32_t>(groupOrder) ^ 0x80000000u) << 32 |
+               (static_cast<uint32_t>(renderOrder) ^ 0x80000000u);
+    }
+
+    // Unsigned bits that order like the floats. -0 is folded onto +0 because
+    // the comparators treat the two as equal. NaN sorts to one end instead of
+    // leaving the order undefined.
+    uint32_t orderedBits(float z) {
+
+        if (z == 0) z = 0;
+        const auto bits = std::bit_cast<uint32_t>(z);
+        return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    }
+
+    uint64_t packDepth(float z, unsigned int id, bool backToFront) {
+
+        const uint32_t bits = backToFront ? ~orderedBits(z) : orderedBits(z);
+        return static_cast<uint64_t>(bits) << 32 | id;
+    }
+
+    // Stable LSD radix sort on Entry::key, one byte per pass. A byte every
+    // entry shares is skipped, so a scene with a handful of programs,
+    // materials and render orders pays for the bytes that actually vary.
+    template<class Entry>
+    void radixSortEntries(std::vector<Entry>& entries, std::vector<Entry>& scratch) {
+
+        const size_t n = entries.size();
+        std::array<std::array<uint32_t, 256>, 8> counts{};
+        for (const auto& e : entries) {
+            for (int b = 0; b < 8; ++b) ++counts[b][(e.key >> (8 * b)) & 0xff];
+        }
+
+        for (int b = 0; b < 8; ++b) {
+            auto& c = counts[b];
+            if (c[(entries.front().key >> (8 * b)) & 0xff] == n) continue;
+
+            uint32_t sum = 0;
+            for (auto& count : c) {
+                const auto bucket = count;
+                count = sum;
+                sum += bucket;
+            }
+            for (const auto& e : entries) scratch[c[(e.key >> (8 * b)) & 0xff]++] = e;
+            entries.swap(scratch);
+        }
+    }
+
     struct {
 
         bool operator()(const RenderItem* a, const RenderItem* b) const {
@@ -51,6 +107,14 @@ RenderList::RenderList(ProgramIdResolver resolver): resolver_(std::move(resolver
 void RenderList::init() {
 
     renderItemsIndex = 0;
+    wideProgramIds_ = false;
+
+    ++frame_;
+    lastMaterial_ = nullptr;
+    lastInfo_ = nullptr;
+    // Entries for materials that are gone would otherwise pile up.
+    if (materialInfo_.size() > 2 * materialsThisFrame_ + 256) materialInfo_.clear();
+    materialsThisFrame_ = 0;
 
     opaque.clear();
     transmissive.clear();
@@ -63,43 +127,67 @@ RenderItem* RenderList::getNextRenderItem(
         Material* material,
         int groupOrder, float z, std::optional<GeometryGroup> group) {
 
-    uint64_t progId = resolver_ ? resolver_(material) : 0;
-
-    RenderItem* renderItem = nullptr;
+    const uint64_t progId = resolve(material).programId;
 
     if (renderItemsIndex >= renderItems.size()) {
-        auto r = std::make_unique<RenderItem>(RenderItem{object->id,
-                                                         object,
-                                                         geometry,
-                                                         material,
-                                                         progId,
-                                                         groupOrder,
-                                                         object->renderOrder,
-                                                         z,
-                                                         group});
-        renderItems.emplace_back(std::move(r));
-        renderItem = renderItems.back().get();
 
-    } else {
-
-        renderItem = renderItems.at(renderItemsIndex).get();
-
-        renderItem->id = object->id;
-        renderItem->object = object;
-        renderItem->geometry = geometry;
-        renderItem->material = material;
-        renderItem->programId = progId;
-        renderItem->groupOrder = groupOrder;
-        renderItem->renderOrder = object->renderOrder;
-        renderItem->z = z;
-        renderItem->group = group;
+        if (renderItems.size() == renderItems.capacity()) grow();
+        renderItems.emplace_back();
     }
 
+    auto* renderItem = &renderItems[renderItemsIndex];
+
+    renderItem->id = object->id;
+    renderItem->object = object;
+    renderItem->geometry = geometry;
+    renderItem->material = material;
+    renderItem->programId = progId;
+    renderItem->groupOrder = groupOrder;
+    renderItem->renderOrder = object->renderOrder;
+    renderItem->z = z;
+    renderItem->group = group;
+
+    renderItem->orderKey = packOrder(groupOrder, object->renderOrder);
+    renderItem->stateKey = progId << 32 | material->id;
+    if (progId > 0xffffffffu) wideProgramIds_ = true;
+
     ++renderItemsIndex;
 
     return renderItem;
 }
 
+RenderList::MaterialInfo& RenderList::resolve(Material* material) {
+
+    if (material == lastMaterial_) return *lastInfo_;
+
+    auto& info = materialInfo_[material];
+    if (info.frame != frame_) {
+        info.frame = frame_;
+        info.programId = resolver_ ? resolver_(material) : 0;
+        info.transmission = dynamic_cast<MaterialWithTransmission*>(material);
+        ++materialsThisFrame_;
+    }
+
+    lastMaterial_ = material;
+    lastInfo_ = &info;
+    return info;
+}
+
+void RenderList::grow() {
+
+    std::vector<RenderItem> grown;
+    grown.reserve(std::max<size_t>(64, renderItems.capacity() * 2));
+    std::move(renderItems.begin(), renderItems.end(), std::back_inserter(grown));
+
+    // The old storage is still alive here, so the offsets are well defined.
+    const RenderItem* base = renderItems.data();
+    for (auto* list : {&opaque, &transmissive, &transparent}) {
+        for (auto& item : *list) item = grown.data() + (item - base);
+    }
+
+    renderItems.swap(grown);
+}
+
 void RenderList::push(
         Object3D* object,
         BufferGeometry* geometry,
@@ -108,17 +196,20 @@ void RenderList::push(
 
     auto renderItem = getNextRenderItem(object, geometry, material, groupOrder, z, group);
 
-    auto transmissionMaterial = dynamic_cast<MaterialWithTransmission*>(material);
+    auto transmissionMaterial = resolve(material).transmission;
     if (transmissionMaterial && transmissionMaterial->transmission > 0.f) {
 
+        renderItem->depthKey = packDepth(z, object->id, true);
         transmissive.insert(transmissive.begin(), renderItem);
 
     } else if (material->transparent) {
 
+        renderItem->depthKey = packDepth(z, object->id, true);
         transparent.emplace_back(renderItem);
 
     } else {
 
+        renderItem->depthKey = packDepth(z, object->id, false);
         opaque.emplace_back(renderItem);
     }
 }
@@ -133,19 +224,56 @@ void RenderList::unshift(
 
     if (material->transparent) {
 
+        renderItem->depthKey = packDepth(z, object->id, true);
         transparent.insert(transparent.begin(), renderItem);
 
     } else {
 
+        renderItem->depthKey = packDepth(z, object->id, false);
         opaque.insert(opaque.begin(), renderItem);
     }
 }
 
 void RenderList::sort() {
 
-    if (opaque.size() > 1) std::stable_sort(opaque.begin(), opaque.end(), painterSortStable);
-    if (transmissive.size() > 1) std::stable_sort(transmissive.begin(), transmissive.end(), reversePainterSortStable);
-    if (transparent.size() > 1) std::stable_sort(transparent.begin(), transparent.end(), reversePainterSortStable);
+    if (opaque.size() >= radixSortMinItems && !wideProgramIds_) {
+        radixSort(opaque, true);
+    } else if (opaque.size() > 1) {
+        std::stable_sort(opaque.begin(), opaque.end(), painterSortStable);
+    }
+
+    for (auto* list : {&transmissive, &transparent}) {
+        if (list->size() >= radixSortMinItems) {
+            radixSort(*list, false);
+        } else if (list->size() > 1) {
+            std::stable_sort(list->begin(), list->end(), reversePainterSortStable);
+        }
+    }
+}
+
+// Sorts (key, position) pairs one key word at a time, least significant word
+// first; every pass is stable, so the result is ordered exactly as the
+// comparator would order it, equal items keeping their list order.
+void RenderList::radixSort(std::vector<RenderItem*>& list, bool withState) {
+
+    const auto n = list.size();
+    sortEntries_.resize(n);
+    sortScratch_.resize(n);
+
+    for (size_t i = 0; i < n; ++i) sortEntries_[i] = {list[i]->depthKey, static_cast<uint32_t>(i)};
+    radixSortEntries(sortEntries_, sortScratch_);
+
+    if (withState) {
+        for (auto& e : sortEntries_) e.key = list[e.index]->stateKey;
+        radixSortEntries(sortEntries_, sortScratch_);
+    }
+
+    for (auto& e : sortEntries_) e.key = list[e.index]->orderKey;
+    radixSortEntries(sortEntries_, sortScratch_);
+
+    sortOrder_.resize(n);
+    for (size_t i = 0; i < n; ++i) sortOrder_[i] = list[sortEntries_[i].index];
+    list.swap(sortOrder_);
 }
 
 void RenderList::finish() {
@@ -154,16 +282,16 @@ void RenderList::finish() {
 
     for (auto i = renderItemsIndex, il = renderItems.size(); i < il; ++i) {
 
-        auto& renderItem = renderItems.at(i);
+        auto& renderItem = renderItems[i];
 
-        if (!renderItem->id) break;
+        if (!renderItem.id) break;
 
-        renderItem->id = std::nullopt;
-        renderItem->object = nullptr;
-        renderItem->geometry = nullptr;
-        renderItem->material = nullptr;
-        renderItem->programId = 0;
-        renderItem->group = std::nullopt;
+        renderItem.id = std::nullopt;
+        renderItem.object = nullptr;
+        renderItem.geometry = nullptr;
+        renderItem.material = nullptr;
+        renderItem.programId = 0;
+        renderItem.group = std::nullopt;
     }
 }
 
@@ -171,23 +299,15 @@ RenderLists::RenderLists(ProgramIdResolver resolver): resolver_(std::move(resolv
 
 RenderList* RenderLists::get(Object3D* scene, size_t renderCallDepth) {
 
-    if (!lists.contains(scene->uuid)) {
+    auto& l = lists[scene->id];
+    if (renderCallDepth >= l.size()) {
 
-        auto& l = lists[scene->uuid].emplace_back(std::make_unique<RenderList>(resolver_));
-        return l.get();
+        l.emplace_back(std::make_unique<RenderList>(resolver_));
+        return l.back().get();
 
     } else {
 
-        auto& l = lists.at(scene->uuid);
-        if (renderCallDepth >= l.size()) {
-
-            l.emplace_back(std::make_unique<RenderList>(resolver_));
-            return l.back().get();
-
-        } else {
-
-            return l.at(renderCallDepth).get();
-        }
+        return l[renderCallDepth].get();
     }
 }
 
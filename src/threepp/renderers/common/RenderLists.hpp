@@ -8,6 +8,8 @@
 #include "threepp/core/misc.hpp"
 #include "threepp/materials/Material.hpp"
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -16,6 +18,8 @@
 
 namespace threepp {
 
+    struct MaterialWithTransmission;
+
     struct RenderItem {
 
         std::optional<unsigned int> id;
@@ -30,6 +34,18 @@ namespace threepp {
         int renderOrder = 0;
         float z = 0;
         std::optional<GeometryGroup> group;
+
+        // The sort keys, packed when the item is pushed so RenderList::sort
+        // never chases material or object pointers. Each is an unsigned
+        // encoding of comparator fields, most significant first:
+        //   orderKey — groupOrder, renderOrder (sign bit flipped)
+        //   stateKey — programId, material id
+        //   depthKey — z as order-preserving bits (inverted for the
+        //              back-to-front lists), object id
+        // Lossless, so sorting on them reproduces the comparators exactly.
+        uint64_t orderKey = 0;
+        uint64_t stateKey = 0;
+        uint64_t depthKey = 0;
     };
 
     // Callback to resolve a material's current program ID.
@@ -42,7 +58,10 @@ namespace threepp {
         std::vector<RenderItem*> transmissive;
         std::vector<RenderItem*> transparent;
 
-        std::vector<std::unique_ptr<RenderItem>> renderItems;
+        // Contiguous and reused frame to frame; the three lists above point
+        // into it. Growing re-points them (see grow()), which only happens
+        // while a scene's item count is still climbing.
+        std::vector<RenderItem> renderItems;
         size_t renderItemsIndex = 0;
 
         explicit RenderList(ProgramIdResolver resolver = nullptr);
@@ -73,6 +92,43 @@ namespace threepp {
 
     private:
         ProgramIdResolver resolver_;
+
+        // What push needs from a material — its program id and transmission
+        // interface — resolved once per material per frame: the resolver is
+        // a map lookup and the cross-cast to MaterialWithTransmission costs
+        // more than the rest of a push. Stamped with the frame (init() count),
+        // so a stale entry, or one whose material died and whose address was
+        // reused, is simply resolved again.
+        struct MaterialInfo {
+            uint64_t frame = 0;
+            uint64_t programId = 0;
+            MaterialWithTransmission* transmission = nullptr;
+        };
+        std::unordered_map<Material*, MaterialInfo> materialInfo_;
+        uint64_t frame_ = 1;
+        size_t materialsThisFrame_ = 0;
+        // Consecutive pushes often share a material, and push looks its
+        // material up right after getNextRenderItem did.
+        Material* lastMaterial_ = nullptr;
+        MaterialInfo* lastInfo_ = nullptr;
+
+        // A program id above 32 bits does not fit stateKey; the opaque list
+        // then sorts with the comparator instead.
+        bool wideProgramIds_ = false;
+
+        struct SortEntry {
+            uint64_t key;
+            uint32_t index;
+        };
+        std::vector<SortEntry> sortEntries_;
+        std::vector<SortEntry> sortScratch_;
+        std::vector<RenderItem*> sortOrder_;
+
+        MaterialInfo& resolve(Material* material);
+
+        void grow();
+
+        void radixSort(std::vector<RenderItem*>& list, bool withState);
     };
 
     struct RenderLists {
@@ -86,7 +142,9 @@ namespace threepp {
     private:
         ProgramIdResolver resolver_;
 
-        std::unordered_map<std::string, std::vector<std::unique_ptr<RenderList>>> lists;
+        // Keyed by Object3D::id — hashing the uuid string per render call
+        // cost more than the lookup it guarded.
+        std::unordered_map<unsigned int, std::vector<std::unique_ptr<RenderList>>> lists;
     };
 
 }// namespace threepp
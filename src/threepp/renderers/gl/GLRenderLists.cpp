@@ -10,23 +10,15 @@ GLRenderLists::GLRenderLists(GLProperties& properties): properties(properties) {
 
 GLRenderList* GLRenderLists::get(Object3D* scene, size_t renderCallDepth) {
 
-    if (!lists.contains(scene->uuid)) {
+    auto& l = lists[scene->id];
+    if (renderCallDepth >= l.size()) {
 
-        auto& l = lists[scene->uuid].emplace_back(std::make_unique<GLRenderList>(properties));
-        return l.get();
+        l.emplace_back(std::make_unique<GLRenderList>(properties));
+        return l.back().get();
 
     } else {
 
-        auto& l = lists.at(scene->uuid);
-        if (renderCallDepth >= l.size()) {
-
-            l.emplace_back(std::make_unique<GLRenderList>(properties));
-            return l.back().get();
-
-        } else {
-
-            return l.at(renderCallDepth).get();
-        }
+        return l[renderCallDepth].get();
     }
 }
 
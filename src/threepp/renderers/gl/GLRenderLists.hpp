@@ -36,7 +36,8 @@ namespace threepp::gl {
     private:
         GLProperties& properties;
 
-        std::unordered_map<std::string, std::vector<std::unique_ptr<GLRenderList>>> lists;
+        // By Object3D::id, as RenderLists.
+        std::unordered_map<unsigned int, std::vector<std::unique_ptr<GLRenderList>>> lists;
     };
 
 }// namespace threepp::gl
@@ -12,6 +12,24 @@ std::string Scene::type() const {
     return "Scene";
 }
 
+void Scene::updateMatrixWorld(bool force) {
+
+    if (!useTransformStore) {
+
+        transformStore_.reset();
+        Object3D::updateMatrixWorld(force);
+        return;
+    }
+
+    // Keyed on the address: a moved-to Scene must not walk the old one.
+    if (!transformStore_ || &transformStore_->root() != this) {
+
+        transformStore_ = std::make_unique<TransformStore>(*this);
+    }
+
+    transformStore_->update(force);
+}
+
 std::shared_ptr<Scene> Scene::create() {
 
     return std::make_shared<Scene>();
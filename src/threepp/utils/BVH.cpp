@@ -1,9 +1,12 @@
 #include "threepp/utils/BVH.hpp"
 
 #include "threepp/core/BufferGeometry.hpp"
+#include "threepp/math/Sphere.hpp"
+#include "threepp/utils/Parallel.hpp"
 
 #include <algorithm>
-#include <functional>
+#include <array>
+#include <cmath>
 
 using namespace threepp;
 
@@ -13,165 +16,402 @@ namespace {
     // from hitting the surfaces the endpoints sit on.
     constexpr float rayEps = 1e-4f;
 
-}// namespace
+    constexpr int numBins = 16;
+
+    // Subtrees with at least this many triangles build their two children on
+    // the thread pool, and bin/bound their triangles with parallelReduce.
+    constexpr std::uint32_t parallelBuildThreshold = 16384;
+
+    struct Aabb {
+        float min[3]{+Infinity<float>, +Infinity<float>, +Infinity<float>};
+        float max[3]{-Infinity<float>, -Infinity<float>, -Infinity<float>};
+
+        void grow(const float p[3]) {
+            for (int a = 0; a < 3; ++a) {
+                min[a] = std::min(min[a], p[a]);
+                max[a] = std::max(max[a], p[a]);
+            }
+        }
+
+        void grow(const Aabb& b) {
+            for (int a = 0; a < 3; ++a) {
+                min[a] = std::min(min[a], b.min[a]);
+                max[a] = std::max(max[a], b.max[a]);
+            }
+        }
+
+        [[nodiscard]] float halfArea() const {
+            const float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+            if (dx < 0 || dy < 0 || dz < 0) return 0.f;
+            return dx * dy + dy * dz + dz * dx;
+        }
+    };
+
+    struct Bin {
+        Aabb bounds;
+        std::uint32_t count = 0;
+    };
+
+    using Bins = std::array<std::array<Bin, numBins>, 3>;
+
+    // Node bounds and centroid bounds of a triangle range, in one pass.
+    struct RangeBounds {
+        Aabb bounds;
+        Aabb centroids;
+
+        RangeBounds& merge(const RangeBounds& o) {
+            bounds.grow(o.bounds);
+            centroids.grow(o.centroids);
+            return *this;
+        }
+    };
 
+    Box3 toBox3(const float mn[3], const float mx[3]) {
+        return {{mn[0], mn[1], mn[2]}, {mx[0], mx[1], mx[2]}};
+    }
 
-std::unique_ptr<BVH::BVHNode> BVH::buildNode(std::vector<int>& indices, int depth) {
-    auto node = std::make_unique<BVHNode>();
-
-    // Calculate bounding box for all triangles in this node
-    if (!indices.empty()) {
-        // Initialize with first triangle's bounding box
-        Box3 tmpBox;
-        tmpBox.expandByPoint(triangles[indices[0]].a());
-        tmpBox.expandByPoint(triangles[indices[0]].b());
-        tmpBox.expandByPoint(triangles[indices[0]].c());
-        node->boundingBox = tmpBox;
-
-        // Union with remaining triangles
-        for (size_t i = 1; i < indices.size(); i++) {
-            tmpBox.makeEmpty();
-            tmpBox.expandByPoint(triangles[indices[i]].a());
-            tmpBox.expandByPoint(triangles[indices[i]].b());
-            tmpBox.expandByPoint(triangles[indices[i]].c());
-            node->boundingBox.union_(tmpBox);
+    // Parametric entry distance of the ray into [mn, mx], or +inf on a miss
+    // or when the entry lies beyond tMax. 0 when the origin is inside.
+    float rayBoxEntry(const float o[3], const float invD[3], const float mn[3], const float mx[3], float tMax) {
+        float t0 = 0.f, t1 = tMax;
+        for (int a = 0; a < 3; ++a) {
+            float tNear = (mn[a] - o[a]) * invD[a];
+            float tFar = (mx[a] - o[a]) * invD[a];
+            if (tNear > tFar) std::swap(tNear, tFar);
+            // NaN (0 * inf on a slab boundary) compares false and keeps the
+            // previous bound — the conservative answer.
+            t0 = tNear > t0 ? tNear : t0;
+            t1 = tFar < t1 ? tFar : t1;
+            if (t0 > t1) return Infinity<float>;
         }
+        return t0;
     }
 
-    // Stopping criteria: max depth reached or few enough triangles
-    if (depth >= maxSubdivisions || static_cast<int>(indices.size()) <= maxTrianglesPerNode) {
-        node->triangleIndices = indices;
-        return node;
+    // Precomputed per-ray data for the slab tests.
+    struct RaySlab {
+        float o[3];
+        float invD[3];
+        float dirLength;// parametric t * dirLength = distance
+
+        explicit RaySlab(const Ray& ray)
+            : o{ray.origin.x, ray.origin.y, ray.origin.z},
+              invD{1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z},
+              dirLength(ray.direction.length()) {}
+    };
+
+    void triangleBox(const Triangle& tri, Box3& box) {
+        box.makeEmpty();
+        box.expandByPoint(tri.a());
+        box.expandByPoint(tri.b());
+        box.expandByPoint(tri.c());
     }
 
-    // Find longest axis of the bounding box
-    Vector3 size;
-    node->boundingBox.getSize(size);
+}// namespace
 
-    int axis = 0;
-    if (size.y > size.x) axis = 1;
-    if (size.z > size[axis]) axis = 2;
 
-    // Sort triangle indices along the longest axis
-    Vector3 centerA, centerB;
-    std::ranges::sort(indices, [this, axis, &centerA, &centerB](int a, int b) {
-        triangles[a].getMidpoint(centerA);
-        triangles[b].getMidpoint(centerB);
-        return centerA[axis] < centerB[axis];
-    });
+struct BVH::Builder {
+
+    const std::vector<Triangle>& source;
+    std::vector<Aabb> triBounds;
+    std::vector<float> centroids;// xyz per triangle
+    std::vector<std::uint32_t> ids;
+    std::uint32_t maxLeaf;
+    int maxDepthCap;
+
+    Builder(const std::vector<Triangle>& source, int maxTrianglesPerNode, int maxSubdivisions)
+        : source(source),
+          triBounds(source.size()),
+          centroids(source.size() * 3),
+          ids(source.size()),
+          maxLeaf(static_cast<std::uint32_t>(std::max(1, maxTrianglesPerNode))),
+          maxDepthCap(std::clamp(maxSubdivisions, 0, BVH::maxDepth - 1)) {
+
+        parallelFor(0, source.size(), 4096, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                const Triangle& t = source[i];
+                Aabb& b = triBounds[i];
+                for (const Vector3* v : {&t.a(), &t.b(), &t.c()}) {
+                    const float p[3]{v->x, v->y, v->z};
+                    b.grow(p);
+                }
+                centroids[i * 3 + 0] = (t.a().x + t.b().x + t.c().x) / 3.f;
+                centroids[i * 3 + 1] = (t.a().y + t.b().y + t.c().y) / 3.f;
+                centroids[i * 3 + 2] = (t.a().z + t.b().z + t.c().z) / 3.f;
+                ids[i] = static_cast<std::uint32_t>(i);
+            }
+        });
+    }
 
-    // Split triangles into two groups
-    const auto mid = static_cast<int>(indices.size() / 2);
-    std::vector<int> leftIndices(indices.begin(), indices.begin() + mid);
-    std::vector<int> rightIndices(indices.begin() + mid, indices.end());
+    [[nodiscard]] RangeBounds boundsOf(std::uint32_t begin, std::uint32_t end) const {
+        const auto fold = [&](std::size_t lo, std::size_t hi) {
+            RangeBounds r;
+            for (std::size_t k = lo; k < hi; ++k) {
+                r.bounds.grow(triBounds[ids[k]]);
+                r.centroids.grow(&centroids[ids[k] * 3]);
+            }
+            return r;
+        };
+        if (end - begin < parallelBuildThreshold) return fold(begin, end);
+        return parallelReduce(begin, end, 0, RangeBounds{}, fold,
+                              [](RangeBounds a, const RangeBounds& b) { return a.merge(b); });
+    }
 
-    // Recursively build child nodes
-    node->left = buildNode(leftIndices, depth + 1);
-    node->right = buildNode(rightIndices, depth + 1);
+    [[nodiscard]] static int binOf(float c, float cmin, float scale) {
+        return std::min(numBins - 1, static_cast<int>((c - cmin) * scale));
+    }
+
+    [[nodiscard]] Bins binRange(std::uint32_t begin, std::uint32_t end, const Aabb& cb) const {
+        const auto fold = [&](std::size_t lo, std::size_t hi) {
+            Bins bins{};
+            for (int a = 0; a < 3; ++a) {
+                const float extent = cb.max[a] - cb.min[a];
+                if (extent <= 0.f) continue;
+                const float scale = numBins / extent;
+                for (std::size_t k = lo; k < hi; ++k) {
+                    const std::uint32_t id = ids[k];
+                    Bin& bin = bins[a][binOf(centroids[id * 3 + a], cb.min[a], scale)];
+                    bin.bounds.grow(triBounds[id]);
+                    ++bin.count;
+                }
+            }
+            return bins;
+        };
+        const auto merge = [](Bins a, const Bins& b) {
+            for (int ax = 0; ax < 3; ++ax) {
+                for (int i = 0; i < numBins; ++i) {
+                    a[ax][i].bounds.grow(b[ax][i].bounds);
+                    a[ax][i].count += b[ax][i].count;
+                }
+            }
+            return a;
+        };
+        if (end - begin < parallelBuildThreshold) return fold(begin, end);
+        return parallelReduce(begin, end, 0, Bins{}, fold, merge);
+    }
+
+    // Returns the split point; `axis` receives the split axis.
+    std::uint32_t split(std::uint32_t begin, std::uint32_t end, const Aabb& cb, int& axis) {
+
+        const Bins bins = binRange(begin, end, cb);
+
+        float bestCost = Infinity<float>;
+        int bestAxis = -1, bestBin = -1;
+        for (int a = 0; a < 3; ++a) {
+            if (cb.max[a] - cb.min[a] <= 0.f) continue;
+
+            // Right-to-left sweep first, then evaluate on the way back.
+            std::array<float, numBins> rightArea{};
+            std::array<std::uint32_t, numBins> rightCount{};
+            Aabb acc;
+            std::uint32_t cnt = 0;
+            for (int i = numBins - 1; i > 0; --i) {
+                acc.grow(bins[a][i].bounds);
+                cnt += bins[a][i].count;
+                rightArea[i] = acc.halfArea();
+                rightCount[i] = cnt;
+            }
+
+            acc = Aabb{};
+            cnt = 0;
+            for (int i = 0; i < numBins - 1; ++i) {
+                acc.grow(bins[a][i].bounds);
+                cnt += bins[a][i].count;
+                if (cnt == 0 || rightCount[i + 1] == 0) continue;
+                const float cost = static_cast<float>(cnt) * acc.halfArea() +
+                                   static_cast<float>(rightCount[i + 1]) * rightArea[i + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestBin = i;
+                }
+            }
+        }
+
+        if (bestAxis < 0) {
+            // Every centroid in one place: no plane separates them, so split
+            // the range in half to still respect the leaf size.
+            axis = 0;
+            return begin + (end - begin) / 2;
+        }
+
+        axis = bestAxis;
+        const float cmin = cb.min[bestAxis];
+        const float scale = numBins / (cb.max[bestAxis] - cmin);
+        const auto mid = std::partition(ids.begin() + begin, ids.begin() + end, [&](std::uint32_t id) {
+            return binOf(centroids[id * 3 + bestAxis], cmin, scale) <= bestBin;
+        });
+        return static_cast<std::uint32_t>(mid - ids.begin());
+    }
+
+    // Appends the subtree over ids[begin, end) to `out` in depth-first order
+    // (interior offsets relative to the start of `out`) and returns its depth.
+    int build(std::uint32_t begin, std::uint32_t end, int depth, std::vector<Node>& out) {
+
+        const RangeBounds rb = boundsOf(begin, end);
+        const std::uint32_t count = end - begin;
+
+        const std::size_t self = out.size();
+        Node node{};
+        std::copy_n(rb.bounds.min, 3, node.min);
+        std::copy_n(rb.bounds.max, 3, node.max);
+
+        if (count <= maxLeaf || depth >= maxDepthCap) {
+            node.offset = begin;
+            node.count = count;
+            out.push_back(node);
+            return 1;
+        }
+
+        int axis = 0;
+        const std::uint32_t mid = split(begin, end, rb.centroids, axis);
+        node.axis = axis;
+        out.push_back(node);
+
+        int leftDepth, rightDepth;
+        if (count >= parallelBuildThreshold) {
+            std::vector<Node> sub[2];
+            int subDepth[2]{};
+            parallelFor(0, 2, 1, [&](std::size_t lo, std::size_t hi) {
+                for (std::size_t i = lo; i < hi; ++i) {
+                    subDepth[i] = i == 0 ? build(begin, mid, depth + 1, sub[0])
+                                         : build(mid, end, depth + 1, sub[1]);
+                }
+            });
+            splice(sub[0], out);
+            out[self].offset = static_cast<std::uint32_t>(out.size());
+            splice(sub[1], out);
+            leftDepth = subDepth[0];
+            rightDepth = subDepth[1];
+        } else {
+            leftDepth = build(begin, mid, depth + 1, out);
+            out[self].offset = static_cast<std::uint32_t>(out.size());
+            rightDepth = build(mid, end, depth + 1, out);
+        }
+
+        return 1 + std::max(leftDepth, rightDepth);
+    }
+
+    static void splice(const std::vector<Node>& sub, std::vector<Node>& out) {
+        const auto base = static_cast<std::uint32_t>(out.size());
+        for (Node n : sub) {
+            if (n.count == 0) n.offset += base;
+            out.push_back(n);
+        }
+    }
+};
 
-    return node;
-}
 
 void BVH::build(const BufferGeometry& geom) {
+    nodes.clear();
     triangles.clear();
+    triangleIds.clear();
+    treeDepth = 0;
     geometry = &geom;
 
     const auto posAttr = geom.getAttribute<float>("position");
     if (!posAttr) return;
 
-    std::vector<int> indices;
+    std::vector<Triangle> source;
+    const auto vertex = [&](int i) {
+        return Vector3(posAttr->getX(i), posAttr->getY(i), posAttr->getZ(i));
+    };
     if (geom.hasIndex()) {
         const auto index = geom.getIndex();
-        for (int i = 0; i < index->count(); i += 3) {
-            const auto a = index->getX(i);
-            const auto b = index->getX(i + 1);
-            const auto c = index->getX(i + 2);
-
-            Triangle tri(
-                    Vector3(posAttr->getX(a), posAttr->getY(a), posAttr->getZ(a)),
-                    Vector3(posAttr->getX(b), posAttr->getY(b), posAttr->getZ(b)),
-                    Vector3(posAttr->getX(c), posAttr->getY(c), posAttr->getZ(c)));
-
-            triangles.emplace_back(tri);
-            indices.emplace_back(static_cast<int>(triangles.size()) - 1);
-        }
+        source.resize(index->count() / 3);
+        parallelFor(0, source.size(), 4096, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t t = lo; t < hi; ++t) {
+                const auto i = static_cast<int>(t * 3);
+                source[t].set(vertex(index->getX(i)), vertex(index->getX(i + 1)), vertex(index->getX(i + 2)));
+            }
+        });
     } else {
-        for (int i = 0; i < posAttr->count(); i += 3) {
-            Triangle tri(
-                    Vector3(posAttr->getX(i), posAttr->getY(i), posAttr->getZ(i)),
-                    Vector3(posAttr->getX(i + 1), posAttr->getY(i + 1), posAttr->getZ(i + 1)),
-                    Vector3(posAttr->getX(i + 2), posAttr->getY(i + 2), posAttr->getZ(i + 2)));
-
-            triangles.emplace_back(tri);
-            indices.emplace_back(static_cast<int>(triangles.size()) - 1);
-        }
+        source.resize(posAttr->count() / 3);
+        parallelFor(0, source.size(), 4096, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t t = lo; t < hi; ++t) {
+                const auto i = static_cast<int>(t * 3);
+                source[t].set(vertex(i), vertex(i + 1), vertex(i + 2));
+            }
+        });
+    }
+    if (source.empty()) return;
+
+    Builder builder(source, maxTrianglesPerNode, maxSubdivisions);
+    nodes.reserve(2 * source.size() / std::max(1, maxTrianglesPerNode) + 1);
+    treeDepth = builder.build(0, static_cast<std::uint32_t>(source.size()), 0, nodes);
+
+    // Leaf order: every leaf's triangles are one contiguous block.
+    triangles.resize(source.size());
+    triangleIds.resize(source.size());
+    for (std::size_t k = 0; k < source.size(); ++k) {
+        triangles[k] = source[builder.ids[k]];
+        triangleIds[k] = static_cast<int>(builder.ids[k]);
     }
-
-    // Build the BVH from triangles
-    root = buildNode(indices, 0);
 }
 
 std::vector<BVH::IntersectionResult> BVH::intersect(const BVH& b1, const Matrix4& m1, const BVH& b2, const Matrix4& m2, bool accurate) {
     std::vector<IntersectionResult> results;
 
     // Test intersection between the two BVH trees
-    intersectBVHNodes(b1, b1.root.get(), m1, b2, b2.root.get(), m2, results, accurate);
+    intersectBVHNodes(b1, m1, b2, m2, results, accurate);
 
     return results;
 }
 
 std::vector<int> BVH::intersect(const Box3& box, const Matrix4& m) const {
     std::vector<int> results;
+    if (nodes.empty()) return results;
 
-    std::function<void(const BVHNode*)> traverse = [&](const BVHNode* node) {
-        if (!node) return;
+    std::uint32_t stack[maxDepth];
+    int sp = 0;
+    stack[sp++] = 0;
 
-        if (!node->boundingBox.clone().applyMatrix4(m).intersectsBox(box)) {
-            return;
-        }
+    Box3 nodeBox, triBox;
+    while (sp > 0) {
+        const Node& node = nodes[stack[--sp]];
 
-        if (node->left == nullptr && node->right == nullptr) {
-            Box3 triBox;
+        nodeBox = toBox3(node.min, node.max);
+        if (!nodeBox.applyMatrix4(m).intersectsBox(box)) continue;
 
-            for (int idx : node->triangleIndices) {
-                triBox.makeEmpty();
-                triBox.expandByPoint(triangles[idx].a());
-                triBox.expandByPoint(triangles[idx].b());
-                triBox.expandByPoint(triangles[idx].c());
+        if (node.count > 0) {
+            for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+                triangleBox(triangles[k], triBox);
                 triBox.applyMatrix4(m);
 
                 if (box.intersectsBox(triBox)) {
-                    results.emplace_back(idx);
+                    results.emplace_back(triangleIds[k]);
                 }
             }
-            return;
+            continue;
         }
 
-        traverse(node->left.get());
-        traverse(node->right.get());
-    };
+        stack[sp++] = node.offset;
+        stack[sp++] = static_cast<std::uint32_t>(&node - nodes.data()) + 1;
+    }
 
-    traverse(root.get());
     return results;
 }
 
 std::vector<int> BVH::intersect(const Sphere& sphere, const Matrix4& m) const {
     std::vector<int> results;
+    if (nodes.empty()) return results;
 
-    std::function<void(const BVHNode*)> traverse = [&](const BVHNode* node) {
-        if (!node) return;
+    std::uint32_t stack[maxDepth];
+    int sp = 0;
+    stack[sp++] = 0;
 
-        if (!node->boundingBox.clone().applyMatrix4(m).intersectsSphere(sphere)) {
-            return;
-        }
+    Box3 nodeBox;
+    Vector3 a, b, c;
+    Vector3 closestPoint;
+    Triangle worldTri;
+    while (sp > 0) {
+        const Node& node = nodes[stack[--sp]];
 
-        if (node->isLeaf()) {
+        nodeBox = toBox3(node.min, node.max);
+        if (!nodeBox.applyMatrix4(m).intersectsSphere(sphere)) continue;
 
-            Vector3 a, b, c;
-            Vector3 closestPoint;
-            Triangle worldTri;
-            for (const int idx : node->triangleIndices) {
-                const Triangle& tri = triangles[idx];
+        if (node.count > 0) {
+            for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+                const Triangle& tri = triangles[k];
                 worldTri.set(
                         a.copy(tri.a()).applyMatrix4(m),
                         b.copy(tri.b()).applyMatrix4(m),
@@ -180,67 +420,57 @@ std::vector<int> BVH::intersect(const Sphere& sphere, const Matrix4& m) const {
                 const float distSq = closestPoint.distanceToSquared(sphere.center);
 
                 if (distSq <= (sphere.radius * sphere.radius)) {
-                    results.push_back(idx);
+                    results.push_back(triangleIds[k]);
                 }
             }
-            return;
+            continue;
         }
 
-        traverse(node->left.get());
-        traverse(node->right.get());
-    };
+        stack[sp++] = node.offset;
+        stack[sp++] = static_cast<std::uint32_t>(&node - nodes.data()) + 1;
+    }
 
-    traverse(root.get());
     return results;
 }
 
 bool BVH::intersects(const BVH& b1, const BVH& b2, const Matrix4& m1, const Matrix4& m2) {
-    if (!b1.root || !b2.root) return false;
-
-    // Create transformed copies of the bounding boxes
-    const Box3 thisRootBox = b1.root->boundingBox.clone().applyMatrix4(m1);
-    const Box3 otherRootBox = b2.root->boundingBox.clone().applyMatrix4(m2);
-
-    // Quick rejection test
-    if (!thisRootBox.intersectsBox(otherRootBox)) {
-        return false;
-    }
+    if (b1.nodes.empty() || b2.nodes.empty()) return false;
 
     Box3 boxA, boxB;
+    Box3 boxTriA, boxTriB;
     Vector3 sizeA, sizeB;
 
-    // Helper function to test transformed triangles
-    std::function<bool(const BVHNode*, const BVHNode*)> testNodes = [&](const BVHNode* nodeA, const BVHNode* nodeB) -> bool {
+    // Pairs still to test, popped depth first in the order the recursive
+    // version visited them.
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> stack;
+    stack.reserve(2 * maxDepth + 2);
+    stack.emplace_back(0, 0);
+
+    while (!stack.empty()) {
+        const auto [ia, ib] = stack.back();
+        stack.pop_back();
+        const Node& nodeA = b1.nodes[ia];
+        const Node& nodeB = b2.nodes[ib];
+
         // Transform bounding boxes for this test
-        boxA.copy(nodeA->boundingBox).applyMatrix4(m1);
-        boxB.copy(nodeB->boundingBox).applyMatrix4(m2);
+        boxA = toBox3(nodeA.min, nodeA.max);
+        boxA.applyMatrix4(m1);
+        boxB = toBox3(nodeB.min, nodeB.max);
+        boxB.applyMatrix4(m2);
 
-        if (!boxA.intersectsBox(boxB)) {
-            return false;
-        }
+        if (!boxA.intersectsBox(boxB)) continue;
 
         // If both nodes are leaves, test triangles
-        if (nodeA->isLeaf() && nodeB->isLeaf()) {
+        if (nodeA.count > 0 && nodeB.count > 0) {
 
-            Box3 boxTriA, boxTriB;
-            for (const int idxA : nodeA->triangleIndices) {
+            for (std::uint32_t ka = nodeA.offset; ka < nodeA.offset + nodeA.count; ++ka) {
 
-                const Triangle& triA = b1.triangles[idxA];
-
-                boxTriA.makeEmpty();
-                boxTriA.expandByPoint(triA.a());
-                boxTriA.expandByPoint(triA.b());
-                boxTriA.expandByPoint(triA.c());
+                triangleBox(b1.triangles[ka], boxTriA);
                 boxTriA.applyMatrix4(m1);
 
-                for (const int idxB : nodeB->triangleIndices) {
-
-                    const Triangle& triB = b2.triangles[idxB];
+                for (std::uint32_t kb = nodeB.offset; kb < nodeB.offset + nodeB.count; ++kb) {
 
-                    boxTriB.makeEmpty();
-                    boxTriB.expandByPoint(triB.a());
-                    boxTriB.expandByPoint(triB.b());
-                    boxTriB.expandByPoint(triB.c());
+                    triangleBox(b2.triangles[kb], boxTriB);
                     boxTriB.applyMatrix4(m2);
 
                     if (boxTriA.intersectsBox(boxTriB)) {
@@ -248,65 +478,61 @@ bool BVH::intersects(const BVH& b1, const BVH& b2, const Matrix4& m1, const Matr
                     }
                 }
             }
-            return false;
+            continue;
         }
 
-        // Recursively descend into smaller node first (heuristic)
-
+        // Descend into the smaller node first (heuristic); a leaf cannot be
+        // descended, so the other one is.
         boxA.getSize(sizeA);
         boxB.getSize(sizeB);
         const float volumeA = sizeA.x * sizeA.y * sizeA.z;
         const float volumeB = sizeB.x * sizeB.y * sizeB.z;
 
-        if (volumeA < volumeB) {
-            // A is smaller, descend A
-            if (nodeA->left && nodeA->right) {
-                return testNodes(nodeA->left.get(), nodeB) ||
-                       testNodes(nodeA->right.get(), nodeB);
-            } else {
-                // B must have children, descend B
-                return testNodes(nodeA, nodeB->left.get()) ||
-                       testNodes(nodeA, nodeB->right.get());
-            }
+        const bool descendA = nodeB.count > 0 || (nodeA.count == 0 && volumeA < volumeB);
+        if (descendA) {
+            stack.emplace_back(nodeA.offset, ib);
+            stack.emplace_back(ia + 1, ib);
         } else {
-            // B is smaller, descend B
-            if (nodeB->left && nodeB->right) {
-                return testNodes(nodeA, nodeB->left.get()) ||
-                       testNodes(nodeA, nodeB->right.get());
-            } else {
-                // A must have children, descend A
-                return testNodes(nodeA->left.get(), nodeB) ||
-                       testNodes(nodeA->right.get(), nodeB);
-            }
+            stack.emplace_back(ia, nodeB.offset);
+            stack.emplace_back(ia, ib + 1);
         }
-    };
+    }
 
-    return testNodes(b1.root.get(), b2.root.get());
+    return false;
 }
 
 std::optional<BVH::RayHit> BVH::raycast(const Ray& ray, float maxDistance) const {
-    if (!root) return std::nullopt;
+    if (nodes.empty()) return std::nullopt;
 
     std::optional<RayHit> best;
     float bestDistance = maxDistance - rayEps;
 
-    Vector3 point, boxPoint, edge1, edge2, normal;
+    const RaySlab slab(ray);
+    const float tLimit = bestDistance / slab.dirLength;
 
-    std::function<void(const BVHNode*)> traverse = [&](const BVHNode* node) {
-        if (!node) return;
+    struct Entry {
+        std::uint32_t node;
+        float t;// parametric entry distance
+    };
+    Entry stack[maxDepth];
+    int sp = 0;
+
+    const float tRoot = rayBoxEntry(slab.o, slab.invD, nodes[0].min, nodes[0].max, tLimit);
+    if (tRoot == Infinity<float>) return std::nullopt;
+    stack[sp++] = {0, tRoot};
+
+    Vector3 point, edge1, edge2, normal;
+    while (sp > 0) {
+        const Entry e = stack[--sp];
 
         // A node entered farther away than the current best cannot improve it.
-        // The entry distance is only meaningful from outside the box.
-        if (!node->boundingBox.containsPoint(ray.origin)) {
-            ray.intersectBox(node->boundingBox, boxPoint);
-            if (boxPoint.isNan()) return;
-            if (boxPoint.distanceTo(ray.origin) > bestDistance) return;
-        }
+        if (e.t * slab.dirLength > bestDistance) continue;
 
-        if (node->isLeaf()) {
+        const Node& node = nodes[e.node];
+        if (node.count > 0) {
 
-            for (const int idx : node->triangleIndices) {
-                const Triangle& tri = triangles[idx];
+            for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+                const Triangle& tri = triangles[k];
 
                 if (!ray.intersectTriangle(tri.a(), tri.b(), tri.c(), false, point)) continue;
 
@@ -319,35 +545,52 @@ std::optional<BVH::RayHit> BVH::raycast(const Ray& ray, float maxDistance) const
                 if (normal.dot(ray.direction) > 0) normal.negate();
 
                 bestDistance = distance;
-                best = RayHit{distance, idx, point, normal};
+                best = RayHit{distance, triangleIds[k], point, normal};
             }
-            return;
+            continue;
         }
 
-        traverse(node->left.get());
-        traverse(node->right.get());
-    };
+        // Nearer child on top of the stack, so it is searched first and its
+        // hits prune the farther one.
+        const std::uint32_t left = e.node + 1, right = node.offset;
+        const float tBest = bestDistance / slab.dirLength;
+        const float tl = rayBoxEntry(slab.o, slab.invD, nodes[left].min, nodes[left].max, tBest);
+        const float tr = rayBoxEntry(slab.o, slab.invD, nodes[right].min, nodes[right].max, tBest);
+        if (tl <= tr) {
+            if (tr != Infinity<float>) stack[sp++] = {right, tr};
+            if (tl != Infinity<float>) stack[sp++] = {left, tl};
+        } else {
+            if (tl != Infinity<float>) stack[sp++] = {left, tl};
+            stack[sp++] = {right, tr};
+        }
+    }
 
-    traverse(root.get());
     return best;
 }
 
 bool BVH::raycastAny(const Ray& ray, float maxDistance) const {
-    if (!root) return false;
+    if (nodes.empty()) return false;
 
     const float limit = maxDistance - rayEps;
 
-    Vector3 point;
+    const RaySlab slab(ray);
+    const float tLimit = limit / slab.dirLength;
+
+    std::uint32_t stack[maxDepth];
+    int sp = 0;
+    stack[sp++] = 0;
 
-    std::function<bool(const BVHNode*)> traverse = [&](const BVHNode* node) -> bool {
-        if (!node) return false;
+    Vector3 point;
+    while (sp > 0) {
+        const std::uint32_t index = stack[--sp];
+        const Node& node = nodes[index];
 
-        if (!ray.intersectsBox(node->boundingBox)) return false;
+        if (rayBoxEntry(slab.o, slab.invD, node.min, node.max, tLimit) == Infinity<float>) continue;
 
-        if (node->isLeaf()) {
+        if (node.count > 0) {
 
-            for (const int idx : node->triangleIndices) {
-                const Triangle& tri = triangles[idx];
+            for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+                const Triangle& tri = triangles[k];
 
                 if (!ray.intersectTriangle(tri.a(), tri.b(), tri.c(), false, point)) continue;
 
@@ -356,129 +599,217 @@ bool BVH::raycastAny(const Ray& ray, float maxDistance) const {
 
                 return true;
             }
-            return false;
+            continue;
         }
 
-        return traverse(node->left.get()) || traverse(node->right.get());
+        // Any hit will do: the child on the ray's side of the split first.
+        const bool leftFirst = ray.direction[node.axis] >= 0.f;
+        stack[sp++] = leftFirst ? node.offset : index + 1;
+        stack[sp++] = leftFirst ? index + 1 : node.offset;
+    }
+
+    return false;
+}
+
+void BVH::walkTriangles(const Ray& ray, float maxDistance, TriangleFn visit) const {
+    if (nodes.empty()) return;
+
+    float limit = maxDistance;
+
+    const RaySlab slab(ray);
+
+    struct Entry {
+        std::uint32_t node;
+        float t;// parametric entry distance
     };
+    Entry stack[maxDepth];
+    int sp = 0;
+
+    const float tRoot = rayBoxEntry(slab.o, slab.invD, nodes[0].min, nodes[0].max, limit / slab.dirLength);
+    if (tRoot == Infinity<float>) return;
+    stack[sp++] = {0, tRoot};
+
+    while (sp > 0) {
+        const Entry e = stack[--sp];
 
-    return traverse(root.get());
+        // visit may have lowered the limit since this node was pushed.
+        if (e.t * slab.dirLength > limit) continue;
+
+        const Node& node = nodes[e.node];
+        if (node.count > 0) {
+
+            for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+                limit = std::min(limit, visit(triangleIds[k]));
+            }
+            continue;
+        }
+
+        const std::uint32_t left = e.node + 1, right = node.offset;
+        const float tMax = limit / slab.dirLength;
+        const float tl = rayBoxEntry(slab.o, slab.invD, nodes[left].min, nodes[left].max, tMax);
+        const float tr = rayBoxEntry(slab.o, slab.invD, nodes[right].min, nodes[right].max, tMax);
+        if (tl <= tr) {
+            if (tr != Infinity<float>) stack[sp++] = {right, tr};
+            if (tl != Infinity<float>) stack[sp++] = {left, tl};
+        } else {
+            if (tl != Infinity<float>) stack[sp++] = {left, tl};
+            stack[sp++] = {right, tr};
+        }
+    }
+}
+
+void BVH::refit(const std::vector<Vector3>& positions) {
+    if (nodes.empty() || !geometry) return;
+
+    const auto* index = geometry->getIndex();
+    const auto vertex = [&](int i) -> const Vector3& {
+        return positions[static_cast<std::size_t>(index ? index->getX(i) : i)];
+    };
+
+    parallelFor(0, triangles.size(), 4096, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t k = lo; k < hi; ++k) {
+            const int i = triangleIds[k] * 3;
+            triangles[k].set(vertex(i), vertex(i + 1), vertex(i + 2));
+        }
+    });
+
+    // Pre-order puts every child after its parent, so a reverse sweep sees
+    // both children of a node before the node itself.
+    for (std::size_t n = nodes.size(); n-- > 0;) {
+        Node& node = nodes[n];
+        Aabb box;
+        if (node.count > 0) {
+            for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+                const Triangle& tri = triangles[k];
+                const float a[3]{tri.a().x, tri.a().y, tri.a().z};
+                const float b[3]{tri.b().x, tri.b().y, tri.b().z};
+                const float c[3]{tri.c().x, tri.c().y, tri.c().z};
+                box.grow(a);
+                box.grow(b);
+                box.grow(c);
+            }
+        } else {
+            for (const auto child : {static_cast<std::uint32_t>(n + 1), node.offset}) {
+                box.grow(nodes[child].min);
+                box.grow(nodes[child].max);
+            }
+        }
+        std::copy(box.min, box.min + 3, node.min);
+        std::copy(box.max, box.max + 3, node.max);
+    }
 }
 
 void BVH::collectBoxes(std::vector<BVHBox3>& boxes) const {
-    collectBoxes(root.get(), boxes);
+    // The node array is already in depth-first pre-order.
+    boxes.reserve(boxes.size() + nodes.size());
+    for (const Node& node : nodes) {
+        boxes.emplace_back(toBox3(node.min, node.max), node.count > 0);
+    }
 }
 
-void BVH::intersectBVHNodes(const BVH& b1, const BVHNode* nodeA, const Matrix4& m1, const BVH& b2, const BVHNode* nodeB, const Matrix4& m2, std::vector<IntersectionResult>& results, bool accurate) {
+void BVH::intersectBVHNodes(const BVH& b1, const Matrix4& m1, const BVH& b2, const Matrix4& m2, std::vector<IntersectionResult>& results, bool accurate) {
+    if (b1.nodes.empty() || b2.nodes.empty()) return;
 
-    Box3 bb1 = nodeA->boundingBox.clone();
-    bb1.applyMatrix4(m1);
+    Box3 bb1, bb2;
+    Box3 boxA, boxB, intersectionBox;
+    Vector3 center, sizeA, sizeB;
 
-    Box3 bb2 = nodeB->boundingBox.clone();
-    bb2.applyMatrix4(m2);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> stack;
+    stack.reserve(2 * maxDepth + 2);
+    stack.emplace_back(0, 0);
 
-    // Quick rejection test using bounding boxes
-    if (!bb1.intersectsBox(bb2)) {
-        return;
-    }
+    while (!stack.empty()) {
+        const auto [ia, ib] = stack.back();
+        stack.pop_back();
+        const Node& nodeA = b1.nodes[ia];
+        const Node& nodeB = b2.nodes[ib];
 
-    // If both nodes are leaves, test all triangle pairs
-    if (nodeA->isLeaf() && nodeB->isLeaf()) {
+        bb1 = toBox3(nodeA.min, nodeA.max);
+        bb1.applyMatrix4(m1);
 
-        Vector3 center;
-        if (accurate) {
-            Box3 boxA, boxB, intersectionBox;
-            for (const int idxA : nodeA->triangleIndices) {
+        bb2 = toBox3(nodeB.min, nodeB.max);
+        bb2.applyMatrix4(m2);
 
-                const Triangle& triA = b1.triangles[idxA];
+        // Quick rejection test using bounding boxes
+        if (!bb1.intersectsBox(bb2)) continue;
 
-                boxA.makeEmpty();
-                boxA.expandByPoint(triA.a());
-                boxA.expandByPoint(triA.b());
-                boxA.expandByPoint(triA.c());
-                boxA.applyMatrix4(m1);
+        // If both nodes are leaves, test all triangle pairs
+        if (nodeA.count > 0 && nodeB.count > 0) {
 
-                for (const int idxB : nodeB->triangleIndices) {
-                    // Could implement detailed triangle-triangle intersection here
-                    // For now, using bounding box test as an approximation
+            if (accurate) {
+                for (std::uint32_t ka = nodeA.offset; ka < nodeA.offset + nodeA.count; ++ka) {
 
-                    const Triangle& triB = b2.triangles[idxB];
+                    triangleBox(b1.triangles[ka], boxA);
+                    boxA.applyMatrix4(m1);
 
-                    boxB.makeEmpty();
-                    boxB.expandByPoint(triB.a());
-                    boxB.expandByPoint(triB.b());
-                    boxB.expandByPoint(triB.c());
-                    boxB.applyMatrix4(m2);
+                    for (std::uint32_t kb = nodeB.offset; kb < nodeB.offset + nodeB.count; ++kb) {
+                        // Could implement detailed triangle-triangle intersection here
+                        // For now, using bounding box test as an approximation
 
-                    if (boxA.intersectsBox(boxB)) {
-                        // Compute intersection box
-                        intersectionBox.set({std::max(boxA.min().x, boxB.min().x),
-                                             std::max(boxA.min().y, boxB.min().y),
-                                             std::max(boxA.min().z, boxB.min().z)},
-                                            {std::min(boxA.max().x, boxB.max().x),
-                                             std::min(boxA.max().y, boxB.max().y),
-                                             std::min(boxA.max().z, boxB.max().z)});
+                        triangleBox(b2.triangles[kb], boxB);
+                        boxB.applyMatrix4(m2);
 
+                        if (boxA.intersectsBox(boxB)) {
+                            // Compute intersection box
+                            intersectionBox.set({std::max(boxA.min().x, boxB.min().x),
+                                                 std::max(boxA.min().y, boxB.min().y),
+                                                 std::max(boxA.min().z, boxB.min().z)},
+                                                {std::min(boxA.max().x, boxB.max().x),
+                                                 std::min(boxA.max().y, boxB.max().y),
+                                                 std::min(boxA.max().z, boxB.max().z)});
 
-                        intersectionBox.getCenter(center);
-                        results.emplace_back(IntersectionResult{idxA, idxB, center});
+
+                            intersectionBox.getCenter(center);
+                            results.emplace_back(IntersectionResult{b1.triangleIds[ka], b2.triangleIds[kb], center});
+                        }
                     }
                 }
+            } else {
+                intersectionBox.set(
+                        {std::max(bb1.min().x, bb2.min().x),
+                         std::max(bb1.min().y, bb2.min().y),
+                         std::max(bb1.min().z, bb2.min().z)},
+                        {std::min(bb1.max().x, bb2.max().x),
+                         std::min(bb1.max().y, bb2.max().y),
+                         std::min(bb1.max().z, bb2.max().z)});
+
+                intersectionBox.getCenter(center);
+                // Use -1 for idxA/idxB to indicate node-level intersection
+                results.emplace_back(IntersectionResult{-1, -1, center});
             }
-        } else {
-            const Box3 intersectionBox(
-                    {std::max(bb1.min().x, bb2.min().x),
-                     std::max(bb1.min().y, bb2.min().y),
-                     std::max(bb1.min().z, bb2.min().z)},
-                    {std::min(bb1.max().x, bb2.max().x),
-                     std::min(bb1.max().y, bb2.max().y),
-                     std::min(bb1.max().z, bb2.max().z)});
-
-            intersectionBox.getCenter(center);
-            // Use -1 for idxA/idxB to indicate node-level intersection
-            results.emplace_back(IntersectionResult{-1, -1, center});
+            continue;
         }
-        return;
-    }
 
-    // Recursively descend into smaller node first (heuristic)
-    Vector3 sizeA, sizeB;
-    nodeA->boundingBox.getSize(sizeA);
-    nodeB->boundingBox.getSize(sizeB);
-    const float volumeA = sizeA.x * sizeA.y * sizeA.z;
-    const float volumeB = sizeB.x * sizeB.y * sizeB.z;
-
-    if (volumeA < volumeB) {
-        // A is smaller, descend A
-        if (nodeA->left && nodeA->right) {
-            intersectBVHNodes(b1, nodeA->left.get(), m1, b2, nodeB, m2, results, accurate);
-            intersectBVHNodes(b1, nodeA->right.get(), m1, b2, nodeB, m2, results, accurate);
-        } else {
-            // B must have children, descend B
-            intersectBVHNodes(b1, nodeA, m1, b2, nodeB->left.get(), m2, results, accurate);
-            intersectBVHNodes(b1, nodeA, m1, b2, nodeB->right.get(), m2, results, accurate);
-        }
-    } else {
-        // B is smaller, descend B
-        if (nodeB->left && nodeB->right) {
-            intersectBVHNodes(b1, nodeA, m1, b2, nodeB->left.get(), m2, results, accurate);
-            intersectBVHNodes(b1, nodeA, m1, b2, nodeB->right.get(), m2, results, accurate);
+        // Descend into the smaller node first (heuristic, untransformed
+        // sizes); a leaf cannot be descended, so the other one is.
+        sizeA.set(nodeA.max[0] - nodeA.min[0], nodeA.max[1] - nodeA.min[1], nodeA.max[2] - nodeA.min[2]);
+        sizeB.set(nodeB.max[0] - nodeB.min[0], nodeB.max[1] - nodeB.min[1], nodeB.max[2] - nodeB.min[2]);
+        const float volumeA = sizeA.x * sizeA.y * sizeA.z;
+        const float volumeB = sizeB.x * sizeB.y * sizeB.z;
+
+        const bool descendA = nodeB.count > 0 || (nodeA.count == 0 && volumeA < volumeB);
+        if (descendA) {
+            stack.emplace_back(nodeA.offset, ib);
+            stack.emplace_back(ia + 1, ib);
         } else {
-            // A must have children, descend A
-            intersectBVHNodes(b1, nodeA->left.get(), m1, b2, nodeB, m2, results, accurate);
-            intersectBVHNodes(b1, nodeA->right.get(), m1, b2, nodeB, m2, results, accurate);
+            stack.emplace_back(ia, nodeB.offset);
+            stack.emplace_back(ia, ib + 1);
         }
     }
 }
 
-void BVH::collectBoxes(const BVHNode* node, std::vector<BVHBox3>& boxes) {
-    if (!node) return;
+const BufferGeometry* BVH::getGeometry() const {
+    return geometry;
+}
 
-    boxes.emplace_back(node->boundingBox, node->isLeaf());
-    collectBoxes(node->left.get(), boxes);
-    collectBoxes(node->right.get(), boxes);
+std::size_t BVH::nodeCount() const {
+    return nodes.size();
 }
 
-const BufferGeometry* BVH::getGeometry() const {
-    return geometry;
+std::size_t BVH::triangleCount() const {
+    return triangles.size();
+}
+
+int BVH::depth() const {
+    return treeDepth;
 }
@@ -25,7 +25,7 @@ namespace {
 
 }// namespace
 
-std::vector<uint8_t> threepp::utils::base64Decode(const std::string& encoded) {
+std::vector<uint8_t> threepp::utils::base64Decode(std::string_view encoded) {
 
     std::vector<uint8_t> out;
     out.reserve(encoded.size() * 3 / 4);
@@ -4,13 +4,14 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace threepp::utils {
 
     // Decodes standard base64 (RFC 4648). Stops at the first character outside
     // the alphabet, so a data-URI payload may be passed with or without padding.
-    std::vector<uint8_t> base64Decode(const std::string& encoded);
+    std::vector<uint8_t> base64Decode(std::string_view encoded);
 
     std::string base64Encode(const uint8_t* data, size_t size);
 
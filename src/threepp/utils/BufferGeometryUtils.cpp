@@ -4,6 +4,8 @@
 #include "threepp/core/AttributeView.hpp"
 #include "threepp/objects/GrassMesh.hpp"
 #include "threepp/objects/SkinnedMesh.hpp"
+#include "threepp/utils/HashIndex.hpp"
+#include "threepp/utils/Parallel.hpp"
 
 #ifdef THREEPP_WITH_VULKAN
 // DisplacedMesh.cpp is only compiled into Vulkan builds (its typeinfo lives
@@ -14,6 +16,7 @@
 #include <meshoptimizer.h>
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <cstdint>
 #include <iostream>
@@ -246,122 +249,135 @@ std::shared_ptr<BufferGeometry> threepp::mergeVertices(const BufferGeometry& geo
 
     const auto& srcAttributes = geometry.getAttributes();
 
-    std::unordered_map<std::string, std::vector<float>> floatArrays;
-    std::unordered_map<std::string, std::vector<unsigned int>> uintArrays;
-    std::unordered_map<std::string, int> itemSizes;
-    std::unordered_map<std::string, bool> normalizeds;
-
     // Every non-uint attribute is read through a FloatAttributeView: zero-copy
     // for float sources, widened (and denormalized) once for narrow ones. The
     // welded output of a narrow source is therefore float — mergeVertices
     // trades that compression away rather than failing; re-run
     // compressAttributes() on the result to get it back.
-    std::unordered_map<std::string, FloatAttributeView> floatViews;
+    struct Channel {
+        std::string name;
+        const BufferAttribute* attr;
+        FloatAttributeView view;
+        const unsigned int* uints = nullptr;
+        int itemSize;
+    };
+    std::vector<Channel> channels;
+    size_t keyWidth = 0;
 
     for (const auto& [name, attr] : srcAttributes) {
 
-        itemSizes[name] = attr->itemSize();
-        normalizeds[name] = attr->normalized();
-
-        if (attr->typed<unsigned int>()) {
-            uintArrays[name] = {};
+        Channel channel{name, attr.get(), {}, nullptr, attr->itemSize()};
+        if (auto uAttr = attr->typed<unsigned int>()) {
+            channel.uints = uAttr->array().data();
         } else {
-            FloatAttributeView view(attr.get());
-            if (!view) {
+            channel.view = FloatAttributeView(attr.get());
+            if (!channel.view) {
                 std::cerr << "THREE.BufferGeometryUtils: .mergeVertices() failed. Unsupported attribute type for \"" << name << "\"." << std::endl;
                 return nullptr;
             }
-            floatViews.emplace(name, std::move(view));
-            floatArrays[name] = {};
         }
+        keyWidth += channel.itemSize;
+        channels.emplace_back(std::move(channel));
     }
 
     const double shiftMultiplier = std::pow(10.0, std::log10(1.0 / static_cast<double>(tolerance)));
 
-    std::unordered_map<std::string, unsigned int> hashToIndex;
-    std::vector<unsigned int> newIndices;
-    newIndices.reserve(vertexCount);
-    unsigned int nextIndex = 0;
-
-    std::string hash;
-
-    for (unsigned int i = 0; i < vertexCount; ++i) {
-
-        const unsigned int srcIndex = index ? static_cast<unsigned int>(index->getX(i)) : i;
-
-        hash.clear();
-
-        for (const auto& [name, attr] : srcAttributes) {
-
-            const int itemSize = itemSizes[name];
-
-            if (auto viewIt = floatViews.find(name); viewIt != floatViews.end()) {
-
-                const auto& view = viewIt->second;
-                for (int k = 0; k < itemSize; ++k) {
-                    const double v = static_cast<double>(view[srcIndex * itemSize + k]) * shiftMultiplier;
-                    hash += std::to_string(static_cast<long long>(v));
-                    hash += ',';
-                }
-
-            } else if (auto uAttr = attr->typed<unsigned int>()) {
-
-                const auto& arr = uAttr->array();
-                for (int k = 0; k < itemSize; ++k) {
-                    hash += std::to_string(arr[srcIndex * itemSize + k]);
-                    hash += ',';
+    // A vertex's key: every component of every attribute, floats scaled by
+    // 1/tolerance and truncated, uints as they are. Fixed width per geometry,
+    // so two keys compare as plain integer runs.
+    const auto quantize = [&](unsigned int srcIndex, int64_t* key) {
+        for (const auto& channel : channels) {
+            const size_t base = static_cast<size_t>(srcIndex) * channel.itemSize;
+            for (int k = 0; k < channel.itemSize; ++k) {
+                if (channel.uints) {
+                    *key++ = channel.uints[base + k];
+                } else {
+                    const double v = static_cast<double>(channel.view[base + k]) * shiftMultiplier;
+                    // Saturate instead of overflowing the cast; NaN keys alike.
+                    *key++ = std::abs(v) < 0x1p62 ? static_cast<int64_t>(v)
+                             : std::isnan(v)      ? std::numeric_limits<int64_t>::min()
+                             : v < 0              ? -(int64_t(1) << 62)
+                                                  : (int64_t(1) << 62);
                 }
             }
         }
+    };
 
-        auto it = hashToIndex.find(hash);
-        if (it != hashToIndex.end()) {
-
-            newIndices.emplace_back(it->second);
-
-        } else {
-
-            for (const auto& [name, attr] : srcAttributes) {
-
-                const int itemSize = itemSizes[name];
+    // Hash every source vertex up front, in parallel.
+    const auto srcCount = static_cast<size_t>(positionAttr->count());
+    std::vector<uint64_t> hashes(srcCount);
+    parallelFor(0, srcCount, 4096, [&](size_t lo, size_t hi) {
+        std::vector<int64_t> key(keyWidth);
+        for (auto i = lo; i < hi; ++i) {
+            quantize(static_cast<unsigned int>(i), key.data());
+            uint64_t h = keyWidth;
+            for (const auto k : key) h = std::rotl((h ^ static_cast<uint64_t>(k)) * 0x9e3779b97f4a7c15ull, 31);
+            hashes[i] = utils::hashMix(h);
+        }
+    });
 
-                if (auto viewIt = floatViews.find(name); viewIt != floatViews.end()) {
+    // Walk the vertices in draw order, so the first occurrence of each key
+    // decides its new index and the source vertex its values come from. Only
+    // the welded vertices' keys are kept: a key is wider than the vertex it
+    // came from, and on a multi-million vertex scan that is memory that hurts.
+    std::vector<unsigned int> newIndices(vertexCount);
+    std::vector<unsigned int> representatives;
+    std::vector<int64_t> keys;
+    representatives.reserve(std::min<size_t>(vertexCount, srcCount));
+    utils::HashIndex hashToIndex(std::min<size_t>(vertexCount, srcCount));
+    std::vector<int64_t> key(keyWidth);
+
+    constexpr unsigned int lookahead = 16;
+    const auto srcIndexAt = [&](unsigned int i) {
+        return index ? static_cast<unsigned int>(index->getX(i)) : i;
+    };
 
-                    const auto& view = viewIt->second;
-                    auto& dst = floatArrays[name];
-                    for (int k = 0; k < itemSize; ++k) {
-                        dst.emplace_back(view[srcIndex * itemSize + k]);
-                    }
+    for (unsigned int i = 0; i < vertexCount; ++i) {
 
-                } else if (auto uAttr = attr->typed<unsigned int>()) {
+        const unsigned int srcIndex = srcIndexAt(i);
+        if (i + lookahead < vertexCount) hashToIndex.prefetch(hashes[srcIndexAt(i + lookahead)]);
 
-                    const auto& src = uAttr->array();
-                    auto& dst = uintArrays[name];
-                    for (int k = 0; k < itemSize; ++k) {
-                        dst.emplace_back(src[srcIndex * itemSize + k]);
-                    }
-                }
-            }
+        quantize(srcIndex, key.data());
+        const auto next = static_cast<uint32_t>(representatives.size());
+        const auto id = hashToIndex.findOrInsert(hashes[srcIndex], next, [&](uint32_t existing) {
+            return std::equal(key.begin(), key.end(), keys.begin() + static_cast<ptrdiff_t>(existing * keyWidth));
+        });
 
-            hashToIndex[hash] = nextIndex;
-            newIndices.emplace_back(nextIndex);
-            ++nextIndex;
+        if (id == next) {
+            representatives.emplace_back(srcIndex);
+            keys.insert(keys.end(), key.begin(), key.end());
         }
+        newIndices[i] = id;
     }
 
     auto result = BufferGeometry::create();
 
-    for (const auto& [name, attr] : srcAttributes) {
+    const auto uniqueCount = representatives.size();
+    for (const auto& channel : channels) {
 
-        if (floatViews.contains(name)) {
+        const auto itemSize = static_cast<size_t>(channel.itemSize);
+        const auto gather = [&](auto* dst, const auto& src) {
+            parallelFor(0, uniqueCount, 8192, [&](size_t lo, size_t hi) {
+                for (auto v = lo; v < hi; ++v) {
+                    const size_t from = static_cast<size_t>(representatives[v]) * itemSize;
+                    for (size_t k = 0; k < itemSize; ++k) dst[v * itemSize + k] = src[from + k];
+                }
+            });
+        };
+
+        if (channel.uints) {
+            std::vector<unsigned int> values(uniqueCount * itemSize);
+            gather(values.data(), channel.uints);
+            result->setAttribute(channel.name, TypedBufferAttribute<unsigned int>::create(std::move(values), channel.itemSize, channel.attr->normalized()));
+        } else {
+            std::vector<float> values(uniqueCount * itemSize);
+            gather(values.data(), channel.view);
             // A widened narrow source was denormalized by the view, so the
             // output floats are plain values — clear the normalized flag.
-            const bool wasNarrow = attr->type() != AttributeType::Float;
-            result->setAttribute(name, TypedBufferAttribute<float>::create(
-                                               floatArrays[name], itemSizes[name],
-                                               wasNarrow ? false : normalizeds[name]));
-        } else if (attr->typed<unsigned int>()) {
-            result->setAttribute(name, TypedBufferAttribute<unsigned int>::create(uintArrays[name], itemSizes[name], normalizeds[name]));
+            const bool wasNarrow = channel.attr->type() != AttributeType::Float;
+            result->setAttribute(channel.name, TypedBufferAttribute<float>::create(
+                                                       std::move(values), channel.itemSize,
+                                                       wasNarrow ? false : channel.attr->normalized()));
         }
     }
 
@@ -0,0 +1,56 @@
+// Numbers out of text the loaders have mapped or read whole (OBJ, STL), with
+// std::from_chars: no locale, no allocation, no exceptions.
+//
+// What is not a number reads as 0, as it always has in these loaders (the
+// std::stof they used threw, and the throw was caught and reported as 0). A
+// leading '+' is accepted, which from_chars alone would not.
+
+#ifndef THREEPP_CHARCONV_HPP
+#define THREEPP_CHARCONV_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+namespace threepp::utils {
+
+    // std::isspace in the "C" locale, without the locale.
+    inline bool isSpace(char c) {
+
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    inline std::int32_t toInt(std::string_view s) {
+
+        if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+        std::int32_t value = 0;
+        const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+        return ec == std::errc() ? value : 0;
+    }
+
+    inline float toFloat(std::string_view s) {
+
+        if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+#if defined(__cpp_lib_to_chars)
+        float value = 0;
+        const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+        return ec == std::errc() ? value : 0.f;
+#else
+        // A standard library without floating-point from_chars (older libc++).
+        char buffer[64];
+        const auto n = std::min(s.size(), sizeof(buffer) - 1);
+        std::copy_n(s.data(), n, buffer);
+        buffer[n] = '\0';
+        char* end = nullptr;
+        errno = 0;
+        const float value = std::strtof(buffer, &end);
+        return end == buffer || errno == ERANGE ? 0.f : value;
+#endif
+    }
+
+}// namespace threepp::utils
+
+#endif//THREEPP_CHARCONV_HPP
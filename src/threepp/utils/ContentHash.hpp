@@ -0,0 +1,54 @@
+// A 64-bit content hash for bulk bytes, used by ObjectExporter to tell an
+// archive member it already wrote from one that changed.
+//
+// Not CRC-32, though every archive entry carries one: 32 bits is too few to
+// trust "same checksum, same bytes" with somebody's scene, and a table CRC
+// runs at a fraction of memory bandwidth. This is xxHash64's inner loop — four
+// independent lanes of multiply-rotate-multiply over 32-byte stripes — with
+// splitmix64's finalizer (hashMix) on the way out. It is not xxHash64 itself:
+// nothing outside this process ever compares the values, so only the quality
+// matters, not agreement with a reference.
+
+#ifndef THREEPP_CONTENTHASH_HPP
+#define THREEPP_CONTENTHASH_HPP
+
+#include "threepp/utils/HashIndex.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace threepp::utils {
+
+    inline uint64_t contentHash(const unsigned char* data, std::size_t size, uint64_t seed = 0) {
+
+        constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+
+        const auto round = [](uint64_t acc, uint64_t input) {
+            return std::rotl(acc + input * prime2, 31) * prime1;
+        };
+        const auto load = [](const unsigned char* p) {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof v);
+            return v;
+        };
+
+        uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+
+        std::size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            for (int l = 0; l < 4; ++l) lanes[l] = round(lanes[l], load(data + i + 8 * l));
+        }
+
+        uint64_t h = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for (; i + 8 <= size; i += 8) h = round(h, load(data + i));
+        for (; i < size; ++i) h = round(h, data[i]);
+
+        return hashMix(h ^ size);
+    }
+
+}// namespace threepp::utils
+
+#endif//THREEPP_CONTENTHASH_HPP
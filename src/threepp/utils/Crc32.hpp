@@ -0,0 +1,47 @@
+// CRC-32/ISO-HDLC, the one ZIP uses, shared by ZipWriter (which stamps it on
+// every entry) and ZipReader (which checks it on every entry it inflates).
+//
+// Reflected input and output, so the polynomial appears here bit-reversed
+// (0x04C11DB7 -> 0xEDB88320) and the register shifts right rather than left.
+// The table is built once, on first use, rather than spelled out as 256 magic
+// constants.
+
+#ifndef THREEPP_CRC32_HPP
+#define THREEPP_CRC32_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace threepp::utils {
+
+    inline const std::array<std::uint32_t, 256>& crc32Table() {
+
+        static const std::array<std::uint32_t, 256> table = [] {
+            std::array<std::uint32_t, 256> t{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        return table;
+    }
+
+    inline std::uint32_t crc32(const unsigned char* data, std::size_t size) {
+
+        const auto& table = crc32Table();
+        std::uint32_t c = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; ++i) {
+
+            c = table[(c ^ data[i]) & 0xFFu] ^ (c >> 8);
+        }
+        return c ^ 0xFFFFFFFFu;
+    }
+
+}// namespace threepp::utils
+
+#endif//THREEPP_CRC32_HPP
@@ -0,0 +1,130 @@
+// Open-addressing hash index for the geometry welders (edges, wireframe,
+// mergeVertices).
+//
+// Maps a key to a dense uint32 id without owning the key: the caller keeps its
+// keys in its own arrays and passes the 64-bit hash plus an equality test on
+// ids. That keeps variable-length keys (a vertex's full attribute tuple) and
+// fixed ones (an edge's two vertex ids) on one table, with no per-key
+// allocation — the std::string keys these call sites used to build cost more
+// than everything else they did.
+//
+// Linear probing over a power-of-two table held at most half full; slots carry
+// the full hash, so growing never calls back into the caller and a probe
+// compares keys only on a hash match.
+
+#ifndef THREEPP_HASHINDEX_HPP
+#define THREEPP_HASHINDEX_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace threepp::utils {
+
+    // splitmix64's finalizer: every input bit reaches every output bit, so the
+    // low bits used for the slot are as good as the high ones.
+    inline uint64_t hashMix(uint64_t x) {
+
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    inline uint64_t hashCombine(uint64_t seed, uint64_t value) {
+
+        return hashMix(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+    }
+
+    class HashIndex {
+
+    public:
+        static constexpr uint32_t npos = 0xffffffffu;
+
+        explicit HashIndex(std::size_t expected = 0) {
+
+            reserve(expected);
+        }
+
+        void reserve(std::size_t expected) {
+
+            const auto capacity = std::bit_ceil(std::max<std::size_t>(16, expected * 2));
+            if (capacity > slots_.size()) rehash(capacity);
+        }
+
+        [[nodiscard]] std::size_t size() const {
+
+            return size_;
+        }
+
+        // The id of the entry eq() accepts among those with this hash, or npos.
+        template<class Eq>
+        [[nodiscard]] uint32_t find(uint64_t hash, Eq&& eq) const {
+
+            for (auto i = hash & mask_;; i = (i + 1) & mask_) {
+                const auto& slot = slots_[i];
+                if (slot.id == npos) return npos;
+                if (slot.hash == hash && eq(slot.id)) return slot.id;
+            }
+        }
+
+        // Hint that the slot for this hash is wanted soon. Walks that know
+        // their hashes ahead of time (hashed in a parallel pass) hide the
+        // cache miss a probe into a big table otherwise costs.
+        void prefetch(uint64_t hash) const {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(&slots_[hash & mask_]);
+#else
+            (void) hash;
+#endif
+        }
+
+        // As find(), but on a miss records `id` under this hash and returns it.
+        template<class Eq>
+        uint32_t findOrInsert(uint64_t hash, uint32_t id, Eq&& eq) {
+
+            if ((size_ + 1) * 2 > slots_.size()) rehash(slots_.size() * 2);
+
+            for (auto i = hash & mask_;; i = (i + 1) & mask_) {
+                auto& slot = slots_[i];
+                if (slot.id == npos) {
+                    slot = {hash, id};
+                    ++size_;
+                    return id;
+                }
+                if (slot.hash == hash && eq(slot.id)) return slot.id;
+            }
+        }
+
+    private:
+        struct Slot {
+            uint64_t hash = 0;
+            uint32_t id = npos;
+        };
+
+        std::vector<Slot> slots_;
+        std::size_t mask_ = 0;
+        std::size_t size_ = 0;
+
+        void rehash(std::size_t capacity) {
+
+            std::vector<Slot> old(capacity);
+            old.swap(slots_);
+            mask_ = capacity - 1;
+
+            for (const auto& slot : old) {
+                if (slot.id == npos) continue;
+                auto i = slot.hash & mask_;
+                while (slots_[i].id != npos) i = (i + 1) & mask_;
+                slots_[i] = slot;
+            }
+        }
+    };
+
+}// namespace threepp::utils
+
+#endif//THREEPP_HASHINDEX_HPP
@@ -0,0 +1,104 @@
+
+#include "MappedFile.hpp"
+
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace threepp::utils;
+
+namespace {
+
+    // The whole file, in one allocation: the fallback where there is no
+    // mapping to be had.
+    //
+    // The stream is constructed from the path OBJECT, never from path.string():
+    // on Windows the narrow overload goes through the ANSI code page, so a name
+    // like "Sainte-Anne-de-Beaupre" with an accented 'e' silently fails to open.
+    // (The path only appears in messages as a string, where a mangled character
+    // is cosmetic.)
+    std::vector<unsigned char> readWholeFile(const std::filesystem::path& path) {
+
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) throw std::runtime_error("cannot open '" + path.string() + "'");
+
+        const std::streamoff end = in.tellg();
+        if (end < 0) throw std::runtime_error("cannot determine the size of '" + path.string() + "'");
+
+        const auto size = static_cast<std::uint64_t>(end);
+        if (size > static_cast<std::uint64_t>((std::numeric_limits<size_t>::max)())) {
+
+            throw std::runtime_error("'" + path.string() + "' is " + std::to_string(size) +
+                                     " bytes, too large to read into memory on this platform");
+        }
+
+        std::vector<unsigned char> bytes(static_cast<size_t>(size));
+        in.seekg(0, std::ios::beg);
+        if (size > 0) {
+
+            in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size));
+            if (static_cast<std::uint64_t>(in.gcount()) != size) {
+
+                throw std::runtime_error("short read from '" + path.string() + "': got " +
+                                         std::to_string(in.gcount()) + " of " + std::to_string(size) + " bytes");
+            }
+        }
+        return bytes;
+    }
+
+}// namespace
+
+
+MappedFile::MappedFile(const std::filesystem::path& path, bool memoryMap) {
+
+    if (memoryMap && map(path)) return;
+
+    buffer_ = readWholeFile(path);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+
+#ifndef _WIN32
+    if (mapped_) ::munmap(const_cast<unsigned char*>(data_), static_cast<size_t>(size_));
+#endif
+}
+
+// False on anything short of a usable mapping — including an empty file,
+// which mmap refuses — and the caller falls back to reading. Errors that
+// matter (no such file) surface from readWholeFile in its own words.
+bool MappedFile::map(const std::filesystem::path& path) {
+
+#ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    const bool sized = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+                       static_cast<std::uint64_t>(st.st_size) <= (std::numeric_limits<size_t>::max)();
+    void* p = sized ? ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0)
+                    : MAP_FAILED;
+    // The mapping holds its own reference to the file.
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    // Loaders mostly walk a file front to back, once.
+    ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    data_ = static_cast<const unsigned char*>(p);
+    size_ = static_cast<std::uint64_t>(st.st_size);
+    mapped_ = true;
+    return true;
+#else
+    (void) path;
+    return false;
+#endif
+}
@@ -0,0 +1,56 @@
+// A whole file, read-only, in memory: mapped where the platform allows (POSIX
+// mmap), read into one buffer otherwise. For loaders that parse big files in
+// place — a mapping costs address space rather than resident memory, and
+// there is no second copy between the page cache and the parser.
+//
+// A mapped file that another process truncates while it is in use faults on
+// access (SIGBUS) rather than throwing; callers that must survive that pass
+// memoryMap = false.
+
+#ifndef THREEPP_MAPPEDFILE_HPP
+#define THREEPP_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace threepp::utils {
+
+    class MappedFile {
+
+    public:
+        // Throws std::runtime_error naming the file if it cannot be opened or
+        // read. Mapping failures (an empty file, a pipe, a platform without
+        // mmap) are not errors; they fall back to reading.
+        explicit MappedFile(const std::filesystem::path& path, bool memoryMap = true);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        [[nodiscard]] const unsigned char* data() const { return data_; }
+
+        [[nodiscard]] std::uint64_t size() const { return size_; }
+
+        [[nodiscard]] std::span<const std::byte> bytes() const {
+
+            return {reinterpret_cast<const std::byte*>(data_), static_cast<std::size_t>(size_)};
+        }
+
+        [[nodiscard]] bool mapped() const { return mapped_; }
+
+    private:
+        const unsigned char* data_ = nullptr;
+        std::uint64_t size_ = 0;
+        bool mapped_ = false;
+        std::vector<unsigned char> buffer_;
+
+        bool map(const std::filesystem::path& path);
+    };
+
+}// namespace threepp::utils
+
+#endif//THREEPP_MAPPEDFILE_HPP
@@ -0,0 +1,274 @@
+
+#include "threepp/utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    // Which pool (if any) the current thread works for, and its lane there.
+    thread_local const void* tlsPool = nullptr;
+    thread_local unsigned tlsLane = 0;
+
+    thread_local int tlsSerialDepth = 0;
+
+    // One parallelFor call. Lives on the caller's stack; every task points at
+    // it, and the caller does not return before `remaining` reaches zero.
+    struct Job {
+        ThreadPool::RangeFn fn;
+        std::size_t grain;
+        std::atomic<std::size_t> remaining;// indices not yet processed
+
+        std::atomic<bool> failed{false};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        Job(ThreadPool::RangeFn fn, std::size_t grain, std::size_t count)
+            : fn(fn), grain(grain), remaining(count) {}
+    };
+
+    struct Task {
+        Job* job;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct Lane {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+}// namespace
+
+struct ThreadPool::Impl {
+
+    explicit Impl(unsigned numWorkers)
+        : lanes_(numWorkers + 1) {
+
+        workers_.reserve(numWorkers);
+        for (unsigned i = 0; i < numWorkers; ++i) {
+            workers_.emplace_back([this, i] { workerMain(i); });
+        }
+    }
+
+    [[nodiscard]] unsigned numWorkers() const {
+        return static_cast<unsigned>(workers_.size());
+    }
+
+    [[nodiscard]] bool isWorkerThread() const {
+        return tlsPool == this;
+    }
+
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, RangeFn fn) {
+
+        if (end <= begin) return;
+
+        const std::size_t n = end - begin;
+
+        if (workers_.empty() || tlsSerialDepth > 0) {
+            // Inline, in index order. An explicit grain is still honoured:
+            // callers may size scratch buffers by it.
+            if (grain == 0) grain = n;
+            for (std::size_t lo = begin; lo < end; lo += std::min(grain, end - lo)) {
+                fn(lo, lo + std::min(grain, end - lo));
+            }
+            return;
+        }
+
+        if (grain == 0) {
+            // ~8 pieces per lane: enough slack for stealing to even out
+            // uneven pieces, few enough that the split overhead stays noise.
+            grain = std::max<std::size_t>(1, n / (std::size_t(numWorkers() + 1) * 8));
+        }
+
+        if (n <= grain) {
+            fn(begin, end);
+            return;
+        }
+
+        Job job(fn, grain, n);
+        const unsigned lane = myLane();
+
+        // The caller takes the first piece itself (splitting as it goes), then
+        // helps with whatever is queued until its job drains.
+        execute({&job, begin, end}, lane);
+        while (job.remaining.load(std::memory_order_acquire) != 0) {
+            Task t{};
+            if (acquire(lane, t)) {
+                execute(t, lane);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        if (job.error) std::rethrow_exception(job.error);
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard lock(sleepMutex_);
+            stop_ = true;
+        }
+        sleepCv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+private:
+    std::vector<Lane> lanes_;// one per worker, plus a shared one for outside callers
+    std::vector<std::thread> workers_;
+
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<unsigned> sleeping_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    bool stop_ = false;
+
+    [[nodiscard]] unsigned myLane() const {
+        return isWorkerThread() ? tlsLane : numWorkers();
+    }
+
+    void workerMain(unsigned lane) {
+
+        tlsPool = this;
+        tlsLane = lane;
+
+        while (true) {
+            Task t{};
+            if (acquire(lane, t)) {
+                execute(t, lane);
+                continue;
+            }
+
+            std::unique_lock lock(sleepMutex_);
+            ++sleeping_;
+            sleepCv_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            --sleeping_;
+            if (stop_) return;
+        }
+    }
+
+    void push(const Task& t, unsigned lane) {
+        {
+            std::lock_guard lock(lanes_[lane].m);
+            lanes_[lane].tasks.push_back(t);
+        }
+        queued_.fetch_add(1);
+        // A worker going to sleep bumps sleeping_ under sleepMutex_ before it
+        // re-checks queued_, so either it sees this task or we see it asleep.
+        if (sleeping_.load() > 0) {
+            std::lock_guard lock(sleepMutex_);
+            sleepCv_.notify_one();
+        }
+    }
+
+    // Own lane first (newest piece, back), then steal (oldest piece, front).
+    bool acquire(unsigned lane, Task& out) {
+
+        {
+            auto& own = lanes_[lane];
+            std::lock_guard lock(own.m);
+            if (!own.tasks.empty()) {
+                out = own.tasks.back();
+                own.tasks.pop_back();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+
+        if (queued_.load() == 0) return false;
+
+        const auto count = static_cast<unsigned>(lanes_.size());
+        for (unsigned k = 1; k < count; ++k) {
+            auto& victim = lanes_[(lane + k) % count];
+            std::lock_guard lock(victim.m);
+            if (!victim.tasks.empty()) {
+                out = victim.tasks.front();
+                victim.tasks.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void execute(Task t, unsigned lane) {
+
+        Job& job = *t.job;
+
+        // Split down to the grain, leaving the upper halves for thieves.
+        while (t.end - t.begin > job.grain) {
+            const std::size_t mid = t.begin + (t.end - t.begin) / 2;
+            push({&job, mid, t.end}, lane);
+            t.end = mid;
+        }
+
+        if (!job.failed.load(std::memory_order_relaxed)) {
+            try {
+                job.fn(t.begin, t.end);
+            } catch (...) {
+                std::lock_guard lock(job.errorMutex);
+                if (!job.error) job.error = std::current_exception();
+                job.failed = true;
+            }
+        }
+
+        // Last touch of `job`: once this reaches zero the caller may return.
+        job.remaining.fetch_sub(t.end - t.begin, std::memory_order_acq_rel);
+    }
+};
+
+ThreadPool::ThreadPool(unsigned numWorkers) {
+
+    if (numWorkers == 0) {
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        numWorkers = hw - 1;
+    }
+    pimpl_ = std::make_unique<Impl>(numWorkers);
+}
+
+unsigned ThreadPool::concurrency() const {
+
+    return pimpl_->numWorkers() + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, RangeFn fn) {
+
+    pimpl_->parallelFor(begin, end, grain, fn);
+}
+
+bool ThreadPool::isWorkerThread() const {
+
+    return pimpl_->isWorkerThread();
+}
+
+ThreadPool& ThreadPool::global() {
+
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::SerialScope::SerialScope() {
+
+    ++tlsSerialDepth;
+}
+
+ThreadPool::SerialScope::~SerialScope() {
+
+    --tlsSerialDepth;
+}
+
+bool ThreadPool::serialOnThisThread() {
+
+    return tlsSerialDepth > 0;
+}
+
+ThreadPool::~ThreadPool() = default;
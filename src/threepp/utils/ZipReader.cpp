@@ -1,7 +1,14 @@
 
 #include "threepp/utils/ZipReader.hpp"
 
+#include "threepp/utils/Crc32.hpp"
+#include "threepp/utils/MappedFile.hpp"
+
+// The inflate PNG decoding already brings into the build (see EXRLoader).
+#include "stb_image.h"
+
 #include <algorithm>
+#include <climits>
 #include <fstream>
 #include <limits>
 #include <stdexcept>
@@ -14,11 +21,15 @@ namespace {
     constexpr std::uint32_t LOCAL_SIG = 0x04034b50;  // "PK\x03\x04"
     constexpr std::uint32_t CENTRAL_SIG = 0x02014b50;// "PK\x01\x02"
     constexpr std::uint32_t EOCD_SIG = 0x06054b50;   // "PK\x05\x06"
+    constexpr std::uint32_t EOCD64_SIG = 0x06064b50; // "PK\x06\x06"
+    constexpr std::uint32_t LOCATOR_SIG = 0x07064b50;// "PK\x06\x07"
 
     // Fixed parts of each record, before any variable-length name/extra/comment.
     constexpr std::uint64_t LOCAL_FIXED = 30;
     constexpr std::uint64_t CENTRAL_FIXED = 46;
     constexpr std::uint64_t EOCD_FIXED = 22;
+    constexpr std::uint64_t EOCD64_FIXED = 56;
+    constexpr std::uint64_t LOCATOR_FIXED = 20;
 
     // The archive comment's length field is 16-bit, so the end-of-central-directory
     // record cannot start further back than this from the end of the file.
@@ -29,6 +40,10 @@ namespace {
     // count is how a naive reader turns a 5 GB archive into nonsense.
     constexpr std::uint32_t ZIP64_32 = 0xFFFFFFFFu;
     constexpr std::uint16_t ZIP64_16 = 0xFFFFu;
+    constexpr std::uint16_t ZIP64_EXTRA = 0x0001;
+
+    constexpr std::uint16_t METHOD_STORED = 0;
+    constexpr std::uint16_t METHOD_DEFLATE = 8;
 
     // General purpose bit flags that change how a record must be read.
     constexpr std::uint16_t FLAG_ENCRYPTED = 0x0001;
@@ -69,6 +84,11 @@ namespace {
                (static_cast<std::uint32_t>(p[3]) << 24);
     }
 
+    std::uint64_t rd64(const unsigned char* p) {
+
+        return static_cast<std::uint64_t>(rd32(p)) | (static_cast<std::uint64_t>(rd32(p + 4)) << 32);
+    }
+
     // Named where the name is more use than the number; the number is always
     // printed, so an unknown method is still reported honestly.
     std::string methodName(std::uint16_t method) {
@@ -87,6 +107,46 @@ namespace {
         }
     }
 
+    // The ZIP64 extended-information extra field (id 0x0001) holds, in this
+    // order, only those of the uncompressed size, the compressed size and the
+    // local header offset whose 32-bit field is the sentinel. Each is replaced
+    // in place; `extra` and `length` have already been bounds-checked against
+    // the central directory record.
+    void readZip64Extra(const unsigned char* extra, std::uint16_t length, const std::string& name,
+                        std::uint64_t& uncompSize, std::uint64_t& compSize, std::uint64_t& localOffset) {
+
+        for (std::uint32_t pos = 0; pos + 4 <= length;) {
+
+            const std::uint16_t id = rd16(extra + pos);
+            const std::uint16_t fieldLen = rd16(extra + pos + 2);
+            if (pos + 4 + fieldLen > length) break;
+
+            if (id == ZIP64_EXTRA) {
+
+                const unsigned char* const field = extra + pos + 4;
+                std::uint32_t at = 0;
+                const auto take = [&](std::uint64_t& value) {
+                    if (value != ZIP64_32) return;
+                    if (at + 8 > fieldLen) {
+
+                        fail(quoted(name) + ": ZIP64 extra field is " + std::to_string(fieldLen) +
+                             " bytes, too short for the sizes and offset it stands in for");
+                    }
+                    value = rd64(field + at);
+                    at += 8;
+                };
+                take(uncompSize);
+                take(compSize);
+                take(localOffset);
+                return;
+            }
+
+            pos += 4 + fieldLen;
+        }
+
+        fail(quoted(name) + ": a size or offset is the ZIP64 sentinel 0xFFFFFFFF, but the entry has no ZIP64 extra field");
+    }
+
     // Entry names are stored with forward slashes by every writer that follows
     // the spec, but not by every writer, and a caller should not have to care.
     // Applied to both sides of the lookup, so has("0_0\\meta.json"),
@@ -98,45 +158,30 @@ namespace {
         return name;
     }
 
-    // The whole file, in one allocation. These archives are ~180 MB and a caller
-    // reads most of every one of them anyway, so a memory-mapped or streaming
-    // design would save little and cost a per-platform mapping layer.
-    //
-    // The stream is constructed from the path OBJECT, never from path.string():
-    // on Windows the narrow overload goes through the ANSI code page, so a name
-    // like "Sainte-Anne-de-Beaupre" with an accented 'e' silently fails to open.
-    // (The path only appears in messages as a string, where a mangled character
-    // is cosmetic.)
-    std::vector<unsigned char> readWholeFile(const std::filesystem::path& path) {
+}// namespace
 
-        std::ifstream in(path, std::ios::binary | std::ios::ate);
-        if (!in) fail("cannot open '" + path.string() + "'");
 
-        const std::streamoff end = in.tellg();
-        if (end < 0) fail("cannot determine the size of '" + path.string() + "'");
+// The file. Shared between copies of a reader so a view outlives whichever
+// copy it was taken from.
+class ZipReader::Storage {
 
-        const auto size = static_cast<std::uint64_t>(end);
-        if (size > static_cast<std::uint64_t>((std::numeric_limits<size_t>::max)())) {
+public:
+    utils::MappedFile file;
 
-            fail("'" + path.string() + "' is " + std::to_string(size) +
-                 " bytes, too large to read into memory on this platform");
-        }
+    Storage(const std::filesystem::path& path, bool memoryMap): file(path, memoryMap) {}
 
-        std::vector<unsigned char> bytes(static_cast<size_t>(size));
-        in.seekg(0, std::ios::beg);
-        if (size > 0) {
+    static std::shared_ptr<const Storage> open(const std::filesystem::path& path, bool memoryMap) {
 
-            in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size));
-            if (static_cast<std::uint64_t>(in.gcount()) != size) {
+        try {
 
-                fail("short read from '" + path.string() + "': got " + std::to_string(in.gcount()) +
-                     " of " + std::to_string(size) + " bytes");
-            }
+            return std::make_shared<Storage>(path, memoryMap);
+
+        } catch (const std::runtime_error& e) {
+
+            fail(e.what());
         }
-        return bytes;
     }
-
-}// namespace
+};
 
 
 bool ZipReader::looksLikeZip(const std::filesystem::path& path) {
@@ -160,8 +205,8 @@ bool ZipReader::looksLikeZip(const std::filesystem::path& path) {
     }
 }
 
-ZipReader::ZipReader(const std::filesystem::path& path)
-    : bytes_(readWholeFile(path)) {
+ZipReader::ZipReader(const std::filesystem::path& path, bool memoryMap)
+    : storage_(Storage::open(path, memoryMap)), data_(storage_->file.data()), size_(storage_->file.size()) {
 
     try {
 
@@ -177,8 +222,8 @@ ZipReader::ZipReader(const std::filesystem::path& path)
 
 void ZipReader::parse() {
 
-    const unsigned char* const d = bytes_.data();
-    const std::uint64_t size = bytes_.size();
+    const unsigned char* const d = data_;
+    const std::uint64_t size = size_;
 
     if (size < EOCD_FIXED) {
 
@@ -214,22 +259,60 @@ void ZipReader::parse() {
     // 2. Its fields. Everything the walk needs comes from here or from the
     //    central directory; nothing is inferred from the file's layout.
     const unsigned char* const e = d + eocd;
-    const std::uint16_t thisDisk = rd16(e + 4);
-    const std::uint16_t cdDisk = rd16(e + 6);
-    const std::uint16_t entriesHere = rd16(e + 8);
-    const std::uint16_t entriesTotal = rd16(e + 10);
-    const std::uint32_t cdSize = rd32(e + 12);
-    const std::uint32_t cdOffset = rd32(e + 16);
+    std::uint64_t thisDisk = rd16(e + 4);
+    std::uint64_t cdDisk = rd16(e + 6);
+    std::uint64_t entriesHere = rd16(e + 8);
+    std::uint64_t entriesTotal = rd16(e + 10);
+    std::uint64_t cdSize = rd32(e + 12);
+    std::uint64_t cdOffset = rd32(e + 16);
+
+    // The central directory ends where the end records begin: the classic one,
+    // or the ZIP64 one in front of it.
+    std::uint64_t directoryEnd = eocd;
+
+    // 2b. ZIP64. A writer that needed it leaves the sentinels above and a
+    //     locator immediately before the classic record, pointing at the ZIP64
+    //     end record that holds the real numbers. When the locator is there its
+    //     numbers are used outright; a sentinel without one is refused.
+    const bool sentinel = entriesHere == ZIP64_16 || entriesTotal == ZIP64_16 ||
+                          cdSize == ZIP64_32 || cdOffset == ZIP64_32;
+
+    if (eocd >= LOCATOR_FIXED && rd32(d + eocd - LOCATOR_FIXED) == LOCATOR_SIG) {
+
+        const std::uint64_t locator = eocd - LOCATOR_FIXED;
+        const std::uint64_t recorded = rd64(d + locator + 8);
+
+        // Like every other offset, the recorded one is off by the size of
+        // anything prepended to the archive; the record normally sits right
+        // before its locator, which is where to look when it is not where it
+        // says.
+        const auto isRecord = [&](std::uint64_t at) {
+            return at <= locator && locator - at >= EOCD64_FIXED && rd32(d + at) == EOCD64_SIG;
+        };
+        std::uint64_t record = recorded;
+        if (!isRecord(record) && locator >= EOCD64_FIXED) record = locator - EOCD64_FIXED;
+        if (!isRecord(record)) {
+
+            fail("ZIP64 end-of-central-directory locator points at offset " + std::to_string(recorded) +
+                 ", where there is no ZIP64 end-of-central-directory record");
+        }
 
-    if (entriesTotal == ZIP64_16) {
+        const unsigned char* const z = d + record;
+        thisDisk = rd32(z + 16);
+        cdDisk = rd32(z + 20);
+        entriesHere = rd64(z + 24);
+        entriesTotal = rd64(z + 32);
+        cdSize = rd64(z + 40);
+        cdOffset = rd64(z + 48);
+        directoryEnd = record;
 
-        fail("entry count is the ZIP64 sentinel 0xFFFF; ZIP64 archives are not supported");
-    }
-    if (cdSize == ZIP64_32 || cdOffset == ZIP64_32) {
+    } else if (sentinel) {
 
-        fail("central directory size " + std::to_string(cdSize) + " / offset " + std::to_string(cdOffset) +
-             " hits the ZIP64 sentinel 0xFFFFFFFF; ZIP64 archives are not supported");
+        fail("entry count " + std::to_string(entriesTotal) + " / central directory size " + std::to_string(cdSize) +
+             " / offset " + std::to_string(cdOffset) + " hits a ZIP64 sentinel, but there is no ZIP64 "
+             "end-of-central-directory locator before the end record");
     }
+
     if (thisDisk != 0 || cdDisk != 0 || entriesHere != entriesTotal) {
 
         fail("spanned (multi-disk) archives are not supported: disk " + std::to_string(thisDisk) +
@@ -241,7 +324,7 @@ void ZipReader::parse() {
     //    cdOffset. An archive with something prepended — a self-extracting stub,
     //    or a concatenation — has every recorded offset shifted by the size of
     //    that prefix, and the shift is recoverable because the directory always
-    //    ends where the EOCD begins. The correction is applied only when the
+    //    ends where the end records begin. The correction is applied only when the
     //    plain reading does not land on a central header and the shifted one
     //    does, and the same delta then applies to every local header offset.
     std::uint64_t cdStart = cdOffset;
@@ -250,9 +333,9 @@ void ZipReader::parse() {
         return entriesTotal == 0 || (cdSize >= 4 && rd32(d + at) == CENTRAL_SIG);
     };
 
-    if (!looksLikeCd(cdStart) && cdSize <= eocd && looksLikeCd(eocd - cdSize)) {
+    if (!looksLikeCd(cdStart) && cdSize <= directoryEnd && looksLikeCd(directoryEnd - cdSize)) {
 
-        cdStart = eocd - cdSize;
+        cdStart = directoryEnd - cdSize;
     }
 
     if (cdStart > size || cdSize > size - cdStart) {
@@ -264,6 +347,14 @@ void ZipReader::parse() {
     const std::int64_t base = static_cast<std::int64_t>(cdStart) - static_cast<std::int64_t>(cdOffset);
     const std::uint64_t cdEnd = cdStart + cdSize;
 
+    // A 64-bit count is whatever the file says it is; it has to fit in the
+    // directory before anything is reserved for it.
+    if (entriesTotal > cdSize / CENTRAL_FIXED) {
+
+        fail(std::to_string(entriesTotal) + " entries cannot fit in a central directory of " +
+             std::to_string(cdSize) + " bytes");
+    }
+
     // 4. Walk the central directory. It is the authority: the local file header
     //    of an entry written with a data descriptor (general purpose bit 3) has
     //    zero for crc, compressed size AND uncompressed size, so a reader that
@@ -273,7 +364,7 @@ void ZipReader::parse() {
 
     std::uint64_t pos = cdStart;
 
-    for (std::uint32_t i = 0; i < entriesTotal; ++i) {
+    for (std::uint64_t i = 0; i < entriesTotal; ++i) {
 
         if (pos + CENTRAL_FIXED > cdEnd) {
 
@@ -290,12 +381,13 @@ void ZipReader::parse() {
 
         const std::uint16_t flags = rd16(c + 8);
         const std::uint16_t method = rd16(c + 10);
-        const std::uint32_t compSize = rd32(c + 20);
-        const std::uint32_t uncompSize = rd32(c + 24);
+        const std::uint32_t crc = rd32(c + 16);
+        std::uint64_t compSize = rd32(c + 20);
+        std::uint64_t uncompSize = rd32(c + 24);
         const std::uint16_t nameLen = rd16(c + 28);
         const std::uint16_t extraLen = rd16(c + 30);
         const std::uint16_t commentLen = rd16(c + 32);
-        const std::uint32_t localOffset = rd32(c + 42);
+        std::uint64_t localOffset = rd32(c + 42);
 
         // Widened before adding: three 16-bit lengths and a 64-bit position
         // cannot overflow a uint64, and pos <= cdEnd <= size throughout.
@@ -323,22 +415,21 @@ void ZipReader::parse() {
             fail(quoted(name) + " is encrypted (general purpose bit 0 set); encrypted entries are not supported");
         }
 
-        if (method != 0) {
+        if (method != METHOD_STORED && method != METHOD_DEFLATE) {
 
             const std::string named = methodName(method);
             fail(quoted(name) + ": compression method " + std::to_string(method) +
-                 (named.empty() ? "" : " (" + named + ")") + " is not supported, only stored entries");
+                 (named.empty() ? "" : " (" + named + ")") + " is not supported, only stored and deflated entries");
         }
 
         if (uncompSize == ZIP64_32 || compSize == ZIP64_32 || localOffset == ZIP64_32) {
 
-            fail(quoted(name) + ": size " + std::to_string(uncompSize) + " / local header offset " +
-                 std::to_string(localOffset) + " hits the ZIP64 sentinel 0xFFFFFFFF; ZIP64 archives are not supported");
+            readZip64Extra(c + CENTRAL_FIXED + nameLen, extraLen, name, uncompSize, compSize, localOffset);
         }
 
         // Stored means the two sizes are the same number by definition. If they
         // disagree the record is corrupt and there is no honest way to pick one.
-        if (compSize != uncompSize) {
+        if (method == METHOD_STORED && compSize != uncompSize) {
 
             fail(quoted(name) + ": stored entry declares compressed size " + std::to_string(compSize) +
                  " but uncompressed size " + std::to_string(uncompSize));
@@ -354,7 +445,9 @@ void ZipReader::parse() {
         //    legitimately differ from the central directory's copies — writers
         //    put different extra fields in the two places — and they are what
         //    decides where the payload begins.
-        const std::int64_t localStart = static_cast<std::int64_t>(localOffset) + base;
+        const std::int64_t localStart = localOffset > static_cast<std::uint64_t>(INT64_MAX)
+                                                ? -1
+                                                : static_cast<std::int64_t>(localOffset) + base;
         if (localStart < 0 || static_cast<std::uint64_t>(localStart) + LOCAL_FIXED > size) {
 
             fail(quoted(name) + ": local header offset " + std::to_string(localOffset) +
@@ -371,15 +464,16 @@ void ZipReader::parse() {
         const std::uint64_t dataOffset =
                 static_cast<std::uint64_t>(localStart) + LOCAL_FIXED + rd16(l + 26) + rd16(l + 28);
 
-        // Subtraction rather than dataOffset + uncompSize, so a size near the
-        // 32-bit ceiling cannot wrap the comparison.
-        if (dataOffset > size || uncompSize > size - dataOffset) {
+        // Subtraction rather than dataOffset + compSize, so a size near the
+        // 64-bit ceiling cannot wrap the comparison.
+        if (dataOffset > size || compSize > size - dataOffset) {
 
-            fail(quoted(name) + ": data runs past the end of the file (" + std::to_string(uncompSize) +
+            fail(quoted(name) + ": data runs past the end of the file (" + std::to_string(compSize) +
                  " bytes at offset " + std::to_string(dataOffset) + ", file is " + std::to_string(size) + " bytes)");
         }
 
-        const auto inserted = entries_.emplace(name, Entry{dataOffset, uncompSize});
+        const Entry parsed{dataOffset, uncompSize, compSize, crc, method};
+        const auto inserted = entries_.emplace(name, parsed);
         if (inserted.second) {
 
             names_.push_back(name);
@@ -388,7 +482,7 @@ void ZipReader::parse() {
 
             // A repeated name is legal — appending to an archive can leave the
             // superseded record in place — and the later one is the live one.
-            inserted.first->second = Entry{dataOffset, uncompSize};
+            inserted.first->second = parsed;
         }
     }
 }
@@ -398,7 +492,12 @@ bool ZipReader::has(const std::string& name) const {
     return entries_.find(normalizeName(name)) != entries_.end();
 }
 
-std::vector<unsigned char> ZipReader::read(const std::string& name) const {
+bool ZipReader::mapped() const {
+
+    return storage_->file.mapped();
+}
+
+const ZipReader::Entry& ZipReader::entry(const std::string& name) const {
 
     const auto it = entries_.find(normalizeName(name));
     if (it == entries_.end()) {
@@ -406,13 +505,89 @@ std::vector<unsigned char> ZipReader::read(const std::string& name) const {
         fail("no entry named " + quoted(name) + " in the archive (" +
              std::to_string(names_.size()) + " entries)");
     }
+    return it->second;
+}
+
+std::vector<unsigned char> ZipReader::inflate(const std::string& name, const Entry& e) const {
+
+    // The decoder takes int lengths. ZipWriter never deflates anything that
+    // large, and an archive from elsewhere that did is refused by name.
+    if (e.size > static_cast<std::uint64_t>(INT_MAX) || e.compressedSize > static_cast<std::uint64_t>(INT_MAX - 8)) {
+
+        fail(quoted(name) + ": deflated entry of " + std::to_string(e.size) + " bytes (" +
+             std::to_string(e.compressedSize) + " compressed) is too large to inflate, the limit is 2 GB");
+    }
+
+    std::vector<unsigned char> out(static_cast<size_t>(e.size));
+    if (!out.empty()) {
+
+        // stb's decoder looks a few bytes past the last code it needs — in a
+        // zlib stream that is the Adler-32 trailer — and calls a raw stream
+        // that ends exactly where its bits do corrupt. In an archive something
+        // always follows an entry (at the least, the end record), so it is
+        // handed up to 8 bytes of that as slack; they are never decoded.
+        const std::uint64_t input = (std::min)(e.compressedSize + 8, size_ - e.offset);
+
+        // Straight from the mapping into the result: the output is sized from
+        // the central directory and the decoder refuses to write past it.
+        const int written = stbi_zlib_decode_noheader_buffer(
+                reinterpret_cast<char*>(out.data()), static_cast<int>(out.size()),
+                reinterpret_cast<const char*>(data_ + e.offset), static_cast<int>(input));
+        if (written != static_cast<int>(out.size())) {
+
+            fail(quoted(name) + ": corrupt deflate stream (inflated to " +
+                 (written < 0 ? std::string("an error") : std::to_string(written) + " bytes") +
+                 ", the central directory says " + std::to_string(e.size) + ")");
+        }
+    }
+
+    const auto crc = utils::crc32(out.data(), out.size());
+    if (crc != e.crc) {
+
+        fail(quoted(name) + ": CRC-32 " + hex32(crc) + " of the inflated data does not match " + hex32(e.crc) +
+             " in the central directory");
+    }
+    return out;
+}
+
+std::vector<unsigned char> ZipReader::read(const std::string& name) const {
+
+    const auto& e = entry(name);
+    if (e.method == METHOD_DEFLATE) return inflate(name, e);
+
+    const auto bytes = view(name);
+    const auto* first = reinterpret_cast<const unsigned char*>(bytes.data());
+    return std::vector<unsigned char>(first, first + bytes.size());
+}
+
+std::span<const std::byte> ZipReader::view(const std::string& name) const {
+
+    const auto& e = entry(name);
+    if (e.method == METHOD_DEFLATE) {
+        fail(quoted(name) + ": deflated, so there are no bytes to view in place; use bytes() or read()");
+    }
 
     // Both bounds were checked against the real file size while parsing, so
     // this is the one place that does not re-derive them.
-    const auto offset = static_cast<size_t>(it->second.offset);
-    const auto length = static_cast<size_t>(it->second.size);
-    const unsigned char* const first = bytes_.data() + offset;
-    return std::vector<unsigned char>(first, first + length);
+    const auto offset = static_cast<size_t>(e.offset);
+    const auto length = static_cast<size_t>(e.size);
+    return {reinterpret_cast<const std::byte*>(data_) + offset, length};
+}
+
+FileBytes ZipReader::bytes(const std::string& name) const {
+
+    const auto& e = entry(name);
+    if (e.method == METHOD_DEFLATE) return {inflate(name, e), {}};
+
+    return {{}, view(name)};
+}
+
+ZipReader::StoredEntry ZipReader::stored(const std::string& name) const {
+
+    const auto& e = entry(name);
+    const auto offset = static_cast<size_t>(e.offset);
+    const auto length = static_cast<size_t>(e.compressedSize);
+    return {{reinterpret_cast<const std::byte*>(data_) + offset, length}, e.size, e.crc, e.method == METHOD_DEFLATE};
 }
 
 std::vector<std::string> ZipReader::names() const {
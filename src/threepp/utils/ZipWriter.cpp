@@ -1,11 +1,21 @@
 
 #include "threepp/utils/ZipWriter.hpp"
 
+#include "threepp/utils/Crc32.hpp"
+#include "threepp/utils/Parallel.hpp"
+
 #include <algorithm>
-#include <array>
+#include <climits>
+#include <cstdlib>
 #include <fstream>
+#include <span>
 #include <stdexcept>
 
+// stb_image_write's zlib-format deflate, compiled in by StbImageWrite.cpp for
+// PNG encoding. It is defined with external linkage but not declared in the
+// header's public section, so it is declared here.
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
 using namespace threepp;
 
 namespace {
@@ -13,19 +23,40 @@ namespace {
     constexpr std::uint32_t LOCAL_SIG = 0x04034b50;  // "PK\x03\x04"
     constexpr std::uint32_t CENTRAL_SIG = 0x02014b50;// "PK\x01\x02"
     constexpr std::uint32_t EOCD_SIG = 0x06054b50;   // "PK\x05\x06"
+    constexpr std::uint32_t EOCD64_SIG = 0x06064b50; // "PK\x06\x06"
+    constexpr std::uint32_t LOCATOR_SIG = 0x07064b50;// "PK\x06\x07"
 
     constexpr std::uint64_t LOCAL_FIXED = 30;
     constexpr std::uint64_t CENTRAL_FIXED = 46;
     constexpr std::uint64_t EOCD_FIXED = 22;
 
-    // 2.0 in both places: the floor for a reader that understands directories
-    // and stored entries, which is all this writer produces. The high byte of
-    // version-made-by is the host system, and 0 (MS-DOS/FAT) is the one value
-    // that carries no attributes worth disagreeing about across platforms —
-    // holding it fixed is what keeps a Windows export and a Linux export of the
-    // same scene byte-identical.
+    // Version-needed-to-extract is per entry and is what a reader gates on:
+    // 2.0 covers stored and DEFLATE entries alike, and 4.5 is where ZIP64 came
+    // in, so an entry whose sizes or offset spill into the ZIP64 extra field
+    // says 45 and every other entry keeps saying 20.
+    //
+    // Version-made-by is a different field and stays 20 even in an archive
+    // with ZIP64 entries. Its low byte only tells a reader how to interpret
+    // the external attributes, which this writer leaves zero; no reader
+    // refuses an entry over it. Tying it to the content would make one big
+    // member rewrite the central record of every small one, and raising it
+    // outright would change the bytes of every archive already written. Its
+    // high byte is the host system, and 0 (MS-DOS/FAT) is the one value that
+    // carries no attributes worth disagreeing about across platforms — holding
+    // it fixed is what keeps a Windows export and a Linux export of the same
+    // scene byte-identical. (The ZIP64 end record itself says 45 in both
+    // places: only a ZIP64-aware reader ever looks at it.)
     constexpr std::uint16_t VERSION_MADE_BY = 20;
     constexpr std::uint16_t VERSION_NEEDED = 20;
+    constexpr std::uint16_t VERSION_ZIP64 = 45;
+
+    constexpr std::uint16_t METHOD_STORED = 0;
+    constexpr std::uint16_t METHOD_DEFLATE = 8;
+    constexpr std::uint16_t ZIP64_EXTRA = 0x0001;
+
+    // stb's default for PNG: its longest hash chains, which still runs at
+    // tens of MB/s and is deterministic, which is what matters here.
+    constexpr int DEFLATE_QUALITY = 8;
 
     // 1980-01-01 00:00, the epoch of the DOS timestamp: year 0 of the 7-bit
     // year field, month 1, day 1. Anything later would be a clock reading, and
@@ -57,37 +88,6 @@ namespace {
         return name;
     }
 
-    // CRC-32/ISO-HDLC, the one ZIP uses: reflected input and output, so the
-    // polynomial appears here bit-reversed (0x04C11DB7 -> 0xEDB88320) and the
-    // register shifts right rather than left. The table is built once, on the
-    // first archive written, rather than spelled out as 256 magic constants.
-    const std::array<std::uint32_t, 256>& crcTable() {
-
-        static const std::array<std::uint32_t, 256> table = [] {
-            std::array<std::uint32_t, 256> t{};
-            for (std::uint32_t i = 0; i < 256; ++i) {
-
-                std::uint32_t c = i;
-                for (int k = 0; k < 8; ++k) c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
-                t[i] = c;
-            }
-            return t;
-        }();
-
-        return table;
-    }
-
-    std::uint32_t crc32(const std::vector<unsigned char>& data) {
-
-        const auto& table = crcTable();
-        std::uint32_t c = 0xFFFFFFFFu;
-        for (const unsigned char byte : data) {
-
-            c = table[(c ^ byte) & 0xFFu] ^ (c >> 8);
-        }
-        return c ^ 0xFFFFFFFFu;
-    }
-
     void put16(std::vector<unsigned char>& out, std::uint16_t v) {
 
         out.push_back(static_cast<unsigned char>(v & 0xFFu));
@@ -102,6 +102,12 @@ namespace {
         out.push_back(static_cast<unsigned char>((v >> 24) & 0xFFu));
     }
 
+    void put64(std::vector<unsigned char>& out, std::uint64_t v) {
+
+        put32(out, static_cast<std::uint32_t>(v & MAX32));
+        put32(out, static_cast<std::uint32_t>(v >> 32));
+    }
+
     void putName(std::vector<unsigned char>& out, const std::string& name) {
 
         out.insert(out.end(), name.begin(), name.end());
@@ -129,10 +135,39 @@ namespace {
         return a < b;
     }
 
+    // What actually goes in the file for one entry: its checksum, its method,
+    // and the deflated bytes when deflating paid off.
+    struct Prepared {
+        std::uint32_t crc{};
+        std::uint16_t method{METHOD_STORED};
+        std::vector<unsigned char> deflated;
+    };
+
+    // Raw DEFLATE, which is what ZIP method 8 holds: stb emits a zlib stream,
+    // so its 2-byte header and 4-byte Adler-32 trailer come off. Empty when
+    // the result would not be smaller than the input.
+    std::vector<unsigned char> deflate(const std::vector<unsigned char>& data) {
+
+        if (data.empty() || data.size() > static_cast<std::size_t>(INT_MAX)) return {};
+
+        int length = 0;
+        unsigned char* zlib = stbi_zlib_compress(const_cast<unsigned char*>(data.data()),
+                                                 static_cast<int>(data.size()), &length, DEFLATE_QUALITY);
+        if (!zlib) return {};
+
+        std::vector<unsigned char> out;
+        if (length > 6 && static_cast<std::size_t>(length - 6) < data.size()) {
+
+            out.assign(zlib + 2, zlib + length - 4);
+        }
+        std::free(zlib);
+        return out;
+    }
+
 }// namespace
 
 
-void ZipWriter::add(std::string name, std::vector<unsigned char> data) {
+std::string ZipWriter::checkName(std::string name) const {
 
     name = normalizeName(std::move(name));
 
@@ -146,11 +181,6 @@ void ZipWriter::add(std::string name, std::vector<unsigned char> data) {
         fail(named(name.substr(0, 64) + "...") + " is " + std::to_string(name.size()) +
              " bytes long; a ZIP entry name cannot exceed " + std::to_string(MAX16));
     }
-    if (data.size() > MAX32) {
-
-        fail(named(name) + " is " + std::to_string(data.size()) +
-             " bytes; entries of 4 GB or more need ZIP64, which is not supported");
-    }
 
     const auto duplicate = std::find_if(entries_.begin(), entries_.end(),
                                         [&](const Entry& e) { return e.name == name; });
@@ -159,22 +189,28 @@ void ZipWriter::add(std::string name, std::vector<unsigned char> data) {
         fail(named(name) + " was added twice; entry names must be unique");
     }
 
-    const auto crc = crc32(data);
-    entries_.push_back(Entry{std::move(name), std::move(data), crc});
+    return name;
 }
 
-void ZipWriter::add(std::string name, const std::string& text) {
+void ZipWriter::add(std::string name, std::vector<unsigned char> data, Compression compression) {
 
-    add(std::move(name), std::vector<unsigned char>(text.begin(), text.end()));
+    entries_.push_back(Entry{checkName(std::move(name)), std::move(data), compression, {}, {}});
 }
 
-std::vector<unsigned char> ZipWriter::build() const {
+void ZipWriter::copy(std::string name, std::shared_ptr<const ZipReader> from, const std::string& entry) {
 
-    if (entries_.size() >= MAX16) {
+    name = checkName(std::move(name));
+    const auto stored = from->stored(entry);
+    const auto compression = stored.deflated ? Compression::Deflate : Compression::Stored;
+    entries_.push_back(Entry{std::move(name), {}, compression, std::move(from), stored});
+}
 
-        fail("archive has " + std::to_string(entries_.size()) +
-             " entries; 65535 or more need ZIP64, which is not supported");
-    }
+void ZipWriter::add(std::string name, const std::string& text, Compression compression) {
+
+    add(std::move(name), std::vector<unsigned char>(text.begin(), text.end()), compression);
+}
+
+void ZipWriter::emit(const std::function<void(const unsigned char*, std::size_t)>& sink) const {
 
     // Sorted by name rather than in add() order, so the caller's traversal
     // order cannot leak into the bytes.
@@ -184,102 +220,177 @@ std::vector<unsigned char> ZipWriter::build() const {
     std::sort(ordered.begin(), ordered.end(),
               [](const Entry* a, const Entry* b) { return before(a->name, b->name); });
 
-    std::vector<unsigned char> out;
-
-    std::uint64_t total = 0;
-    for (const auto* entry : ordered) {
-
-        total += LOCAL_FIXED + entry->name.size() + entry->data.size() +
-                 CENTRAL_FIXED + entry->name.size();
-    }
-    out.reserve(static_cast<std::size_t>(total + EOCD_FIXED));
+    // The expensive part, and every entry's is independent of the others'.
+    // A copied entry has had it done already, by whoever wrote it first.
+    std::vector<Prepared> prepared(ordered.size());
+    parallelFor(0, ordered.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (auto i = lo; i < hi; ++i) {
+            if (ordered[i]->source) {
+                prepared[i].crc = ordered[i]->stored.crc;
+                prepared[i].method = ordered[i]->stored.deflated ? METHOD_DEFLATE : METHOD_STORED;
+                continue;
+            }
+            const auto& data = ordered[i]->data;
+            prepared[i].crc = utils::crc32(data.data(), data.size());
+            if (ordered[i]->compression == Compression::Deflate) {
+                prepared[i].deflated = deflate(data);
+                if (!prepared[i].deflated.empty()) prepared[i].method = METHOD_DEFLATE;
+            }
+        }
+    });
 
-    std::vector<std::uint32_t> localOffsets;
+    const auto payloadOf = [&](std::size_t i) -> std::span<const unsigned char> {
+        if (ordered[i]->source) {
+            const auto bytes = ordered[i]->stored.bytes;
+            return {reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size()};
+        }
+        return prepared[i].method == METHOD_DEFLATE ? prepared[i].deflated : ordered[i]->data;
+    };
+    const auto sizeOf = [&](std::size_t i) -> std::uint64_t {
+        return ordered[i]->source ? ordered[i]->stored.size : ordered[i]->data.size();
+    };
+
+    std::uint64_t offset = 0;
+    std::vector<unsigned char> header;
+    const auto flush = [&] {
+        sink(header.data(), header.size());
+        offset += header.size();
+        header.clear();
+    };
+
+    std::vector<std::uint64_t> localOffsets;
     localOffsets.reserve(ordered.size());
 
-    for (const auto* entry : ordered) {
-
-        // Checked before the header is written rather than after: the offset
-        // that overflows is the one that would silently alias entry 0's.
-        if (out.size() > MAX32) {
+    for (std::size_t i = 0; i < ordered.size(); ++i) {
 
-            fail(named(entry->name) + " starts at offset " + std::to_string(out.size()) +
-                 "; archives of 4 GB or more need ZIP64, which is not supported");
+        const auto* entry = ordered[i];
+        const auto payload = payloadOf(i);
+        const std::uint64_t size = sizeOf(i);
+        const std::uint64_t compressed = payload.size();
+        // A value equal to the sentinel must go through ZIP64 as well, or it
+        // would read back as "look in the extra field".
+        const bool sizes64 = size >= MAX32 || compressed >= MAX32;
+
+        localOffsets.push_back(offset);
+
+        put32(header, LOCAL_SIG);
+        put16(header, sizes64 ? VERSION_ZIP64 : VERSION_NEEDED);
+        put16(header, flagsFor(entry->name));
+        put16(header, prepared[i].method);
+        put16(header, DOS_TIME);
+        put16(header, DOS_DATE);
+        put32(header, prepared[i].crc);
+        put32(header, sizes64 ? MAX32 : static_cast<std::uint32_t>(compressed));
+        put32(header, sizes64 ? MAX32 : static_cast<std::uint32_t>(size));
+        put16(header, static_cast<std::uint16_t>(entry->name.size()));
+        put16(header, sizes64 ? 20 : 0);
+        putName(header, entry->name);
+        if (sizes64) {
+
+            // In the local header the ZIP64 field carries both sizes, always.
+            put16(header, ZIP64_EXTRA);
+            put16(header, 16);
+            put64(header, size);
+            put64(header, compressed);
         }
-        localOffsets.push_back(static_cast<std::uint32_t>(out.size()));
-
-        const auto size = static_cast<std::uint32_t>(entry->data.size());
-
-        put32(out, LOCAL_SIG);
-        put16(out, VERSION_NEEDED);
-        put16(out, flagsFor(entry->name));
-        put16(out, 0);// stored
-        put16(out, DOS_TIME);
-        put16(out, DOS_DATE);
-        put32(out, entry->crc);
-        put32(out, size);// compressed == uncompressed, by definition of stored
-        put32(out, size);
-        put16(out, static_cast<std::uint16_t>(entry->name.size()));
-        put16(out, 0);// no extra field
-        putName(out, entry->name);
-
-        out.insert(out.end(), entry->data.begin(), entry->data.end());
+        flush();
+
+        if (!payload.empty()) sink(payload.data(), payload.size());
+        offset += payload.size();
     }
 
-    const auto cdStart = out.size();
+    const auto cdStart = offset;
 
     for (std::size_t i = 0; i < ordered.size(); ++i) {
 
         const auto* entry = ordered[i];
-        const auto size = static_cast<std::uint32_t>(entry->data.size());
-
-        put32(out, CENTRAL_SIG);
-        put16(out, VERSION_MADE_BY);
-        put16(out, VERSION_NEEDED);
-        put16(out, flagsFor(entry->name));
-        put16(out, 0);// stored
-        put16(out, DOS_TIME);
-        put16(out, DOS_DATE);
-        put32(out, entry->crc);
-        put32(out, size);
-        put32(out, size);
-        put16(out, static_cast<std::uint16_t>(entry->name.size()));
-        put16(out, 0);// no extra field
-        put16(out, 0);// no comment
-        put16(out, 0);// disk number
-        put16(out, 0);// internal attributes
-        put32(out, 0);// external attributes: none, so the archive says nothing
-                      // about a mode or a hidden bit it did not observe
-        put32(out, localOffsets[i]);
-        putName(out, entry->name);
+        const std::uint64_t size = sizeOf(i);
+        const std::uint64_t compressed = payloadOf(i).size();
+
+        // In the central directory it carries only the fields that overflowed,
+        // in the order the spec lists them.
+        std::vector<unsigned char> extra;
+        if (size >= MAX32) put64(extra, size);
+        if (compressed >= MAX32) put64(extra, compressed);
+        if (localOffsets[i] >= MAX32) put64(extra, localOffsets[i]);
+
+        put32(header, CENTRAL_SIG);
+        put16(header, VERSION_MADE_BY);
+        put16(header, extra.empty() ? VERSION_NEEDED : VERSION_ZIP64);
+        put16(header, flagsFor(entry->name));
+        put16(header, prepared[i].method);
+        put16(header, DOS_TIME);
+        put16(header, DOS_DATE);
+        put32(header, prepared[i].crc);
+        put32(header, compressed >= MAX32 ? MAX32 : static_cast<std::uint32_t>(compressed));
+        put32(header, size >= MAX32 ? MAX32 : static_cast<std::uint32_t>(size));
+        put16(header, static_cast<std::uint16_t>(entry->name.size()));
+        put16(header, static_cast<std::uint16_t>(extra.empty() ? 0 : 4 + extra.size()));
+        put16(header, 0);// no comment
+        put16(header, 0);// disk number
+        put16(header, 0);// internal attributes
+        put32(header, 0);// external attributes: none, so the archive says nothing
+                         // about a mode or a hidden bit it did not observe
+        put32(header, localOffsets[i] >= MAX32 ? MAX32 : static_cast<std::uint32_t>(localOffsets[i]));
+        putName(header, entry->name);
+        if (!extra.empty()) {
+
+            put16(header, ZIP64_EXTRA);
+            put16(header, static_cast<std::uint16_t>(extra.size()));
+            header.insert(header.end(), extra.begin(), extra.end());
+        }
+        flush();
     }
 
-    const auto cdSize = out.size() - cdStart;
-
-    if (cdStart > MAX32 || cdSize > MAX32) {
-
-        fail("central directory is " + std::to_string(cdSize) + " bytes at offset " +
-             std::to_string(cdStart) + "; archives of 4 GB or more need ZIP64, which is not supported");
+    const std::uint64_t cdSize = offset - cdStart;
+    const std::uint64_t count = ordered.size();
+    const bool count64 = count >= MAX16;
+    const bool cdSize64 = cdSize >= MAX32;
+    const bool cdStart64 = cdStart >= MAX32;
+
+    if (count64 || cdSize64 || cdStart64) {
+
+        const auto eocd64 = offset;
+
+        put32(header, EOCD64_SIG);
+        put64(header, 44);// size of the rest of this record
+        put16(header, VERSION_ZIP64);
+        put16(header, VERSION_ZIP64);
+        put32(header, 0);// this disk
+        put32(header, 0);// disk the central directory starts on
+        put64(header, count);
+        put64(header, count);
+        put64(header, cdSize);
+        put64(header, cdStart);
+
+        put32(header, LOCATOR_SIG);
+        put32(header, 0);// disk holding the ZIP64 end record
+        put64(header, eocd64);
+        put32(header, 1);// total disks
     }
 
-    put32(out, EOCD_SIG);
-    put16(out, 0);// this disk
-    put16(out, 0);// disk the central directory starts on
-    put16(out, static_cast<std::uint16_t>(ordered.size()));
-    put16(out, static_cast<std::uint16_t>(ordered.size()));
-    put32(out, static_cast<std::uint32_t>(cdSize));
-    put32(out, static_cast<std::uint32_t>(cdStart));
-    put16(out, 0);// no archive comment
+    put32(header, EOCD_SIG);
+    put16(header, 0);// this disk
+    put16(header, 0);// disk the central directory starts on
+    put16(header, count64 ? MAX16 : static_cast<std::uint16_t>(count));
+    put16(header, count64 ? MAX16 : static_cast<std::uint16_t>(count));
+    put32(header, cdSize64 ? MAX32 : static_cast<std::uint32_t>(cdSize));
+    put32(header, cdStart64 ? MAX32 : static_cast<std::uint32_t>(cdStart));
+    put16(header, 0);// no archive comment
+    flush();
+}
+
+std::vector<unsigned char> ZipWriter::build() const {
 
+    std::vector<unsigned char> out;
+    emit([&](const unsigned char* data, std::size_t size) {
+        out.insert(out.end(), data, data + size);
+    });
     return out;
 }
 
 void ZipWriter::writeTo(const std::filesystem::path& path) const {
 
-    // Built first: a refusal (ZIP64, a duplicate name) must not have already
-    // deleted the archive it was asked to replace.
-    const auto bytes = build();
-
     auto temp = path;
     temp += ".tmp";
 
@@ -290,8 +401,21 @@ void ZipWriter::writeTo(const std::filesystem::path& path) const {
         std::ofstream out(temp, std::ios::binary | std::ios::trunc);
         if (!out) fail("cannot open '" + temp.string() + "' for writing");
 
-        out.write(reinterpret_cast<const char*>(bytes.data()),
-                  static_cast<std::streamsize>(bytes.size()));
+        // Streamed: a multi-gigabyte archive never exists twice in memory. If
+        // anything throws part way, the target is still the previous archive.
+        try {
+
+            emit([&](const unsigned char* data, std::size_t size) {
+                out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+            });
+
+        } catch (...) {
+
+            out.close();
+            std::error_code ignored;
+            std::filesystem::remove(temp, ignored);
+            throw;
+        }
         out.flush();
 
         if (!out) {
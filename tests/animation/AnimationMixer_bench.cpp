@@ -0,0 +1,148 @@
+// CPU microbenchmark for AnimationMixer: interpolants vs compiled clips.
+//
+// Not a ctest — run manually. A crowd of skeletal rigs, each with its own
+// mixer playing two clips (position, rotation and scale on every bone) and
+// crossfading between them, advanced a frame at a time. The same crowd runs
+// twice, once per AnimationMixer::compileClips setting, and the final poses
+// are compared so a fast but wrong run shows up.
+//
+// Usage: AnimationMixer_bench [rigs] [bones] [frames]   (default 300 40 600)
+
+#include "threepp/animation/AnimationMixer.hpp"
+#include "threepp/animation/tracks/QuaternionKeyframeTrack.hpp"
+#include "threepp/animation/tracks/VectorKeyframeTrack.hpp"
+#include "threepp/math/MathUtils.hpp"
+#include "threepp/objects/Group.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    // 30 keys a second, pos/quat/scale per bone, like a typical glTF export.
+    std::shared_ptr<AnimationClip> makeClip(const std::string& name, int bones, float duration, unsigned seed) {
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+        const int keys = static_cast<int>(duration * 30) + 1;
+        std::vector<float> times(keys);
+        for (int k = 0; k < keys; ++k) times[k] = duration * static_cast<float>(k) / static_cast<float>(keys - 1);
+
+        std::vector<std::shared_ptr<KeyframeTrack>> tracks;
+        for (int b = 0; b < bones; ++b) {
+
+            const auto bone = "bone" + std::to_string(b);
+            std::vector<float> pos, quat, scale;
+            for (int k = 0; k < keys; ++k) {
+                pos.insert(pos.end(), {dist(rng), dist(rng), dist(rng)});
+                Quaternion q;
+                q.setFromEuler(Euler(dist(rng), dist(rng), dist(rng)));
+                quat.insert(quat.end(), {q.x, q.y, q.z, q.w});
+                const float s = 1 + 0.1f * dist(rng);
+                scale.insert(scale.end(), {s, s, s});
+            }
+            tracks.emplace_back(std::make_shared<VectorKeyframeTrack>(bone + ".position", times, pos));
+            tracks.emplace_back(std::make_shared<QuaternionKeyframeTrack>(bone + ".quaternion", times, quat));
+            tracks.emplace_back(std::make_shared<VectorKeyframeTrack>(bone + ".scale", times, scale));
+        }
+
+        return std::make_shared<AnimationClip>(name, duration, tracks);
+    }
+
+    struct Crowd {
+        std::vector<std::shared_ptr<Group>> rigs;
+        std::vector<std::unique_ptr<AnimationMixer>> mixers;
+    };
+
+    Crowd makeCrowd(int rigs, int bones, bool compile,
+                    const std::shared_ptr<AnimationClip>& walk, const std::shared_ptr<AnimationClip>& run) {
+
+        Crowd crowd;
+        for (int r = 0; r < rigs; ++r) {
+
+            auto root = Group::create();
+            Object3D* parent = root.get();
+            for (int b = 0; b < bones; ++b) {
+                auto bone = Object3D::create();
+                bone->name = "bone" + std::to_string(b);
+                parent->add(bone);
+                // A spine of four chains, roughly a skeleton's depth.
+                parent = (b % 10 == 9) ? root.get() : parent->children.back();
+            }
+
+            auto mixer = std::make_unique<AnimationMixer>(*root);
+            mixer->compileClips = compile;
+            auto* walkAction = mixer->clipAction(walk);
+            auto* runAction = mixer->clipAction(run);
+            walkAction->play();
+            runAction->play();
+            walkAction->crossFadeTo(runAction, 2.f);
+            // Spread the crowd over the clip.
+            mixer->update(0.013f * static_cast<float>(r));
+
+            crowd.rigs.emplace_back(std::move(root));
+            crowd.mixers.emplace_back(std::move(mixer));
+        }
+        return crowd;
+    }
+
+    double runFrames(Crowd& crowd, int frames) {
+
+        const auto t0 = Clock::now();
+        for (int f = 0; f < frames; ++f) {
+            for (auto& mixer : crowd.mixers) mixer->update(1.f / 60);
+        }
+        return msSince(t0);
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+
+    const int rigs = argc > 1 ? std::atoi(argv[1]) : 300;
+    const int bones = argc > 2 ? std::atoi(argv[2]) : 40;
+    const int frames = argc > 3 ? std::atoi(argv[3]) : 600;
+
+    const auto walk = makeClip("walk", bones, 1.2f, 1);
+    const auto run = makeClip("run", bones, 0.8f, 2);
+
+    std::printf("%d rigs x %d bones (%d tracks each), %d frames\n", rigs, bones, bones * 3, frames);
+
+    auto legacy = makeCrowd(rigs, bones, false, walk, run);
+    auto compiled = makeCrowd(rigs, bones, true, walk, run);
+
+    const double legacyMs = runFrames(legacy, frames);
+    const double compiledMs = runFrames(compiled, frames);
+
+    const double tracksPerFrame = static_cast<double>(rigs) * bones * 3 * 2;
+    std::printf("  interpolants %9.1f ms  %6.1f ns/track\n", legacyMs, legacyMs * 1e6 / (tracksPerFrame * frames));
+    std::printf("  compiled     %9.1f ms  %6.1f ns/track  (%.2fx)\n", compiledMs, compiledMs * 1e6 / (tracksPerFrame * frames),
+                legacyMs / compiledMs);
+
+    std::size_t mismatches = 0;
+    for (int r = 0; r < rigs; ++r) {
+        legacy.rigs[r]->traverse([&](Object3D& a) {
+            if (&a == legacy.rigs[r].get()) return;
+            const auto* b = compiled.rigs[r]->getObjectByName(a.name);
+            if (!b || !(a.position == b->position && a.quaternion == b->quaternion && a.scale == b->scale)) ++mismatches;
+        });
+    }
+    std::printf("  pose mismatches: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -349,3 +349,74 @@ TEST_CASE("A STEP rotation track snaps instead of slerping") {
     INFO("y at t=0.8 = " << rig.node->quaternion.y);
     CHECK_THAT(rig.node->quaternion.y, WithinAbs(0.f, 1e-4));
 }
+
+TEST_CASE("A compiled mixer poses exactly as the interpolant path") {
+
+    // Two identical rigs, one mixer each; only compileClips differs. Every
+    // interpolation the compiled path handles (vector lerp, quaternion slerp,
+    // step) plus one it hands back to the interpolant (smooth), played as a
+    // crossfade, under a ping-pong loop and with an additive layer on top.
+    const float s = std::sqrt(0.5f);
+    const std::vector<float> times{0.f, 0.3f, 0.55f, 1.f};
+
+    auto walk = std::make_shared<AnimationClip>(
+            "walk", 1.f,
+            std::vector<std::shared_ptr<KeyframeTrack>>{
+                    std::make_shared<VectorKeyframeTrack>(
+                            "Cube.position", times,
+                            std::vector<float>{0, 0, 0, 1, 2, 3, -4, 5, 0.5f, 7, 1, -2}),
+                    std::make_shared<QuaternionKeyframeTrack>(
+                            "Cube.quaternion", times,
+                            std::vector<float>{0, 0, 0, 1, 0, s, 0, s, s, 0, 0, s, 0, 0, 0, 1}),
+                    std::make_shared<VectorKeyframeTrack>(
+                            "Cube.scale", times,
+                            std::vector<float>{1, 1, 1, 2, 2, 2, 1, 3, 1, 1, 1, 1},
+                            Interpolation::Smooth)});
+
+    auto run = std::make_shared<AnimationClip>(
+            "run", 0.8f,
+            std::vector<std::shared_ptr<KeyframeTrack>>{
+                    std::make_shared<VectorKeyframeTrack>(
+                            "Cube.position", std::vector<float>{0.f, 0.8f},
+                            std::vector<float>{5, 0, 0, -5, 1, 0}),
+                    std::make_shared<QuaternionKeyframeTrack>(
+                            "Cube.quaternion", std::vector<float>{0.f, 0.4f, 0.8f},
+                            std::vector<float>{0, 0, 0, 1, 0, 0, s, s, 0, 0, 0, 1},
+                            Interpolation::Discrete)});
+
+    auto wave = std::make_shared<AnimationClip>(
+            "wave", 0.5f,
+            std::vector<std::shared_ptr<KeyframeTrack>>{
+                    std::make_shared<VectorKeyframeTrack>(
+                            "Cube.position", std::vector<float>{0.f, 0.25f, 0.5f},
+                            std::vector<float>{0, 0, 0, 0, 1, 0, 0, 0, 0})});
+    wave->makeAdditive();
+
+    auto legacyRig = makeRig();
+    auto compiledRig = makeRig();
+    AnimationMixer legacy(*legacyRig.root);
+    AnimationMixer compiled(*compiledRig.root);
+    compiled.compileClips = true;
+
+    for (auto* mixer : {&legacy, &compiled}) {
+        auto* walkAction = mixer->clipAction(walk);
+        auto* runAction = mixer->clipAction(run);
+        walkAction->setLoop(Loop::PingPong).play();
+        runAction->play();
+        walkAction->crossFadeTo(runAction, 0.7f);
+        mixer->clipAction(wave)->setEffectiveWeight(0.6f).play();
+    }
+
+    int mismatches = 0;
+    for (int i = 0; i < 90; ++i) {
+        // Uneven steps, so keys are crossed both one at a time and several at once.
+        const float dt = (i % 7 == 0) ? 0.31f : 0.017f * static_cast<float>(1 + i % 3);
+        legacy.update(dt);
+        compiled.update(dt);
+
+        const auto& a = *legacyRig.node;
+        const auto& b = *compiledRig.node;
+        if (!(a.position == b.position && a.quaternion == b.quaternion && a.scale == b.scale)) ++mismatches;
+    }
+    CHECK(mismatches == 0);
+}
@@ -10,6 +10,10 @@
 //   static     — updateMatrixWorld() with nothing dirty (early-out + locality)
 //   dynamic5   — mutate 5% of node positions, then updateMatrixWorld()
 //   readAll    — read matrixWorld translation of every node (scene-prep style)
+//   storeStat  — static, through a TransformStore's linear pass
+//   storeDyn5  — dynamic5, through the same TransformStore
+//   parStat    — static, through updateMatrixWorldParallel
+//   parDyn5    — dynamic5, through updateMatrixWorldParallel
 //   teardown   — destroy the tree (free cost)
 //
 // Each phase runs in two heap layouts: "clustered" (nodes allocated
@@ -20,6 +24,7 @@
 // Usage: Object3D_bench [nodeCount]   (default 100000)
 
 #include "threepp/core/Object3D.hpp"
+#include "threepp/core/TransformStore.hpp"
 
 #include <algorithm>
 #include <chrono>
@@ -31,6 +36,7 @@
 #include <vector>
 
 using threepp::Object3D;
+using threepp::TransformStore;
 
 namespace {
 
@@ -160,6 +166,33 @@ int main(int argc, char** argv) {
             checksum += acc;
         });
 
+        // The two update phases again, flattened. The first update() lays the
+        // tree out; it is not timed, as a stable scene pays it once.
+        TransformStore store(*tree.root);
+        store.update();
+
+        const auto storeStat = runPhase(reps, [&](int) {
+            store.update();
+        });
+
+        const auto storeDyn = runPhase(reps, [&](int i) {
+            const float d = (i % 2 == 0) ? 0.001f : -0.001f;
+            for (auto* o : dirty) o->position.x += d;
+            store.update();
+        });
+
+        const auto parStat = runPhase(reps, [&](int) {
+            tree.root->updateMatrixWorldParallel();
+        });
+
+        const auto parDyn = runPhase(reps, [&](int i) {
+            const float d = (i % 2 == 0) ? 0.001f : -0.001f;
+            for (auto* o : dirty) o->position.x += d;
+            tree.root->updateMatrixWorldParallel();
+        });
+
+        for (const auto* o : tree.flat) checksum += o->matrixWorld->elements[12];
+
         // teardown
         const auto t0 = Clock::now();
         tree.flat.clear();
@@ -170,6 +203,14 @@ int main(int argc, char** argv) {
         std::printf("[%s] static   %8.3f ms  (min %.3f)\n", layout, stat.medianMs, stat.minMs);
         std::printf("[%s] dynamic5 %8.3f ms  (min %.3f)\n", layout, dyn.medianMs, dyn.minMs);
         std::printf("[%s] readAll  %8.3f ms  (min %.3f)\n", layout, read.medianMs, read.minMs);
+        std::printf("[%s] storeStat %7.3f ms  (min %.3f)  %.2fx\n", layout, storeStat.medianMs, storeStat.minMs,
+                    stat.medianMs / storeStat.medianMs);
+        std::printf("[%s] storeDyn5 %7.3f ms  (min %.3f)  %.2fx\n", layout, storeDyn.medianMs, storeDyn.minMs,
+                    dyn.medianMs / storeDyn.medianMs);
+        std::printf("[%s] parStat  %8.3f ms  (min %.3f)  %.2fx\n", layout, parStat.medianMs, parStat.minMs,
+                    stat.medianMs / parStat.medianMs);
+        std::printf("[%s] parDyn5  %8.3f ms  (min %.3f)  %.2fx\n", layout, parDyn.medianMs, parDyn.minMs,
+                    dyn.medianMs / parDyn.medianMs);
         std::printf("[%s] teardown %8.3f ms\n", layout, teardownMs);
     }
 
@@ -11,6 +11,9 @@
 #include "threepp/objects/Mesh.hpp"
 #include "threepp/objects/Points.hpp"
 
+#include <memory>
+#include <stdexcept>
+
 using namespace threepp;
 
 namespace {
@@ -189,3 +192,54 @@ TEST_CASE("Points intersection threshold") {
     raycaster.params.pointsThreshold = 2.001f;
     CHECK(raycaster.intersectObject(*points).size() == 1);
 }
+
+TEST_CASE("intersectBatch matches intersectObjects per ray") {
+
+    auto objectsToCheck = getObjectsToCheck();
+    // One mesh through its bounds tree, and a Points object on the serial path.
+    objectsToCheck[1]->as<Mesh>()->geometry()->computeBoundsTree();
+    auto pointsGeometry = BufferGeometry::create();
+    pointsGeometry->setFromPoints(std::vector{Vector3(0.5f, 0.2f, -6), Vector3(-4, 0.1f, -3)});
+    objectsToCheck.emplace_back(Points::create(pointsGeometry, nullptr));
+    objectsToCheck.back()->updateMatrixWorld();
+
+    std::vector<Object3D*> objects;
+    for (auto& o : objectsToCheck) objects.emplace_back(o.get());
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < 500; ++i) {
+        const float x = static_cast<float>(i % 25) * 0.01f - 0.12f;
+        const float y = static_cast<float>(i / 25) * 0.01f - 0.1f;
+        rays.emplace_back(Vector3(0, 0, 0), Vector3(x, y, -1).normalize());
+    }
+
+    auto raycaster = getRaycaster();
+    raycaster.params.pointsThreshold = 0.2f;
+
+    std::vector<std::optional<Intersection>> hits(rays.size());
+    Raycaster::BatchOptions options;
+    options.raysPerPacket = 16;
+    raycaster.intersectBatch(rays, objects, hits, options);
+
+    std::unique_ptr<bool[]> occluded(new bool[rays.size()]);
+    raycaster.intersectBatchAny(rays, objects, {occluded.get(), rays.size()}, options);
+
+    int hitCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i) {
+        raycaster.ray = rays[i];
+        const auto expected = raycaster.intersectObjects(objects, true);
+
+        REQUIRE(hits[i].has_value() == !expected.empty());
+        REQUIRE(occluded[i] == !expected.empty());
+        if (expected.empty()) continue;
+
+        ++hitCount;
+        CHECK(hits[i]->distance == expected.front().distance);
+        CHECK(hits[i]->object == expected.front().object);
+        CHECK(hits[i]->faceIndex == expected.front().faceIndex);
+    }
+    CHECK(hitCount > 50);
+
+    std::vector<std::optional<Intersection>> tooFew(rays.size() - 1);
+    CHECK_THROWS_AS(raycaster.intersectBatch(rays, objects, tooFew), std::invalid_argument);
+}
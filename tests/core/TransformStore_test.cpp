@@ -0,0 +1,162 @@
+// TransformStore has to be a drop-in for updateMatrixWorld: the same world
+// matrix on every node, bit for bit, after every frame — through mutations,
+// externally driven matrices, reshaping of the graph, and nodes whose class
+// does its own thing in updateMatrixWorld.
+
+#include "threepp/cameras/PerspectiveCamera.hpp"
+#include "threepp/core/Object3D.hpp"
+#include "threepp/core/TransformStore.hpp"
+#include "threepp/scenes/Scene.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "graph_fixtures.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace threepp;
+using namespace graphtest;
+
+TEST_CASE("TransformStore matches updateMatrixWorld frame after frame", "[core]") {
+
+    auto recursive = buildGraph(30, 9, true);
+    auto flattened = buildGraph(30, 9, true);
+    TransformStore store(*flattened);
+
+    for (int frame = 0; frame < 6; ++frame) {
+        mutate(*recursive, 7, frame);
+        mutate(*flattened, 7, frame);
+        recursive->updateMatrixWorld(frame == 3);
+        store.update(frame == 3);
+        REQUIRE(snapshotWorlds(*recursive) == snapshotWorlds(*flattened));
+    }
+    CHECK(store.size() == 30 * 9 + 1);
+}
+
+TEST_CASE("TransformStore picks up externally driven matrices", "[core]") {
+
+    auto recursive = buildGraph(4, 6, true);
+    auto flattened = buildGraph(4, 6, true);
+    TransformStore store(*flattened);
+    recursive->updateMatrixWorld();
+    store.update();
+
+    for (auto* root : {recursive.get(), flattened.get()}) {
+        auto* node = root->children[2];
+        node->matrixAutoUpdate = false;
+        node->matrix->makeRotationX(0.7f).setPosition(1, 2, 3);
+    }
+    recursive->updateMatrixWorld();
+    store.update();
+    REQUIRE(snapshotWorlds(*recursive) == snapshotWorlds(*flattened));
+}
+
+TEST_CASE("TransformStore follows the graph as it is reshaped", "[core]") {
+
+    auto recursive = buildGraph(5, 5, true);
+    auto flattened = buildGraph(5, 5, true);
+    TransformStore store(*flattened);
+    recursive->updateMatrixWorld();
+    store.update();
+    const auto before = store.size();
+
+    for (auto* root : {recursive.get(), flattened.get()}) {
+        // A new subtree, a node moved under another branch, and one removed.
+        buildGraph(root->children[1]->shared_from_this(), 2, 3, true);
+        root->children[3]->add(root->children[0]->children[0]->shared_from_this());
+        root->remove(*root->children[4]);
+    }
+    recursive->updateMatrixWorld();
+    store.update();
+    REQUIRE(snapshotWorlds(*recursive) == snapshotWorlds(*flattened));
+    CHECK(store.size() != before);
+}
+
+TEST_CASE("TransformStore only rebuilds for edits under its own root", "[core]") {
+
+    auto scene = buildGraph(4, 4);
+    auto other = buildGraph(4, 4);
+    auto* branch = scene->children[1];
+    TransformStore store(*scene);
+    TransformStore branchStore(*branch);
+    store.update();
+    branchStore.update();
+    REQUIRE(store.rebuilds() == 1);
+    REQUIRE(branchStore.rebuilds() == 1);
+
+    // Another graph changing shape, or being destroyed, is none of its business.
+    other->children[0]->add(Object3D::create());
+    other->remove(*other->children[2]);
+    other.reset();
+    store.update();
+    branchStore.update();
+    CHECK(store.rebuilds() == 1);
+    CHECK(branchStore.rebuilds() == 1);
+
+    // A sibling of the branch changes the scene's layout, not the branch's.
+    scene->children[0]->children[0]->add(Object3D::create());
+    store.update();
+    branchStore.update();
+    CHECK(store.rebuilds() == 2);
+    CHECK(branchStore.rebuilds() == 1);
+
+    // Three levels down the branch reaches both.
+    branch->children[0]->children[0]->children[0]->add(Object3D::create());
+    store.update();
+    branchStore.update();
+    CHECK(store.rebuilds() == 3);
+    CHECK(branchStore.rebuilds() == 2);
+    CHECK(store.size() == 4 * 4 + 1 + 2);
+}
+
+TEST_CASE("TransformStore hands overriding nodes their own update", "[core]") {
+
+    auto scene = Scene::create();
+    scene->useTransformStore = true;
+    buildGraph(scene, 3, 4, true);
+
+    auto camera = PerspectiveCamera::create();
+    camera->position.set(0, 1, 5);
+    scene->children[0]->add(camera);
+
+    auto counting = std::make_shared<CountingGroup>();
+    auto below = Object3D::create();
+    below->position.x = 2;
+    counting->add(below);
+    scene->add(counting);
+
+    scene->position.y = 3;
+    scene->updateMatrixWorld();
+
+    CHECK(counting->updates == 1);
+    CHECK(below->matrixWorld->elements[12] == 2);
+    CHECK(below->matrixWorld->elements[13] == 3);
+
+    Matrix4 inverse;
+    inverse.copy(*camera->matrixWorld).invert();
+    CHECK(camera->matrixWorldInverse == inverse);
+
+    // The same scene updated by the recursion gives the same matrices.
+    const auto flattened = snapshotWorlds(*scene);
+    scene->useTransformStore = false;
+    scene->updateMatrixWorld(true);
+    CHECK(snapshotWorlds(*scene) == flattened);
+}
+
+TEST_CASE("updateMatrixWorldParallel may pass a Scene's store by", "[core]") {
+
+    std::vector<std::shared_ptr<Scene>> scenes;
+    for (int i = 0; i < 2; ++i) {
+        scenes.push_back(Scene::create());
+        scenes.back()->useTransformStore = true;
+        buildGraph(scenes.back(), 40, 6, true);
+    }
+
+    for (int frame = 0; frame < 3; ++frame) {
+        for (auto& scene : scenes) mutate(*scene, 5, frame);
+        scenes[0]->updateMatrixWorld(frame == 1);
+        scenes[1]->updateMatrixWorldParallel(frame == 1, 8);
+        REQUIRE(snapshotWorlds(*scenes[0]) == snapshotWorlds(*scenes[1]));
+    }
+}
@@ -0,0 +1,82 @@
+// Test-only scene graphs shared by the matrixWorld tests: the recursion,
+// the parallel walk and TransformStore are all checked by building the same
+// graph twice, mutating both alike, and comparing every node's matrixWorld.
+
+#ifndef THREEPP_GRAPH_FIXTURES_HPP
+#define THREEPP_GRAPH_FIXTURES_HPP
+
+#include "threepp/core/Object3D.hpp"
+#include "threepp/math/Matrix4.hpp"
+#include "threepp/objects/Group.hpp"
+#include "threepp/objects/Mesh.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace graphtest {
+
+    // A Group that counts its updates, to see a walk call an override.
+    class CountingGroup: public threepp::Group {
+    public:
+        int updates = 0;
+
+        void updateMatrixWorld(bool force) override {
+            ++updates;
+            Group::updateMatrixWorld(force);
+        }
+    };
+
+    // `groups` chains `depth` nodes deep under `root`, mirroring a real
+    // HUD/scene graph. Mixed graphs put a Mesh at every third level and hang
+    // every other level off the same parent, so the chains also branch.
+    inline std::shared_ptr<threepp::Object3D> buildGraph(const std::shared_ptr<threepp::Object3D>& root,
+                                                         int groups, int depth, bool mixed = false) {
+        using namespace threepp;
+
+        for (int g = 0; g < groups; ++g) {
+            Object3D* cursor = root.get();
+            for (int d = 0; d < depth; ++d) {
+                auto n = (mixed && d % 3 == 1) ? std::shared_ptr<Object3D>(Mesh::create()) : Object3D::create();
+                n->position.set(0.1f * float(d), 0.2f * float(g), 0.05f * float(g + d));
+                n->rotation.y = 0.01f * float(g * depth + d);
+                n->scale.set(1.f, 1.f + 0.01f * float(d), 1.f);
+                auto* raw = n.get();
+                cursor->add(n);
+                if (!mixed || d % 2 == 0) cursor = raw;
+            }
+        }
+        return root;
+    }
+
+    inline std::shared_ptr<threepp::Object3D> buildGraph(int groups, int depth, bool mixed = false) {
+        return buildGraph(threepp::Object3D::create(), groups, depth, mixed);
+    }
+
+    inline void forEachNode(threepp::Object3D& o, const std::function<void(threepp::Object3D&)>& fn) {
+        fn(o);
+        for (auto& c : o.children) forEachNode(*c, fn);
+    }
+
+    inline std::vector<threepp::Matrix4> snapshotWorlds(threepp::Object3D& root) {
+        std::vector<threepp::Matrix4> out;
+        forEachNode(root, [&](threepp::Object3D& o) { out.push_back(*o.matrixWorld); });
+        return out;
+    }
+
+    // Moves every `nth` node in preorder, counting from `offset`; applied to
+    // two structurally identical graphs it moves the same nodes in both.
+    inline void mutate(threepp::Object3D& root, int nth, int offset = 0) {
+        int i = 0;
+        forEachNode(root, [&](threepp::Object3D& o) {
+            if ((i + offset) % nth == 0) {
+                o.position.x += 1.5f;
+                o.rotation.z += 0.25f;
+            }
+            ++i;
+        });
+    }
+
+}// namespace graphtest
+
+#endif//THREEPP_GRAPH_FIXTURES_HPP
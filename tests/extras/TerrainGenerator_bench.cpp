@@ -0,0 +1,109 @@
+// CPU microbenchmark for the terrain bake on the shared thread pool.
+//
+// Not a ctest — run manually. Each phase runs once inside a
+// ThreadPool::SerialScope (every parallel call inline on this thread) and once
+// on the pool, so the speedup column is the scheduler's doing and nothing
+// else. The checksums must agree between the two columns: Parallel.hpp's
+// contract is that only the threading differs, never the result.
+//
+// Phases:
+//   field   — buildField(): noise stack into the dense grid
+//   bake    — displaceTo(): field into the PlaneGeometry (includes normals)
+//   splat   — bakeSplatColors(): slope/altitude albedo
+//
+// Usage: TerrainGenerator_bench [resolution]   (default 1024)
+
+#include "threepp/extras/terrain/TerrainGenerator.hpp"
+#include "threepp/utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    struct PhaseResult {
+        double medianMs;
+        double checksum;
+    };
+
+    template<class F>
+    PhaseResult runPhase(int reps, bool serial, F&& fn) {
+        std::vector<double> samples;
+        double checksum = 0.0;
+        for (int i = 0; i < reps; ++i) {
+            const auto t0 = Clock::now();
+            if (serial) {
+                ThreadPool::SerialScope scope;
+                checksum = fn();
+            } else {
+                checksum = fn();
+            }
+            samples.push_back(msSince(t0));
+        }
+        std::sort(samples.begin(), samples.end());
+        return {samples[samples.size() / 2], checksum};
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+
+    terrain::TerrainParams tp;
+    tp.resolution = argc > 1 ? std::atoi(argv[1]) : 1024;
+    const int reps = 5;
+
+    std::printf("TerrainGenerator_bench  resolution=%d  reps=%d  lanes=%u\n",
+                tp.resolution, reps, ThreadPool::global().concurrency());
+
+    terrain::TerrainGenerator gen(tp.seed);
+    gen.buildField(tp);
+    auto geo = gen.makeGeometry(tp);
+
+    const auto field = [&] {
+        gen.buildField(tp);
+        double s = 0.0;
+        for (float f : gen.getField()) s += f;
+        return s;
+    };
+    const auto bake = [&] {
+        gen.displaceTo(*geo, tp);
+        double s = 0.0;
+        for (float f : geo->getAttribute<float>("position")->array()) s += f;
+        return s;
+    };
+    const auto splat = [&] {
+        const auto px = gen.bakeSplatColors(tp);
+        double s = 0.0;
+        for (auto c : px) s += c;
+        return s;
+    };
+
+    const struct {
+        const char* name;
+        std::function<double()> fn;
+    } phases[] = {{"field", field}, {"bake ", bake}, {"splat", splat}};
+
+    std::printf("phase        serial ms   parallel ms   speedup   checksums\n");
+    for (const auto& phase : phases) {
+        const auto serial = runPhase(reps, true, phase.fn);
+        const auto parallel = runPhase(reps, false, phase.fn);
+        std::printf("%s   %11.3f   %11.3f   %6.2fx   %s\n",
+                    phase.name, serial.medianMs, parallel.medianMs,
+                    serial.medianMs / std::max(parallel.medianMs, 1e-9),
+                    serial.checksum == parallel.checksum ? "match" : "MISMATCH");
+    }
+
+    return 0;
+}
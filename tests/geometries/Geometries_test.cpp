@@ -20,11 +20,16 @@
 
 #include "threepp/extras/core/Shape.hpp"
 #include "threepp/extras/curves/CatmullRomCurve3.hpp"
+#include "threepp/math/MathUtils.hpp"
+#include "threepp/math/Triangle.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -101,6 +106,107 @@ namespace {
         return cases;
     }
 
+    using Segment = std::array<float, 6>;
+
+    std::vector<Segment> segmentsOf(const BufferGeometry& lines, bool directed) {
+        const auto& v = lines.getAttribute<float>("position")->array();
+        std::vector<Segment> segments;
+        for (size_t i = 0; i + 6 <= v.size(); i += 6) {
+            Segment s{v[i], v[i + 1], v[i + 2], v[i + 3], v[i + 4], v[i + 5]};
+            if (!directed && std::lexicographical_compare(s.begin() + 3, s.end(), s.begin(), s.begin() + 3)) {
+                std::rotate(s.begin(), s.begin() + 3, s.end());
+            }
+            segments.push_back(s);
+        }
+        std::sort(segments.begin(), segments.end());
+        return segments;
+    }
+
+    // The edge pairing EdgesGeometry has always done, written plainly: corners
+    // match on their position rounded to 1e-4, an edge met in reverse closes
+    // (and is drawn when the face normals differ by the threshold), and
+    // whatever is left open is drawn.
+    std::vector<Segment> referenceEdges(const BufferGeometry& geometry, float thresholdAngle) {
+        const auto thresholdDot = std::cos(math::DEG2RAD * thresholdAngle);
+        const auto* pos = geometry.getAttribute<float>("position");
+        const auto* index = geometry.getIndex();
+        const int count = index ? index->count() : pos->count();
+
+        using Corner = std::array<long long, 3>;
+        struct Open {
+            Segment segment;
+            Vector3 normal;
+        };
+        std::map<std::pair<Corner, Corner>, std::optional<Open>> edges;
+        std::vector<Segment> out;
+
+        for (int i = 0; i + 3 <= count; i += 3) {
+            std::array<Vector3, 3> v;
+            std::array<Corner, 3> c;
+            for (int j = 0; j < 3; ++j) {
+                const int k = index ? index->getX(i + j) : i + j;
+                v[j].set(pos->getX(k), pos->getY(k), pos->getZ(k));
+                c[j] = {std::llround(v[j].x * 1e4), std::llround(v[j].y * 1e4), std::llround(v[j].z * 1e4)};
+            }
+            if (c[0] == c[1] || c[1] == c[2] || c[2] == c[0]) continue;
+            Vector3 normal;
+            Triangle::getNormal(v[0], v[1], v[2], normal);
+
+            for (int j = 0; j < 3; ++j) {
+                const int n = (j + 1) % 3;
+                const Segment segment{v[j].x, v[j].y, v[j].z, v[n].x, v[n].y, v[n].z};
+                auto reverse = edges.find({c[n], c[j]});
+                if (reverse != edges.end() && reverse->second) {
+                    if (normal.dot(reverse->second->normal) <= thresholdDot) out.push_back(segment);
+                    reverse->second.reset();
+                } else if (auto& e = edges[{c[j], c[n]}]; !e) {
+                    e = Open{segment, normal};
+                }
+            }
+        }
+        for (const auto& [key, e] : edges) {
+            if (e) out.push_back(e->segment);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    std::vector<Segment> referenceWireframe(const BufferGeometry& geometry) {
+        const auto* pos = geometry.getAttribute<float>("position");
+        const auto* index = geometry.getIndex();
+        const auto vertex = [&](int k) { return std::array<float, 3>{pos->getX(k), pos->getY(k), pos->getZ(k)}; };
+
+        std::vector<Segment> out;
+        const auto add = [&](int a, int b) {
+            const auto va = vertex(a), vb = vertex(b);
+            out.push_back({va[0], va[1], va[2], vb[0], vb[1], vb[2]});
+        };
+        if (index) {
+            auto groups = geometry.groups;
+            if (groups.empty()) groups = {GeometryGroup{0, index->count(), 0}};
+            std::map<std::pair<int, int>, int> seen;
+            for (const auto& g : groups) {
+                for (int i = g.start; i < g.start + g.count; i += 3) {
+                    for (int j = 0; j < 3; ++j) {
+                        const int a = index->getX(i + j), b = index->getX(i + (j + 1) % 3);
+                        if (!seen[{std::min(a, b), std::max(a, b)}]++) add(std::min(a, b), std::max(a, b));
+                    }
+                }
+            }
+        } else {
+            for (int i = 0; i + 3 <= pos->count(); i += 3) {
+                for (int j = 0; j < 3; ++j) add(i + j, i + (j + 1) % 3);
+            }
+        }
+        return segmentsOf(*[&] {
+            auto lines = BufferGeometry::create();
+            std::vector<float> flat;
+            for (const auto& s : out) flat.insert(flat.end(), s.begin(), s.end());
+            lines->setAttribute("position", FloatBufferAttribute::create(flat, 3));
+            return lines;
+        }(), false);
+    }
+
     bool allFinite(const std::vector<float>& v) {
         for (const float f : v) {
             if (!std::isfinite(f)) return false;
@@ -289,6 +395,31 @@ TEST_CASE("Edges and wireframe geometries derive valid line lists") {
     }
 }
 
+TEST_CASE("Edges and wireframe geometries match the reference pairing") {
+
+    for (const auto& c : allCases()) {
+
+        auto indexed = c.make();
+        for (const auto& source : {indexed, indexed->hasIndex() ? indexed->toNonIndexed() : indexed}) {
+
+            INFO("source geometry: " << c.name << (source->hasIndex() ? "" : " (non-indexed)"));
+
+            for (const float threshold : {1.f, 30.f, 90.f}) {
+                INFO("threshold: " << threshold);
+                CHECK(segmentsOf(*EdgesGeometry::create(*source, threshold), true) == referenceEdges(*source, threshold));
+            }
+
+            CHECK(segmentsOf(*WireframeGeometry::create(*source), false) == referenceWireframe(*source));
+        }
+    }
+
+    // A box has its 12 creases and nothing else, indexed or not: 4 edges
+    // each of 2, 3 and 4 segments, 2 points a segment.
+    const auto box = BoxGeometry::create(1, 2, 3, 2, 3, 4);
+    CHECK(EdgesGeometry::create(*box, 45)->getAttribute<float>("position")->count() == 4 * (2 + 3 + 4) * 2);
+    CHECK(EdgesGeometry::create(*box->toNonIndexed(), 45)->getAttribute<float>("position")->count() == 4 * (2 + 3 + 4) * 2);
+}
+
 // Vertex/index counts for the parametric generators, pinned against the
 // documented three.js formulas so a segment-loop off-by-one is caught rather
 // than silently changing tessellation.
@@ -4,6 +4,7 @@
 #include "threepp/loaders/EXRLoader.hpp"
 #include "threepp/textures/Texture.hpp"
 #include "threepp/utils/Base64.hpp"
+#include "threepp/utils/ThreadPool.hpp"
 
 #include <algorithm>
 #include <cstdint>
@@ -316,6 +317,54 @@ TEST_CASE("EXRLoader ZIPS and RLE decode bit-identically to the uncompressed enc
     }
 }
 
+TEST_CASE("EXRLoader decodes chunks in parallel exactly as it does serially") {
+
+    // 300 single-line ZIPS blocks and 19 ZIP ones: several pieces each.
+    for (int compression : {ZIPS, ZIP}) {
+        const auto file = buildExr(gradientSpec(compression, 24, 300));
+
+        EXRLoader loader;
+        std::shared_ptr<Texture> serial;
+        {
+            ThreadPool::SerialScope scope;
+            serial = loader.loadFromMemory(file, "serial");
+        }
+        auto parallel = loader.loadFromMemory(file, "parallel");
+        REQUIRE(serial != nullptr);
+        REQUIRE(parallel != nullptr);
+
+        CHECK(pixels(parallel) == pixels(serial));
+        CHECK(pixels(parallel)[(299 * 24 + 5) * 4] == 6.f);// flipped: file row 0 is the last row
+    }
+}
+
+TEST_CASE("EXRLoader halfFloat keeps the file's half bits") {
+
+    const auto file = buildExr(gradientSpec(ZIP, 16, 40));
+
+    EXRLoader loader;
+    auto wide = loader.loadFromMemory(file, "float", false);
+    loader.halfFloat = true;
+    auto half = loader.loadFromMemory(file, "half", false);
+    REQUIRE(wide != nullptr);
+    REQUIRE(half != nullptr);
+
+    CHECK(half->image().isHalfFloat());
+    CHECK(half->type == Type::HalfFloat);
+    CHECK(half->format == Format::RGBA);
+    CHECK(half->image().byteSize() * 2 == wide->image().byteSize());
+
+    const auto& h = half->image().data<std::uint16_t>();
+    const auto& f = pixels(wide);
+    REQUIRE(h.size() == f.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < h.size(); ++i) {
+        if (h[i] != toHalf(f[i])) ++mismatches;
+    }
+    CHECK(mismatches == 0);
+    CHECK(h[3] == 0x3C00);// alpha 1.0, the file has no A channel
+}
+
 TEST_CASE("EXRLoader converts half bit patterns exactly") {
 
     // Hand-written halves, including the cases the fixture converter refuses:
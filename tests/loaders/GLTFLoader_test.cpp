@@ -8,11 +8,24 @@
 #include "threepp/materials/MeshStandardMaterial.hpp"
 #include "threepp/objects/Mesh.hpp"
 
+#include "external/meshoptimizer/meshoptimizer.h"
+
+#ifdef THREEPP_WITH_DRACO
+#include "draco/compression/encode.h"
+#include "draco/mesh/triangle_soup_mesh_builder.h"
+#endif
+
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -548,3 +561,408 @@ TEST_CASE("GLTFLoader widens COLOR_0 when preserveNarrowAttributes is off") {
     CHECK(colWide->array()[0] == 1.f);
     CHECK(colWide->array()[4] == 1.f);
 }
+
+// Images are decoded up front, in parallel, and handed to the textures that
+// use them: one image behind two textures, one texture in two colour spaces,
+// and an image file next to the .glb must all bind the same pixels however
+// many decodes are in flight.
+TEST_CASE("GLTFLoader binds predecoded images to every texture that uses them") {
+    Bin bin;
+    size_t posOff = bin.put<float>({0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f});
+    size_t uvOff = bin.put<float>({0.f, 0.f, 1.f, 0.f, 0.f, 1.f});
+    size_t idxOff = bin.put<uint16_t>({0, 1, 2});
+    size_t pngOff = bin.putBytes(kPng2x2);
+
+    const auto pngPath = fs::temp_directory_path() / "threepp_gltf_test_image.png";
+    {
+        std::ofstream out(pngPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(kPng2x2.data()), static_cast<std::streamsize>(kPng2x2.size()));
+    }
+
+    std::string json = R"({
+      "asset":{"version":"2.0"},
+      "buffers":[{"byteLength":)" + std::to_string(bin.data.size()) + R"(}],
+      "bufferViews":[
+        {"buffer":0,"byteOffset":)" + std::to_string(posOff) + R"(,"byteLength":36},
+        {"buffer":0,"byteOffset":)" + std::to_string(uvOff) + R"(,"byteLength":24},
+        {"buffer":0,"byteOffset":)" + std::to_string(idxOff) + R"(,"byteLength":6},
+        {"buffer":0,"byteOffset":)" + std::to_string(pngOff) + R"(,"byteLength":)" + std::to_string(kPng2x2.size()) + R"(}],
+      "accessors":[
+        {"bufferView":0,"componentType":5126,"count":3,"type":"VEC3"},
+        {"bufferView":1,"componentType":5126,"count":3,"type":"VEC2"},
+        {"bufferView":2,"componentType":5123,"count":3,"type":"SCALAR"}],
+      "images":[{"bufferView":3,"mimeType":"image/png"},{"uri":")" + pngPath.filename().string() + R"("}],
+      "samplers":[{"magFilter":9728,"minFilter":9728},{}],
+      "textures":[{"source":0,"sampler":0},{"source":0,"sampler":1},{"source":1}],
+      "materials":[{
+        "pbrMetallicRoughness":{"baseColorTexture":{"index":0},"metallicRoughnessTexture":{"index":1}},
+        "normalTexture":{"index":0},
+        "emissiveTexture":{"index":2}}],
+      "meshes":[{"primitives":[{"attributes":{"POSITION":0,"TEXCOORD_0":1},"indices":2,"material":0}]}],
+      "nodes":[{"mesh":0}],
+      "scenes":[{"nodes":[0]}]
+    })";
+
+    auto path = writeTempGlb(makeGlb(json, bin.data));
+
+    for (unsigned inFlight : {1u, 0u}) {
+        GLTFLoader loader;
+        loader.maxImagesInFlight = inFlight;
+        auto res = loader.load(path);
+        REQUIRE(res);
+        auto* mesh = firstMesh(res->scene.get());
+        REQUIRE(mesh);
+        auto mat = std::dynamic_pointer_cast<MeshStandardMaterial>(mesh->material());
+        REQUIRE(mat);
+
+        for (const auto& map : {mat->map, mat->metalnessMap, mat->roughnessMap, mat->normalMap, mat->emissiveMap}) {
+            REQUIRE(map);
+            CHECK(map->image().width() == 2);
+            CHECK(map->image().data() == mat->map->image().data());
+        }
+        CHECK(mat->map->colorSpace != mat->normalMap->colorSpace);
+        CHECK(mat->map->magFilter == Filter::Nearest);
+        CHECK(mat->metalnessMap->magFilter == Filter::Linear);
+        // Embedded images keep their encoded bytes; a file keeps its file.
+        CHECK_FALSE(mat->map->encodedSource.empty());
+        CHECK_FALSE(mat->metalnessMap->encodedSource.empty());
+        CHECK(mat->emissiveMap->encodedSource.empty());
+    }
+
+    fs::remove(path);
+    fs::remove(pngPath);
+}
+
+TEST_CASE("GLTFLoader loads from memory through a resolver") {
+    Bin bin;
+    size_t posOff = bin.put<float>({0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 3.f, 0.f});
+    size_t idxOff = bin.put<uint16_t>({0, 1, 2});
+
+    const std::string body = R"(
+      "bufferViews":[
+        {"buffer":0,"byteOffset":)" + std::to_string(posOff) + R"(,"byteLength":36},
+        {"buffer":0,"byteOffset":)" + std::to_string(idxOff) + R"(,"byteLength":6}],
+      "accessors":[
+        {"bufferView":0,"componentType":5126,"count":3,"type":"VEC3"},
+        {"bufferView":1,"componentType":5123,"count":3,"type":"SCALAR"}],
+      "meshes":[{"primitives":[{"attributes":{"POSITION":0},"indices":1}]}],
+      "nodes":[{"mesh":0}],
+      "scenes":[{"nodes":[0]}]
+    })";
+    const auto byteLength = std::to_string(bin.data.size());
+
+    auto requireTriangle = [](const std::optional<GLTFResult>& res) {
+        REQUIRE(res);
+        auto* mesh = firstMesh(res->scene.get());
+        REQUIRE(mesh);
+        const auto& a = mesh->geometry()->getAttribute<float>("position")->array();
+        CHECK(a[3] == 2.f);
+        CHECK(a[7] == 3.f);
+        CHECK(mesh->geometry()->getIndex()->count() == 3);
+    };
+
+    GLTFLoader loader;
+
+    SECTION("a .glb, told apart by its magic") {
+        const auto glb = makeGlb(R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":)" + byteLength + "}]," + body, bin.data);
+        requireTriangle(loader.load(std::as_bytes(std::span(glb))));
+    }
+
+    SECTION("a .gltf with its buffer elsewhere") {
+        const std::string json = R"({"asset":{"version":"2.0"},"buffers":[{"uri":"tri%20angle.bin","byteLength":)" + byteLength + "}]," + body;
+        const auto bytes = std::as_bytes(std::span(json));
+
+        std::vector<std::string> asked;
+        requireTriangle(loader.load(bytes, [&](const std::string& uri) -> std::optional<std::span<const std::byte>> {
+            asked.push_back(uri);
+            if (uri != "tri angle.bin") return std::nullopt;
+            return std::as_bytes(std::span(bin.data));
+        }));
+        CHECK(asked == std::vector<std::string>{"tri angle.bin"});
+
+        // Nothing to resolve it with.
+        CHECK_FALSE(loader.load(bytes).has_value());
+        CHECK_FALSE(loader.load(bytes, [](const std::string&) { return std::optional<std::span<const std::byte>>(); }).has_value());
+    }
+
+    SECTION("a .gltf and its .bin on disk, mapped") {
+        const auto dir = fs::temp_directory_path() / ("threepp_gltf_test_" + std::to_string(g_counter++));
+        fs::create_directories(dir);
+        {
+            std::ofstream out(dir / "tri angle.bin", std::ios::binary);
+            out.write(reinterpret_cast<const char*>(bin.data.data()), static_cast<std::streamsize>(bin.data.size()));
+            std::ofstream(dir / "model.gltf") << R"({"asset":{"version":"2.0"},"buffers":[{"uri":"tri%20angle.bin","byteLength":)" + byteLength + "}]," + body;
+        }
+        const auto res = loader.load(dir / "model.gltf");
+        fs::remove_all(dir);
+        requireTriangle(res);
+    }
+}
+
+TEST_CASE("GLTFLoader decodes meshopt bufferViews shared by several meshes") {
+    // A quad: 4 positions and 6 indices, each in its own compressed
+    // bufferView, referenced by two meshes on two nodes.
+    const std::vector<float> positions{0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0};
+    const std::vector<unsigned int> indices{0, 1, 2, 0, 2, 3};
+
+    std::vector<uint8_t> vertexStream(meshopt_encodeVertexBufferBound(4, 12));
+    vertexStream.resize(meshopt_encodeVertexBuffer(vertexStream.data(), vertexStream.size(), positions.data(), 4, 12));
+    std::vector<uint8_t> indexStream(meshopt_encodeIndexBufferBound(6, 4));
+    indexStream.resize(meshopt_encodeIndexBuffer(indexStream.data(), indexStream.size(), indices.data(), 6));
+
+    Bin bin;
+    const size_t vOff = bin.putBytes(vertexStream);
+    const size_t iOff = bin.putBytes(indexStream);
+
+    auto meshopt = [&](size_t off, size_t len, int stride, int count, const char* mode) {
+        return R"({"buffer":0,"byteLength":)" + std::to_string(count * stride) +
+               R"(,"byteStride":)" + std::to_string(stride) +
+               R"(,"extensions":{"EXT_meshopt_compression":{"buffer":0,"byteOffset":)" + std::to_string(off) +
+               R"(,"byteLength":)" + std::to_string(len) + R"(,"byteStride":)" + std::to_string(stride) +
+               R"(,"count":)" + std::to_string(count) + R"(,"mode":")" + mode + R"("}}})";
+    };
+
+    const std::string json = R"({
+      "asset":{"version":"2.0"},
+      "extensionsUsed":["EXT_meshopt_compression"],
+      "buffers":[{"byteLength":)" + std::to_string(bin.data.size()) + R"(}],
+      "bufferViews":[)" + meshopt(vOff, vertexStream.size(), 12, 4, "ATTRIBUTES") + "," +
+                             meshopt(iOff, indexStream.size(), 4, 6, "TRIANGLES") + R"(],
+      "accessors":[
+        {"bufferView":0,"componentType":5126,"count":4,"type":"VEC3"},
+        {"bufferView":1,"componentType":5125,"count":6,"type":"SCALAR"}],
+      "meshes":[
+        {"primitives":[{"attributes":{"POSITION":0},"indices":1}]},
+        {"primitives":[{"attributes":{"POSITION":0},"indices":1}]}],
+      "nodes":[{"mesh":0},{"mesh":1,"translation":[2,0,0]}],
+      "scenes":[{"nodes":[0,1]}]
+    })";
+
+    const auto glb = makeGlb(json, bin.data);
+    GLTFLoader loader;
+    GLTFLoader::LoadStats stats;
+    const auto res = loader.load(std::as_bytes(std::span(glb)), {}, stats);
+    REQUIRE(res);
+
+    std::vector<Mesh*> meshes;
+    collectMeshes(res->scene.get(), meshes);
+    REQUIRE(meshes.size() == 2);
+    REQUIRE(meshes[0]->geometry() != meshes[1]->geometry());
+    for (auto* mesh : meshes) {
+        CHECK(mesh->geometry()->getAttribute<float>("position")->array() == positions);
+        CHECK(mesh->geometry()->getIndex()->array() == std::vector<unsigned int>(indices.begin(), indices.end()));
+    }
+
+    // Each view decoded once, and let go after the second mesh read it.
+    CHECK(stats.meshoptViewsDecoded == 2);
+    CHECK(stats.meshoptViewsHeld == 0);
+}
+
+namespace {
+
+    // A triangle whose primitive carries KHR_draco_mesh_compression next to
+    // plain accessors: `fallback` gives those accessors bufferViews of their
+    // own, `required` lists the extension in extensionsRequired. The Draco
+    // bufferView holds no valid stream — only builds without Draco read it.
+    std::vector<uint8_t> dracoTriangleGlb(bool fallback, bool required) {
+        Bin bin;
+        const size_t posOff = bin.put<float>({0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 3.f, 0.f});
+        const size_t idxOff = bin.put<uint16_t>({0, 1, 2});
+        const size_t dracoOff = bin.put<uint8_t>({'n', 'o', 't', ' ', 'd', 'r', 'a', 'c', 'o'});
+
+        const auto view = [&](int index) {
+            return fallback ? R"("bufferView":)" + std::to_string(index) + "," : std::string();
+        };
+        return makeGlb(R"({
+          "asset":{"version":"2.0"},
+          "extensionsUsed":["KHR_draco_mesh_compression"],)" +
+                               std::string(required ? R"("extensionsRequired":["KHR_draco_mesh_compression"],)" : "") + R"(
+          "buffers":[{"byteLength":)" + std::to_string(bin.data.size()) + R"(}],
+          "bufferViews":[
+            {"buffer":0,"byteOffset":)" + std::to_string(posOff) + R"(,"byteLength":36},
+            {"buffer":0,"byteOffset":)" + std::to_string(idxOff) + R"(,"byteLength":6},
+            {"buffer":0,"byteOffset":)" + std::to_string(dracoOff) + R"(,"byteLength":9}],
+          "accessors":[
+            {)" + view(0) + R"("componentType":5126,"count":3,"type":"VEC3"},
+            {)" + view(1) + R"("componentType":5123,"count":3,"type":"SCALAR"}],
+          "meshes":[{"primitives":[{"attributes":{"POSITION":0},"indices":1,
+            "extensions":{"KHR_draco_mesh_compression":{"bufferView":2,"attributes":{"POSITION":0}}}}]}],
+          "nodes":[{"mesh":0}],
+          "scenes":[{"nodes":[0]}]
+        })",
+                       bin.data);
+    }
+
+    // What load() reports on std::cerr when it fails.
+    std::string loadError(const std::vector<uint8_t>& glb) {
+        std::ostringstream captured;
+        auto* previous = std::cerr.rdbuf(captured.rdbuf());
+        const auto res = GLTFLoader().load(std::as_bytes(std::span(glb)));
+        std::cerr.rdbuf(previous);
+        return res ? std::string() : captured.str();
+    }
+
+}// namespace
+
+#ifndef THREEPP_WITH_DRACO
+
+TEST_CASE("GLTFLoader reads the fallback accessors of an optional Draco primitive") {
+    const auto glb = dracoTriangleGlb(true, false);
+    GLTFLoader loader;
+    GLTFLoader::LoadStats stats;
+    const auto res = loader.load(std::as_bytes(std::span(glb)), {}, stats);
+    REQUIRE(res);
+
+    auto* mesh = firstMesh(res->scene.get());
+    REQUIRE(mesh);
+    CHECK(mesh->geometry()->getAttribute<float>("position")->array() ==
+          std::vector<float>{0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 3.f, 0.f});
+    CHECK(mesh->geometry()->getIndex()->array() == std::vector<unsigned int>{0, 1, 2});
+    CHECK(stats.dracoPrimitivesDecoded == 0);
+}
+
+TEST_CASE("GLTFLoader names the build option when a file needs Draco") {
+    SECTION("listed in extensionsRequired") {
+        const auto error = loadError(dracoTriangleGlb(true, true));
+        CHECK(error.find("KHR_draco_mesh_compression is required by this file") != std::string::npos);
+        CHECK(error.find("THREEPP_WITH_DRACO") != std::string::npos);
+    }
+    SECTION("optional, but with nothing to fall back on") {
+        const auto error = loadError(dracoTriangleGlb(false, false));
+        CHECK(error.find("has no uncompressed fallback") != std::string::npos);
+        CHECK(error.find("THREEPP_WITH_DRACO") != std::string::npos);
+    }
+}
+
+#else
+
+TEST_CASE("GLTFLoader decodes a Draco primitive like its uncompressed twin") {
+    // A 4x4-quad grid with float positions and uvs and normalized uint8
+    // colours, written twice into one buffer: plain, and as an edgebreaker
+    // Draco stream (which renumbers the points). The same document is loaded
+    // with and without the extension on its primitive, and both have to come
+    // out as the same triangles, corner for corner.
+    constexpr int cells = 4;
+    std::vector<float> positions, uvs;
+    std::vector<uint8_t> colors;
+    std::vector<uint16_t> indices;
+    for (int y = 0; y <= cells; ++y) {
+        for (int x = 0; x <= cells; ++x) {
+            positions.insert(positions.end(), {float(x), float(y), 0.25f * float(x * y)});
+            uvs.insert(uvs.end(), {float(x) / cells, float(y) / cells});
+            colors.insert(colors.end(), {uint8_t(x * 60), uint8_t(y * 60), uint8_t(255 - x * y * 15), 255});
+        }
+    }
+    for (int y = 0; y < cells; ++y) {
+        for (int x = 0; x < cells; ++x) {
+            const auto a = uint16_t(y * (cells + 1) + x), b = uint16_t(a + 1), c = uint16_t(a + cells + 1), d = uint16_t(c + 1);
+            indices.insert(indices.end(), {a, b, d, a, d, c});
+        }
+    }
+    const auto points = positions.size() / 3;
+    const auto faces = indices.size() / 3;
+
+    draco::TriangleSoupMeshBuilder builder;
+    builder.Start(static_cast<int>(faces));
+    const int pos = builder.AddAttribute(draco::GeometryAttribute::POSITION, 3, draco::DT_FLOAT32);
+    const int uv = builder.AddAttribute(draco::GeometryAttribute::TEX_COORD, 2, draco::DT_FLOAT32);
+    const int color = builder.AddAttribute(draco::GeometryAttribute::COLOR, 4, draco::DT_UINT8);
+    for (size_t f = 0; f < faces; ++f) {
+        const auto i = &indices[f * 3];
+        const draco::FaceIndex face(static_cast<uint32_t>(f));
+        builder.SetAttributeValuesForFace(pos, face, &positions[i[0] * 3], &positions[i[1] * 3], &positions[i[2] * 3]);
+        builder.SetAttributeValuesForFace(uv, face, &uvs[i[0] * 2], &uvs[i[1] * 2], &uvs[i[2] * 2]);
+        builder.SetAttributeValuesForFace(color, face, &colors[i[0] * 4], &colors[i[1] * 4], &colors[i[2] * 4]);
+    }
+    const auto dracoMesh = builder.Finalize();
+    REQUIRE(dracoMesh);
+
+    draco::Encoder encoder;
+    encoder.SetEncodingMethod(draco::MESH_EDGEBREAKER_ENCODING);
+    draco::EncoderBuffer encoded;
+    REQUIRE(encoder.EncodeMeshToBuffer(*dracoMesh, &encoded).ok());
+    const auto uniqueId = [&](int attribute) { return std::to_string(dracoMesh->attribute(attribute)->unique_id()); };
+
+    const auto bytes = [](const void* data, size_t size) {
+        const auto* first = static_cast<const uint8_t*>(data);
+        return std::vector<uint8_t>(first, first + size);
+    };
+    Bin bin;
+    const size_t posOff = bin.putBytes(bytes(positions.data(), positions.size() * 4));
+    const size_t uvOff = bin.putBytes(bytes(uvs.data(), uvs.size() * 4));
+    const size_t colorOff = bin.putBytes(colors);
+    const size_t idxOff = bin.putBytes(bytes(indices.data(), indices.size() * 2));
+    const size_t dracoOff = bin.putBytes(bytes(encoded.data(), encoded.size()));
+
+    const auto document = [&](bool draco) {
+        const auto view = [](size_t off, size_t len) {
+            return R"({"buffer":0,"byteOffset":)" + std::to_string(off) + R"(,"byteLength":)" + std::to_string(len) + "}";
+        };
+        const auto n = std::to_string(points);
+        return makeGlb(R"({
+          "asset":{"version":"2.0"},)" +
+                               std::string(draco ? R"("extensionsUsed":["KHR_draco_mesh_compression"],"extensionsRequired":["KHR_draco_mesh_compression"],)" : "") + R"(
+          "buffers":[{"byteLength":)" + std::to_string(bin.data.size()) + R"(}],
+          "bufferViews":[)" + view(posOff, positions.size() * 4) + "," + view(uvOff, uvs.size() * 4) + "," +
+                                       view(colorOff, colors.size()) + "," + view(idxOff, indices.size() * 2) + "," +
+                                       view(dracoOff, encoded.size()) + R"(],
+          "accessors":[
+            {"bufferView":0,"componentType":5126,"count":)" + n + R"(,"type":"VEC3"},
+            {"bufferView":1,"componentType":5126,"count":)" + n + R"(,"type":"VEC2"},
+            {"bufferView":2,"componentType":5121,"normalized":true,"count":)" + n + R"(,"type":"VEC4"},
+            {"bufferView":3,"componentType":5123,"count":)" + std::to_string(indices.size()) + R"(,"type":"SCALAR"}],
+          "meshes":[{"primitives":[{"attributes":{"POSITION":0,"TEXCOORD_0":1,"COLOR_0":2},"indices":3)" +
+                               std::string(draco ? R"(,"extensions":{"KHR_draco_mesh_compression":{"bufferView":4,"attributes":{"POSITION":)" +
+                                                           uniqueId(pos) + R"(,"TEXCOORD_0":)" + uniqueId(uv) + R"(,"COLOR_0":)" + uniqueId(color) + "}}}"
+                                             : "") + R"(}]}],
+          "nodes":[{"mesh":0}],
+          "scenes":[{"nodes":[0]}]
+        })",
+                       bin.data);
+    };
+
+    // Every triangle as its corners' attribute values, starting from the
+    // smallest corner so a rotated triangle compares equal.
+    const auto triangles = [](const GLTFResult& res) {
+        const auto geometry = firstMesh(res.scene.get())->geometry();
+        const auto* index = geometry->getIndex();
+        const std::array<FloatAttributeView, 3> views{FloatAttributeView(geometry->getAttribute("position")),
+                                                      FloatAttributeView(geometry->getAttribute("uv")),
+                                                      FloatAttributeView(geometry->getAttribute("color"))};
+        std::vector<std::vector<float>> out;
+        for (int f = 0; f < index->count() / 3; ++f) {
+            std::array<std::vector<float>, 3> corners;
+            for (int k = 0; k < 3; ++k) {
+                const auto v = static_cast<size_t>(index->getX(f * 3 + k));
+                for (const auto& view : views) {
+                    const auto n = static_cast<size_t>(view.itemSize());
+                    corners[k].insert(corners[k].end(), view.data() + v * n, view.data() + (v + 1) * n);
+                }
+            }
+            const auto first = std::min_element(corners.begin(), corners.end()) - corners.begin();
+            std::vector<float> triangle;
+            for (int k = 0; k < 3; ++k) {
+                const auto& corner = corners[(first + k) % 3];
+                triangle.insert(triangle.end(), corner.begin(), corner.end());
+            }
+            out.push_back(std::move(triangle));
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+
+    GLTFLoader loader;
+    const auto plainGlb = document(false);
+    const auto plain = loader.load(std::as_bytes(std::span(plainGlb)));
+    const auto dracoGlb = document(true);
+    GLTFLoader::LoadStats stats;
+    const auto compressed = loader.load(std::as_bytes(std::span(dracoGlb)), {}, stats);
+    REQUIRE(plain);
+    REQUIRE(compressed);
+
+    CHECK(stats.dracoPrimitivesDecoded == 1);
+    CHECK(stats.dracoAccessorsHeld == 0);
+    CHECK(triangles(*compressed) == triangles(*plain));
+}
+
+#endif
@@ -0,0 +1,162 @@
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "threepp/loaders/LoaderService.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    // Holds the service's only worker inside a load until opened, so the
+    // requests behind it pile up in the queues.
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool open = false;
+        bool entered = false;
+
+        std::shared_ptr<Group> block() {
+            std::unique_lock lock(mutex);
+            entered = true;
+            cv.notify_all();
+            cv.wait(lock, [&] { return open; });
+            return Group::create();
+        }
+
+        void waitEntered() {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return entered; });
+        }
+
+        void release() {
+            std::lock_guard lock(mutex);
+            open = true;
+            cv.notify_all();
+        }
+    };
+
+}// namespace
+
+TEST_CASE("LoaderService runs visible requests first") {
+
+    LoaderService service(1);
+    Gate gate;
+    auto blocker = service.load([&] { return gate.block(); });
+    gate.waitEntered();
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](std::string name) {
+        return [&, name] {
+            std::lock_guard lock(mutex);
+            order.push_back(name);
+            return Group::create();
+        };
+    };
+
+    auto a = service.load(record("background"), LoaderService::Priority::Background);
+    auto b = service.load(record("normal"), LoaderService::Priority::Normal);
+    auto c = service.load(record("visible"), LoaderService::Priority::Visible);
+    auto d = service.load(record("normal 2"), LoaderService::Priority::Normal);
+
+    gate.release();
+    service.waitIdle();
+
+    CHECK(order == std::vector<std::string>{"visible", "normal", "normal 2", "background"});
+
+    const auto stats = service.stats();
+    CHECK(stats.submitted == 5);
+    CHECK(stats.completed == 5);
+    CHECK(stats.pending == 0);
+    CHECK(stats.running == 0);
+    CHECK(stats.progress() == 1);
+}
+
+TEST_CASE("LoaderService drops requests whose AsyncGroup is gone") {
+
+    LoaderService service(1);
+    Gate gate;
+    auto blocker = service.load([&] { return gate.block(); });
+    gate.waitEntered();
+
+    std::atomic<int> runs{0};
+    auto kept = service.load([&] { ++runs; return Group::create(); });
+    service.load([&] { ++runs; return Group::create(); });// discarded at once
+
+    CHECK(service.stats().pending == 2);
+    gate.release();
+    service.waitIdle();
+
+    CHECK(runs == 1);
+    const auto stats = service.stats();
+    CHECK(stats.cancelled == 1);
+    CHECK(stats.completed == 2);
+
+    kept->updateMatrixWorld();
+    CHECK(kept->isLoaded());
+    CHECK(kept->children.size() == 1);
+}
+
+TEST_CASE("LoaderService loads a key once for every request in flight") {
+
+    LoaderService service(1);
+    Gate gate;
+    auto blocker = service.load([&] { return gate.block(); });
+    gate.waitEntered();
+
+    std::atomic<int> runs{0};
+    auto load = [&] {
+        ++runs;
+        auto group = Group::create();
+        group->add(Group::create());
+        return group;
+    };
+
+    auto normal = service.load(load, LoaderService::Priority::Background, "model.glb", 100);
+    auto other = service.load(load, LoaderService::Priority::Normal, "other.glb", 10);
+    // Joins the first and lifts it ahead of "other.glb".
+    auto visible = service.load(load, LoaderService::Priority::Visible, "model.glb", 100);
+
+    gate.release();
+    service.waitIdle();
+
+    CHECK(runs == 2);
+    const auto stats = service.stats();
+    CHECK(stats.submitted == 3);
+    CHECK(stats.deduplicated == 1);
+    CHECK(stats.completed == 3);
+    CHECK(stats.bytes == 110);
+
+    normal->updateMatrixWorld();
+    visible->updateMatrixWorld();
+    REQUIRE(normal->children.size() == 1);
+    REQUIRE(visible->children.size() == 1);
+    CHECK(normal->children[0] != visible->children[0]);
+    CHECK(normal->children[0]->children.size() == 1);
+    CHECK(visible->children[0]->children.size() == 1);
+
+    // Finished, so asking again loads again.
+    auto again = service.load(load, LoaderService::Priority::Normal, "model.glb");
+    service.waitIdle();
+    CHECK(runs == 3);
+}
+
+TEST_CASE("LoaderService reports a failed load") {
+
+    LoaderService service(2);
+    auto throws = service.load([]() -> std::shared_ptr<Group> { throw std::runtime_error("no"); });
+    auto empty = service.load([]() -> std::shared_ptr<Group> { return nullptr; });
+    service.waitIdle();
+
+    const auto stats = service.stats();
+    CHECK(stats.failed == 2);
+    CHECK(stats.completed == 0);
+    CHECK_FALSE(throws->isLoading());
+    CHECK_FALSE(empty->isLoading());
+}
@@ -0,0 +1,135 @@
+// OBJLoader throughput, in megabytes of OBJ text per second.
+//
+// Not a ctest — run manually. Without a file argument the bench writes a
+// synthetic model to the temp directory: a grid of quads with positions, uvs
+// and normals, split into objects and material groups the way exported
+// scenes are, so every part of the parser (floats, face corners, the
+// per-object state) is in the measurement. The file is read once beforehand
+// so both phases run from the page cache; the serial and pooled results are
+// compared before anything is printed.
+//
+// Phases:
+//   serial  — OBJLoader::load inside a ThreadPool::SerialScope
+//   pooled  — OBJLoader::load on the shared pool
+//
+// Usage: OBJLoader_bench [megabytes]      (default 100, synthetic)
+//        OBJLoader_bench <model.obj>
+
+#include "threepp/core/BufferGeometry.hpp"
+#include "threepp/loaders/OBJLoader.hpp"
+#include "threepp/utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    template<class F>
+    double medianMs(int reps, F&& fn) {
+        std::vector<double> samples;
+        for (int i = 0; i < reps; ++i) {
+            const auto t0 = Clock::now();
+            fn();
+            samples.push_back(msSince(t0));
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    // Rows of `columns` quads until the file reaches about `bytes`; a new
+    // object every 64 rows and a new material every 16.
+    void writeGrid(const std::filesystem::path& path, std::size_t bytes) {
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        constexpr int columns = 256;
+        char line[128];
+
+        for (int row = 0; static_cast<std::size_t>(out.tellp()) < bytes; ++row) {
+
+            if (row % 64 == 0) out << "o part" << row / 64 << "\n";
+            if (row % 16 == 0) out << "usemtl material" << (row / 16) % 5 << "\n";
+
+            for (int c = 0; c <= columns; ++c) {
+                for (int r = 0; r < 2; ++r) {
+                    std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+                                  c * 0.01, (row + r) * 0.01, 0.001 * ((c * 7 + row) % 13),
+                                  c / double(columns), (row + r) / 1024.0, 0.0, 0.0, 1.0);
+                    out << line;
+                }
+            }
+            // Relative indices: each quad refers back into its own row.
+            for (int c = 0; c < columns; ++c) {
+                const int a = -(columns + 1 - c) * 2, b = a + 1, d = a + 2, e = a + 3;
+                std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                              a, a, a, d, d, d, e, e, e, b, b, b);
+                out << line;
+            }
+        }
+    }
+
+    std::vector<float> positions(const std::shared_ptr<Group>& group) {
+
+        std::vector<float> all;
+        for (const auto* child : group->children) {
+            const auto& array = child->geometry()->getAttribute<float>("position")->array();
+            all.insert(all.end(), array.begin(), array.end());
+        }
+        return all;
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+
+    std::filesystem::path path;
+    bool synthetic = false;
+    if (argc > 1 && std::filesystem::is_regular_file(argv[1])) {
+        path = argv[1];
+    } else {
+        const std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100;
+        path = std::filesystem::temp_directory_path() / "threepp_OBJLoader_bench.obj";
+        writeGrid(path, megabytes << 20);
+        synthetic = true;
+    }
+
+    const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1 << 20);
+    std::printf("OBJLoader_bench  %.1f MB  lanes=%u\n", megabytes, ThreadPool::global().concurrency());
+
+    OBJLoader loader;
+    loader.useCache = false;
+
+    std::shared_ptr<Group> serial, pooled;
+    loader.load(path, false);
+    const double serialMs = medianMs(3, [&] {
+        ThreadPool::SerialScope scope;
+        serial = loader.load(path, false);
+    });
+    const double pooledMs = medianMs(3, [&] { pooled = loader.load(path, false); });
+
+    if (synthetic) std::filesystem::remove(path);
+
+    if (!serial || !pooled || positions(serial) != positions(pooled)) {
+        std::printf("serial and pooled results differ\n");
+        return 1;
+    }
+
+    std::printf("meshes   %zu, %zu floats of position\n", pooled->children.size(), positions(pooled).size());
+    std::printf("serial   %9.2f ms   %8.1f MB/s\n", serialMs, megabytes / serialMs * 1000);
+    std::printf("pooled   %9.2f ms   %8.1f MB/s\n", pooledMs, megabytes / pooledMs * 1000);
+
+    return 0;
+}
@@ -2,10 +2,13 @@
 
 #include "threepp/loaders/OBJLoader.hpp"
 #include "threepp/objects/Mesh.hpp"
+#include "threepp/utils/ThreadPool.hpp"
 
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace threepp;
 
@@ -218,3 +221,89 @@ TEST_CASE("OBJLoader resolves negative face indices relative to the end") {
     };
     CHECK(posOf(relative) == posOf(absolute));
 }
+
+// The file is parsed in ~1 MB chunks, in parallel, and merged in order. A
+// model several chunks long must come out exactly as the text says — relative
+// indices reaching back across a chunk boundary included — and the same with
+// the pool as without it.
+TEST_CASE("OBJLoader parses multi-chunk files in order") {
+
+    constexpr int rows = 20000;
+    std::ostringstream obj;
+    obj << "usemtl first\n";
+    for (int row = 0; row < rows; ++row) {
+        if (row == rows / 2) obj << "usemtl second\n";
+        obj << "v " << row << " 0.5 -" << row << "\n"
+            << "v " << row << " 1.5 -" << row << "\n"
+            << "v " << row << " 2.5 -" << row << "\n"
+            << "# a comment long enough to push the file past a few chunks, "
+            << "so that the row pattern straddles every boundary somewhere\n";
+        // Every other face reaches back with relative indices.
+        if (row % 2) {
+            obj << "f -3 -2 -1\n";
+        } else {
+            obj << "f " << row * 3 + 1 << " " << row * 3 + 2 << " " << row * 3 + 3 << "\n";
+        }
+    }
+    const auto text = obj.str();
+    REQUIRE(text.size() > 3 * (1 << 20));
+
+    auto path = writeTempFile("threepp_multi_chunk.obj", text);
+    OBJLoader loader;
+    loader.useCache = false;
+
+    auto group = loader.load(path, false);
+    std::shared_ptr<Group> serial;
+    {
+        ThreadPool::SerialScope scope;
+        serial = loader.load(path, false);
+    }
+    std::filesystem::remove(path);
+
+    REQUIRE(positionCount(group) == rows * 3);
+    const auto& position = group->children.front()->as<Mesh>()->geometry()->getAttribute<float>("position")->array();
+    for (int row = 0; row < rows; ++row) {
+        for (int k = 0; k < 3; ++k) {
+            const auto* p = &position[(row * 3 + k) * 3];
+            REQUIRE(p[0] == static_cast<float>(row));
+            REQUIRE(p[1] == 0.5f + static_cast<float>(k));
+            REQUIRE(p[2] == -static_cast<float>(row));
+        }
+    }
+
+    const auto& groups = group->children.front()->as<Mesh>()->geometry()->groups;
+    REQUIRE(groups.size() == 2);
+    CHECK(groups[0].start == 0);
+    CHECK(groups[0].count == rows / 2 * 3);
+    CHECK(groups[1].start == rows / 2 * 3);
+    CHECK(groups[1].count == rows / 2 * 3);
+
+    REQUIRE(positionCount(serial) == rows * 3);
+    CHECK(serial->children.front()->as<Mesh>()->geometry()->getAttribute<float>("position")->array() == position);
+}
+
+TEST_CASE("OBJLoader accepts CRLF, tabs, runs of spaces and a missing final newline") {
+
+    auto tidy = loadObj("threepp_tidy.obj",
+                        "v 0.0 0.0 0.0\n"
+                        "v 1.0 0.0 0.0\n"
+                        "v 0.0 1.0 0.0\n"
+                        "vt 0.5 0.5\n"
+                        "f 1/1 2/1 3/1\n");
+    auto messy = loadObj("threepp_messy.obj",
+                         "v\t0.0  0.0 +0.0\r\n"
+                         "  v 1.0 0.0 0.0\r\n"
+                         "v 0.0   1.0\t0.0   \r\n"
+                         "vt 0.5 0.5\r\n"
+                         "\r\n"
+                         "f  1/1\t2/1   3/1");
+
+    REQUIRE(positionCount(tidy) == 3);
+    REQUIRE(positionCount(messy) == 3);
+
+    auto attribute = [](const std::shared_ptr<Group>& g, const std::string& name) {
+        return g->children.front()->as<Mesh>()->geometry()->getAttribute<float>(name)->array();
+    };
+    CHECK(attribute(messy, "position") == attribute(tidy, "position"));
+    CHECK(attribute(messy, "uv") == attribute(tidy, "uv"));
+}
@@ -1266,6 +1266,145 @@ TEST_CASE("three.js typed-array names map onto threepp attribute types") {
 }
 
 
+TEST_CASE("Geometry arrays parse the same whatever order their entry's keys are in") {
+
+    ObjectLoader loader;
+
+    SECTION("a type written after its array") {
+
+        const std::string text = R"({
+            "metadata": { "version": 4.5, "type": "Object" },
+            "geometries": [ { "uuid": "G", "type": "BufferGeometry", "data": {
+                "attributes": {
+                    "position": { "array": [0,0,0, 1,0,0, 1,1,0], "itemSize": 3, "type": "Float32Array" },
+                    "custom": { "array": [4000000000, 1], "itemSize": 1, "type": "Uint32Array" },
+                    "signed": { "array": [-5, 7], "itemSize": 1, "type": "Int32Array" } },
+                "morphAttributes": { "position": [
+                    { "array": [0,0.5,0, 0,0,0, 0,0,0], "itemSize": 3, "type": "Float32Array" } ] },
+                "index": { "array": [0,1,2], "type": "Uint16Array" } } } ],
+            "materials": [ { "uuid": "M", "type": "MeshStandardMaterial" } ],
+            "object": {
+                "uuid": "ROOT", "type": "Mesh", "layers": 1,
+                "matrix": [1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1],
+                "geometry": "G", "material": "M"
+            }
+        })";
+
+        auto parsed = loader.parse(text);
+        REQUIRE(parsed != nullptr);
+
+        const auto geometry = parsed->geometry();
+        CHECK(storedArray<float>(geometry->getAttribute("position")) ==
+              std::vector<float>{0, 0, 0, 1, 0, 0, 1, 1, 0});
+        // Above 2^24: held as a double until the type was known, not as a float.
+        CHECK(storedArray<unsigned int>(geometry->getAttribute("custom")) ==
+              std::vector<unsigned int>{4000000000u, 1});
+        CHECK(storedArray<float>(geometry->getAttribute("signed")) == std::vector<float>{-5, 7});
+
+        const auto& morph = geometry->getMorphAttributes().at("position");
+        REQUIRE(morph.size() == 1);
+        CHECK(storedArray<float>(morph.front().get())[1] == 0.5f);
+
+        REQUIRE(geometry->hasIndex());
+        CHECK(geometry->getIndex()->array() == std::vector<unsigned int>{0, 1, 2});
+    }
+
+    SECTION("an \"array\" outside the geometry data is left to its owner") {
+
+        const std::string text = R"({
+            "metadata": { "version": 4.5, "type": "Object" },
+            "geometries": [ { "uuid": "G", "type": "BufferGeometry", "data": {
+                "attributes": { "position": { "type": "Float32Array", "array": [0,0,0], "itemSize": 3 } } } } ],
+            "materials": [ { "uuid": "M", "type": "MeshStandardMaterial" } ],
+            "object": {
+                "uuid": "ROOT", "type": "Mesh", "layers": 1,
+                "matrix": [1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1],
+                "geometry": "G", "material": "M",
+                "userData": { "array": [1, 2, 3] }
+            }
+        })";
+
+        auto parsed = loader.parse(text);
+        REQUIRE(parsed != nullptr);
+        // Seen as the array it is, and refused as userData always refuses one.
+        REQUIRE(loader.warnings().size() == 1);
+        CHECK(loader.warnings().front() == "skipping userData entry 'array': unsupported JSON type");
+    }
+
+    SECTION("a repeated key keeps its last value, as json::parse does") {
+
+        const std::string text = R"({
+            "metadata": { "version": 4.5, "type": "Object" },
+            "object": { "uuid": "ROOT", "type": "Group", "name": "first", "layers": 1,
+                        "matrix": [1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1],
+                        "children": [ { "uuid": "C", "type": "Group", "name": "child", "layers": 1,
+                                        "matrix": [1,0,0,0, 0,1,0,0, 0,0,1,0, 2,0,0,1] } ],
+                        "name": "second" }
+        })";
+
+        auto parsed = loader.parse(text);
+        REQUIRE(parsed != nullptr);
+        CHECK(parsed->name == "second");
+        REQUIRE(parsed->children.size() == 1);
+        CHECK(parsed->children.front()->name == "child");
+        CHECK(parsed->children.front()->position.x == 2);
+    }
+
+    SECTION("malformed JSON inside a geometry array is still malformed") {
+
+        CHECK(loader.parse(threejsDocWithAttribute("Float32Array", "[0, 1,, 2]", 1)) == nullptr);
+        REQUIRE(loader.warnings().size() == 1);
+        CHECK(loader.warnings().front() == "malformed JSON");
+    }
+}
+
+
+TEST_CASE("Base64-encoded geometry round-trips bit-exact in a single JSON document") {
+
+    auto geometry = makeCompressibleGeometry();
+    REQUIRE(compressAttributes(*geometry) > 0);
+    auto mesh = Mesh::create(geometry, MeshStandardMaterial::create());
+
+    ObjectExporterOptions options;
+    options.geometry = GeometryEncoding::Base64;
+
+    ObjectExporter exporter;
+    const auto text = exporter.toJson(*mesh, options);
+    CHECK(exporter.warnings().empty());
+
+    const auto document = nlohmann::json::parse(text);
+    REQUIRE(document.contains("threeppBuffers"));
+    const auto data = geometryData(text);
+    CHECK_FALSE(data["attributes"]["position"].contains("array"));
+    CHECK(data["attributes"]["position"]["url"] == "buffers/" + geometry->uuid + ".bin");
+
+    ObjectLoader loader;
+    auto parsed = loader.parse(text);
+    REQUIRE(parsed != nullptr);
+    CHECK(loader.warnings().empty());
+
+    const auto parsedGeometry = parsed->geometry();
+    for (const auto* name : {"position", "normal", "uv", "color"}) {
+        const auto* before = geometry->getAttribute(name);
+        const auto* after = parsedGeometry->getAttribute(name);
+        REQUIRE(after != nullptr);
+        CHECK(after->type() == before->type());
+        CHECK(after->normalized() == before->normalized());
+    }
+    CHECK(storedArray<float>(parsedGeometry->getAttribute("position")) ==
+          storedArray<float>(geometry->getAttribute("position")));
+    CHECK(storedArray<std::int16_t>(parsedGeometry->getAttribute("normal")) ==
+          storedArray<std::int16_t>(geometry->getAttribute("normal")));
+    CHECK(parsedGeometry->getIndex()->array() == geometry->getIndex()->array());
+
+    // And it is the same scene the plain-number document describes.
+    ObjectLoader plain;
+    auto fromNumbers = plain.parse(exporter.toJson(*mesh));
+    REQUIRE(fromNumbers != nullptr);
+    CHECK(storedArray<std::uint8_t>(fromNumbers->geometry()->getAttribute("color")) ==
+          storedArray<std::uint8_t>(parsedGeometry->getAttribute("color")));
+}
+
 TEST_CASE("A REFERENCED image comes back the same way up it went in") {
 
     // The two `url` forms in an `images` entry are two different contracts:
@@ -1,11 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include "threepp/geometries/BoxGeometry.hpp"
 #include "threepp/loaders/STLLoader.hpp"
 
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -31,6 +33,61 @@ namespace {
         buf.insert(buf.end(), tmp, tmp + 4);
     }
 
+    // A unit box as STL, either form: 12 facets over 8 distinct corners.
+    std::vector<float> boxSoup() {
+        const auto box = BoxGeometry::create(1, 1, 1)->toNonIndexed();
+        return box->getAttribute<float>("position")->array();
+    }
+
+    std::vector<char> binaryStl(const std::vector<float>& soup) {
+        std::vector<char> bytes(80, 0);
+        const auto faces = static_cast<uint32_t>(soup.size() / 9);
+        char countBytes[4];
+        std::memcpy(countBytes, &faces, 4);
+        bytes.insert(bytes.end(), countBytes, countBytes + 4);
+        for (uint32_t f = 0; f < faces; ++f) {
+            for (int k = 0; k < 3; ++k) appendFloat(bytes, 0.f);
+            for (int k = 0; k < 9; ++k) appendFloat(bytes, soup[f * 9 + k]);
+            bytes.push_back(0);
+            bytes.push_back(0);
+        }
+        return bytes;
+    }
+
+    std::string asciiStl(const std::vector<float>& soup) {
+        std::ostringstream out;
+        out.precision(9);
+        out << "solid box\n";
+        for (size_t f = 0; f < soup.size() / 9; ++f) {
+            out << "  facet normal 0 0 0\n    outer loop\n";
+            for (int v = 0; v < 3; ++v) {
+                out << "      vertex " << soup[f * 9 + v * 3] << " " << soup[f * 9 + v * 3 + 1] << " " << soup[f * 9 + v * 3 + 2] << "\n";
+            }
+            out << "    endloop\n  endfacet\n";
+        }
+        out << "endsolid box\n";
+        return out.str();
+    }
+
+    // The welded geometry, expanded through its index, against the soup.
+    void requireWelded(const std::shared_ptr<BufferGeometry>& geometry, const std::vector<float>& soup) {
+        REQUIRE(geometry);
+        auto* index = geometry->getIndex();
+        auto* position = geometry->getAttribute<float>("position");
+        REQUIRE(index);
+        REQUIRE(position);
+        CHECK(position->count() == 8);
+        REQUIRE(index->count() * 3 == static_cast<int>(soup.size()));
+        for (int i = 0; i < index->count(); ++i) {
+            const auto v = index->getX(i);
+            REQUIRE(position->getX(v) == soup[i * 3]);
+            REQUIRE(position->getY(v) == soup[i * 3 + 1]);
+            REQUIRE(position->getZ(v) == soup[i * 3 + 2]);
+        }
+        REQUIRE(geometry->getAttribute<float>("normal"));
+        CHECK(geometry->getAttribute<float>("normal")->count() == 8);
+    }
+
 }// namespace
 
 TEST_CASE("STLLoader parses ASCII STL without crashing") {
@@ -107,3 +164,33 @@ TEST_CASE("STLLoader parses binary STL without crashing") {
 
     std::filesystem::remove(path);
 }
+
+TEST_CASE("STLLoader welds shared corners into an indexed geometry") {
+
+    const auto soup = boxSoup();
+    REQUIRE(soup.size() == 12 * 9);
+
+    auto binary = writeTempFile("threepp_box_binary.stl", binaryStl(soup));
+    auto ascii = writeTempFile("threepp_box_ascii.stl", asciiStl(soup));
+
+    STLLoader loader;
+
+    SECTION("unwelded, both forms load the same flat triangles") {
+        auto fromBinary = loader.load(binary);
+        auto fromAscii = loader.load(ascii);
+        REQUIRE(fromBinary);
+        REQUIRE(fromAscii);
+        CHECK_FALSE(fromBinary->hasIndex());
+        CHECK(fromBinary->getAttribute<float>("position")->array() == soup);
+        CHECK(fromAscii->getAttribute<float>("position")->array() == soup);
+    }
+
+    SECTION("welded") {
+        loader.weld = true;
+        requireWelded(loader.load(binary), soup);
+        requireWelded(loader.load(ascii), soup);
+    }
+
+    std::filesystem::remove(binary);
+    std::filesystem::remove(ascii);
+}
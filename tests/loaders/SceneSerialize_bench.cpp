@@ -10,6 +10,9 @@
 //
 //   SceneSerialize_bench "path/to/Bistro.fbx"
 //
+// "embed all, base64" is the same self-contained document with the geometry
+// as base64 sections (GeometryEncoding::Base64) instead of JSON numbers.
+//
 // Phases, per storage mode:
 //   export     — Object3D graph -> JSON text
 //   parse      — JSON text -> Object3D graph (includes re-import when linked)
@@ -18,7 +21,10 @@
 // The archive row is measured against the file rather than against a string,
 // because that is what it is: save() writes a .tpz and load() reads it back.
 // Its JSON counterpart ("embed all, via file") does the same through a .json,
-// so the pair differs in the storage of the numbers and not in the I/O.
+// so the pair differs in the storage of the numbers and not in the I/O. The
+// "resaved" rows save the unchanged scene again over the archive the same
+// exporter just wrote — an autosave with nothing edited — which copies every
+// member out of the previous file instead of encoding it.
 
 #include "threepp/loaders/AssetSource.hpp"
 #include "threepp/loaders/ModelLoader.hpp"
@@ -100,6 +106,25 @@ namespace {
                     parsed ? countNodes(*parsed) : 0);
     }
 
+    // The autosave case: the exporter that wrote the archive saving the same,
+    // unchanged scene over it again, which copies every member out of it.
+    void runResave(const char* label, Scene& scene, const ObjectExporterOptions& options,
+                   const std::filesystem::path& path) {
+
+        ObjectExporter exporter;
+        exporter.save(scene, path, options);
+
+        const auto saveStart = Clock::now();
+        exporter.save(scene, path, options);
+        const auto saveMs = msSince(saveStart);
+
+        std::error_code ec;
+        const auto bytes = std::filesystem::file_size(path, ec);
+
+        std::printf("  %-22s save   %8.1f ms                       %8.2f MB\n",
+                    label, saveMs, ec ? 0.0 : static_cast<double>(bytes) / (1024.0 * 1024.0));
+    }
+
 }// namespace
 
 
@@ -151,6 +176,10 @@ int main(int argc, char** argv) {
     embedded.resourcePath = resourcePath;
     run("embed all", *scene, embedded, resourcePath);
 
+    ObjectExporterOptions base64 = embedded;
+    base64.geometry = GeometryEncoding::Base64;
+    run("embed all, base64", *scene, base64, resourcePath);
+
     ObjectExporterOptions refImages = embedded;
     refImages.images = ImageStorage::Reference;
     run("reference textures", *scene, refImages, resourcePath);
@@ -171,6 +200,12 @@ int main(int argc, char** argv) {
 
     runFile("embed all (file)", *scene, embedded, dir / "scene.json");
     runFile("archive (.tpz)", *scene, embedded, dir / "scene.tpz");
+    runResave("archive, resaved", *scene, embedded, dir / "scene.tpz");
+
+    ObjectExporterOptions compressed = embedded;
+    compressed.compressArchive = true;
+    runFile("archive, deflated", *scene, compressed, dir / "deflated.tpz");
+    runResave("deflated, resaved", *scene, compressed, dir / "deflated.tpz");
 
     return 0;
 }
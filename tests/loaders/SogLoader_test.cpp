@@ -335,6 +335,46 @@ TEST_CASE("SogLoader does not transpose the higher-order coefficients") {
     }
 }
 
+TEST_CASE("SogLoader assembles a level's chunks in file order, whatever order they decode in") {
+
+    const auto a = makeCloud(1, 5000);// more than one dequantization piece
+    auto b = makeCloud(1, 300, 2.f);
+
+    const auto dir = scratch("twochunks");
+    (void) splattest::writeSogChunk(dir / "0_0", a);
+    (void) splattest::writeSogChunk(dir / "1_0", b);
+
+    {
+        const std::string bound = R"("bound": {"min": [-4, -4, -4], "max": [4, 4, 4]})";
+        std::ofstream out(dir / "lod-meta.json");
+        out << R"({"version": 1, "lodLevels": 1, "counts": [5300],
+                   "filenames": ["0_0/meta.json", "1_0/meta.json"],
+                   "tree": {)" << bound << R"(, "children": [
+                       {)" << bound << R"(, "lods": {"0": {"file": 0, "offset": 0, "count": 5000}}},
+                       {)" << bound << R"(, "lods": {"0": {"file": 1, "offset": 0, "count": 300}}}]}})";
+    }
+
+    SogLoader::LoadStats stats;
+    const auto level = SogLoader::load(dir, SogLoader::Options{}, stats);
+    REQUIRE(level.count() == 5300);
+
+    CHECK(stats.chunks == 2);
+    CHECK(stats.planes == 14);
+    CHECK(stats.decodeSeconds >= 0);
+    CHECK(stats.dequantizeSeconds >= 0);
+
+    const auto first = SogLoader::load(dir / "0_0");
+    const auto second = SogLoader::load(dir / "1_0");
+    for (std::size_t i : {std::size_t{0}, std::size_t{4095}, std::size_t{4096}, std::size_t{4999}}) {
+        CHECK(level.means[i].x == first.means[i].x);
+        CHECK(level.opacities[i] == first.opacities[i]);
+    }
+    for (std::size_t i : {std::size_t{0}, std::size_t{299}}) {
+        CHECK(level.means[5000 + i].z == second.means[i].z);
+        CHECK(level.shAt(5000 + i)[5] == second.shAt(i)[5]);
+    }
+}
+
 TEST_CASE("SogLoader describes a chunk without decoding it") {
 
     const auto cloud = makeCloud(2, 32);
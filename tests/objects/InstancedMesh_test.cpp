@@ -8,11 +8,13 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include "threepp/core/Raycaster.hpp"
 #include "threepp/geometries/BoxGeometry.hpp"
 #include "threepp/loaders/ObjectLoader.hpp"
 #include "threepp/materials/MeshBasicMaterial.hpp"
 #include "threepp/objects/InstancedMesh.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 using namespace threepp;
@@ -96,3 +98,85 @@ TEST_CASE("ObjectLoader: count-0 InstancedMesh with instanceColor loads safely")
     // No instances means no per-instance color buffer to fill.
     CHECK(mesh->instanceColor() == nullptr);
 }
+
+namespace {
+
+    // Every instance as its own Mesh, in instance order — what raycast()
+    // reported before it walked a tree.
+    std::vector<Intersection> castEachInstance(InstancedMesh& instanced, Raycaster& raycaster) {
+
+        std::vector<Intersection> hits;
+        Matrix4 m;
+        for (size_t i = 0; i < instanced.count(); ++i) {
+            instanced.getMatrixAt(i, m);
+            auto mesh = Mesh::create(instanced.geometry(), instanced.material());
+            mesh->applyMatrix4(m);
+            mesh->updateMatrixWorld(true);
+            for (auto& hit : raycaster.intersectObject(*mesh)) {
+                hit.instanceId = static_cast<int>(i);
+                hits.push_back(hit);
+            }
+        }
+        std::stable_sort(hits.begin(), hits.end(), [](auto& a, auto& b) { return a.distance < b.distance; });
+        return hits;
+    }
+
+    std::shared_ptr<InstancedMesh> makeGrid(size_t side) {
+
+        auto mesh = InstancedMesh::create(BoxGeometry::create(0.5f, 0.5f, 0.5f), MeshBasicMaterial::create(), side * side);
+        Matrix4 m;
+        for (size_t i = 0; i < side * side; ++i) {
+            m.makeRotationY(static_cast<float>(i) * 0.3f);
+            m.setPosition(static_cast<float>(i % side), static_cast<float>(i / side) * 0.9f, 0.f);
+            mesh->setMatrixAt(i, m);
+        }
+        mesh->instanceMatrix()->needsUpdate();
+        mesh->updateMatrixWorld(true);
+        return mesh;
+    }
+
+}// namespace
+
+TEST_CASE("instance tree raycast matches casting every instance") {
+
+    auto mesh = makeGrid(24);
+
+    for (int i = 0; i < 50; ++i) {
+        Raycaster raycaster(Vector3(static_cast<float>(i % 24), static_cast<float>(i / 2), 10.f),
+                            Vector3(0.05f, -0.02f, -1.f).normalize());
+        const auto expected = castEachInstance(*mesh, raycaster);
+        const auto actual = raycaster.intersectObject(*mesh);
+
+        REQUIRE(actual.size() == expected.size());
+        for (size_t k = 0; k < actual.size(); ++k) {
+            CHECK(actual[k].distance == expected[k].distance);
+            CHECK(actual[k].instanceId == expected[k].instanceId);
+            CHECK(actual[k].faceIndex == expected[k].faceIndex);
+            CHECK(actual[k].object == mesh.get());
+        }
+
+        raycaster.firstHitOnly = true;
+        const auto first = raycaster.intersectObject(*mesh);
+        REQUIRE(first.size() == std::min<size_t>(1, expected.size()));
+        if (!first.empty()) CHECK(first.front().instanceId == expected.front().instanceId);
+    }
+}
+
+TEST_CASE("instance tree follows instanceMatrix updates") {
+
+    auto mesh = makeGrid(8);
+    Raycaster raycaster(Vector3(20.f, 0.f, 10.f), Vector3(0.f, 0.f, -1.f));
+    CHECK(raycaster.intersectObject(*mesh).empty());
+
+    Matrix4 m;
+    m.makeTranslation(20.f, 0.f, 0.f);
+    mesh->setMatrixAt(5, m);
+    mesh->instanceMatrix()->needsUpdate();
+
+    const auto hits = raycaster.intersectObject(*mesh);
+    REQUIRE(hits.size() == 2);
+    CHECK(hits.front().instanceId == 5);
+
+    mesh->setCount(5);
+    CHECK(raycaster.intersectObject(*mesh).empty());
+}
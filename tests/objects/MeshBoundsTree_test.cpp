@@ -0,0 +1,171 @@
+// Mesh::raycast through a geometry's bounds tree must report exactly what the
+// plain triangle loop reports — same hits, same order, same fields.
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "threepp/core/Raycaster.hpp"
+#include "threepp/geometries/TorusKnotGeometry.hpp"
+#include "threepp/materials/MeshBasicMaterial.hpp"
+#include "threepp/objects/Mesh.hpp"
+
+#include <random>
+
+using namespace threepp;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+    std::shared_ptr<Mesh> makeKnot(std::vector<std::shared_ptr<Material>> materials) {
+
+        auto mesh = Mesh::create(TorusKnotGeometry::create(1, 0.4f, 200, 24), std::move(materials));
+        mesh->position.set(0.3f, -0.2f, 0.1f);
+        mesh->rotation.set(0.4f, 1.1f, -0.3f);
+        mesh->scale.set(1.5f, 0.8f, 1.2f);
+        mesh->updateMatrixWorld(true);
+        return mesh;
+    }
+
+    Raycaster randomRaycaster(std::mt19937& rng) {
+
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        Vector3 origin(u(rng) * 5, u(rng) * 5, u(rng) * 5);
+        Vector3 target(u(rng) * 0.5f, u(rng) * 0.5f, u(rng) * 0.5f);
+        return Raycaster(origin, (target - origin).normalize());
+    }
+
+    void requireSame(const std::vector<Intersection>& expected, const std::vector<Intersection>& actual) {
+
+        REQUIRE(expected.size() == actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const auto& e = expected[i];
+            const auto& a = actual[i];
+            REQUIRE(e.distance == a.distance);
+            REQUIRE(e.point == a.point);
+            REQUIRE(e.faceIndex == a.faceIndex);
+            REQUIRE(e.uv == a.uv);
+            REQUIRE(e.face.has_value() == a.face.has_value());
+            REQUIRE(e.face->a == a.face->a);
+            REQUIRE(e.face->b == a.face->b);
+            REQUIRE(e.face->c == a.face->c);
+            REQUIRE(e.face->normal == a.face->normal);
+            REQUIRE(e.face->materialIndex == a.face->materialIndex);
+        }
+    }
+
+    // Every ray twice, without and then with the tree.
+    int compareWithTree(Mesh& mesh, bool firstHitOnly) {
+
+        auto& geometry = *mesh.geometry();
+        std::mt19937 rng(7);
+        int hits = 0;
+        for (int i = 0; i < 300; ++i) {
+            auto raycaster = randomRaycaster(rng);
+            raycaster.firstHitOnly = firstHitOnly;
+
+            geometry.disposeBoundsTree();
+            const auto expected = raycaster.intersectObject(mesh);
+
+            geometry.computeBoundsTree();
+            const auto actual = raycaster.intersectObject(mesh);
+
+            requireSame(expected, actual);
+            if (firstHitOnly) REQUIRE(expected.size() <= 1);
+            hits += static_cast<int>(expected.size());
+        }
+        return hits;
+    }
+
+}// namespace
+
+
+TEST_CASE("bounds tree raycast matches the triangle loop", "[objects][raycast]") {
+
+    auto mesh = makeKnot({MeshBasicMaterial::create()});
+    REQUIRE(compareWithTree(*mesh, false) > 200);
+}
+
+TEST_CASE("bounds tree honours groups, sides and the draw range", "[objects][raycast]") {
+
+    auto front = MeshBasicMaterial::create();
+    auto back = MeshBasicMaterial::create();
+    back->side = Side::Back;
+    auto both = MeshBasicMaterial::create();
+    both->side = Side::Double;
+
+    auto mesh = makeKnot({front, back, both});
+    auto& geometry = *mesh->geometry();
+    const int count = geometry.getIndex()->count();
+    const int third = count / 9 * 3;
+    geometry.clearGroups();
+    geometry.addGroup(0, third, 0);
+    geometry.addGroup(third, third, 1);
+    geometry.addGroup(third * 2, count - third * 2, 2);
+    // Overlaps the first group, so some triangles are tested twice.
+    geometry.addGroup(third / 6 * 3, third, 2);
+    geometry.setDrawRange(300, count - 900);
+
+    REQUIRE(compareWithTree(*mesh, false) > 100);
+    REQUIRE(compareWithTree(*mesh, true) > 100);
+}
+
+TEST_CASE("firstHitOnly keeps the nearest hit", "[objects][raycast]") {
+
+    auto mesh = makeKnot({MeshBasicMaterial::create()});
+    mesh->geometry()->computeBoundsTree();
+
+    std::mt19937 rng(11);
+    for (int i = 0; i < 100; ++i) {
+        auto raycaster = randomRaycaster(rng);
+        const auto all = raycaster.intersectObject(*mesh);
+
+        raycaster.firstHitOnly = true;
+        const auto first = raycaster.intersectObject(*mesh);
+
+        REQUIRE(first.size() == std::min<size_t>(1, all.size()));
+        if (!all.empty()) REQUIRE(first.front().faceIndex == all.front().faceIndex);
+    }
+
+    REQUIRE(compareWithTree(*mesh, true) > 100);
+}
+
+TEST_CASE("the bounds tree follows the geometry", "[objects][raycast]") {
+
+    auto mesh = makeKnot({MeshBasicMaterial::create()});
+    auto& geometry = *mesh->geometry();
+    geometry.computeBoundsTree();
+    const auto before = geometry.boundsTree();
+    REQUIRE(before);
+    REQUIRE(geometry.boundsTree() == before);
+
+    // Straight down -Z through the centre of the first triangle.
+    const auto* position = geometry.getAttribute<float>("position");
+    const auto* index = geometry.getIndex();
+    Vector3 centre;
+    for (int i = 0; i < 3; ++i) {
+        centre.x += position->getX(index->getX(i)) / 3;
+        centre.y += position->getY(index->getX(i)) / 3;
+    }
+    Raycaster raycaster(Vector3(centre.x, centre.y, 20), Vector3(0, 0, -1));
+    raycaster.firstHitOnly = true;
+    mesh->position.set(0, 0, 0);
+    mesh->rotation.set(0, 0, 0);
+    mesh->scale.set(1, 1, 1);
+    mesh->updateMatrixWorld(true);
+
+    const auto hit = raycaster.intersectObject(*mesh);
+    REQUIRE(hit.size() == 1);
+
+    // translate() bumps the position version; the next query rebuilds.
+    geometry.translate(0, 0, 2);
+    geometry.computeBoundingSphere();
+    geometry.boundingBox.reset();
+    const auto moved = raycaster.intersectObject(*mesh);
+    REQUIRE(geometry.boundsTree() != before);
+    REQUIRE(moved.size() == 1);
+    REQUIRE_THAT(moved.front().distance, WithinAbs(hit.front().distance - 2, 1e-4));
+
+    geometry.disposeBoundsTree();
+    REQUIRE_FALSE(geometry.hasBoundsTree());
+    REQUIRE_FALSE(geometry.boundsTree());
+}
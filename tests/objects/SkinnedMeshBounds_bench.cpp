@@ -0,0 +1,119 @@
+// CPU microbenchmark for SkinnedMesh::posedBoundingBox: per-bone boxes vs
+// skinning every vertex (exactPosedBounds); and for skinning itself,
+// boneTransform one vertex at a time vs the skinVertices batch.
+//
+// Not a ctest — run manually. A crowd of characters, each a segmented column
+// skinned to a chain of bones with blended weights, posed differently every
+// frame and asked for its bounds, as culling and raycast early-outs do. Also
+// reports how much bigger the per-bone box is than the exact one.
+//
+// Usage: SkinnedMeshBounds_bench [characters] [bones] [frames]   (default 300 24 60)
+
+#include "threepp/objects/SkinnedMesh.hpp"
+
+#include "skinned_rig.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace threepp;
+using skinnedtest::makeLeg;
+using skinnedtest::Rig;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    void pose(Rig& c, int frame, int index) {
+        const float t = 0.05f * static_cast<float>(frame) + 0.37f * static_cast<float>(index);
+        auto& bones = c.mesh->skeleton->bones;
+        for (std::size_t b = 0; b < bones.size(); ++b) {
+            bones[b]->rotation.set(0.2f * std::sin(t + static_cast<float>(b)), 0, 0.25f * std::cos(t * 1.3f + static_cast<float>(b)));
+        }
+        c.root->updateMatrixWorld(true);
+    }
+
+    double run(std::vector<Rig>& crowd, int frames, bool exact, double& volume) {
+
+        double ms = 0;
+        volume = 0;
+        for (int f = 0; f < frames; ++f) {
+            for (std::size_t i = 0; i < crowd.size(); ++i) pose(crowd[i], f, static_cast<int>(i));
+
+            const auto t0 = Clock::now();
+            for (auto& c : crowd) {
+                c.mesh->exactPosedBounds = exact;
+                Vector3 size;
+                c.mesh->posedBoundingBox().getSize(size);
+                volume += size.x * size.y * size.z;
+            }
+            ms += msSince(t0);
+        }
+        return ms;
+    }
+
+    double skin(std::vector<Rig>& crowd, int frames, bool batch, double& checksum) {
+
+        double ms = 0;
+        checksum = 0;
+        std::vector<Vector3> out(crowd.front().mesh->geometry()->getAttribute<float>("position")->count());
+        for (int f = 0; f < frames; ++f) {
+            for (std::size_t i = 0; i < crowd.size(); ++i) pose(crowd[i], f, static_cast<int>(i));
+
+            const auto t0 = Clock::now();
+            for (auto& c : crowd) {
+                if (batch) {
+                    c.mesh->skinVertices(out);
+                } else {
+                    for (std::size_t v = 0; v < out.size(); ++v) c.mesh->boneTransform(v, out[v]);
+                }
+                checksum += out.back().x + out.front().y;
+            }
+            ms += msSince(t0);
+        }
+        return ms;
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+
+    const int characters = argc > 1 ? std::atoi(argv[1]) : 300;
+    const int bones = argc > 2 ? std::atoi(argv[2]) : 24;
+    const int frames = argc > 3 ? std::atoi(argv[3]) : 60;
+
+    std::vector<Rig> crowd;
+    for (int i = 0; i < characters; ++i) crowd.emplace_back(makeLeg(bones, bones * 6, 6));
+    const auto vertices = crowd.front().mesh->geometry()->getAttribute<float>("position")->count();
+
+    std::printf("%d characters x %d bones x %u vertices, %d frames\n", characters, bones, vertices, frames);
+
+    double exactVolume = 0, boneVolume = 0;
+    const double exactMs = run(crowd, frames, true, exactVolume);
+    const double boneMs = run(crowd, frames, false, boneVolume);
+
+    std::printf("  exact (every vertex) %9.2f ms  %8.2f us/character\n", exactMs, exactMs * 1e3 / (characters * frames));
+    std::printf("  per-bone boxes       %9.2f ms  %8.2f us/character  (%.1fx)\n", boneMs, boneMs * 1e3 / (characters * frames),
+                exactMs / boneMs);
+    std::printf("  per-bone box volume  %.2fx the exact one\n", boneVolume / exactVolume);
+
+    double singleSum = 0, batchSum = 0;
+    const double singleMs = skin(crowd, frames, false, singleSum);
+    const double batchMs = skin(crowd, frames, true, batchSum);
+    const double skinned = static_cast<double>(characters) * frames * vertices;
+
+    std::printf("  boneTransform        %9.2f ms  %8.2f ns/vertex\n", singleMs, singleMs * 1e6 / skinned);
+    std::printf("  skinVertices         %9.2f ms  %8.2f ns/vertex  (%.1fx)\n", batchMs, batchMs * 1e6 / skinned,
+                singleMs / batchMs);
+    std::printf("  checksum drift       %.3g\n", std::abs(singleSum - batchSum));
+
+    return 0;
+}
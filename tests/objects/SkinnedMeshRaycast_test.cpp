@@ -23,19 +23,18 @@
 #include "threepp/objects/Skeleton.hpp"
 #include "threepp/objects/SkinnedMesh.hpp"
 
+#include "skinned_rig.hpp"
+
 #include <memory>
 #include <vector>
 
 using namespace threepp;
 using Catch::Matchers::WithinAbs;
+using skinnedtest::makeLeg;
+using skinnedtest::Rig;
 
 namespace {
 
-    struct Rig {
-        std::shared_ptr<Group> root;
-        std::shared_ptr<SkinnedMesh> mesh;
-    };
-
     // A one-bone "character": a 1 m cube standing with its centre 1 m up,
     // under an armature node scaled by `armatureScale`.
     //
@@ -162,3 +161,135 @@ TEST_CASE("moving the bone moves what can be picked", "[objects][skinning]") {
     REQUIRE_FALSE(moved.empty());
     CHECK(moved.front().object == rig.mesh.get());
 }
+
+TEST_CASE("a bounds tree follows the pose", "[objects][skinning]") {
+
+    // The geometry's tree holds the bind pose; the mesh refits a copy of it
+    // to the skeleton, so picking through it agrees with the plain loop.
+    auto rig = makeRig(0.01f);
+    rig.mesh->geometry()->computeBoundsTree();
+
+    const auto atRest = shootAtChest(*rig.root);
+    REQUIRE(atRest.size() == 2);
+    CHECK_THAT(atRest.front().distance, WithinAbs(4.5f, 1e-3f));
+
+    rig.mesh->skeleton->bones.front()->position.set(300.f, 0.f, 0.f);
+    rig.root->updateMatrixWorld(true);
+
+    CHECK(shootAtChest(*rig.root).empty());
+
+    Raycaster raycaster;
+    raycaster.set(Vector3(3.f, 1.f, 5.f), Vector3(0.f, 0.f, -1.f));
+    const auto moved = raycaster.intersectObject(*rig.root, true);
+    REQUIRE(moved.size() == 2);
+    CHECK_THAT(moved.front().distance, WithinAbs(4.5f, 1e-3f));
+
+    raycaster.firstHitOnly = true;
+    CHECK(raycaster.intersectObject(*rig.root, true).size() == 1);
+}
+
+namespace {
+
+    bool contains(const Box3& outer, const Box3& inner, float eps = 1e-4f) {
+
+        return outer.min().x <= inner.min().x + eps && outer.min().y <= inner.min().y + eps &&
+               outer.min().z <= inner.min().z + eps && outer.max().x >= inner.max().x - eps &&
+               outer.max().y >= inner.max().y - eps && outer.max().z >= inner.max().z - eps;
+    }
+
+}// namespace
+
+TEST_CASE("per-bone posed bounds enclose the skinned vertices", "[objects][skinning]") {
+
+    auto leg = makeLeg();
+    auto& bones = leg.mesh->skeleton->bones;
+
+    for (int step = 0; step < 6; ++step) {
+
+        bones[0]->rotation.z = 0.3f * static_cast<float>(step);
+        bones[1]->rotation.x = -0.5f * static_cast<float>(step);
+        bones[0]->position.x = 0.25f * static_cast<float>(step);
+        leg.root->updateMatrixWorld(true);
+
+        leg.mesh->exactPosedBounds = false;
+        const Box3 fromBones(leg.mesh->posedBoundingBox());
+
+        leg.mesh->exactPosedBounds = true;
+        leg.mesh->updateMatrixWorld(true);
+        const Box3 exact(leg.mesh->posedBoundingBox());
+
+        INFO("step " << step);
+        REQUIRE_FALSE(exact.isEmpty());
+        CHECK(contains(fromBones, exact));
+        // Loose, but not by more than a limb.
+        Vector3 a, b;
+        fromBones.getSize(a);
+        exact.getSize(b);
+        CHECK(a.length() < b.length() + 2.f);
+    }
+}
+
+TEST_CASE("a single-bone skin gets the exact box from its bone", "[objects][skinning]") {
+
+    auto rig = makeRig(1.f);
+    auto& bone = *rig.mesh->skeleton->bones.front();
+    bone.rotation.set(0.4f, 0.2f, -0.7f);
+    bone.position.set(1.f, 2.f, 3.f);
+    rig.root->updateMatrixWorld(true);
+
+    const Box3 fromBone(rig.mesh->posedBoundingBox());
+    rig.mesh->exactPosedBounds = true;
+    rig.mesh->updateMatrixWorld(true);
+    const Box3& exact = rig.mesh->posedBoundingBox();
+
+    CHECK(contains(fromBone, exact));
+    CHECK(contains(exact, fromBone));
+}
+
+TEST_CASE("unnormalized skin weights fall back to the exact pass", "[objects][skinning]") {
+
+    auto rig = makeRig(1.f);
+    auto weights = rig.mesh->geometry()->getAttribute<float>("skinWeight");
+    for (unsigned i = 0; i < weights->count(); ++i) weights->setX(i, 2.f);
+    rig.mesh->bind(rig.mesh->skeleton, Matrix4());
+    rig.root->updateMatrixWorld(true);
+
+    // Every vertex doubled away from the bone's origin.
+    const auto& box = rig.mesh->posedBoundingBox();
+    CHECK_THAT(box.min().y, WithinAbs(1.f, 1e-3f));
+    CHECK_THAT(box.max().y, WithinAbs(3.f, 1e-3f));
+}
+
+TEST_CASE("a morph that moves the mesh off its bones still picks", "[objects][skinning]") {
+
+    // A relative target carrying the whole cube 3 m along +X, clear of the
+    // box its bone saw at bind time.
+    auto rig = makeRig(1.f);
+    const auto geometry = rig.mesh->geometry();
+    const auto count = geometry->getAttribute<float>("position")->count();
+    std::vector<float> shift(count * 3, 0.f);
+    for (unsigned i = 0; i < count; ++i) shift[i * 3] = 3.f;
+    geometry->getOrCreateMorphAttribute("position")->emplace_back(FloatBufferAttribute::create(shift, 3));
+    geometry->morphTargetsRelative = true;
+    rig.mesh->morphTargetInfluences() = {1.f};
+
+    auto material = MeshBasicMaterial::create();
+    material->morphTargets = true;
+    rig.mesh->setMaterial(material);
+    rig.root->updateMatrixWorld(true);
+
+    for (const bool exact : {false, true}) {
+
+        INFO("exactPosedBounds " << exact);
+        rig.mesh->exactPosedBounds = exact;
+        rig.mesh->updateMatrixWorld(true);
+
+        CHECK_THAT(rig.mesh->posedBoundingBox().min().x, WithinAbs(2.5f, 1e-4f));
+
+        Raycaster raycaster;
+        raycaster.set(Vector3(3.f, 1.f, 5.f), Vector3(0.f, 0.f, -1.f));
+        const auto hits = raycaster.intersectObject(*rig.root, true);
+        REQUIRE_FALSE(hits.empty());
+        CHECK_THAT(hits.front().distance, WithinAbs(4.5f, 1e-3f));
+    }
+}
@@ -0,0 +1,151 @@
+// SkinnedMesh::skinVertices, the batch skinning kernel behind posed bounds
+// and raycasting: it has to put every vertex where boneTransform does, fold
+// in morph targets the way the renderer does, and give the same bits however
+// the batch is cut up or threaded.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "threepp/materials/MeshBasicMaterial.hpp"
+#include "threepp/objects/SkinnedMesh.hpp"
+#include "threepp/utils/ThreadPool.hpp"
+
+#include "skinned_rig.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace threepp;
+using skinnedtest::makeLeg;
+using skinnedtest::Rig;
+
+namespace {
+
+    void bend(Rig& rig) {
+        auto& bones = rig.mesh->skeleton->bones;
+        for (std::size_t b = 0; b < bones.size(); ++b) {
+            bones[b]->rotation.set(0.3f * std::sin(static_cast<float>(b)), 0.1f, 0.4f * std::cos(static_cast<float>(b)));
+        }
+        rig.root->position.set(1, -2, 0.5f);
+        rig.root->updateMatrixWorld(true);
+    }
+
+    bool same(const std::vector<Vector3>& a, const std::vector<Vector3>& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](auto& x, auto& y) {
+                   return x.x == y.x && x.y == y.y && x.z == y.z;
+               });
+    }
+
+}// namespace
+
+TEST_CASE("skinVertices puts every vertex where boneTransform does") {
+
+    auto rig = makeLeg(6, 24, 2);
+    bend(rig);
+
+    const auto count = rig.mesh->geometry()->getAttribute<float>("position")->count();
+    std::vector<Vector3> batch(count);
+    rig.mesh->skinVertices(batch);
+
+    int far = 0;
+    Vector3 single;
+    for (unsigned i = 0; i < count; ++i) {
+        rig.mesh->boneTransform(i, single);
+        if (single.distanceTo(batch[i]) > 1e-4f) ++far;
+    }
+    CHECK(far == 0);
+}
+
+TEST_CASE("skinVertices gives the same bits however the batch is cut") {
+
+    // Large enough to be split across the pool.
+    auto rig = makeLeg(8, 300, 16);
+    bend(rig);
+
+    const auto count = rig.mesh->geometry()->getAttribute<float>("position")->count();
+    REQUIRE(count > 20000);
+
+    std::vector<Vector3> parallel(count), parallelNormals(count);
+    rig.mesh->skinVertices(parallel, parallelNormals);
+
+    std::vector<Vector3> serial(count), serialNormals(count);
+    {
+        ThreadPool::SerialScope scope;
+        rig.mesh->skinVertices(serial, serialNormals);
+    }
+    CHECK(same(parallel, serial));
+    CHECK(same(parallelNormals, serialNormals));
+
+    // Odd-sized pieces at odd offsets.
+    std::vector<Vector3> pieces(count), pieceNormals(count);
+    for (std::size_t first = 0; first < count; first += 1237) {
+        const auto n = std::min<std::size_t>(1237, count - first);
+        rig.mesh->skinVertices(std::span(pieces).subspan(first, n), std::span(pieceNormals).subspan(first, n), first);
+    }
+    CHECK(same(parallel, pieces));
+    CHECK(same(parallelNormals, pieceNormals));
+}
+
+TEST_CASE("skinVertices turns normals with the bones and keeps them unit length") {
+
+    auto rig = makeLeg(1, 1, 1);
+    rig.mesh->skeleton->bones[0]->rotation.z = math::PI / 2;
+    rig.root->updateMatrixWorld(true);
+
+    const auto geometry = rig.mesh->geometry();
+    const auto count = geometry->getAttribute<float>("position")->count();
+    std::vector<Vector3> positions(count), normals(count);
+    rig.mesh->skinVertices(positions, normals);
+
+    const auto rest = geometry->getAttribute<float>("normal");
+    int wrong = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        // A quarter turn about Z: (x, y, z) -> (-y, x, z).
+        Vector3 expected(-rest->getY(i), rest->getX(i), rest->getZ(i));
+        expected.normalize();
+        if (normals[i].distanceTo(expected) > 1e-4f || std::abs(normals[i].length() - 1) > 1e-4f) ++wrong;
+    }
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("skinVertices applies morph targets when the material enables them") {
+
+    auto rig = makeLeg(1, 1, 1);
+    const auto geometry = rig.mesh->geometry();
+    const auto count = geometry->getAttribute<float>("position")->count();
+
+    // A relative target pushing every vertex 2 units along +X.
+    std::vector<float> shift(count * 3, 0.f);
+    for (unsigned i = 0; i < count; ++i) shift[i * 3] = 2.f;
+    geometry->getOrCreateMorphAttribute("position")->emplace_back(FloatBufferAttribute::create(shift, 3));
+    geometry->morphTargetsRelative = true;
+    rig.mesh->morphTargetInfluences() = {0.25f};
+
+    std::vector<Vector3> plain(count), morphed(count);
+    rig.mesh->skinVertices(plain);
+
+    auto material = MeshBasicMaterial::create();
+    material->morphTargets = true;
+    rig.mesh->setMaterial(material);
+    rig.mesh->skinVertices(morphed);
+
+    int wrong = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        if (std::abs(morphed[i].x - plain[i].x - 0.5f) > 1e-5f || morphed[i].y != plain[i].y) ++wrong;
+    }
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("skinVertices rejects a range past the end") {
+
+    auto rig = makeLeg(1, 1, 1);
+    const auto count = rig.mesh->geometry()->getAttribute<float>("position")->count();
+
+    std::vector<Vector3> out(count);
+    CHECK_THROWS_AS(rig.mesh->skinVertices(out, {}, 1), std::out_of_range);
+
+    std::vector<Vector3> normals(count - 1);
+    CHECK_THROWS_AS(rig.mesh->skinVertices(out, normals), std::invalid_argument);
+}
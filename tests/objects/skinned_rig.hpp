@@ -0,0 +1,80 @@
+// Test-only skinned rigs shared by the SkinnedMesh tests and the bounds bench.
+//
+// makeLeg is a column standing on the origin over a chain of bones one metre
+// apart, each vertex blended between the two bones nearest it — the smallest
+// rig on which per-bone bounds, batch skinning and picking all have to agree
+// with boneTransform.
+
+#ifndef THREEPP_SKINNED_RIG_HPP
+#define THREEPP_SKINNED_RIG_HPP
+
+#include "threepp/geometries/BoxGeometry.hpp"
+#include "threepp/materials/MeshBasicMaterial.hpp"
+#include "threepp/objects/Bone.hpp"
+#include "threepp/objects/Group.hpp"
+#include "threepp/objects/Skeleton.hpp"
+#include "threepp/objects/SkinnedMesh.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace skinnedtest {
+
+    struct Rig {
+        std::shared_ptr<threepp::Group> root;
+        std::shared_ptr<threepp::SkinnedMesh> mesh;
+    };
+
+    // A 0.4 m square column `bones` metres tall, hip bone at the origin and
+    // one more bone every metre up. A vertex at height y is weighted to the
+    // bones either side of y - 0.5, so each segment blends into the next
+    // across its middle. Segment counts set the vertex count: the height is
+    // cut `heightSegments` times, each side `sideSegments` times.
+    inline Rig makeLeg(int bones = 2, unsigned heightSegments = 8, unsigned sideSegments = 1) {
+
+        using namespace threepp;
+
+        auto root = Group::create();
+        std::vector<std::shared_ptr<Bone>> chain;
+        for (int b = 0; b < bones; ++b) {
+            auto bone = Bone::create();
+            if (chain.empty()) {
+                root->add(bone);
+            } else {
+                bone->position.y = 1.f;
+                chain.back()->add(bone);
+            }
+            chain.push_back(bone);
+        }
+
+        const auto height = static_cast<float>(bones);
+        auto geometry = BoxGeometry::create(0.4f, height, 0.4f, sideSegments, heightSegments, sideSegments);
+        geometry->translate(0.f, height / 2, 0.f);
+        auto mesh = SkinnedMesh::create(geometry, MeshBasicMaterial::create());
+        root->add(mesh);
+        root->updateMatrixWorld(true);
+
+        const auto position = geometry->getAttribute<float>("position");
+        const auto count = position->count();
+        std::vector<float> indices(count * 4, 0.f);
+        std::vector<float> weights(count * 4, 0.f);
+        for (unsigned i = 0; i < count; ++i) {
+            const float y = std::clamp(position->getY(i) - 0.5f, 0.f, height - 1.f);
+            const int lower = std::clamp(static_cast<int>(y), 0, std::max(bones - 2, 0));
+            const float w = bones > 1 ? y - static_cast<float>(lower) : 0.f;
+            indices[i * 4] = static_cast<float>(lower);
+            indices[i * 4 + 1] = static_cast<float>(std::min(lower + 1, bones - 1));
+            weights[i * 4] = 1.f - w;
+            weights[i * 4 + 1] = w;
+        }
+        geometry->setAttribute("skinIndex", FloatBufferAttribute::create(std::move(indices), 4));
+        geometry->setAttribute("skinWeight", FloatBufferAttribute::create(std::move(weights), 4));
+
+        mesh->bind(Skeleton::create(chain));
+        return {root, mesh};
+    }
+
+}// namespace skinnedtest
+
+#endif//THREEPP_SKINNED_RIG_HPP
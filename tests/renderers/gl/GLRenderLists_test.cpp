@@ -4,9 +4,13 @@
 #undef near
 #undef far
 #include "threepp/core/BufferGeometry.hpp"
+#include "threepp/materials/MeshPhysicalMaterial.hpp"
 #include "threepp/renderers/gl/GLProperties.hpp"
 #include "threepp/renderers/gl/GLRenderLists.hpp"
 
+#include <algorithm>
+#include <random>
+
 using namespace threepp;
 using namespace threepp::gl;
 
@@ -174,3 +178,113 @@ TEST_CASE("push") {
         CHECK(!o->group.has_value());
     }
 }
+
+namespace {
+
+    // The comparators RenderList::sort used before it sorted on packed keys;
+    // the key sort must reproduce them exactly.
+    bool painterLess(const RenderItem* a, const RenderItem* b) {
+        if (a->groupOrder != b->groupOrder) return a->groupOrder < b->groupOrder;
+        if (a->renderOrder != b->renderOrder) return a->renderOrder < b->renderOrder;
+        if (a->programId != b->programId) return a->programId < b->programId;
+        if (a->material->id != b->material->id) return a->material->id < b->material->id;
+        if (a->z != b->z) return a->z < b->z;
+        return a->id < b->id;
+    }
+
+    bool reversePainterLess(const RenderItem* a, const RenderItem* b) {
+        if (a->groupOrder != b->groupOrder) return a->groupOrder < b->groupOrder;
+        if (a->renderOrder != b->renderOrder) return a->renderOrder < b->renderOrder;
+        if (a->z != b->z) return a->z > b->z;
+        return a->id < b->id;
+    }
+
+    void fillRandom(threepp::RenderList& list, int count, std::mt19937& rng,
+                    std::vector<std::unique_ptr<Object3D>>& objects,
+                    const std::vector<std::shared_ptr<Material>>& materials) {
+
+        std::uniform_int_distribution<int> order(-2, 2);
+        std::uniform_int_distribution<size_t> pick(0, materials.size() - 1);
+        // Few distinct depths, so ties fall through to the id and to list order.
+        const float depths[] = {-1.5f, -0.f, 0.f, 0.25f, 0.5f, 1e-30f, -1e-30f, 3.f};
+        std::uniform_int_distribution<size_t> depth(0, std::size(depths) - 1);
+
+        for (int i = 0; i < count; ++i) {
+            // Some objects push more than once, as multi-material meshes do.
+            if (objects.empty() || rng() % 4 != 0) {
+                objects.emplace_back(std::make_unique<Object3D>());
+                objects.back()->renderOrder = order(rng);
+            }
+            auto* object = objects[rng() % objects.size()].get();
+            auto* material = materials[pick(rng)].get();
+            if (rng() % 16 == 0) {
+                list.unshift(object, nullptr, material, order(rng), depths[depth(rng)], std::nullopt);
+            } else {
+                list.push(object, nullptr, material, order(rng), depths[depth(rng)], std::nullopt);
+            }
+        }
+    }
+
+}// namespace
+
+TEST_CASE("sort matches the painter comparators") {
+
+    std::vector<std::shared_ptr<Material>> materials;
+    for (int i = 0; i < 12; ++i) {
+        auto m = MeshPhysicalMaterial::create();
+        m->transparent = i % 3 == 0;
+        if (i % 4 == 1) m->transmission = 0.5f;
+        materials.emplace_back(m);
+    }
+
+    // A handful of "programs", shared between materials.
+    threepp::RenderList list([](Material* m) -> uint64_t { return 1000 + m->id % 5; });
+
+    std::mt19937 rng(17);
+    for (int count : {10, 200, 5000}) {
+        for (int frame = 0; frame < 3; ++frame) {
+            std::vector<std::unique_ptr<Object3D>> objects;
+            list.init();
+            fillRandom(list, count, rng, objects, materials);
+            list.finish();
+
+            auto opaque = list.opaque;
+            auto transmissive = list.transmissive;
+            auto transparent = list.transparent;
+            std::stable_sort(opaque.begin(), opaque.end(), painterLess);
+            std::stable_sort(transmissive.begin(), transmissive.end(), reversePainterLess);
+            std::stable_sort(transparent.begin(), transparent.end(), reversePainterLess);
+
+            list.sort();
+
+            REQUIRE(list.opaque.size() + list.transmissive.size() + list.transparent.size() == static_cast<size_t>(count));
+            REQUIRE(list.opaque == opaque);
+            REQUIRE(list.transmissive == transmissive);
+            REQUIRE(list.transparent == transparent);
+        }
+    }
+}
+
+TEST_CASE("items stay valid while the list grows") {
+
+    DummyMaterial opaque;
+    DummyMaterial transparent;
+    transparent.transparent = true;
+
+    threepp::RenderList list;
+    std::vector<Object3D> objects(1000);
+    for (auto& o : objects) {
+        list.push(&o, nullptr, o.id % 2 ? &transparent : &opaque, 0, static_cast<float>(o.id), std::nullopt);
+    }
+    list.unshift(&objects.front(), nullptr, &opaque, 0, 0, std::nullopt);
+
+    REQUIRE(list.opaque.size() + list.transparent.size() == objects.size() + 1);
+    REQUIRE(list.opaque.front()->object == &objects.front());
+    for (const auto* items : {&list.opaque, &list.transparent}) {
+        for (const auto* item : *items) {
+            REQUIRE(item >= list.renderItems.data());
+            REQUIRE(item < list.renderItems.data() + list.renderItems.size());
+            REQUIRE(item->id == item->object->id);
+        }
+    }
+}
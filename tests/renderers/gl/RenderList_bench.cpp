@@ -0,0 +1,148 @@
+// Scene prep cost in GLRenderer::render for a many-draw scene.
+//
+// Not a ctest — run manually. No GL context is needed: the bench does what
+// render() does between updating the camera and issuing the first draw —
+// projectObject's frustum test and clip-space depth per mesh, then
+// GLRenderList::push, finish and sort — on a scene of small boxes spread
+// through the camera's view. Programs are stand-ins attached through
+// GLProperties, so push resolves them exactly as the renderer does.
+//
+// Phases (median of the frames):
+//   project — frustum test, depth, push, finish
+//   sort    — GLRenderList::sort
+//   legacy  — std::stable_sort with the painter comparators sort() used to
+//             run, over the same lists; reported for comparison only
+//
+// Usage: RenderList_bench [draws]   (default 50000)
+
+#include "threepp/cameras/PerspectiveCamera.hpp"
+#include "threepp/geometries/BoxGeometry.hpp"
+#include "threepp/materials/MeshBasicMaterial.hpp"
+#include "threepp/math/Frustum.hpp"
+#include "threepp/objects/Mesh.hpp"
+#include "threepp/renderers/gl/GLRenderLists.hpp"
+#include "threepp/scenes/Scene.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    double median(std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    struct StandInProgram: gl::GLProgram {};
+
+    bool painterLess(const RenderItem* a, const RenderItem* b) {
+        if (a->groupOrder != b->groupOrder) return a->groupOrder < b->groupOrder;
+        if (a->renderOrder != b->renderOrder) return a->renderOrder < b->renderOrder;
+        if (a->programId != b->programId) return a->programId < b->programId;
+        if (a->material->id != b->material->id) return a->material->id < b->material->id;
+        if (a->z != b->z) return a->z < b->z;
+        return a->id < b->id;
+    }
+
+    bool reversePainterLess(const RenderItem* a, const RenderItem* b) {
+        if (a->groupOrder != b->groupOrder) return a->groupOrder < b->groupOrder;
+        if (a->renderOrder != b->renderOrder) return a->renderOrder < b->renderOrder;
+        if (a->z != b->z) return a->z > b->z;
+        return a->id < b->id;
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+
+    const int draws = argc > 1 ? std::atoi(argv[1]) : 50000;
+    constexpr int frames = 30;
+
+    // 64 materials over 16 programs; one in eight transparent.
+    gl::GLProperties properties;
+    std::vector<StandInProgram> programs(16);
+    std::vector<std::shared_ptr<MeshBasicMaterial>> materials;
+    for (int i = 0; i < 64; ++i) {
+        auto m = MeshBasicMaterial::create();
+        m->transparent = i % 8 == 0;
+        properties.materialProperties.get(m.get())->program = &programs[i % programs.size()];
+        materials.emplace_back(m);
+    }
+
+    auto scene = Scene::create();
+    auto geometry = BoxGeometry::create(0.5f, 0.5f, 0.5f);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    for (int i = 0; i < draws; ++i) {
+        auto mesh = Mesh::create(geometry, materials[rng() % materials.size()]);
+        mesh->position.set(u(rng) * 200, u(rng) * 200, -200 + u(rng) * 190);
+        scene->add(mesh);
+    }
+    scene->updateMatrixWorld();
+
+    PerspectiveCamera camera(90, 1, 0.1f, 1000);
+    camera.updateMatrixWorld();
+
+    Matrix4 projScreenMatrix;
+    projScreenMatrix.multiplyMatrices(camera.projectionMatrix, camera.matrixWorldInverse);
+    Frustum frustum;
+    frustum.setFromProjectionMatrix(projScreenMatrix);
+
+    gl::GLRenderLists lists(properties);
+    Vector3 clip;
+    std::vector<double> projectMs, sortMs, legacyMs;
+    size_t pushed = 0;
+
+    for (int frame = 0; frame < frames; ++frame) {
+
+        auto* list = lists.get(scene.get(), 0);
+
+        auto t0 = Clock::now();
+        list->init();
+        for (const auto& child : scene->children) {
+            if (!child->frustumCulled || frustum.intersectsObject(*child)) {
+                clip.setFromMatrixPosition(*child->matrixWorld).applyMatrix4(projScreenMatrix);
+                auto* mesh = child->as<Mesh>();
+                list->push(mesh, mesh->geometry().get(), mesh->material().get(), 0, clip.z, std::nullopt);
+            }
+        }
+        list->finish();
+        projectMs.push_back(msSince(t0));
+
+        auto opaque = list->opaque;
+        auto transparent = list->transparent;
+
+        t0 = Clock::now();
+        list->sort();
+        sortMs.push_back(msSince(t0));
+
+        t0 = Clock::now();
+        std::stable_sort(opaque.begin(), opaque.end(), painterLess);
+        std::stable_sort(transparent.begin(), transparent.end(), reversePainterLess);
+        legacyMs.push_back(msSince(t0));
+
+        if (opaque != list->opaque || transparent != list->transparent) {
+            std::printf("sort order differs from the comparators\n");
+            return 1;
+        }
+        pushed = list->opaque.size() + list->transparent.size();
+    }
+
+    std::printf("RenderList_bench  draws=%d  visible=%zu  frames=%d\n", draws, pushed, frames);
+    std::printf("project %8.3f ms\n", median(projectMs));
+    std::printf("sort    %8.3f ms   (legacy comparator sort %8.3f ms)\n", median(sortMs), median(legacyMs));
+
+    return 0;
+}
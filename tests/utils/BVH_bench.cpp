@@ -0,0 +1,119 @@
+// Build and query cost of threepp::BVH on a dense mesh.
+//
+// Not a ctest — run manually. The mesh is a TorusKnotGeometry refined until it
+// has at least the requested triangle count (long thin triangles wound around
+// themselves: a harder case for split selection than a sphere or a grid).
+// Rays are aimed from a shell around the knot at points inside its bounds, so
+// roughly half of them hit.
+//
+// Phases:
+//   build      — BVH::build, serial (ThreadPool::SerialScope) and pooled
+//   raycast    — closest hit
+//   raycastAny — occlusion query over the same rays
+//   box        — intersect(Box3) with a box 1/8 the size of the bounds
+//
+// Usage: BVH_bench [triangles]   (default 2000000)
+
+#include "threepp/geometries/TorusKnotGeometry.hpp"
+#include "threepp/utils/BVH.hpp"
+#include "threepp/utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    template<class F>
+    double medianMs(int reps, F&& fn) {
+        std::vector<double> samples;
+        for (int i = 0; i < reps; ++i) {
+            const auto t0 = Clock::now();
+            fn();
+            samples.push_back(msSince(t0));
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+
+    const std::size_t target = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    // tubular * radial * 2 triangles, at a 8:1 aspect.
+    const auto radial = static_cast<unsigned>(std::max(8.0, std::sqrt(target / 16.0)));
+    const auto geometry = TorusKnotGeometry::create(1, 0.4f, radial * 8, radial);
+    const std::size_t triangles = geometry->getIndex()->count() / 3;
+
+    std::printf("BVH_bench  triangles=%zu  lanes=%u\n", triangles, ThreadPool::global().concurrency());
+
+    BVH bvh;
+    const double buildSerial = medianMs(3, [&] {
+        ThreadPool::SerialScope serial;
+        bvh.build(*geometry);
+    });
+    const double buildPooled = medianMs(3, [&] { bvh.build(*geometry); });
+
+    std::printf("build      serial %9.2f ms   pooled %9.2f ms   nodes=%zu depth=%d\n",
+                buildSerial, buildPooled, bvh.nodeCount(), bvh.depth());
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    std::vector<Ray> rays(100000);
+    for (auto& ray : rays) {
+        Vector3 origin(u(rng), u(rng), u(rng));
+        origin.normalize().multiplyScalar(4);
+        const Vector3 target(u(rng) * 1.5f, u(rng) * 1.5f, u(rng) * 0.5f);
+        ray.set(origin, (target - origin).normalize());
+    }
+
+    std::size_t hits = 0;
+    double distanceSum = 0.0;
+    const double raycastMs = medianMs(3, [&] {
+        hits = 0;
+        distanceSum = 0.0;
+        for (const auto& ray : rays) {
+            if (const auto hit = bvh.raycast(ray)) {
+                ++hits;
+                distanceSum += hit->distance;
+            }
+        }
+    });
+
+    std::size_t occluded = 0;
+    const double anyMs = medianMs(3, [&] {
+        occluded = 0;
+        for (const auto& ray : rays) occluded += bvh.raycastAny(ray, 100.f);
+    });
+
+    std::size_t boxHits = 0;
+    const double boxMs = medianMs(3, [&] {
+        boxHits = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const Vector3 c(u(rng), u(rng), u(rng) * 0.3f);
+            boxHits += bvh.intersect(Box3(c - Vector3(0.25f, 0.25f, 0.1f), c + Vector3(0.25f, 0.25f, 0.1f))).size();
+        }
+    });
+
+    std::printf("raycast    %9.2f ms / %zu rays  (%.0f krays/s, %zu hits, sum %.4f)\n",
+                raycastMs, rays.size(), rays.size() / raycastMs, hits, distanceSum);
+    std::printf("raycastAny %9.2f ms / %zu rays  (%.0f krays/s, %zu occluded)\n",
+                anyMs, rays.size(), rays.size() / anyMs, occluded);
+    std::printf("box        %9.2f ms / 1000 boxes  (%zu triangles)\n", boxMs, boxHits);
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "threepp/geometries/BoxGeometry.hpp"
+#include "threepp/geometries/TorusKnotGeometry.hpp"
+#include "threepp/math/Sphere.hpp"
+#include "threepp/utils/BVH.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <random>
+
+using namespace threepp;
+
+namespace {
+
+    std::vector<Triangle> trianglesOf(const BufferGeometry& geometry) {
+        std::vector<Triangle> tris;
+        const auto* pos = geometry.getAttribute<float>("position");
+        const auto* index = geometry.getIndex();
+        const auto vertex = [&](int i) { return Vector3(pos->getX(i), pos->getY(i), pos->getZ(i)); };
+        for (int i = 0; i < index->count(); i += 3) {
+            tris.emplace_back(vertex(index->getX(i)), vertex(index->getX(i + 1)), vertex(index->getX(i + 2)));
+        }
+        return tris;
+    }
+
+    // Closest hit by testing every triangle, with the same near limit as BVH.
+    std::optional<std::pair<float, int>> bruteForce(const std::vector<Triangle>& tris, const Ray& ray) {
+        std::optional<std::pair<float, int>> best;
+        Vector3 point;
+        for (int i = 0; i < static_cast<int>(tris.size()); ++i) {
+            if (!ray.intersectTriangle(tris[i].a(), tris[i].b(), tris[i].c(), false, point)) continue;
+            const float d = point.distanceTo(ray.origin);
+            if (d < 1e-4f) continue;
+            if (!best || d < best->first) best = std::make_pair(d, i);
+        }
+        return best;
+    }
+
+    Ray randomRay(std::mt19937& rng) {
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        Vector3 origin(u(rng) * 4, u(rng) * 4, u(rng) * 4);
+        Vector3 target(u(rng) * 0.5f, u(rng) * 0.5f, u(rng) * 0.5f);
+        return Ray(origin, (target - origin).normalize());
+    }
+
+}// namespace
+
+TEST_CASE("BVH raycast matches brute force") {
+
+    const auto geometry = TorusKnotGeometry::create(1, 0.4f, 256, 32);
+    const auto tris = trianglesOf(*geometry);
+
+    BVH bvh;
+    bvh.build(*geometry);
+    REQUIRE(bvh.triangleCount() == tris.size());
+    REQUIRE(bvh.depth() <= BVH::maxDepth);
+
+    std::mt19937 rng(42);
+    int hits = 0;
+    for (int i = 0; i < 500; ++i) {
+        const Ray ray = randomRay(rng);
+        const auto expected = bruteForce(tris, ray);
+        const auto actual = bvh.raycast(ray);
+
+        REQUIRE(expected.has_value() == actual.has_value());
+        REQUIRE(bvh.raycastAny(ray, 100.f) == expected.has_value());
+        if (!expected) continue;
+
+        ++hits;
+        REQUIRE_THAT(actual->distance, Catch::Matchers::WithinAbs(expected->first, 1e-5));
+        REQUIRE(actual->normal.dot(ray.direction) <= 0.f);
+        REQUIRE(bvh.raycast(ray, expected->first * 0.5f) == std::nullopt);
+    }
+    REQUIRE(hits > 100);
+}
+
+TEST_CASE("BVH box and sphere queries match brute force") {
+
+    const auto geometry = TorusKnotGeometry::create(1, 0.4f, 128, 16);
+    const auto tris = trianglesOf(*geometry);
+
+    BVH bvh;
+    bvh.build(*geometry);
+
+    Matrix4 m;
+    m.makeTranslation(0.5f, 0, 0);
+
+    const Box3 box({0, 0, 0}, {1, 1, 1});
+    auto fromBox = bvh.intersect(box, m);
+    std::sort(fromBox.begin(), fromBox.end());
+
+    std::vector<int> expectedBox;
+    Box3 triBox;
+    for (int i = 0; i < static_cast<int>(tris.size()); ++i) {
+        triBox.setFromPoints(std::vector<Vector3>{tris[i].a(), tris[i].b(), tris[i].c()});
+        if (triBox.applyMatrix4(m).intersectsBox(box)) expectedBox.push_back(i);
+    }
+    REQUIRE(!expectedBox.empty());
+    REQUIRE(fromBox == expectedBox);
+
+    const Sphere sphere({0.5f, 0.5f, 0}, 0.7f);
+    auto fromSphere = bvh.intersect(sphere);
+    std::sort(fromSphere.begin(), fromSphere.end());
+
+    std::vector<int> expectedSphere;
+    Vector3 closest;
+    for (int i = 0; i < static_cast<int>(tris.size()); ++i) {
+        tris[i].closestPointToPoint(sphere.center, closest);
+        if (closest.distanceToSquared(sphere.center) <= sphere.radius * sphere.radius) expectedSphere.push_back(i);
+    }
+    REQUIRE(!expectedSphere.empty());
+    REQUIRE(fromSphere == expectedSphere);
+}
+
+TEST_CASE("BVH vs BVH") {
+
+    const auto geometry = BoxGeometry::create(1, 1, 1, 4, 4, 4);
+
+    BVH a, b;
+    a.build(*geometry);
+    b.build(*geometry);
+
+    Matrix4 m1, m2;
+    m2.makeTranslation(0.5f, 0, 0);
+    REQUIRE(BVH::intersects(a, b, m1, m2));
+    REQUIRE(!BVH::intersect(a, m1, b, m2, true).empty());
+
+    m2.makeTranslation(3, 0, 0);
+    REQUIRE(!BVH::intersects(a, b, m1, m2));
+    REQUIRE(BVH::intersect(a, m1, b, m2).empty());
+}
+
+TEST_CASE("BVH refit matches a rebuild") {
+
+    const auto geometry = TorusKnotGeometry::create(1, 0.4f, 128, 16);
+    auto* pos = geometry->getAttribute<float>("position");
+
+    BVH refitted;
+    refitted.build(*geometry);
+
+    // A non-rigid deformation: a twist about Y.
+    std::vector<Vector3> twisted(pos->count());
+    for (int i = 0; i < pos->count(); ++i) {
+        Vector3 v(pos->getX(i), pos->getY(i), pos->getZ(i));
+        v.applyAxisAngle(Vector3(0, 1, 0), v.y * 0.8f);
+        twisted[i] = v;
+    }
+    refitted.refit(twisted);
+
+    for (int i = 0; i < pos->count(); ++i) {
+        pos->setXYZ(i, twisted[i].x, twisted[i].y, twisted[i].z);
+    }
+    const auto tris = trianglesOf(*geometry);
+
+    std::mt19937 rng(3);
+    for (int i = 0; i < 300; ++i) {
+        const Ray ray = randomRay(rng);
+        const auto expected = bruteForce(tris, ray);
+        const auto actual = refitted.raycast(ray);
+
+        REQUIRE(expected.has_value() == actual.has_value());
+        if (expected) REQUIRE_THAT(actual->distance, Catch::Matchers::WithinAbs(expected->first, 1e-5));
+    }
+}
+
+TEST_CASE("BVH respects its limits") {
+
+    const auto geometry = TorusKnotGeometry::create(1, 0.4f, 128, 16);
+
+    BVH capped(8, 4);
+    capped.build(*geometry);
+    REQUIRE(capped.depth() <= 5);
+
+    BVH bvh(4);
+    bvh.build(*geometry);
+
+    std::vector<BVHBox3> boxes;
+    bvh.collectBoxes(boxes);
+    REQUIRE(boxes.size() == bvh.nodeCount());
+    REQUIRE(!boxes.front().isLeaf());
+
+    BVH empty;
+    REQUIRE(!empty.raycast(Ray()).has_value());
+    REQUIRE(!BVH::intersects(empty, bvh));
+}
@@ -0,0 +1,133 @@
+// mergeVertices on a scan-sized triangle soup, against the implementation it
+// replaced.
+//
+// Not a ctest — run manually. The soup is a SphereGeometry de-indexed, so
+// every vertex appears about six times with position, normal and uv: what a
+// scanned mesh looks like coming out of an STL/OBJ-style reader. The legacy
+// path below is the former mergeVertices — one std::string key per vertex
+// across every attribute, looked up in an unordered_map<std::string> —
+// trimmed to float attributes; both outputs are compared before timing.
+//
+// Phases:
+//   legacy  — string keys
+//   serial  — mergeVertices inside a ThreadPool::SerialScope
+//   pooled  — mergeVertices on the shared pool
+//
+// Usage: MergeVertices_bench [vertices]   (default 3000000)
+
+#include "threepp/geometries/SphereGeometry.hpp"
+#include "threepp/utils/BufferGeometryUtils.hpp"
+#include "threepp/utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    template<class F>
+    double medianMs(int reps, F&& fn) {
+        std::vector<double> samples;
+        for (int i = 0; i < reps; ++i) {
+            const auto t0 = Clock::now();
+            fn();
+            samples.push_back(msSince(t0));
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    struct Welded {
+        std::vector<unsigned int> index;
+        std::unordered_map<std::string, std::vector<float>> attributes;
+    };
+
+    Welded legacyMergeVertices(const BufferGeometry& geometry, float tolerance = 1e-4f) {
+
+        const auto& srcAttributes = geometry.getAttributes();
+        const auto vertexCount = static_cast<unsigned int>(geometry.getAttribute<float>("position")->count());
+        const double shiftMultiplier = std::pow(10.0, std::log10(1.0 / static_cast<double>(tolerance)));
+
+        Welded out;
+        std::unordered_map<std::string, unsigned int> hashToIndex;
+        unsigned int nextIndex = 0;
+        std::string hash;
+
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+
+            hash.clear();
+            for (const auto& [name, attr] : srcAttributes) {
+                const auto& array = attr->typed<float>()->array();
+                for (int k = 0; k < attr->itemSize(); ++k) {
+                    hash += std::to_string(static_cast<long long>(static_cast<double>(array[i * attr->itemSize() + k]) * shiftMultiplier));
+                    hash += ',';
+                }
+            }
+
+            if (auto it = hashToIndex.find(hash); it != hashToIndex.end()) {
+                out.index.emplace_back(it->second);
+            } else {
+                for (const auto& [name, attr] : srcAttributes) {
+                    const auto& array = attr->typed<float>()->array();
+                    auto& dst = out.attributes[name];
+                    for (int k = 0; k < attr->itemSize(); ++k) dst.emplace_back(array[i * attr->itemSize() + k]);
+                }
+                hashToIndex[hash] = nextIndex;
+                out.index.emplace_back(nextIndex++);
+            }
+        }
+        return out;
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+
+    const std::size_t target = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 3000000;
+
+    // widthSegments * heightSegments * 6 soup vertices, at a 2:1 aspect.
+    const auto height = static_cast<unsigned>(std::max(4.0, std::sqrt(target / 12.0)));
+    const auto soup = SphereGeometry::create(1, height * 2, height)->toNonIndexed();
+    const auto vertices = soup->getAttribute<float>("position")->count();
+
+    std::printf("MergeVertices_bench  vertices=%d  lanes=%u\n", vertices, ThreadPool::global().concurrency());
+
+    Welded legacy;
+    const double legacyMs = medianMs(3, [&] { legacy = legacyMergeVertices(*soup); });
+
+    std::shared_ptr<BufferGeometry> welded;
+    const double serialMs = medianMs(3, [&] {
+        ThreadPool::SerialScope serial;
+        welded = mergeVertices(*soup);
+    });
+    const double pooledMs = medianMs(3, [&] { welded = mergeVertices(*soup); });
+
+    bool same = welded->getIndex()->array() == legacy.index;
+    for (const auto& [name, values] : legacy.attributes) {
+        same = same && welded->getAttribute<float>(name)->array() == values;
+    }
+    if (!same) {
+        std::printf("output differs from the legacy implementation\n");
+        return 1;
+    }
+
+    std::printf("welded   %d -> %d vertices\n", vertices, welded->getAttribute<float>("position")->count());
+    std::printf("legacy   %9.2f ms\n", legacyMs);
+    std::printf("serial   %9.2f ms   (%.1fx)\n", serialMs, legacyMs / serialMs);
+    std::printf("pooled   %9.2f ms   (%.1fx)\n", pooledMs, legacyMs / pooledMs);
+
+    return 0;
+}
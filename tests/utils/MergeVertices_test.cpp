@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "threepp/geometries/BoxGeometry.hpp"
+#include "threepp/geometries/SphereGeometry.hpp"
+#include "threepp/utils/BufferGeometryUtils.hpp"
+#include "threepp/utils/ThreadPool.hpp"
+
+#include <vector>
+
+using namespace threepp;
+
+namespace {
+
+    std::vector<float> positionsOf(const BufferGeometry& geometry) {
+        std::vector<float> out;
+        const auto* pos = geometry.getAttribute<float>("position");
+        const auto* index = geometry.getIndex();
+        const int count = index ? index->count() : pos->count();
+        for (int i = 0; i < count; ++i) {
+            const int v = index ? index->getX(i) : i;
+            out.insert(out.end(), {pos->getX(v), pos->getY(v), pos->getZ(v)});
+        }
+        return out;
+    }
+
+    std::shared_ptr<BufferGeometry> makeStrip(std::vector<float> positions, std::vector<unsigned int> ids) {
+        auto geometry = BufferGeometry::create();
+        geometry->setAttribute("position", FloatBufferAttribute::create(std::move(positions), 3));
+        if (!ids.empty()) geometry->setAttribute("id", TypedBufferAttribute<unsigned int>::create(std::move(ids), 1));
+        return geometry;
+    }
+
+}// namespace
+
+TEST_CASE("mergeVertices welds a triangle soup back to its shared vertices") {
+
+    const auto box = BoxGeometry::create(1, 2, 3, 2, 2, 2);
+    const auto soup = box->toNonIndexed();
+
+    const auto welded = mergeVertices(*soup);
+    REQUIRE(welded);
+
+    // Normals and uvs keep the faces apart, so exactly the indexed box's
+    // vertices come back, and every triangle still draws the same corners.
+    CHECK(welded->getAttribute<float>("position")->count() == box->getAttribute<float>("position")->count());
+    CHECK(welded->getIndex()->count() == soup->getAttribute<float>("position")->count());
+    CHECK(positionsOf(*welded) == positionsOf(*soup));
+    CHECK(welded->getAttribute<float>("uv")->count() == welded->getAttribute<float>("position")->count());
+}
+
+TEST_CASE("mergeVertices numbers vertices by first occurrence") {
+
+    // 0 and 2 share a tolerance bucket, 1 and 3 are the same point.
+    const auto geometry = makeStrip({1, 1, 1, 0, 0, 0, 1.00001f, 1, 1, 0, 0, 0, 2, 2, 2, 0.9999f, 1, 1}, {});
+    const auto welded = mergeVertices(*geometry);
+
+    const auto& index = welded->getIndex()->array();
+    CHECK(index == std::vector<unsigned int>{0, 1, 0, 1, 2, 3});
+
+    // Each welded vertex keeps the values of its first occurrence.
+    const auto& position = welded->getAttribute<float>("position")->array();
+    CHECK(position == std::vector<float>{1, 1, 1, 0, 0, 0, 2, 2, 2, 0.9999f, 1, 1});
+}
+
+TEST_CASE("mergeVertices keys on every attribute") {
+
+    const auto geometry = makeStrip({0, 0, 0, 0, 0, 0, 0, 0, 0}, {7, 8, 7});
+    const auto welded = mergeVertices(*geometry);
+
+    CHECK(welded->getIndex()->array() == std::vector<unsigned int>{0, 1, 0});
+    CHECK(welded->getAttribute<unsigned int>("id")->array() == std::vector<unsigned int>{7, 8});
+}
+
+TEST_CASE("mergeVertices is the same serial and pooled") {
+
+    const auto soup = SphereGeometry::create(1, 128, 96)->toNonIndexed();
+
+    const auto pooled = mergeVertices(*soup);
+    std::shared_ptr<BufferGeometry> serial;
+    {
+        ThreadPool::SerialScope scope;
+        serial = mergeVertices(*soup);
+    }
+
+    CHECK(pooled->getIndex()->array() == serial->getIndex()->array());
+    for (const auto* name : {"position", "normal", "uv"}) {
+        CHECK(pooled->getAttribute<float>(name)->array() == serial->getAttribute<float>(name)->array());
+    }
+}
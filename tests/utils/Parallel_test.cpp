@@ -0,0 +1,113 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "threepp/utils/Parallel.hpp"
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace threepp;
+
+
+TEST_CASE("parallelFor covers every index exactly once") {
+
+    for (const std::size_t grain : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{100000}}) {
+
+        // Catch2 assertions are not thread-safe: collect, then check here.
+        std::vector<int> hits(10007, 0);
+        std::atomic<bool> badPiece{false};
+        parallelFor(0, hits.size(), grain, [&](std::size_t lo, std::size_t hi) {
+            if (lo >= hi || (grain > 0 && hi - lo > grain)) badPiece = true;
+            for (std::size_t i = lo; i < hi; ++i) ++hits[i];
+        });
+
+        REQUIRE(!badPiece);
+        for (int h : hits) REQUIRE(h == 1);
+    }
+}
+
+TEST_CASE("parallelFor on an empty range does nothing") {
+
+    bool called = false;
+    parallelFor(5, 5, 0, [&](std::size_t, std::size_t) { called = true; });
+    parallelFor(5, 3, 0, [&](std::size_t, std::size_t) { called = true; });
+    REQUIRE(!called);
+}
+
+TEST_CASE("Nested parallelFor completes") {
+
+    std::vector<std::atomic<int>> sums(64);
+    parallelFor(0, sums.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            parallelFor(0, 1000, 10, [&](std::size_t a, std::size_t b) {
+                sums[i] += static_cast<int>(b - a);
+            });
+        }
+    });
+
+    for (const auto& s : sums) REQUIRE(s.load() == 1000);
+}
+
+TEST_CASE("parallelFor rethrows on the caller") {
+
+    REQUIRE_THROWS_AS(parallelFor(0, 1000, 1, [&](std::size_t lo, std::size_t) {
+                          if (lo == 500) throw std::runtime_error("boom");
+                      }),
+                      std::runtime_error);
+
+    // The pool is still usable afterwards.
+    std::atomic<int> count{0};
+    parallelFor(0, 100, 1, [&](std::size_t lo, std::size_t hi) { count += static_cast<int>(hi - lo); });
+    REQUIRE(count == 100);
+}
+
+TEST_CASE("parallelReduce is deterministic and matches the serial fold") {
+
+    std::vector<float> v(100003);
+    for (std::size_t i = 0; i < v.size(); ++i) v[i] = 1.f / static_cast<float>(i + 1);
+
+    const auto sum = [&] {
+        return parallelReduce(0, v.size(), 0, 0.f,
+                              [&](std::size_t lo, std::size_t hi) {
+                                  float s = 0.f;
+                                  for (std::size_t i = lo; i < hi; ++i) s += v[i];
+                                  return s;
+                              },
+                              [](float a, float b) { return a + b; });
+    };
+
+    const float parallel = sum();
+    float serial;
+    {
+        ThreadPool::SerialScope scope;
+        REQUIRE(ThreadPool::serialOnThisThread());
+        serial = sum();
+    }
+    REQUIRE(!ThreadPool::serialOnThisThread());
+
+    // Same partition either way, so bit-identical — not merely close.
+    REQUIRE(parallel == serial);
+    for (int i = 0; i < 10; ++i) REQUIRE(sum() == parallel);
+}
+
+TEST_CASE("parallelForEach visits every element") {
+
+    std::vector<int> v(5000);
+    std::iota(v.begin(), v.end(), 0);
+    parallelForEach(v.begin(), v.end(), [](int& x) { x *= 2; });
+    for (std::size_t i = 0; i < v.size(); ++i) REQUIRE(v[i] == static_cast<int>(i) * 2);
+}
+
+TEST_CASE("Private pool") {
+
+    ThreadPool pool(3);
+    REQUIRE(pool.concurrency() == 4);
+    REQUIRE(!pool.isWorkerThread());
+
+    std::atomic<std::size_t> total{0};
+    const auto body = [&](std::size_t lo, std::size_t hi) { total += hi - lo; };
+    pool.parallelFor(0, 4096, 1, {[](void* ctx, std::size_t lo, std::size_t hi) { (*static_cast<decltype(body)*>(ctx))(lo, hi); },
+                                  const_cast<void*>(static_cast<const void*>(&body))});
+    REQUIRE(total == 4096);
+}
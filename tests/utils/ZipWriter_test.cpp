@@ -6,6 +6,9 @@
 
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -77,3 +80,182 @@ TEST_CASE("An archive round-trips its bytes, and says the same thing twice") {
     CHECK(flags == 0);
     CHECK(size == document.size());
 }
+
+TEST_CASE("A mapped archive serves the same bytes in place, and still refuses a truncated one") {
+
+    std::vector<unsigned char> payload(70000);
+    for (size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<unsigned char>(i * 31 + 7);
+
+    const auto dir = std::filesystem::temp_directory_path() / "threepp-zipwriter-test";
+    std::filesystem::create_directories(dir);
+
+    const auto path = dir / "mapped.tpz";
+    {
+        ZipWriter writer;
+        writer.add("scene.json", std::string("{}"));
+        writer.add("buffers/big.bin", payload);
+        writer.add("empty.bin", std::vector<unsigned char>{});
+        writer.writeTo(path);
+    }
+
+    for (const bool memoryMap : {true, false}) {
+
+        ZipReader reader(path, memoryMap);
+#ifndef _WIN32
+        CHECK(reader.mapped() == memoryMap);
+#endif
+
+        const auto view = reader.view("buffers/big.bin");
+        REQUIRE(view.size() == payload.size());
+        const auto* first = reinterpret_cast<const unsigned char*>(view.data());
+        CHECK(std::vector<unsigned char>(first, first + view.size()) == payload);
+        CHECK(reader.read("buffers/big.bin") == payload);
+        // bytes() borrows a stored member rather than copying it.
+        CHECK(reader.bytes("buffers/big.bin").view().data() == view.data());
+        CHECK(reader.view("empty.bin").empty());
+        CHECK_THROWS_AS(reader.view("missing.bin"), std::runtime_error);
+
+        // Copies share the one mapping, so a view outlives the reader it came from.
+        std::span<const std::byte> kept;
+        {
+            const ZipReader copy = reader;
+            kept = copy.view("buffers/big.bin");
+        }
+        CHECK(kept.data() == view.data());
+    }
+
+    // Every bound is still checked against the real length: cut the file inside
+    // the payload and the central directory no longer matches what is there.
+    const auto bytes = fileBytes(path);
+    const auto truncated = dir / "truncated.tpz";
+    {
+        std::ofstream out(truncated, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    CHECK_THROWS_AS(ZipReader(truncated, true), std::runtime_error);
+    CHECK_THROWS_AS(ZipReader(truncated, false), std::runtime_error);
+}
+
+TEST_CASE("Deflated entries round-trip, and ones that do not shrink are stored") {
+
+    // Attribute-like data: repetitive, so it deflates well.
+    std::vector<unsigned char> indices;
+    for (std::uint32_t i = 0; i < 50000; ++i) {
+        for (int b = 0; b < 4; ++b) indices.push_back(static_cast<unsigned char>((i / 3) >> (8 * b)));
+    }
+    // Noise: deflate cannot help, so the writer must fall back to stored.
+    std::vector<unsigned char> noise(20000);
+    std::uint32_t state = 12345;
+    for (auto& byte : noise) {
+        state = state * 1664525u + 1013904223u;
+        byte = static_cast<unsigned char>(state >> 24);
+    }
+
+    const auto dir = std::filesystem::temp_directory_path() / "threepp-zipwriter-test";
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "deflated.tpz";
+
+    std::string document = R"({"metadata":{"version":4.5},"object":{"children":[)";
+    for (int i = 0; i < 200; ++i) document += R"({"type":"Mesh","name":"part )" + std::to_string(i) + R"("},)";
+    document += "{}]}}";
+
+    ZipWriter writer;
+    writer.add("scene.json", document, ZipWriter::Compression::Deflate);
+    writer.add("buffers/index.bin", indices, ZipWriter::Compression::Deflate);
+    writer.add("buffers/noise.bin", noise, ZipWriter::Compression::Deflate);
+    writer.add("buffers/empty.bin", std::vector<unsigned char>{}, ZipWriter::Compression::Deflate);
+    writer.writeTo(path);
+
+    // writeTo streams what build() assembles; they are the same bytes.
+    CHECK(fileBytes(path) == writer.build());
+    CHECK(std::filesystem::file_size(path) < indices.size() / 2 + noise.size() + 1000);
+
+    for (const bool memoryMap : {true, false}) {
+
+        ZipReader reader(path, memoryMap);
+        CHECK(reader.read("buffers/index.bin") == indices);
+        CHECK(reader.read("buffers/noise.bin") == noise);
+        CHECK(reader.read("buffers/empty.bin").empty());
+
+        // A deflated member has nothing in the file to view in place; bytes()
+        // inflates it into a buffer the caller owns, and the reader keeps none.
+        CHECK_THROWS_AS(reader.view("buffers/index.bin"), std::runtime_error);
+        const auto member = reader.bytes("buffers/index.bin");
+        CHECK(!member.owned.empty());
+        const auto view = member.view();
+        const auto* first = reinterpret_cast<const unsigned char*>(view.data());
+        CHECK(std::vector<unsigned char>(first, first + view.size()) == indices);
+    }
+
+    // A flipped byte in the deflated payload must not come back as data.
+    auto bytes = fileBytes(path);
+    const auto corrupt = dir / "corrupt.tpz";
+    {
+        // scene.json is first in the file and deflated; damage it a little
+        // way in.
+        bytes[30 + std::string("scene.json").size() + 40] ^= 0x55;
+        std::ofstream out(corrupt, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+    ZipReader damaged(corrupt);
+    CHECK(ZipReader(path).read("scene.json") == std::vector<unsigned char>(document.begin(), document.end()));
+    CHECK_THROWS_AS(damaged.read("scene.json"), std::runtime_error);
+    CHECK(damaged.read("buffers/index.bin") == indices);
+}
+
+TEST_CASE("An entry copied from another archive is written as if it had been added") {
+
+    std::vector<unsigned char> repetitive;
+    for (std::uint32_t i = 0; i < 20000; ++i) repetitive.push_back(static_cast<unsigned char>(i / 7));
+    const std::vector<unsigned char> small{1, 2, 3, 4, 5};
+
+    const auto dir = std::filesystem::temp_directory_path() / "threepp-zipwriter-test";
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "source.tpz";
+
+    ZipWriter source;
+    source.add("buffers/a.bin", repetitive, ZipWriter::Compression::Deflate);
+    source.add("buffers/b.bin", small, ZipWriter::Compression::Stored);
+    source.writeTo(path);
+
+    const auto reader = std::make_shared<const ZipReader>(path);
+    CHECK(reader->stored("buffers/a.bin").deflated);
+    CHECK(reader->stored("buffers/a.bin").size == repetitive.size());
+    CHECK_FALSE(reader->stored("buffers/b.bin").deflated);
+
+    ZipWriter copied;
+    copied.add("scene.json", std::string("{}"));
+    copied.copy("buffers/a.bin", reader, "buffers/a.bin");
+    copied.copy("buffers/b.bin", reader, "buffers/b.bin");
+
+    ZipWriter added;
+    added.add("buffers/b.bin", small);
+    added.add("buffers/a.bin", repetitive, ZipWriter::Compression::Deflate);
+    added.add("scene.json", std::string("{}"));
+
+    CHECK(copied.build() == added.build());
+
+    CHECK_THROWS_AS(copied.copy("buffers/a.bin", reader, "buffers/a.bin"), std::runtime_error);
+    CHECK_THROWS_AS(copied.copy("buffers/c.bin", reader, "buffers/missing.bin"), std::runtime_error);
+}
+
+TEST_CASE("65535 entries or more go through the ZIP64 end records") {
+
+    const auto dir = std::filesystem::temp_directory_path() / "threepp-zipwriter-test";
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "many.tpz";
+
+    constexpr int count = 70000;
+    {
+        ZipWriter writer;
+        for (int i = 0; i < count; ++i) {
+            writer.add("e/" + std::to_string(i), std::vector<unsigned char>{static_cast<unsigned char>(i)});
+        }
+        writer.writeTo(path);
+    }
+
+    ZipReader reader(path);
+    REQUIRE(reader.names().size() == count);
+    CHECK(reader.read("e/0") == std::vector<unsigned char>{0});
+    CHECK(reader.read("e/69999") == std::vector<unsigned char>{static_cast<unsigned char>(69999)});
+}